@@ -0,0 +1,203 @@
+//checks the register values adc_plan() (MyDrivers/myadc.c) works out for the trigger rates the programs use
+//
+//  adc_rates                        exit status 0 when every case matches
+//
+//fixed cases (single and dual ADC) compare every register against values worked out by hand from RM0008 , the sweep then checks for each
+//rate from 1 Hz to 200 kHz at 8 , 32 and 72 MHz that the plan either hits the rate within 0.1% (one timer tick at the
+//top end) and leaves room for the scan , or refuses it because the scan does not fit
+
+#include <stdio.h>
+#include <string.h>
+#include "stm32f1xx.h"
+#include "myadc.h"
+
+typedef struct
+{
+	const char *name;
+	adc_config_t cfg;
+	uint32_t timer_clock;
+	uint32_t pclk2;
+	int err;
+	adc_plan_t want;		//checked when err is 0
+} plan_case_t;
+
+#define JOY .channels = { 5, 6 }, .smp = { ADC_SMP_41_5, ADC_SMP_41_5 }
+
+//a plan in RM0008 terms , the ADC2 registers stay 0 outside dual mode
+#define PLAN(adcpre_, clk, cr1_, cr2_, sqr1_, sqr2_, sqr3_, smpr1_, smpr2_, cndtr_, psc_, arr_, ccr_, scan, rate, dma) \
+	.adcpre = adcpre_, .adc_clock = clk, .cr1 = cr1_, .cr2 = cr2_, .sqr1 = sqr1_, .sqr2 = sqr2_, .sqr3 = sqr3_, \
+	.smpr1 = smpr1_, .smpr2 = smpr2_, .cndtr = cndtr_, .psc = psc_, .arr = arr_, .ccr = ccr_, .scan_ns = scan, \
+	.rate_mhz = rate, .dma_ccr = dma
+
+#define JOY_SQR3 (5 | 6 << 5)
+#define JOY_SMPR2 (4 << 15 | 4 << 18)
+#define TIM3_CR2 (ADC_CR2_DMA | ADC_CR2_EXTTRIG | (4 << 17))
+#define TIM2_CR2 (ADC_CR2_DMA | ADC_CR2_EXTTRIG | (3 << 17))
+#define DMA16 (DMA_CCR_CIRC | DMA_CCR_MINC | DMA_CCR_MSIZE_0 | DMA_CCR_PSIZE_0 | DMA_CCR_HTIE | DMA_CCR_TCIE)
+#define DMA32 (DMA_CCR_CIRC | DMA_CCR_MINC | DMA_CCR_MSIZE_1 | DMA_CCR_PSIZE_1 | DMA_CCR_HTIE | DMA_CCR_TCIE)
+#define ADC2_SWSTART (ADC_CR2_EXTTRIG | (7 << 17))
+
+static const plan_case_t cases[] =
+{
+	//joysticks at 1 kHz on HSI (8 MHz everywhere): ADC clock 4 MHz , 2 x 54 cycles = 27 us per scan , 8000 ticks
+	{ .name = "joystick 1k @8M", .cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM3_TRGO, .block = 8, .nch = 2, JOY },
+	  .timer_clock = 8000000, .pclk2 = 8000000,
+	  .want = { PLAN(0, 4000000, ADC_CR1_SCAN, TIM3_CR2, 1 << 20, 0, JOY_SQR3, 0, JOY_SMPR2, 32, 0, 7999, 4000, 27000, 1000000, DMA16) } },
+	//same at 32 MHz (motor_code_tx): /4 -> 8 MHz , 13.5 us per scan
+	{ .name = "joystick 1k @32M", .cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM3_TRGO, .block = 8, .nch = 2, JOY },
+	  .timer_clock = 32000000, .pclk2 = 32000000,
+	  .want = { PLAN(1, 8000000, ADC_CR1_SCAN, TIM3_CR2, 1 << 20, 0, JOY_SQR3, 0, JOY_SMPR2, 32, 0, 31999, 16000, 13500, 1000000, DMA16) } },
+	//72 MHz: /6 -> 12 MHz , 72000 ticks need PSC 1
+	{ .name = "joystick 1k @72M", .cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM2_CC2, .block = 0, .nch = 2, JOY },
+	  .timer_clock = 72000000, .pclk2 = 72000000,
+	  .want = { PLAN(2, 12000000, ADC_CR1_SCAN, TIM2_CR2, 1 << 20, 0, JOY_SQR3, 0, JOY_SMPR2, 64, 1, 35999, 18000, 9000, 1000000, DMA16) } },
+	//current sensor at 20 kHz on channel 5 , 13.5 cycles: 26 cycles at 4 MHz = 6.5 us of a 50 us period
+	{ .name = "current 20k @8M", .cfg = { .rate = 20000, .trigger = ADC_TRIG_TIM2_CC2, .block = 16, .nch = 1, .channels = { 5 },
+	  .smp = { ADC_SMP_13_5 } }, .timer_clock = 8000000, .pclk2 = 8000000,
+	  .want = { PLAN(0, 4000000, 0, TIM2_CR2, 0, 0, 5, 0, 2 << 15, 32, 0, 399, 200, 6500, 20000000, DMA16) } },
+	//free running , the rate follows from the sample times alone: 4 MHz / 108 cycles
+	{ .name = "continuous @8M", .cfg = { .rate = 0, .trigger = ADC_TRIG_CONT, .block = 16, .nch = 2, JOY },
+	  .timer_clock = 8000000, .pclk2 = 8000000,
+	  .want = { PLAN(0, 4000000, ADC_CR1_SCAN, ADC_CR2_DMA | ADC_CR2_CONT, 1 << 20, 0, JOY_SQR3, 0, JOY_SMPR2, 64, 0, 0, 0, 27000, 37037037, DMA16) } },
+	//channels 10-17 go to SMPR1 , entries 7-12 to SQR2 and 13-16 to SQR1
+	{ .name = "16 entries", .cfg = { .rate = 100, .trigger = ADC_TRIG_TIM3_TRGO, .block = 1, .nch = 16,
+	  .channels = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 16, 17 }, .smp = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 7, 7 } },
+	  .timer_clock = 8000000, .pclk2 = 8000000,
+	  .want = { PLAN(0, 4000000, ADC_CR1_SCAN, TIM3_CR2, 15 << 20 | 12 | 13 << 5 | 16 << 10 | 17 << 15, 6 | 7 << 5 | 8 << 10 | 9 << 15 | 10 << 20 | 11 << 25,
+	    0 | 1 << 5 | 2 << 10 | 3 << 15 | 4 << 20 | 5 << 25, 2 | 2 << 3 | 2 << 6 | 2 << 9 | 7 << 18 | 7 << 21, 0x09249249, 32, 1, 39999, 20000,
+	    (10 * 20 + 4 * 26 + 2 * 252) * 250, 100000, DMA16) } },
+	//X on ADC1 and Y on ADC2 at the same instant: one 41.5 cycle conversion per scan , pairs packed in 32 bit words
+	{ .name = "dual joystick @8M", .cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM3_TRGO, .block = 10, .nch = 1, .channels = { 5 },
+	  .smp = { ADC_SMP_41_5 }, .dual = 1, .channels2 = { 6 } }, .timer_clock = 8000000, .pclk2 = 8000000,
+	  .want = { PLAN(0, 4000000, 6 << 16, TIM3_CR2, 0, 0, 5, 0, 4 << 15, 20, 0, 7999, 4000, 13500, 1000000, DMA32),
+	    .adc2_cr1 = 0, .adc2_cr2 = ADC2_SWSTART, .adc2_sqr1 = 0, .adc2_sqr2 = 0, .adc2_sqr3 = 6, .adc2_smpr1 = 0, .adc2_smpr2 = 4 << 18 } },
+	//two pairs (X , Y) and (current , voltage) , ADC2 keeps CONT in step with ADC1
+	{ .name = "dual continuous", .cfg = { .rate = 0, .trigger = ADC_TRIG_CONT, .block = 16, .nch = 2, JOY, .dual = 1, .channels2 = { 8, 9 } },
+	  .timer_clock = 8000000, .pclk2 = 8000000,
+	  .want = { PLAN(0, 4000000, ADC_CR1_SCAN | 6 << 16, ADC_CR2_DMA | ADC_CR2_CONT, 1 << 20, 0, JOY_SQR3, 0, JOY_SMPR2, 64, 0, 0, 0, 27000, 37037037, DMA32),
+	    .adc2_cr1 = ADC_CR1_SCAN, .adc2_cr2 = ADC2_SWSTART | ADC_CR2_CONT, .adc2_sqr1 = 1 << 20, .adc2_sqr2 = 0, .adc2_sqr3 = 8 | 9 << 5,
+	    .adc2_smpr1 = 0, .adc2_smpr2 = 4 << 24 | 4 << 27 } },
+	{ .name = "dual same channel", .cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM3_TRGO, .nch = 2, JOY, .dual = 1, .channels2 = { 6, 6 } },
+	  .timer_clock = 8000000, .pclk2 = 8000000, .err = ADC_ERR_CHANNELS },
+	{ .name = "dual 9 pairs", .cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM3_TRGO, .nch = 9, .dual = 1, .channels2 = { 1 } },
+	  .timer_clock = 8000000, .pclk2 = 8000000, .err = ADC_ERR_CHANNELS },
+	{ .name = "too fast", .cfg = { .rate = 200000, .trigger = ADC_TRIG_TIM3_TRGO, .nch = 2, .channels = { 5, 6 },
+	  .smp = { ADC_SMP_239_5, ADC_SMP_239_5 } }, .timer_clock = 72000000, .pclk2 = 72000000, .err = ADC_ERR_RATE },
+	{ .name = "rate 0", .cfg = { .rate = 0, .trigger = ADC_TRIG_TIM3_TRGO, .nch = 2, JOY },
+	  .timer_clock = 8000000, .pclk2 = 8000000, .err = ADC_ERR_RATE },
+	{ .name = "no channels", .cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM3_TRGO, .nch = 0 },
+	  .timer_clock = 8000000, .pclk2 = 8000000, .err = ADC_ERR_CHANNELS },
+	{ .name = "channel 18", .cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM3_TRGO, .nch = 1, .channels = { 18 } },
+	  .timer_clock = 8000000, .pclk2 = 8000000, .err = ADC_ERR_CHANNELS },
+	{ .name = "block too big", .cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM3_TRGO, .block = ADC_BLOCK_SCANS + 1, .nch = 2, JOY },
+	  .timer_clock = 8000000, .pclk2 = 8000000, .err = ADC_ERR_BLOCK },
+	{ .name = "bad trigger", .cfg = { .rate = 1000, .trigger = 7, .nch = 2, JOY },
+	  .timer_clock = 8000000, .pclk2 = 8000000, .err = ADC_ERR_TRIGGER },
+};
+
+static int check(const char *name, const char *field, uint32_t got, uint32_t want)
+{
+	if (got == want)
+		return 0;
+	printf("  %-18s %-11s 0x%08X , want 0x%08X\n", name, field, got, want);
+	return 1;
+}
+
+static int fixed_cases(void)
+{
+	int failed = 0;
+
+	for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		const plan_case_t *c = &cases[i];
+		adc_plan_t p;
+		int bad = 0;
+		int err = adc_plan(&c->cfg, c->timer_clock, c->pclk2, &p);
+
+		bad |= check(c->name, "result", err, c->err);
+		if (!err && !c->err)
+		{
+			bad |= check(c->name, "adcpre", p.adcpre, c->want.adcpre);
+			bad |= check(c->name, "adc_clock", p.adc_clock, c->want.adc_clock);
+			bad |= check(c->name, "cr1", p.cr1, c->want.cr1);
+			bad |= check(c->name, "cr2", p.cr2, c->want.cr2);
+			bad |= check(c->name, "sqr1", p.sqr1, c->want.sqr1);
+			bad |= check(c->name, "sqr2", p.sqr2, c->want.sqr2);
+			bad |= check(c->name, "sqr3", p.sqr3, c->want.sqr3);
+			bad |= check(c->name, "smpr1", p.smpr1, c->want.smpr1);
+			bad |= check(c->name, "smpr2", p.smpr2, c->want.smpr2);
+			bad |= check(c->name, "cndtr", p.cndtr, c->want.cndtr);
+			bad |= check(c->name, "psc", p.psc, c->want.psc);
+			bad |= check(c->name, "arr", p.arr, c->want.arr);
+			bad |= check(c->name, "ccr", p.ccr, c->want.ccr);
+			bad |= check(c->name, "scan_ns", p.scan_ns, c->want.scan_ns);
+			bad |= check(c->name, "rate_mhz", p.rate_mhz, c->want.rate_mhz);
+			bad |= check(c->name, "dma_ccr", p.dma_ccr, c->want.dma_ccr);
+			bad |= check(c->name, "adc2_cr1", p.adc2_cr1, c->want.adc2_cr1);
+			bad |= check(c->name, "adc2_cr2", p.adc2_cr2, c->want.adc2_cr2);
+			bad |= check(c->name, "adc2_sqr1", p.adc2_sqr1, c->want.adc2_sqr1);
+			bad |= check(c->name, "adc2_sqr2", p.adc2_sqr2, c->want.adc2_sqr2);
+			bad |= check(c->name, "adc2_sqr3", p.adc2_sqr3, c->want.adc2_sqr3);
+			bad |= check(c->name, "adc2_smpr1", p.adc2_smpr1, c->want.adc2_smpr1);
+			bad |= check(c->name, "adc2_smpr2", p.adc2_smpr2, c->want.adc2_smpr2);
+		}
+		printf("%-18s %s", c->name, bad ? "FAIL\n" : "ok");
+		if (!bad && !err)
+			printf("  PSC %u ARR %u -> %.3f Hz , scan %.1f us\n", p.psc, p.arr, p.rate_mhz / 1000.0, p.scan_ns / 1000.0);
+		else if (!bad)
+			printf("  refused (%d)\n", err);
+		failed |= bad;
+	}
+	return failed;
+}
+
+static int sweep(void)
+{
+	static const uint32_t clocks[] = { 8000000, 32000000, 72000000 };
+	adc_config_t cfg = { .rate = 0, .trigger = ADC_TRIG_TIM3_TRGO, .nch = 2, JOY };
+	uint32_t planned = 0, refused = 0, failed = 0;
+
+	for (unsigned k = 0; k < 3; k++)
+	{
+		for (uint32_t rate = 1; rate <= 200000; rate += rate < 1000 ? 1 : rate / 997)
+		{
+			adc_plan_t p;
+			double ticks, err;
+
+			cfg.rate = rate;
+			if (adc_plan(&cfg, clocks[k], clocks[k], &p))
+			{
+				//only allowed when the scan really does not fit
+				if (1e9 / rate >= p.scan_ns * 1.001)
+				{
+					printf("  %u Hz @%u refused although a scan takes %u ns\n", rate, clocks[k], p.scan_ns);
+					failed++;
+				}
+				refused++;
+				continue;
+			}
+			ticks = (double) (p.psc + 1) * (p.arr + 1);
+			err = (clocks[k] / ticks - rate) / rate;
+			if (err < 0)
+				err = -err;
+			//rounding to whole ticks costs at most half a tick of the period
+			if ((err > 0.001 && err * ticks > 0.5 * (p.psc + 1) + 1e-9) || ticks * 1e9 / clocks[k] < p.scan_ns)
+			{
+				printf("  %u Hz @%u: PSC %u ARR %u is %.4f%% off\n", rate, clocks[k], p.psc, p.arr, err * 100);
+				failed++;
+			}
+			planned++;
+		}
+	}
+	printf("sweep              %s  %u rates planned , %u refused\n", failed ? "FAIL" : "ok", planned, refused);
+	return failed != 0;
+}
+
+int main(void)
+{
+	int failed = fixed_cases();
+
+	failed |= sweep();
+	printf("%s\n", failed ? "FAIL" : "PASS");
+	return failed;
+}
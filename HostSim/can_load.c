@@ -0,0 +1,252 @@
+//CAN load test , runs MyDrivers/mycan.c against two peer nodes on the simulated bus
+//
+//  can_load                      both 250 kbit/s and 1 Mbit/s , one child process each
+//  can_load <bitrate> [seconds] [time scale]
+//
+//CAN1 keeps its tx queue full with id 0x100 , peer "hi" sends id 0x080 every 2 ms and peer "lo" keeps id 0x200 going
+//back to back , so the bus is saturated and CAN1 both wins and loses arbitration
+//exit status is 0 when the bus stayed above 90% load , nothing was lost or reordered and every sequence arrived
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "stm32f1xx.h"
+#include "mmio.h"
+#include "cansim.h"
+#include "mycan.h"
+#include "mycanfilter.h"
+
+#define ID_DUT 0x100
+#define ID_HI 0x080
+#define ID_LO 0x200
+#define HI_PERIOD_NS 2000000ULL
+#define SEQ_SLOTS 4096
+#define MAX_SAMPLES 200000
+
+typedef struct
+{
+	uint32_t samples[MAX_SAMPLES];
+	uint32_t n;
+	uint32_t max;
+} latency_t;
+
+static latency_t rx_latency;		//end of frame on the bus -> CAN1 rx interrupt , ns
+static latency_t tx_latency;		//can_send() -> transmission complete , ns
+
+static uint64_t frame_end[2][SEQ_SLOTS];	//per peer , when each sequence number left the bus
+static uint32_t next_rx_seq[2];
+static uint32_t rx_seq_errors;
+static uint32_t dut_seq_seen, dut_seq_errors;
+static uint32_t hi_seq, lo_seq;
+static cansim_node_t *hi, *lo;
+
+static void sample(latency_t *l, uint32_t ns)
+{
+	if (l->n < MAX_SAMPLES)
+		l->samples[l->n++] = ns;
+	if (ns > l->max)
+		l->max = ns;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+
+	return x < y ? -1 : x > y;
+}
+
+static uint32_t percentile(latency_t *l, int p)
+{
+	if (!l->n)
+		return 0;
+	qsort(l->samples, l->n, sizeof(uint32_t), cmp_u32);
+	return l->samples[(uint64_t) (l->n - 1) * p / 100];
+}
+
+static void put_seq(cansim_frame_t *f, uint32_t id, uint32_t seq)
+{
+	memset(f, 0, sizeof(*f));
+	f->id = id;
+	f->dlc = 8;
+	f->data[0] = seq;
+	f->data[1] = seq >> 8;
+	f->data[2] = seq >> 16;
+	f->data[3] = seq >> 24;
+}
+
+static uint32_t get_seq(const uint8_t *d)
+{
+	return d[0] | (d[1] << 8) | (d[2] << 16) | ((uint32_t) d[3] << 24);
+}
+
+//------------------------------------------------------------------ peers (simulator thread)
+
+static void peer_sent(cansim_node_t *node, const cansim_frame_t *f, void *ctx)
+{
+	cansim_frame_t next;
+	int p = node == lo;
+
+	(void) ctx;
+	frame_end[p][get_seq(f->data) % SEQ_SLOTS] = f->t_ns;
+	if (node == lo)
+	{
+		put_seq(&next, ID_LO, ++lo_seq);
+		cansim_peer_send(lo, &next);		//straight back into arbitration
+	}
+	else
+	{
+		put_seq(&next, ID_HI, ++hi_seq);
+		cansim_peer_send_at(hi, &next, f->t_ns + HI_PERIOD_NS);
+	}
+}
+
+static void peer_receive(cansim_node_t *node, const cansim_frame_t *f, void *ctx)
+{
+	(void) ctx;
+	if (node != lo || f->id != ID_DUT)
+		return;
+	if (get_seq(f->data) != dut_seq_seen)
+		dut_seq_errors++;
+	dut_seq_seen = get_seq(f->data) + 1;
+}
+
+//------------------------------------------------------------------ firmware side hooks
+
+void can_rx_hook(const can_frame_t *frame)
+{
+	int p = frame->id == ID_LO;
+	uint32_t seq = get_seq(frame->data);
+
+	sample(&rx_latency, sim_now_ns() - frame_end[p][seq % SEQ_SLOTS]);
+	if (seq != next_rx_seq[p])
+		rx_seq_errors++;
+	next_rx_seq[p] = seq + 1;
+}
+
+void can_tx_hook(const can_frame_t *frame, uint8_t ok)
+{
+	if (ok)
+		sample(&tx_latency, (uint64_t) (can_timestamp() - frame->stamp) * 1000000000ULL / SystemCoreClock);
+}
+
+//------------------------------------------------------------------ CAN1 set up , as in the CAN/ programs
+
+static void can_init(uint32_t btr)
+{
+	RCC->APB1ENR |= RCC_APB1ENR_CAN1EN;
+	CAN1->MCR &= ~CAN_MCR_SLEEP;
+	while (CAN1->MSR & CAN_MSR_SLAK);
+	CAN1->MCR |= CAN_MCR_INRQ;
+	while (!(CAN1->MSR & CAN_MSR_INAK));
+	CAN1->BTR = btr;				//automatic retransmission stays on , a lost arbitration is retried
+	CAN1->MCR &= ~CAN_MCR_INRQ;
+	while (CAN1->MSR & CAN_MSR_INAK);
+}
+
+static void filter_setup(void)
+{
+	static const can_filter_range_t accept[] = { { ID_HI, ID_HI, 0 }, { ID_LO, ID_LO, 0 } };
+	can_filter_bank_t banks[CAN_FILTER_BANKS];
+	int nbanks = can_filter_plan(accept, 2, banks);
+
+	if (nbanks > 0)
+		can_filter_apply(banks, nbanks);
+}
+
+static int run(uint32_t bitrate, double seconds)
+{
+	cansim_node_stats_t dut, hs, ls;
+	cansim_bus_stats_t bus;
+	cansim_frame_t f;
+	can_frame_t frame = { 0 };
+	uint32_t seq = 0, lost;
+	uint64_t start, end;
+	double load;
+	int ok;
+
+	//PCLK1 is 8 MHz: 16 tq with prescaler 2 for 250 kbit/s , 8 tq with prescaler 1 for 1 Mbit/s
+	can_init(bitrate == 1000000 ? 0x00140000 : 0x001C0001);
+	filter_setup();
+	can_rx_init();
+	can_tx_init();
+
+	hi = cansim_peer_new("hi", bitrate);
+	lo = cansim_peer_new("lo", bitrate);
+	cansim_peer_callbacks(hi, peer_receive, peer_sent, 0);
+	cansim_peer_callbacks(lo, peer_receive, peer_sent, 0);
+
+	start = sim_now_ns();
+	end = start + (uint64_t) (seconds * 1e9);
+	put_seq(&f, ID_HI, 0);
+	cansim_peer_send(hi, &f);
+	put_seq(&f, ID_LO, 0);
+	cansim_peer_send(lo, &f);
+
+	frame.id = ID_DUT;
+	frame.dlc = 8;
+	while (sim_now_ns() < end)
+	{
+		while (can_recv(&frame))
+			;
+		while (can_tx_pending() < CAN_TX_QUEUE_SIZE)
+		{
+			frame.id = ID_DUT;
+			frame.dlc = 8;
+			frame.data[0] = seq;
+			frame.data[1] = seq >> 8;
+			frame.data[2] = seq >> 16;
+			frame.data[3] = seq >> 24;
+			can_send(&frame);
+			seq++;
+		}
+	}
+	end = sim_now_ns();
+
+	cansim_bus_stats(&bus);
+	cansim_node_stats(cansim_dut(), &dut);
+	cansim_node_stats(hi, &hs);
+	cansim_node_stats(lo, &ls);
+	load = (double) bus.busy_ns / (end - start);
+	lost = can_rx_stats.ring_overruns + can_rx_stats.fifo_overruns[0] + can_rx_stats.fifo_overruns[1];
+
+	printf("%u bit/s , %.2f s simulated\n", cansim_bitrate(cansim_dut()), (end - start) / 1e9);
+	printf("  bus load %.1f%% , %llu frames , %llu error frames\n", load * 100, (unsigned long long) bus.frames, (unsigned long long) bus.error_frames);
+	printf("  CAN1 sent %u (%.0f frames/s) , arbitration lost %u , received %u\n", dut.tx_ok, dut.tx_ok / ((end - start) / 1e9), dut.arb_lost, can_rx_stats.frames);
+	printf("  peer hi sent %u , peer lo sent %u , lo arbitration lost %u\n", hs.tx_ok, ls.tx_ok, ls.arb_lost);
+	printf("  rx irq latency us   p50 %.1f  p99 %.1f  max %.1f\n", percentile(&rx_latency, 50) / 1e3, percentile(&rx_latency, 99) / 1e3, rx_latency.max / 1e3);
+	printf("  tx queue->done us   p50 %.1f  p99 %.1f  max %.1f\n", percentile(&tx_latency, 50) / 1e3, percentile(&tx_latency, 99) / 1e3, tx_latency.max / 1e3);
+	printf("  lost %u , rx sequence errors %u , tx sequence errors %u\n", lost, rx_seq_errors, dut_seq_errors);
+
+	ok = load >= 0.90 && !lost && !rx_seq_errors && !dut_seq_errors && dut.tx_ok > 0 && !bus.error_frames;
+	printf("  %s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		static const char *rates[] = { "250000", "1000000" };
+		int failed = 0;
+
+		for (int i = 0; i < 2; i++)
+		{
+			int status;
+
+			fflush(stdout);
+			if (fork() == 0)
+			{
+				execl("/proc/self/exe", argv[0], rates[i], (char *) 0);
+				_exit(2);
+			}
+			wait(&status);
+			failed |= !WIFEXITED(status) || WEXITSTATUS(status);
+		}
+		return failed;
+	}
+
+	sim_set_time_scale(argc > 3 ? atof(argv[3]) : 0.25);
+	return run(atoi(argv[1]), argc > 2 ? atof(argv[2]) : 1.0);
+}
@@ -0,0 +1,184 @@
+//rx ring test , the MyDrivers/mycan.c interrupts fill the ring while can_recv() empties it on a saturated bus
+//
+//gcc -O2 -I HostSim -I MyDrivers HostSim/mmio.c HostSim/device.c HostSim/cansim.c HostSim/can_rx_ring.c MyDrivers/mycan.c MyDrivers/mycanfilter.c -lpthread -o can_rx_ring
+//
+//  can_rx_ring [bitrate] [time scale]         1 Mbit/s and 0.25 by default
+//
+//peers "a" (standard id 0x100) and "b" (extended id 0x18FF0001) send sequence numbered frames back to back
+//bytes 0..3 hold the sequence , 4..7 its complement , so a slot read while the interrupt rewrote it shows up
+//drain:  can_recv() keeps up , every frame must arrive once , in order , intact and with rising stamps
+//stall:  the main loop stops for longer than the ring lasts , frames that arrive are still intact and in order and
+//        every missing sequence number is counted in ring_overruns
+//end:    peers stop , frames sent = frames received + ring_overruns
+//exit status is 0 when every phase passes
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "stm32f1xx.h"
+#include "mmio.h"
+#include "cansim.h"
+#include "mycan.h"
+#include "mycanfilter.h"
+
+#define ID_A 0x100
+#define ID_B 0x18FF0001
+#define DRAIN_NS 500000000ULL
+#define FRAME_BITS 125			//8 byte frame with some stuffing and the interframe space
+#define STALLS 20
+
+static cansim_node_t *a, *b;
+static uint32_t a_seq, b_seq;
+static volatile int peers_stop;
+
+//firmware side bookkeeping , main loop only
+static uint32_t next_seq[2];
+static uint32_t received, gaps, bad;
+static uint32_t last_stamp;
+
+//------------------------------------------------------------------ peers (simulator thread)
+
+static void put_seq(cansim_frame_t *f, cansim_node_t *node, uint32_t seq)
+{
+	f->id = node == a ? ID_A : ID_B;
+	f->ide = node != a;
+	f->rtr = 0;
+	f->dlc = 8;
+	for (int i = 0; i < 4; i++)
+	{
+		f->data[i] = seq >> (8 * i);
+		f->data[4 + i] = ~seq >> (8 * i);
+	}
+}
+
+static void peer_sent(cansim_node_t *node, const cansim_frame_t *f, void *ctx)
+{
+	cansim_frame_t next;
+
+	(void) f;
+	(void) ctx;
+	if (peers_stop)
+		return;
+	put_seq(&next, node, node == a ? ++a_seq : ++b_seq);
+	cansim_peer_send(node, &next);			//straight back into arbitration
+}
+
+//------------------------------------------------------------------ firmware side
+
+static void can_init(uint32_t btr)
+{
+	RCC->APB1ENR |= RCC_APB1ENR_CAN1EN;
+	CAN1->MCR &= ~CAN_MCR_SLEEP;
+	while (CAN1->MSR & CAN_MSR_SLAK);
+	CAN1->MCR |= CAN_MCR_INRQ;
+	while (!(CAN1->MSR & CAN_MSR_INAK));
+	CAN1->BTR = btr;
+	CAN1->MCR &= ~CAN_MCR_INRQ;
+	while (CAN1->MSR & CAN_MSR_INAK);
+}
+
+static void filter_setup(void)
+{
+	static const can_filter_range_t accept[] = { { ID_A, ID_A, 0 }, { ID_B, ID_B, 1 } };
+	can_filter_bank_t banks[CAN_FILTER_BANKS];
+	int nbanks = can_filter_plan(accept, 2, banks);
+
+	if (nbanks > 0)
+		can_filter_apply(banks, nbanks);
+}
+
+//everything can_recv() has , checked frame by frame
+static void drain(void)
+{
+	can_frame_t f;
+
+	while (can_recv(&f))
+	{
+		int p = f.ide;
+		uint32_t seq = f.data[0] | (f.data[1] << 8) | (f.data[2] << 16) | ((uint32_t) f.data[3] << 24);
+		uint32_t inv = f.data[4] | (f.data[5] << 8) | (f.data[6] << 16) | ((uint32_t) f.data[7] << 24);
+
+		received++;
+		if (f.id != (p ? ID_B : ID_A) || f.dlc != 8 || f.rtr || inv != ~seq || (int32_t) (seq - next_seq[p]) < 0
+				|| (int32_t) (f.stamp - last_stamp) < 0)
+			bad++;
+		else
+			gaps += seq - next_seq[p];
+		next_seq[p] = seq + 1;
+		last_stamp = f.stamp;
+	}
+}
+
+static int phase(const char *name, uint32_t frames, uint32_t gap, uint32_t overruns, int want_overruns)
+{
+	uint32_t fifo = can_rx_stats.fifo_overruns[0] + can_rx_stats.fifo_overruns[1];
+	int ok = !bad && !fifo && gap == overruns && (want_overruns ? overruns > 0 : overruns == 0) && frames > 0;
+
+	printf("  %-6s %7u frames , %5u ring overruns , %5u missing , %u bad , %u fifo overruns %s\n", name, frames,
+			overruns, gap, bad, fifo, ok ? "ok" : "FAIL");
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t bitrate = argc > 1 ? atoi(argv[1]) : 1000000;
+	cansim_node_stats_t as, bs;
+	cansim_bus_stats_t bus;
+	cansim_frame_t f;
+	uint64_t start, t, stall_ns;
+	uint32_t frames0, gaps0, over0;
+	double load;
+	int ok = 1;
+
+	sim_set_time_scale(argc > 2 ? atof(argv[2]) : 0.25);
+	//PCLK1 is 8 MHz: 16 tq with prescaler 2 for 250 kbit/s , 8 tq with prescaler 1 for 1 Mbit/s
+	can_init(bitrate == 1000000 ? 0x00140000 : 0x001C0001);
+	filter_setup();
+	can_rx_init();
+
+	a = cansim_peer_new("a", bitrate);
+	b = cansim_peer_new("b", bitrate);
+	cansim_peer_callbacks(a, 0, peer_sent, 0);
+	cansim_peer_callbacks(b, 0, peer_sent, 0);
+	put_seq(&f, a, 0);
+	cansim_peer_send(a, &f);
+	put_seq(&f, b, 0);
+	cansim_peer_send(b, &f);
+	printf("%u bit/s , rx ring of %u\n", bitrate, CAN_RX_RING_SIZE);
+
+	start = sim_now_ns();
+	while (sim_now_ns() - start < DRAIN_NS)
+		drain();
+	cansim_bus_stats(&bus);
+	load = (double) bus.busy_ns / (sim_now_ns() - start);
+	ok &= phase("drain", received, gaps, can_rx_stats.ring_overruns, 0);
+	printf("  bus load %.1f%% %s\n", load * 100, load >= 0.90 ? "ok" : "FAIL");
+	ok &= load >= 0.90;
+
+	//long enough for about 3 rings of frames , then as long again to catch up
+	stall_ns = 3ULL * CAN_RX_RING_SIZE * FRAME_BITS * 1000000000ULL / bitrate;
+	frames0 = received;
+	gaps0 = gaps;
+	over0 = can_rx_stats.ring_overruns;
+	for (int i = 0; i < STALLS; i++)
+	{
+		t = sim_now_ns();
+		while (sim_now_ns() - t < stall_ns)
+			;					//the interrupts keep filling the ring
+		while (sim_now_ns() - t < 2 * stall_ns)
+			drain();
+	}
+	ok &= phase("stall", received - frames0, gaps - gaps0, can_rx_stats.ring_overruns - over0, 1);
+
+	peers_stop = 1;
+	t = sim_now_ns();
+	while (sim_now_ns() - t < 5000000)
+		drain();
+	cansim_node_stats(a, &as);
+	cansim_node_stats(b, &bs);
+	printf("  end    peers sent %u , received %u + ring overruns %u %s\n", as.tx_ok + bs.tx_ok, received,
+			can_rx_stats.ring_overruns, as.tx_ok + bs.tx_ok == received + can_rx_stats.ring_overruns ? "ok" : "FAIL");
+	ok &= as.tx_ok + bs.tx_ok == received + can_rx_stats.ring_overruns;
+
+	printf(ok ? "all passed\n" : "FAILED\n");
+	return !ok;
+}
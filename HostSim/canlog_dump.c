@@ -0,0 +1,73 @@
+//prints a capture written by MyDrivers/mycanlog.c
+//
+//  canlog_dump <log file>          "-" or nothing reads stdin
+//
+//one line per frame: seconds since the first sync , id , [dlc] , data bytes (or "remote")
+//drop records and bytes skipped while hunting for a sync are reported inline and in the totals on stderr
+
+#include <stdio.h>
+#include <string.h>
+#include "canlogfmt.h"
+
+int main(int argc, char **argv)
+{
+	FILE *in = stdin;
+	static uint8_t buf[65536];
+	canlog_decoder_t d;
+	canlog_record_t rec;
+	uint32_t len = 0, pos = 0, used;
+	uint64_t frames = 0, dropped = 0, t0 = 0;
+	int have_t0 = 0, eof = 0;
+
+	if (argc > 1 && strcmp(argv[1], "-"))
+		in = fopen(argv[1], "rb");
+	if (!in)
+	{
+		perror(argv[1]);
+		return 2;
+	}
+	canlog_decoder_init(&d);
+
+	while (1)
+	{
+		used = canlog_decode(&d, buf + pos, len - pos, &rec);
+		if (!used)
+		{
+			//need more bytes , keep the partial record
+			if (eof)
+				break;
+			memmove(buf, buf + pos, len - pos);
+			len -= pos;
+			pos = 0;
+			len += fread(buf + len, 1, sizeof(buf) - len, in);
+			eof = feof(in) || ferror(in);
+			continue;
+		}
+		pos += used;
+
+		if (rec.type == CANLOG_REC_SYNC && !have_t0)
+		{
+			t0 = rec.time_us;
+			have_t0 = 1;
+		}
+		if (rec.type == CANLOG_REC_DROP)
+		{
+			printf("%12.6f  *** %u frames dropped\n", (rec.time_us - t0) / 1e6, rec.dropped);
+			dropped += rec.dropped;
+		}
+		if (rec.type == CANLOG_REC_FRAME)
+		{
+			printf("%12.6f  %*s%0*X  [%u] ", (rec.time_us - t0) / 1e6, rec.ide ? 0 : 5, "", rec.ide ? 8 : 3, rec.id, rec.dlc);
+			if (rec.rtr)
+				printf(" remote");
+			for (uint8_t i = 0; !rec.rtr && i < rec.dlc; i++)
+				printf(" %02X", rec.data[i]);
+			printf("\n");
+			frames++;
+		}
+	}
+	if (len != pos)
+		fprintf(stderr, "%u bytes of an unfinished record at the end\n", len - pos);
+	fprintf(stderr, "%llu frames , %llu dropped , %u bytes skipped , %u bad records\n", (unsigned long long) frames, (unsigned long long) dropped, d.skipped, d.errors);
+	return d.errors || dropped ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+//full load check of the CAN LOGGER program ("CAN/CAN LOGGER" , MyDrivers/mycanlog.c) , link it in with the program and run it
+//
+//  gcc -O2 -DUART_TX_BUF_SIZE=2048 -I HostSim -I MyDrivers -x c "CAN/CAN LOGGER" -x none HostSim/mmio.c HostSim/device.c
+//      HostSim/periph.c HostSim/cansim.c HostSim/canlog_load.c MyDrivers/mycan.c MyDrivers/mycanfilter.c
+//      MyDrivers/mycanlog.c MyDrivers/canlogfmt.c MyDrivers/myuart.c -lpthread -lm -o canlog_load
+//  ./canlog_load                    exit status 0 when every check passes
+//
+//peer "load" keeps the 250 kbit/s bus saturated for RUN_NS with a mix of standard and extended ids , 0 to 8 data bytes
+//and remote frames , peer "ack" acknowledges them (the logger is silent)
+//the bytes the logger sends out of USART1 at 500 kbaud are decoded as they come off the line , after the run every
+//frame the bus carried must be in the log once , in order and intact , with no drop record , nothing counted in
+//canlog_stats.dropped or can_rx_stats and no decoder errors
+//stamps: mycan.c stamps in the rx interrupt , which the host can deliver late , so log times are taken against bus times
+//from the frame that trailed its bus time least , in every STAMP_BLOCK frames at least one must be within STAMP_SLACK_US
+//of its bus time (the log clock does not drift) , the latest one is only reported
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "mmio.h"
+#include "periph.h"
+#include "cansim.h"
+#include "mycan.h"
+#include "mycanlog.h"
+#include "canlogfmt.h"
+#include "myuart.h"
+
+#define MS 1000000ULL
+#define BITRATE 250000
+#define LINE_BYTES_PER_S 50000		//500 kbaud , 10 bits a byte
+#define LEAD_NS (10 * MS)		//the program sets up its filters and interrupts
+#define RUN_NS (3000 * MS)
+#define DRAIN_NS (100 * MS)		//a full 2048 byte ring goes out in 41 ms
+#define STAMP_SLACK_US 20
+#define STAMP_BLOCK 256
+#define MAX_FRAMES 65536
+#define MAX_LOG (1 << 20)
+
+static cansim_node_t *load, *ack;
+static uint32_t seq;
+static int stopped;
+
+static cansim_frame_t bus[MAX_FRAMES];		//every good frame , as the monitor saw it
+static uint32_t nbus;
+static int32_t stamp_err[MAX_FRAMES];		//log time less bus time , us , both from the first frame
+static uint8_t log_bytes[MAX_LOG];		//what came out of USART1
+static uint32_t nlog;
+
+//------------------------------------------------------------------ bus side (simulator thread)
+
+//frame k of the mix: 8 byte standard , 8 byte extended , short extended , standard remote
+static void make_frame(cansim_frame_t *f, uint32_t k)
+{
+	memset(f, 0, sizeof(*f));
+	switch (k % 4)
+	{
+	case 0:
+		f->id = 0x100 + k % 0x600;
+		f->dlc = 8;
+		break;
+	case 1:
+		f->id = 0x18FF0000 | (k & 0xFFFF);
+		f->ide = 1;
+		f->dlc = 8;
+		break;
+	case 2:
+		f->id = 0x0CF00400 + k % 256;
+		f->ide = 1;
+		f->dlc = k / 4 % 9;
+		break;
+	default:
+		f->id = 0x7E0 + k % 8;
+		f->rtr = 1;
+		f->dlc = k / 4 % 9;
+		break;
+	}
+	for (int i = 0; !f->rtr && i < f->dlc; i++)
+		f->data[i] = k >> (8 * (i & 3)) ^ i * 0x35;
+}
+
+static void load_sent(cansim_node_t *node, const cansim_frame_t *f, void *ctx)
+{
+	cansim_frame_t next;
+
+	(void) f;
+	(void) ctx;
+	if (stopped)
+		return;
+	make_frame(&next, ++seq);
+	cansim_peer_send(node, &next);		//straight back into arbitration
+}
+
+static void on_bus(cansim_node_t *node, const cansim_frame_t *f, void *ctx)
+{
+	(void) node;
+	(void) ctx;
+	if (nbus < MAX_FRAMES)
+		bus[nbus++] = *f;
+}
+
+static void on_line(USART_TypeDef *usart, uint8_t byte, uint64_t t_ns, void *ctx)
+{
+	(void) usart;
+	(void) t_ns;
+	(void) ctx;
+	if (nlog < MAX_LOG)
+		log_bytes[nlog++] = byte;
+}
+
+//------------------------------------------------------------------ checks
+
+static int report(uint64_t run_ns, uint64_t busy_ns)
+{
+	canlog_decoder_t d;
+	canlog_record_t rec;
+	uint32_t pos = 0, used, frames = 0, bad = 0, drops = 0, syncs = 0;
+	uint64_t t0_us = 0, t0_ns = 0;
+	int32_t base = 0, best = 0, drift = 0, late = 0;
+	double load_share = (double) busy_ns / run_ns;
+	double line_share = (double) nlog * 1e9 / run_ns / LINE_BYTES_PER_S;
+	uint32_t lost = can_rx_stats.ring_overruns + can_rx_stats.fifo_overruns[0] + can_rx_stats.fifo_overruns[1];
+	int ok_load, ok_log, ok_stamps, ok_stats;
+
+	canlog_decoder_init(&d);
+	while ((used = canlog_decode(&d, log_bytes + pos, nlog - pos, &rec)) != 0)
+	{
+		pos += used;
+		if (rec.type == CANLOG_REC_SYNC)
+			syncs++;
+		else if (rec.type == CANLOG_REC_DROP)
+			drops += rec.dropped;
+		if (rec.type != CANLOG_REC_FRAME)
+			continue;
+		if (frames < nbus)
+		{
+			const cansim_frame_t *f = &bus[frames];
+
+			if (rec.id != f->id || rec.ide != f->ide || rec.rtr != f->rtr || rec.dlc != f->dlc
+					|| (!f->rtr && memcmp(rec.data, f->data, f->dlc)))
+			{
+				if (bad < 10)
+					printf("  record %u: %s id 0x%X dlc %u , bus had 0x%X dlc %u\n", frames, rec.ide ? "extended" : "standard",
+							rec.id, rec.dlc, f->id, f->dlc);
+				bad++;
+			}
+			if (!frames)
+			{
+				t0_us = rec.time_us;
+				t0_ns = f->t_ns;
+			}
+			stamp_err[frames] = (int64_t) (rec.time_us - t0_us) - (int64_t) ((f->t_ns - t0_ns) / 1000);
+			base = stamp_err[frames] < base ? stamp_err[frames] : base;
+		}
+		frames++;
+	}
+	for (uint32_t i = 0; i < frames && i < nbus; i++)
+	{
+		int32_t err = stamp_err[i] - base;
+
+		best = i % STAMP_BLOCK == 0 || err < best ? err : best;
+		if (i % STAMP_BLOCK == STAMP_BLOCK - 1 || i == nbus - 1)
+			drift = best > drift ? best : drift;
+		late = err > late ? err : late;
+	}
+
+	ok_load = load_share >= 0.90 && nbus < MAX_FRAMES;
+	ok_log = frames == nbus && !bad && !drops && !d.errors && !d.skipped && pos == nlog;
+	ok_stamps = drift <= STAMP_SLACK_US;
+	ok_stats = !canlog_stats.dropped && !lost && !uart_tx_stats.refused && canlog_stats.frames == nbus;
+
+	printf("bus: %u frames in %.1f s , load %.1f%% %s\n", nbus, run_ns / 1e9, load_share * 100, ok_load ? "ok" : "FAIL");
+	printf("log: %u bytes (%.1f%% of the 500 kbaud line) , %u frames , %u syncs , %u dropped , %u bad , %u decoder errors ,"
+			" %u bytes skipped %s\n", nlog, line_share * 100, frames, syncs, drops, bad, d.errors, d.skipped, ok_log ? "ok" : "FAIL");
+	printf("stamps: closest of every %u frames %d us off at worst (allowed %u) , %d us late at most %s\n", STAMP_BLOCK,
+			drift, STAMP_SLACK_US, late, ok_stamps ? "ok" : "FAIL");
+	printf("stats: canlog %u frames %u dropped , can rx lost %u , uart refused %u , ring at most %u of %u bytes %s\n",
+			canlog_stats.frames, canlog_stats.dropped, lost, uart_tx_stats.refused, uart_tx_stats.max_fill,
+			UART_TX_BUF_SIZE, ok_stats ? "ok" : "FAIL");
+	return ok_load && ok_log && ok_stamps && ok_stats;
+}
+
+static uint64_t load_step(void *ctx, uint64_t now)
+{
+	static uint64_t at, start, stop;
+	static cansim_bus_stats_t bus0, bus1;
+	cansim_frame_t f;
+	int ok;
+
+	(void) ctx;
+	if (now < at)
+		return at;
+	if (!start)
+	{
+		//CAN1 is briefly online with the reset BTR when the program wakes it , LEAD_NS covers that too
+		if (!cansim_online(cansim_dut()))
+			return at = now + MS / 10;
+		return at = start = now + LEAD_NS;
+	}
+	if (!stop)
+	{
+		stop = now + RUN_NS;
+		cansim_bus_stats(&bus0);
+		make_frame(&f, seq);
+		cansim_peer_send(load, &f);
+		return at = stop;
+	}
+	if (!stopped)
+	{
+		stopped = 1;
+		cansim_bus_stats(&bus1);
+		return at = now + DRAIN_NS;
+	}
+	ok = report(stop - start, bus1.busy_ns - bus0.busy_ns);
+	printf(ok ? "all passed\n" : "FAILED\n");
+	fflush(stdout);
+	_exit(!ok);
+}
+
+__attribute__((constructor(250))) static void canlog_load_init(void)
+{
+	load = cansim_peer_new("load", BITRATE);
+	ack = cansim_peer_new("ack", BITRATE);
+	cansim_peer_callbacks(load, 0, load_sent, 0);
+	cansim_monitor(on_bus, 0);
+	periph_usart_callbacks(USART1, on_line, 0, 0);
+	sim_set_time_scale(0.25);		//HOSTSIM_TIME_SCALE still wins
+	sim_add_model(load_step, 0);
+}
@@ -0,0 +1,107 @@
+//plays a capture from MyDrivers/mycanlog.c back onto the simulated bus , link it in with any program
+//
+//  HOSTSIM_CAN_REPLAY=capture.bin ./program
+//  HOSTSIM_CAN_REPLAY_RATE=500000          bus bit rate , 250000 by default
+//
+//peer "replay" sends every logged frame with the gaps it was captured with , starting 10 ms after CAN1 leaves init mode
+//(time for the program to set up its filters and interrupts)
+//peer "ack" only acknowledges , a capture usually comes from a bus where CAN1 was not the only receiver
+//a frame may go out later than logged if the bus is busier than it was , never earlier
+//dropped frames in the capture cannot be replayed , they are counted on stderr when the log ends
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mmio.h"
+#include "cansim.h"
+#include "canlogfmt.h"
+
+#define LEAD_NS 10000000ULL
+#define POLL_NS 1000000ULL		//fewer than CANSIM_PEER_QUEUE frames fit in 1 ms even at 1 Mbit/s
+
+static uint8_t *log_data;
+static uint32_t log_len, log_pos;
+static canlog_decoder_t decoder;
+static cansim_node_t *replay;
+static uint64_t start_ns = 0;		//0 until CAN1 comes online
+static uint64_t first_us;
+static int have_first;
+static uint64_t frames, dropped;
+
+static uint64_t replay_step(void *ctx, uint64_t now)
+{
+	canlog_record_t rec;
+	cansim_frame_t f;
+	uint32_t used;
+
+	(void) ctx;
+	if (!log_data)
+		return ~0ULL;
+	if (!start_ns)
+	{
+		if (!cansim_online(cansim_dut()))
+			return now + POLL_NS / 10;
+		start_ns = now + LEAD_NS;
+	}
+
+	while (cansim_peer_pending(replay) < CANSIM_PEER_QUEUE)
+	{
+		used = canlog_decode(&decoder, log_data + log_pos, log_len - log_pos, &rec);
+		if (!used)
+		{
+			fprintf(stderr, "canreplay: end of log , %llu frames replayed , %llu dropped in the capture , %u bytes skipped\n",
+				(unsigned long long) frames, (unsigned long long) dropped, decoder.skipped);
+			free(log_data);
+			log_data = 0;
+			return ~0ULL;
+		}
+		log_pos += used;
+		if (rec.type == CANLOG_REC_DROP)
+			dropped += rec.dropped;
+		if (rec.type != CANLOG_REC_FRAME)
+			continue;
+		if (!have_first)
+		{
+			first_us = rec.time_us;
+			have_first = 1;
+		}
+		memset(&f, 0, sizeof(f));
+		f.id = rec.id;
+		f.ide = rec.ide;
+		f.rtr = rec.rtr;
+		f.dlc = rec.dlc;
+		memcpy(f.data, rec.data, 8);
+		cansim_peer_send_at(replay, &f, start_ns + (rec.time_us - first_us) * 1000);
+		frames++;
+	}
+	return now + POLL_NS;
+}
+
+__attribute__((constructor(250))) static void canreplay_init(void)
+{
+	const char *path = getenv("HOSTSIM_CAN_REPLAY");
+	const char *rate = getenv("HOSTSIM_CAN_REPLAY_RATE");
+	uint32_t bitrate = rate ? strtoul(rate, 0, 0) : 250000;
+	FILE *in;
+	long size;
+
+	if (!path)
+		return;
+	in = fopen(path, "rb");
+	if (!in)
+	{
+		perror(path);
+		exit(2);
+	}
+	fseek(in, 0, SEEK_END);
+	size = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	log_data = malloc(size > 0 ? size : 1);
+	log_len = fread(log_data, 1, size > 0 ? size : 0, in);
+	fclose(in);
+
+	canlog_decoder_init(&decoder);
+	replay = cansim_peer_new("replay", bitrate);
+	cansim_peer_new("ack", bitrate);
+	sim_add_model(replay_step, 0);
+}
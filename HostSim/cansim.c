@@ -0,0 +1,1072 @@
+#include <string.h>
+#include "mmio.h"
+#include "cansim.h"
+#include "stm32f1xx.h"
+
+#define NONE (~0ULL)
+#define RATE_TOLERANCE 0.01
+#define MAX_BITS 160			//stuffed SOF..CRC of the longest frame is 154
+
+#define OFF_TX_MBX 0x180
+#define OFF_RX_FIFO 0x1B0
+#define OFF_FMR 0x200
+#define OFF_FM1R 0x204
+#define OFF_FS1R 0x20C
+#define OFF_FFA1R 0x214
+#define OFF_FA1R 0x21C
+#define OFF_FILTERS 0x240
+#define FILTER_BANKS 14
+
+#define LEC_STUFF 1
+#define LEC_ACK 3
+#define LEC_BIT_RECESSIVE 4
+
+struct cansim_node
+{
+	const char *name;
+	uint32_t bitrate;		//peers only , CAN1 follows its BTR
+	int ack;
+	uint16_t tec, rec;
+	int busoff;
+	uint64_t busoff_until;		//recovery time , NONE while waiting for software
+	cansim_node_stats_t stats;
+
+	//peer tx queue
+	cansim_frame_t q[CANSIM_PEER_QUEUE];
+	uint64_t q_ready[CANSIM_PEER_QUEUE];
+	uint32_t q_head, q_count;
+	cansim_frame_fn on_receive, on_sent;
+	void *ctx;
+};
+
+static struct cansim_node nodes[CANSIM_MAX_NODES] = { { .name = "CAN1" } };
+static int nnodes = 1;
+#define DUT (&nodes[0])
+
+CAN_TypeDef *CAN1;
+static CAN_TypeDef *can;		//model side alias of CAN1
+
+static struct
+{
+	cansim_frame_t f;
+	uint64_t ready;
+	uint32_t order;			//request order for TXFP
+	int pending;
+} mbx[3];
+static uint32_t request_count;
+static int on_wire_mbx = -1;		//mailbox whose frame is on the bus (or the loopback timeline)
+
+static uint8_t fifo_count[2];
+static cansim_frame_t fifo_frame[2][3];
+static uint8_t fifo_fmi[2][3];
+
+static uint64_t mode_ns = NONE;		//pending INAK / SLAK update
+
+//one transfer in flight on the shared bus and one on the loopback timeline
+typedef struct
+{
+	int busy;
+	uint64_t start, end, free_ns;
+	int ok;
+	cansim_node_t *tx[CANSIM_MAX_NODES];
+	int ntx;
+	cansim_frame_t f;
+} wire_t;
+
+static wire_t bus, lb;
+static cansim_bus_stats_t bus_stats;
+static cansim_frame_fn monitor_fn;
+static void *monitor_ctx;
+static uint64_t callback_ns;		//frame end while callbacks run , stamps frames the peers send from them
+
+//------------------------------------------------------------------ frame bits
+
+static uint16_t crc15(const uint8_t *bits, int n)
+{
+	uint16_t crc = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		int next = bits[i] ^ ((crc >> 14) & 1);
+
+		crc = (crc << 1) & 0x7FFF;
+		if (next)
+			crc ^= 0x4599;
+	}
+	return crc;
+}
+
+//stuffed bit stream from SOF to the end of the CRC , arb[] marks the bits that still belong to arbitration
+static int frame_stream(const cansim_frame_t *f, uint8_t *bits, uint8_t *arb)
+{
+	uint8_t raw[MAX_BITS], raw_arb[MAX_BITS];
+	int n = 0, out = 0, run = 0;
+	uint8_t dlc = f->dlc > 8 ? 8 : f->dlc;
+	uint8_t len = f->rtr ? 0 : dlc;
+	uint16_t crc;
+
+#define PUT(v, a) do { raw[n] = (v) ? 1 : 0; raw_arb[n++] = (a); } while (0)
+	PUT(0, 1);
+	if (f->ide)
+	{
+		for (int i = 28; i >= 18; i--)
+			PUT((f->id >> i) & 1, 1);
+		PUT(1, 1);				//SRR
+		PUT(1, 1);				//IDE
+		for (int i = 17; i >= 0; i--)
+			PUT((f->id >> i) & 1, 1);
+		PUT(f->rtr, 1);
+		PUT(0, 0);				//r1
+	}
+	else
+	{
+		for (int i = 10; i >= 0; i--)
+			PUT((f->id >> i) & 1, 1);
+		PUT(f->rtr, 1);
+		PUT(0, 1);				//IDE , a standard frame beats an extended one here
+	}
+	PUT(0, 0);					//r0
+	for (int i = 3; i >= 0; i--)
+		PUT((f->dlc >> i) & 1, 0);
+	for (int b = 0; b < len; b++)
+		for (int i = 7; i >= 0; i--)
+			PUT((f->data[b] >> i) & 1, 0);
+	crc = crc15(raw, n);
+	for (int i = 14; i >= 0; i--)
+		PUT((crc >> i) & 1, 0);
+#undef PUT
+
+	for (int i = 0; i < n; i++)
+	{
+		bits[out] = raw[i];
+		arb[out++] = raw_arb[i];
+		run = (out > 1 && bits[out - 1] == bits[out - 2]) ? run + 1 : 1;
+		if (run == 5)
+		{
+			bits[out] = !raw[i];			//stuff bit , counts as the first of the next run
+			arb[out++] = raw_arb[i];
+			run = 1;
+		}
+	}
+	return out;
+}
+
+uint32_t cansim_frame_bits(const cansim_frame_t *f)
+{
+	uint8_t bits[MAX_BITS], arb[MAX_BITS];
+
+	return frame_stream(f, bits, arb) + 13;	//CRC delimiter , ACK slot and delimiter , EOF , interframe space
+}
+
+static uint64_t bits_ns(uint32_t bits, uint32_t bitrate)
+{
+	return (uint64_t) bits * 1000000000ULL / bitrate;
+}
+
+static int rate_matches(uint32_t a, uint32_t b)
+{
+	double d = (double) a - (double) b;
+
+	return (d < 0 ? -d : d) <= RATE_TOLERANCE * b;
+}
+
+//------------------------------------------------------------------ CAN1 state
+
+static uint32_t dut_bitrate(void)
+{
+	uint32_t ppre1 = (RCC->CFGR >> 8) & 0x7;
+	uint32_t pclk1 = SystemCoreClock >> ((ppre1 & 0x4) ? (ppre1 & 0x3) + 1 : 0);
+	uint32_t btr = can->BTR;
+	uint32_t tq = 3 + ((btr >> 16) & 0xF) + ((btr >> 20) & 0x7);
+
+	return pclk1 / (((btr & 0x3FF) + 1) * tq);
+}
+
+//synchronised to the bus and not bus off
+static int dut_running(void)
+{
+	return !(can->MSR & (CAN_MSR_INAK | CAN_MSR_SLAK)) && !DUT->busoff;
+}
+
+static int dut_loopback(void)
+{
+	return dut_running() && (can->BTR & CAN_BTR_LBKM);
+}
+
+static int dut_listens(void)
+{
+	return dut_running() && !(can->BTR & CAN_BTR_LBKM);
+}
+
+static int dut_drives(void)		//may transmit and acknowledge on the shared bus
+{
+	return dut_listens() && !(can->BTR & CAN_BTR_SILM);
+}
+
+static uint32_t arb_key(const cansim_frame_t *f)
+{
+	uint32_t key = f->ide ? (((f->id >> 18) << 19) | (1 << 18) | (f->id & 0x3FFFF)) : (f->id << 19);
+
+	return (key << 1) | f->rtr;
+}
+
+static void update_irqs(void)
+{
+	uint32_t ier = can->IER;
+
+	nvic_set_level(USB_HP_CAN1_TX_IRQn, (ier & CAN_IER_TMEIE) && (can->TSR & (CAN_TSR_RQCP0 | CAN_TSR_RQCP1 | CAN_TSR_RQCP2)));
+	nvic_set_level(USB_LP_CAN1_RX0_IRQn, ((ier & CAN_IER_FMPIE0) && (can->RF0R & CAN_RF0R_FMP0))
+		|| ((ier & CAN_IER_FFIE0) && (can->RF0R & CAN_RF0R_FULL0)) || ((ier & CAN_IER_FOVIE0) && (can->RF0R & CAN_RF0R_FOVR0)));
+	nvic_set_level(CAN1_RX1_IRQn, ((ier & CAN_IER_FMPIE1) && (can->RF1R & CAN_RF1R_FMP1))
+		|| ((ier & CAN_IER_FFIE1) && (can->RF1R & CAN_RF1R_FULL1)) || ((ier & CAN_IER_FOVIE1) && (can->RF1R & CAN_RF1R_FOVR1)));
+	nvic_set_level(CAN1_SCE_IRQn, (ier & CAN_IER_ERRIE) && (can->MSR & CAN_MSR_ERRI));
+}
+
+//TME , CODE and LOW follow the mailbox states
+static void update_tsr(void)
+{
+	static const uint32_t tme[3] = { CAN_TSR_TME0, CAN_TSR_TME1, CAN_TSR_TME2 };
+	static const uint32_t low[3] = { CAN_TSR_LOW0, CAN_TSR_LOW1, CAN_TSR_LOW2 };
+	uint32_t tsr = can->TSR & ~(CAN_TSR_TME | CAN_TSR_CODE | CAN_TSR_LOW);
+	int lowest = -1, npending = 0, code = -1;
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (!mbx[i].pending)
+		{
+			tsr |= tme[i];
+			if (code < 0)
+				code = i;
+			continue;
+		}
+		npending++;
+		if (lowest < 0 || ((can->MCR & CAN_MCR_TXFP) ? mbx[i].order > mbx[lowest].order : arb_key(&mbx[i].f) >= arb_key(&mbx[lowest].f)))
+			lowest = i;
+	}
+	if (npending > 1)
+		tsr |= low[lowest];
+	tsr |= (uint32_t) (code >= 0 ? code : lowest) << 24;
+	can->TSR = tsr;
+}
+
+static void update_esr(int lec)
+{
+	static const uint32_t ie[3] = { CAN_IER_EWGIE, CAN_IER_EPVIE, CAN_IER_BOFIE };
+	uint32_t old = can->ESR;
+	uint32_t flags = 0, esr;
+
+	if (DUT->tec >= 96 || DUT->rec >= 96)
+		flags |= CAN_ESR_EWGF;
+	if (DUT->tec > 127 || DUT->rec > 127)
+		flags |= CAN_ESR_EPVF;
+	if (DUT->busoff)
+		flags |= CAN_ESR_BOFF;
+	esr = (old & CAN_ESR_LEC) | flags | ((uint32_t) (DUT->tec > 255 ? 255 : DUT->tec) << 16) | ((uint32_t) (DUT->rec > 255 ? 255 : DUT->rec) << 24);
+	if (lec >= 0)
+		esr = (esr & ~CAN_ESR_LEC) | (lec << 4);
+	can->ESR = esr;
+
+	for (int i = 0; i < 3; i++)
+		if ((flags & ~old & (1u << i)) && (can->IER & ie[i]))
+			can->MSR |= CAN_MSR_ERRI;
+	if (lec > 0 && (can->IER & CAN_IER_LECIE))
+		can->MSR |= CAN_MSR_ERRI;
+}
+
+static void dut_reset(void)
+{
+	memset((void *) can, 0, sizeof(*can));
+	can->MCR = 0x00010002;
+	can->MSR = 0x00000C02;
+	can->TSR = 0x1C000000;
+	can->BTR = 0x01230000;
+	can->FMR = 0x2A1C0E01;
+	memset(mbx, 0, sizeof(mbx));
+	memset(fifo_count, 0, sizeof(fifo_count));
+	on_wire_mbx = -1;
+	mode_ns = NONE;
+	DUT->tec = 0;
+	DUT->rec = 0;
+	DUT->busoff = 0;
+}
+
+//------------------------------------------------------------------ error counting
+
+static void node_changed(cansim_node_t *n, int lec)
+{
+	if (n->tec > 255 && !n->busoff)
+	{
+		n->busoff = 1;
+		n->stats.busoffs++;
+		//128 x 11 recessive bits , CAN1 without ABOM waits for software to leave init mode first
+		if (n == DUT && !(can->MCR & CAN_MCR_ABOM))
+			n->busoff_until = NONE;
+		else
+			n->busoff_until = bus.free_ns + bits_ns(128 * 11, n == DUT ? dut_bitrate() : n->bitrate);
+	}
+	n->stats.tec = n->tec;
+	n->stats.rec = n->rec;
+	if (n == DUT)
+		update_esr(lec);
+}
+
+static void tx_error(cansim_node_t *n, int lec)
+{
+	//an error passive transmitter that only missed its ACK keeps its count
+	if (!(lec == LEC_ACK && n->tec > 127))
+		n->tec += 8;
+	n->stats.tx_errors++;
+	node_changed(n, lec);
+}
+
+static void rx_error(cansim_node_t *n, int lec)
+{
+	if (n->rec < 255)
+		n->rec++;
+	n->stats.rx_errors++;
+	node_changed(n, lec);
+}
+
+static void tx_good(cansim_node_t *n)
+{
+	if (n->tec)
+		n->tec--;
+	n->stats.tx_ok++;
+	node_changed(n, 0);
+}
+
+static void rx_good(cansim_node_t *n)
+{
+	if (n->rec > 127)
+		n->rec = 120;
+	else if (n->rec)
+		n->rec--;
+	n->stats.rx++;
+	node_changed(n, 0);
+}
+
+static void recover(cansim_node_t *n)
+{
+	n->busoff = 0;
+	n->tec = 0;
+	n->rec = 0;
+	node_changed(n, -1);
+}
+
+//------------------------------------------------------------------ CAN1 transmit / receive
+
+static void dut_tx_done(int m, int ok, uint32_t why)
+{
+	static const uint32_t rqcp[3] = { CAN_TSR_RQCP0, CAN_TSR_RQCP1, CAN_TSR_RQCP2 };
+
+	mbx[m].pending = 0;
+	can->sTxMailBox[m].TIR &= ~CAN_TI0R_TXRQ;
+	can->TSR &= ~((CAN_TSR_TXOK0 | CAN_TSR_ALST0 | CAN_TSR_TERR0) << (8 * m));
+	can->TSR |= rqcp[m] | ((ok ? CAN_TSR_TXOK0 : why) << (8 * m));
+	update_tsr();
+}
+
+//most urgent mailbox requested by t , -1 if none
+static int dut_candidate(uint64_t t)
+{
+	int best = -1;
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (!mbx[i].pending || mbx[i].ready > t)
+			continue;
+		if (best < 0 || ((can->MCR & CAN_MCR_TXFP) ? mbx[i].order < mbx[best].order : arb_key(&mbx[i].f) < arb_key(&mbx[best].f)))
+			best = i;
+	}
+	return best;
+}
+
+static uint64_t dut_earliest(void)
+{
+	uint64_t t = NONE;
+
+	for (int i = 0; i < 3; i++)
+		if (mbx[i].pending && mbx[i].ready < t)
+			t = mbx[i].ready;
+	return t;
+}
+
+static int filter_fifo(const cansim_frame_t *f, uint8_t *fmi)
+{
+	uint32_t w32 = (f->ide ? ((f->id << 3) | CAN_RI0R_IDE) : (f->id << 21)) | (f->rtr ? CAN_RI0R_RTR : 0);
+	uint16_t w16 = f->ide ? (((f->id >> 18) << 5) | 0x08 | ((f->id >> 15) & 0x7)) : (f->id << 5);
+	uint8_t number[2] = { 0, 0 };
+	int best_fifo = -1, best_rank = 4;
+
+	if (f->rtr)
+		w16 |= 0x10;
+	if (can->FMR & CAN_FMR_FINIT)
+		return -1;				//reception is off while the filters are being set up
+
+	for (int b = 0; b < FILTER_BANKS; b++)
+	{
+		uint32_t bit = 1u << b;
+		int fifo = (can->FFA1R & bit) ? 1 : 0;
+		int list = (can->FM1R & bit) ? 1 : 0;
+		int s32 = (can->FS1R & bit) ? 1 : 0;
+		int count = s32 ? (list ? 2 : 1) : (list ? 4 : 2);
+		int rank = (s32 ? 0 : 2) + (list ? 0 : 1);	//32 bit before 16 bit , list before mask
+		uint32_t fr1 = can->sFilterRegister[b].FR1;
+		uint32_t fr2 = can->sFilterRegister[b].FR2;
+
+		for (int j = 0; (can->FA1R & bit) && j < count; j++)
+		{
+			int hit;
+
+			if (s32 && !list)
+				hit = ((w32 ^ fr1) & fr2 & ~1u) == 0;
+			else if (s32)
+				hit = ((w32 ^ (j ? fr2 : fr1)) & ~1u) == 0;
+			else
+			{
+				uint32_t fr = j < (list ? 2 : 1) ? fr1 : fr2;
+
+				if (list)
+					hit = w16 == (uint16_t) ((j & 1) ? fr >> 16 : fr);
+				else
+					hit = ((w16 ^ (uint16_t) fr) & (uint16_t) (fr >> 16)) == 0;
+			}
+			if (hit && rank < best_rank)
+			{
+				best_rank = rank;
+				best_fifo = fifo;
+				*fmi = number[fifo] + j;
+			}
+		}
+		number[fifo] += count;			//numbering counts inactive banks too
+	}
+	return best_fifo;
+}
+
+static void fifo_publish(int fifo)
+{
+	volatile uint32_t *rfr = fifo ? &can->RF1R : &can->RF0R;
+	CAN_FIFOMailBox_TypeDef *mb = &can->sFIFOMailBox[fifo];
+	const cansim_frame_t *f = &fifo_frame[fifo][0];
+
+	*rfr = (*rfr & ~CAN_RF0R_FMP0) | fifo_count[fifo];
+	if (!fifo_count[fifo])
+		return;
+	mb->RIR = (f->ide ? ((f->id << 3) | CAN_RI0R_IDE) : (f->id << 21)) | (f->rtr ? CAN_RI0R_RTR : 0);
+	mb->RDTR = (f->dlc & 0xF) | ((uint32_t) fifo_fmi[fifo][0] << 8);
+	mb->RDLR = f->data[0] | (f->data[1] << 8) | (f->data[2] << 16) | ((uint32_t) f->data[3] << 24);
+	mb->RDHR = f->data[4] | (f->data[5] << 8) | (f->data[6] << 16) | ((uint32_t) f->data[7] << 24);
+}
+
+static void dut_receive(const cansim_frame_t *f)
+{
+	uint8_t fmi = 0;
+	int fifo = filter_fifo(f, &fmi);
+	volatile uint32_t *rfr;
+
+	if (fifo < 0)
+		return;
+	rfr = fifo ? &can->RF1R : &can->RF0R;
+	if (fifo_count[fifo] == 3)
+	{
+		*rfr |= CAN_RF0R_FOVR0;
+		if (can->MCR & CAN_MCR_RFLM)
+			return;				//locked , the new frame is lost
+		fifo_count[fifo] = 2;			//otherwise the last one is overwritten
+	}
+	fifo_frame[fifo][fifo_count[fifo]] = *f;
+	fifo_fmi[fifo][fifo_count[fifo]] = fmi;
+	if (++fifo_count[fifo] == 3)
+		*rfr |= CAN_RF0R_FULL0;
+	fifo_publish(fifo);
+}
+
+static void fifo_release(int fifo)
+{
+	if (!fifo_count[fifo])
+		return;
+	fifo_count[fifo]--;
+	memmove(&fifo_frame[fifo][0], &fifo_frame[fifo][1], fifo_count[fifo] * sizeof(cansim_frame_t));
+	memmove(&fifo_fmi[fifo][0], &fifo_fmi[fifo][1], fifo_count[fifo]);
+	fifo_publish(fifo);
+}
+
+//------------------------------------------------------------------ register writes from the firmware
+
+static void can_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+{
+	volatile uint32_t *reg = (volatile uint32_t *) ((uint8_t *) can + off);
+
+	(void) ctx;
+	if (off == 0x00)
+	{
+		if (val & CAN_MCR_RESET)
+		{
+			dut_reset();
+			update_irqs();
+			return;
+		}
+		*reg = val & 0x000100FF;
+		if ((val ^ old) & (CAN_MCR_INRQ | CAN_MCR_SLEEP))
+			mode_ns = sim_now_ns() + bits_ns(11, dut_bitrate());	//takes 11 recessive bits
+		if ((old & CAN_MCR_INRQ) && !(val & CAN_MCR_INRQ) && DUT->busoff && DUT->busoff_until == NONE)
+			DUT->busoff_until = sim_now_ns() + bits_ns(128 * 11, dut_bitrate());
+	}
+	else if (off == 0x04)
+		*reg = old & ~(val & (CAN_MSR_ERRI | CAN_MSR_WKUI | CAN_MSR_SLAKI));
+	else if (off == 0x08)
+	{
+		*reg = old;
+		for (int m = 0; m < 3; m++)
+		{
+			uint32_t bits = val >> (8 * m);
+
+			if (bits & CAN_TSR_RQCP0)
+				can->TSR &= ~((CAN_TSR_RQCP0 | CAN_TSR_TXOK0 | CAN_TSR_ALST0 | CAN_TSR_TERR0) << (8 * m));
+			if ((bits & CAN_TSR_ABRQ0) && mbx[m].pending && on_wire_mbx != m)
+				dut_tx_done(m, 0, 0);
+		}
+		update_tsr();
+	}
+	else if (off == 0x0C || off == 0x10)
+	{
+		int fifo = off == 0x10;
+
+		*reg = old & ~(val & (CAN_RF0R_FULL0 | CAN_RF0R_FOVR0));
+		if (val & CAN_RF0R_RFOM0)
+			fifo_release(fifo);
+	}
+	else if (off == 0x14)
+		*reg = val & 0x0003CF7F;
+	else if (off == 0x18)
+		*reg = (old & ~CAN_ESR_LEC) | (val & CAN_ESR_LEC);	//only LEC is writable
+	else if (off == 0x1C)
+		*reg = (can->MSR & CAN_MSR_INAK) ? (val & 0xC37F03FF) : old;	//bit timing only in init mode
+	else if (off >= OFF_TX_MBX && off < OFF_RX_FIFO)
+	{
+		int m = (off - OFF_TX_MBX) / 16;
+
+		if (mbx[m].pending)
+			*reg = old;				//write protected until the mailbox is empty again
+		else if (off % 16 == 0 && (val & CAN_TI0R_TXRQ))
+		{
+			CAN_TxMailBox_TypeDef *mb = &can->sTxMailBox[m];
+			cansim_frame_t *f = &mbx[m].f;
+
+			f->ide = (mb->TIR & CAN_TI0R_IDE) ? 1 : 0;
+			f->rtr = (mb->TIR & CAN_TI0R_RTR) ? 1 : 0;
+			f->id = f->ide ? (mb->TIR >> 3) : (mb->TIR >> 21);
+			f->dlc = mb->TDTR & 0xF;
+			for (int i = 0; i < 4; i++)
+			{
+				f->data[i] = mb->TDLR >> (8 * i);
+				f->data[4 + i] = mb->TDHR >> (8 * i);
+			}
+			mbx[m].pending = 1;
+			mbx[m].ready = sim_now_ns();
+			mbx[m].order = request_count++;
+			update_tsr();
+		}
+	}
+	else if (off >= OFF_RX_FIFO && off < OFF_RX_FIFO + 0x20)
+		*reg = old;					//read only
+	else if (off == OFF_FMR)
+		*reg = (old & ~CAN_FMR_FINIT) | (val & CAN_FMR_FINIT);
+	else if (off == OFF_FM1R || off == OFF_FS1R || off == OFF_FFA1R)
+		*reg = (can->FMR & CAN_FMR_FINIT) ? (val & 0x3FFF) : old;
+	else if (off == OFF_FA1R)
+		*reg = val & 0x3FFF;
+	else if (off >= OFF_FILTERS && off < OFF_FILTERS + FILTER_BANKS * 8)
+	{
+		int b = (off - OFF_FILTERS) / 8;
+
+		if (!(can->FMR & CAN_FMR_FINIT) && (can->FA1R & (1u << b)))
+			*reg = old;				//active bank outside filter init mode
+	}
+	else
+		*reg = old;					//reserved
+
+	update_irqs();
+	sim_kick();
+}
+
+//------------------------------------------------------------------ the shared bus
+
+static int node_on_bus(cansim_node_t *n)
+{
+	return n == DUT ? dut_drives() : !n->busoff;
+}
+
+static uint32_t node_rate(cansim_node_t *n)
+{
+	return n == DUT ? dut_bitrate() : n->bitrate;
+}
+
+static uint64_t node_ready(cansim_node_t *n)
+{
+	if (!node_on_bus(n))
+		return NONE;
+	if (n == DUT)
+		return dut_earliest();
+	return n->q_count ? n->q_ready[n->q_head] : NONE;
+}
+
+//arbitration , decides what the bus carries next and when it ends
+static void bus_begin(uint64_t start)
+{
+	uint8_t bits[CANSIM_MAX_NODES][MAX_BITS], arb[CANSIM_MAX_NODES][MAX_BITS];
+	int len[CANSIM_MAX_NODES], alive[CANSIM_MAX_NODES];
+	cansim_node_t *cont[CANSIM_MAX_NODES];
+	const cansim_frame_t *cf[CANSIM_MAX_NODES];
+	int ncont = 0, nalive, k, err_bit = -1, destroyed = 0, acked = 0;
+	uint32_t rate = 0;
+	uint64_t first = NONE;
+
+	//the bus runs at the rate of whoever started first , other rates only produce garbage
+	for (int i = 0; i < nnodes; i++)
+	{
+		uint64_t r = node_ready(&nodes[i]);
+
+		if (r <= start && r < first)
+		{
+			first = r;
+			rate = node_rate(&nodes[i]);
+		}
+	}
+	for (int i = 0; i < nnodes; i++)
+	{
+		cansim_node_t *n = &nodes[i];
+
+		if (node_ready(n) > start)
+			continue;
+		if (!rate_matches(node_rate(n), rate))
+		{
+			if (n->tec <= 127)
+				destroyed = 1;
+			tx_error(n, LEC_BIT_RECESSIVE);
+			if (n == DUT && (can->MCR & CAN_MCR_NART))
+				dut_tx_done(dut_candidate(start), 0, CAN_TSR_TERR0);
+			continue;
+		}
+		cf[ncont] = n == DUT ? &mbx[dut_candidate(start)].f : &n->q[n->q_head];
+		len[ncont] = frame_stream(cf[ncont], bits[ncont], arb[ncont]);
+		alive[ncont] = 1;
+		cont[ncont++] = n;
+	}
+
+	//wired AND , recessive senders that read dominant drop out (or see a bit error past the arbitration field)
+	nalive = ncont;
+	for (k = 0; nalive > 1; k++)
+	{
+		int bus_bit = 1, done = 1;
+
+		for (int i = 0; i < ncont; i++)
+		{
+			if (alive[i] && k < len[i])
+			{
+				bus_bit &= bits[i][k];
+				done = 0;
+			}
+		}
+		if (done)
+			break;
+		for (int i = 0; i < ncont; i++)
+		{
+			if (!alive[i] || k >= len[i] || bits[i][k] == bus_bit)
+				continue;
+			if (arb[i][k])
+			{
+				alive[i] = 0;
+				nalive--;
+				cont[i]->stats.arb_lost++;
+				if (cont[i] == DUT && (can->MCR & CAN_MCR_NART))
+					dut_tx_done(dut_candidate(start), 0, CAN_TSR_ALST0);
+			}
+			else if (err_bit < 0)
+				err_bit = k;
+		}
+		if (err_bit >= 0)
+			break;
+	}
+
+	bus.busy = 1;
+	bus.start = start;
+	bus.ntx = 0;
+	for (int i = 0; i < ncont; i++)
+	{
+		if (!alive[i])
+			continue;
+		bus.tx[bus.ntx++] = cont[i];
+		bus.f = *cf[i];
+		if (cont[i] == DUT)
+			on_wire_mbx = dut_candidate(start);
+	}
+
+	//receivers at the bus rate acknowledge , error active receivers at another rate destroy the frame
+	for (int i = 0; i < nnodes; i++)
+	{
+		cansim_node_t *n = &nodes[i];
+		int sending = 0;
+
+		for (int j = 0; j < bus.ntx; j++)
+			sending |= bus.tx[j] == n;
+		if (sending || (n == DUT ? !dut_listens() : n->busoff))
+			continue;
+		if (!rate_matches(node_rate(n), rate))
+		{
+			if (n->rec <= 127 && (n != DUT || dut_drives()))
+				destroyed = 1;
+			rx_error(n, LEC_STUFF);
+		}
+		else if (n == DUT ? dut_drives() : n->ack)
+			acked = 1;
+	}
+
+	if (err_bit >= 0 || destroyed)
+	{
+		bus.ok = 0;
+		bus.end = start + bits_ns((err_bit >= 0 ? err_bit : 14) + 6 + 8 + 3, rate);
+		for (int j = 0; j < bus.ntx; j++)
+			tx_error(bus.tx[j], LEC_BIT_RECESSIVE);
+	}
+	else if (!acked)
+	{
+		bus.ok = 0;
+		bus.end = start + bits_ns(len[0] + 2 + 6 + 8 + 3, rate);
+		for (int j = 0; j < bus.ntx; j++)
+			tx_error(bus.tx[j], LEC_ACK);
+	}
+	else
+	{
+		bus.ok = 1;
+		bus.end = start + bits_ns(cansim_frame_bits(&bus.f), rate);
+	}
+}
+
+static void deliver_to_peers(const cansim_frame_t *f, cansim_node_t *from, uint32_t rate, cansim_node_t **skip, int nskip)
+{
+	for (int i = 1; i < nnodes; i++)
+	{
+		cansim_node_t *n = &nodes[i];
+		int sender = 0;
+
+		for (int j = 0; j < nskip; j++)
+			sender |= skip[j] == n;
+		if (sender || n->busoff || !rate_matches(n->bitrate, rate))
+			continue;
+		rx_good(n);
+		if (n->on_receive)
+			n->on_receive(n, f, n->ctx);
+	}
+	if (monitor_fn)
+		monitor_fn(from, f, monitor_ctx);
+}
+
+static void peer_sent(cansim_node_t *n, const cansim_frame_t *f)
+{
+	n->q_head = (n->q_head + 1) % CANSIM_PEER_QUEUE;
+	n->q_count--;
+	if (n->on_sent)
+		n->on_sent(n, f, n->ctx);
+}
+
+static void bus_finish(void)
+{
+	cansim_frame_t f = bus.f;
+	uint32_t rate = dut_bitrate();
+
+	bus.busy = 0;
+	bus.free_ns = bus.end;
+	bus_stats.busy_ns += bus.end - bus.start;
+	callback_ns = bus.end;
+	f.t_ns = bus.end;
+
+	for (int j = 0; j < bus.ntx; j++)
+		rate = node_rate(bus.tx[j]);
+
+	if (!bus.ok)
+	{
+		bus_stats.error_frames++;
+		for (int j = 0; j < bus.ntx; j++)
+		{
+			if (bus.tx[j] == DUT && on_wire_mbx >= 0 && (can->MCR & CAN_MCR_NART))
+				dut_tx_done(on_wire_mbx, 0, CAN_TSR_TERR0);
+		}
+		for (int i = 0; i < nnodes; i++)
+		{
+			int sending = 0;
+
+			for (int j = 0; j < bus.ntx; j++)
+				sending |= bus.tx[j] == &nodes[i];
+			if (!sending && bus.ntx && rate_matches(node_rate(&nodes[i]), rate) && (i ? !nodes[i].busoff : dut_listens()))
+				rx_error(&nodes[i], LEC_STUFF);
+		}
+	}
+	else
+	{
+		bus_stats.frames++;
+		for (int j = 0; j < bus.ntx; j++)
+		{
+			tx_good(bus.tx[j]);
+			if (bus.tx[j] == DUT)
+				dut_tx_done(on_wire_mbx, 1, 0);
+			else
+				peer_sent(bus.tx[j], &f);
+		}
+		if (dut_listens() && rate_matches(dut_bitrate(), rate) && bus.tx[0] != DUT)
+		{
+			rx_good(DUT);
+			dut_receive(&f);
+		}
+		deliver_to_peers(&f, bus.tx[0], rate, bus.tx, bus.ntx);
+	}
+	on_wire_mbx = -1;
+	callback_ns = 0;
+	update_irqs();
+}
+
+static uint64_t bus_step(uint64_t now)
+{
+	while (1)
+	{
+		uint64_t start = NONE;
+
+		if (bus.busy)
+		{
+			if (bus.end > now)
+				return bus.end;
+			bus_finish();
+			return now;			//one frame at a time while catching up
+		}
+		for (int i = 0; i < nnodes; i++)
+		{
+			uint64_t r = node_ready(&nodes[i]);
+
+			if (r < start)
+				start = r;
+		}
+		if (start == NONE)
+			return NONE;
+		if (start < bus.free_ns)
+			start = bus.free_ns;
+		if (start > now)
+			return start;
+		bus_begin(start);
+	}
+}
+
+//------------------------------------------------------------------ loopback timeline
+
+static uint64_t loopback_step(uint64_t now)
+{
+	while (1)
+	{
+		uint64_t start;
+		int m;
+
+		if (lb.busy)
+		{
+			cansim_frame_t f = mbx[on_wire_mbx].f;
+
+			if (lb.end > now)
+				return lb.end;
+			lb.busy = 0;
+			lb.free_ns = lb.end;
+			f.t_ns = lb.end;
+			callback_ns = lb.end;
+			dut_tx_done(on_wire_mbx, 1, 0);
+			on_wire_mbx = -1;
+			tx_good(DUT);
+			dut_receive(&f);
+			if (!(can->BTR & CAN_BTR_SILM))
+				deliver_to_peers(&f, DUT, dut_bitrate(), 0, 0);
+			callback_ns = 0;
+			update_irqs();
+			return now;
+		}
+		if (!dut_loopback() || (start = dut_earliest()) == NONE)
+			return NONE;
+		if (start < lb.free_ns)
+			start = lb.free_ns;
+		if (start > now)
+			return start;
+		m = dut_candidate(start);
+		on_wire_mbx = m;
+		lb.busy = 1;
+		lb.start = start;
+		lb.end = start + bits_ns(cansim_frame_bits(&mbx[m].f), dut_bitrate());
+	}
+}
+
+//------------------------------------------------------------------ model
+
+static uint64_t can_step(void *ctx, uint64_t now)
+{
+	uint64_t next = NONE, t;
+
+	(void) ctx;
+	if (mode_ns != NONE && mode_ns <= now)
+	{
+		uint32_t msr = can->MSR & ~(CAN_MSR_INAK | CAN_MSR_SLAK);
+
+		if (can->MCR & CAN_MCR_INRQ)
+			msr |= CAN_MSR_INAK;
+		else if (can->MCR & CAN_MCR_SLEEP)
+			msr |= CAN_MSR_SLAK;
+		can->MSR = msr;
+		mode_ns = NONE;
+	}
+	if (mode_ns < next)
+		next = mode_ns;
+
+	for (int i = 0; i < nnodes; i++)
+	{
+		if (nodes[i].busoff && nodes[i].busoff_until <= now)
+			recover(&nodes[i]);
+		if (nodes[i].busoff && nodes[i].busoff_until < next)
+			next = nodes[i].busoff_until;
+	}
+
+	t = bus_step(now);
+	if (t < next)
+		next = t;
+	t = loopback_step(now);
+	if (t < next)
+		next = t;
+	update_irqs();
+	return next;
+}
+
+__attribute__((constructor(200))) static void cansim_init(void)
+{
+	void *alias;
+
+	CAN1 = mmio_map(sizeof(CAN_TypeDef), 0, can_write, 0, 0, &alias);
+	can = alias;
+	dut_reset();
+	sim_add_model(can_step, 0);
+}
+
+//------------------------------------------------------------------ peers
+
+cansim_node_t *cansim_dut(void)
+{
+	return DUT;
+}
+
+cansim_node_t *cansim_peer_new(const char *name, uint32_t bitrate)
+{
+	cansim_node_t *n;
+
+	hw_lock();
+	n = &nodes[nnodes++];
+	memset(n, 0, sizeof(*n));
+	n->name = name;
+	n->bitrate = bitrate;
+	n->ack = 1;
+	hw_unlock();
+	return n;
+}
+
+void cansim_peer_callbacks(cansim_node_t *node, cansim_frame_fn on_receive, cansim_frame_fn on_sent, void *ctx)
+{
+	hw_lock();
+	node->on_receive = on_receive;
+	node->on_sent = on_sent;
+	node->ctx = ctx;
+	hw_unlock();
+}
+
+void cansim_peer_ack(cansim_node_t *node, int ack)
+{
+	hw_lock();
+	node->ack = ack;
+	hw_unlock();
+}
+
+int cansim_peer_send_at(cansim_node_t *node, const cansim_frame_t *f, uint64_t t_ns)
+{
+	int ok = 0;
+
+	hw_lock();
+	if (node->q_count < CANSIM_PEER_QUEUE)
+	{
+		uint32_t slot = (node->q_head + node->q_count) % CANSIM_PEER_QUEUE;
+
+		node->q[slot] = *f;
+		node->q_ready[slot] = t_ns;
+		node->q_count++;
+		ok = 1;
+	}
+	hw_unlock();
+	sim_kick();
+	return ok;
+}
+
+int cansim_peer_send(cansim_node_t *node, const cansim_frame_t *f)
+{
+	return cansim_peer_send_at(node, f, callback_ns ? callback_ns : sim_now_ns());
+}
+
+uint32_t cansim_peer_pending(cansim_node_t *node)
+{
+	return node->q_count;
+}
+
+uint32_t cansim_bitrate(cansim_node_t *node)
+{
+	uint32_t rate;
+
+	hw_lock();
+	rate = node_rate(node);
+	hw_unlock();
+	return rate;
+}
+
+int cansim_online(cansim_node_t *node)
+{
+	int on;
+
+	hw_lock();
+	on = node == DUT ? dut_running() : !node->busoff;
+	hw_unlock();
+	return on;
+}
+
+const char *cansim_name(cansim_node_t *node)
+{
+	return node->name;
+}
+
+void cansim_node_stats(cansim_node_t *node, cansim_node_stats_t *stats)
+{
+	hw_lock();
+	*stats = node->stats;
+	hw_unlock();
+}
+
+void cansim_bus_stats(cansim_bus_stats_t *stats)
+{
+	hw_lock();
+	*stats = bus_stats;
+	hw_unlock();
+}
+
+void cansim_monitor(cansim_frame_fn fn, void *ctx)
+{
+	hw_lock();
+	monitor_fn = fn;
+	monitor_ctx = ctx;
+	hw_unlock();
+}
+
+int cansim_filter_fifo(const cansim_frame_t *f)
+{
+	uint8_t fmi;
+	int fifo;
+
+	hw_lock();
+	fifo = filter_fifo(f, &fmi);
+	hw_unlock();
+	return fifo;
+}
@@ -0,0 +1,71 @@
+#ifndef CANSIM_H
+#define CANSIM_H
+
+//bxCAN model for CAN1 plus any number of scripted peer nodes on one virtual bus
+//
+//every frame is turned into its stuffed bit stream (SOF to CRC) and the contenders are compared bit by bit ,
+//so arbitration , frame length and bus load come out exactly as on the wire
+//bit rates come from each node's own timing (BTR and PCLK1 for CAN1) , a node more than 1% off the bus rate
+//cannot receive and destroys frames with error flags until its REC pushes it error passive
+//
+//a frame nobody acknowledges is an ACK error , TEC/REC , error passive and bus off follow the CAN rules
+//loopback (LBKM) runs on a private timeline: own frames are received back , and echoed to the peers unless SILM is set
+
+#include <stdint.h>
+
+typedef struct
+{
+	uint32_t id;
+	uint8_t ide;
+	uint8_t rtr;
+	uint8_t dlc;
+	uint8_t data[8];
+	uint64_t t_ns;			//end of frame (virtual time) , filled in by the simulator
+} cansim_frame_t;
+
+typedef struct cansim_node cansim_node_t;
+
+//called from the simulator thread with hw_lock held , may call cansim_peer_send()
+typedef void (*cansim_frame_fn)(cansim_node_t *node, const cansim_frame_t *f, void *ctx);
+
+typedef struct
+{
+	uint32_t tx_ok;
+	uint32_t rx;
+	uint32_t arb_lost;
+	uint32_t tx_errors;		//error frames while this node was transmitting
+	uint32_t rx_errors;
+	uint32_t busoffs;
+	uint16_t tec;
+	uint16_t rec;
+} cansim_node_stats_t;
+
+typedef struct
+{
+	uint64_t frames;		//frames that made it through
+	uint64_t error_frames;
+	uint64_t busy_ns;		//time the bus was not idle (frames , error frames and interframe space)
+} cansim_bus_stats_t;
+
+#define CANSIM_MAX_NODES 8
+#define CANSIM_PEER_QUEUE 64
+
+cansim_node_t *cansim_dut(void);			//the node behind CAN1
+cansim_node_t *cansim_peer_new(const char *name, uint32_t bitrate);
+void cansim_peer_callbacks(cansim_node_t *node, cansim_frame_fn on_receive, cansim_frame_fn on_sent, void *ctx);
+void cansim_peer_ack(cansim_node_t *node, int ack);	//peers acknowledge frames unless told otherwise
+int cansim_peer_send(cansim_node_t *node, const cansim_frame_t *f);	//queued in order , 0 if the queue is full
+int cansim_peer_send_at(cansim_node_t *node, const cansim_frame_t *f, uint64_t t_ns);	//not before t_ns
+uint32_t cansim_peer_pending(cansim_node_t *node);
+
+uint32_t cansim_bitrate(cansim_node_t *node);
+int cansim_online(cansim_node_t *node);		//CAN1 out of init / sleep mode , not bus off (peers only the latter)
+const char *cansim_name(cansim_node_t *node);
+void cansim_node_stats(cansim_node_t *node, cansim_node_stats_t *stats);
+void cansim_bus_stats(cansim_bus_stats_t *stats);
+void cansim_monitor(cansim_frame_fn fn, void *ctx);	//sees every good frame , node is the sender
+
+uint32_t cansim_frame_bits(const cansim_frame_t *f);	//SOF to end of interframe space , stuff bits included
+int cansim_filter_fifo(const cansim_frame_t *f);	//FIFO the CAN1 filter banks put a frame in , -1 if rejected
+
+#endif
@@ -0,0 +1,198 @@
+//host checks for the ADC decimator (MyDrivers/adcdecim.c)
+//
+//  decim_bench                      exit status 0 when every check passes
+//
+//exact: every output is compared against a plain reference (window sum , or the triangular sinc^2 weights) on random 12 bit input
+//noise: a DC level with a fractional part plus 0.5 LSB rms white noise is quantized to 12 bits , the rms of the outputs gives
+//       the noise floor and the effective bits ; each 4x of osr must buy close to one bit and the mean must track the level
+//speed: host TSC cycles per input sample , as a relative figure between settings (the M3 loop is 3-4 instructions per sample)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <x86intrin.h>
+#include "adcdecim.h"
+
+#define N_IN (1 << 20)
+
+static uint16_t in[N_IN * 2];
+static uint16_t out[N_IN];
+
+static uint32_t rng = 12345;
+
+static double uniform(void)
+{
+	rng = rng * 1664525 + 1013904223;
+	return ((rng >> 8) + 0.5) / 16777216.0;
+}
+
+static double gauss(void)
+{
+	return sqrt(-2 * log(uniform())) * cos(2 * M_PI * uniform());
+}
+
+static uint16_t quantize(double v)
+{
+	long q = lround(v);
+
+	return q < 0 ? 0 : q > 4095 ? 4095 : q;
+}
+
+//sum over the window ending at input k (order 1: osr samples , order 2: 2 * osr - 1 samples weighted 1 , 2 .. osr .. 2 , 1)
+static uint32_t reference(const uint16_t *x, uint32_t k, uint16_t osr, uint8_t order)
+{
+	uint32_t sum = 0;
+
+	if (order == 1)
+	{
+		for (uint32_t i = 0; i < osr; i++)
+			sum += x[k - i];
+		return sum;
+	}
+	for (uint32_t i = 0; i < 2U * osr - 1; i++)
+		sum += x[k - i] * (i < osr ? i + 1 : 2 * osr - 1 - i);
+	return sum;
+}
+
+static int exact(void)
+{
+	static const uint16_t osrs[] = { 4, 16, 64, 256 };
+	int failed = 0;
+
+	for (uint32_t i = 0; i < N_IN; i++)
+		in[i] = uniform() * 4096;
+	for (uint8_t order = 1; order <= 2; order++)
+		for (unsigned o = 0; o < 4; o++)
+			for (uint8_t bits = 12; bits <= 16; bits += 2)
+			{
+				decim_t d;
+				uint32_t n = 0, pos = 0, bad = 0;
+				uint16_t osr = osrs[o];
+				int shift;
+
+				decim_init(&d, osr, order, bits);
+				shift = d.shift;
+				//odd feed lengths so outputs land in the middle of a call
+				while (pos < 64 * 1024)
+				{
+					uint32_t len = 1 + (pos * 7919) % 97;
+
+					n += decim_feed(&d, in + pos, len, 1, out + n);
+					pos += len;
+				}
+				for (uint32_t k = 0; k < n; k++)
+				{
+					uint32_t sum = reference(in, (k + order) * osr - 1, osr, order);
+					uint32_t want = shift > 0 ? (sum + (1U << (shift - 1))) >> shift : sum << -shift;
+
+					if (out[k] != want || want >> bits)
+						bad++;
+				}
+				if (n != pos / osr - (order - 1) || bad)
+				{
+					printf("  exact order %u osr %3u -> %u bits: %u outputs , %u wrong\n", order, osr, bits, n, bad);
+					failed = 1;
+				}
+			}
+	printf("exact              %s\n", failed ? "FAIL" : "ok");
+	return failed;
+}
+
+//rms of the outputs around the true level , in 12 bit LSB
+static double noise_floor(uint16_t osr, uint8_t order, uint8_t bits, double level, double *mean_err)
+{
+	decim_t d;
+	uint32_t n;
+	double scale = 1.0 / (1 << (bits - 12)), sum = 0, sum2 = 0;
+
+	for (uint32_t i = 0; i < N_IN; i++)
+		in[i] = quantize(level + 0.5 * gauss());
+	decim_init(&d, osr, order, bits);
+	n = decim_feed(&d, in, N_IN, 1, out);
+	for (uint32_t k = 0; k < n; k++)
+	{
+		double e = out[k] * scale - level;
+
+		sum += e;
+		sum2 += e * e;
+	}
+	*mean_err = sum / n;
+	return sqrt(sum2 / n);
+}
+
+static int noise(void)
+{
+	static const uint16_t osrs[] = { 4, 16, 64, 256 };
+	static const double levels[] = { 1000.0, 2047.3, 3071.75 };
+	int failed = 0;
+
+	printf("noise floor        0.5 LSB rms input noise , 16 bit output , rms in 12 bit LSB\n");
+	for (uint8_t order = 1; order <= 2; order++)
+	{
+		double base_err, base = 0;
+
+		for (unsigned l = 0; l < 3; l++)
+			base += noise_floor(4, 1, 16, levels[l], &base_err) * 2 / 3;	//osr 4 rms * sqrt(4) = single sample rms
+		for (unsigned o = 0; o < 4; o++)
+		{
+			double rms = 0, worst_mean = 0, mean_err, enob, gain;
+
+			for (unsigned l = 0; l < 3; l++)
+			{
+				rms += noise_floor(osrs[o], order, 16, levels[l], &mean_err) / 3;
+				if (fabs(mean_err) > worst_mean)
+					worst_mean = fabs(mean_err);
+			}
+			enob = 12 - log2(rms * sqrt(12));
+			gain = log2(base / rms);
+			//order 2 averages a triangular window of 2 * osr - 1 samples , a little quieter than the boxcar
+			if (gain < log2(osrs[o]) / 2 - 0.3 || worst_mean > 0.05)
+				failed = 1;
+			printf("  order %u osr %3u  rms %.4f  effective bits %.2f  gain %.2f bits  worst mean error %.4f LSB\n",
+				order, osrs[o], rms, enob, gain, worst_mean);
+		}
+	}
+	printf("noise              %s\n", failed ? "FAIL" : "ok");
+	return failed;
+}
+
+static void speed(void)
+{
+	static const uint16_t osrs[] = { 16, 256 };
+
+	for (uint32_t i = 0; i < 2 * N_IN; i++)
+		in[i] = uniform() * 4096;
+	for (uint8_t order = 1; order <= 2; order++)
+		for (unsigned o = 0; o < 2; o++)
+			for (uint8_t stride = 1; stride <= 2; stride++)
+			{
+				decim_t d;
+				uint64_t best = ~0ULL;
+
+				for (int rep = 0; rep < 5; rep++)
+				{
+					uint64_t t;
+
+					decim_init(&d, osrs[o], order, 16);
+					t = __rdtsc();
+					//DMA sized blocks , 32 scans a call
+					for (uint32_t pos = 0; pos < N_IN; pos += 32)
+						decim_feed(&d, in + pos * stride, 32, stride, out);
+					t = __rdtsc() - t;
+					if (t < best)
+						best = t;
+				}
+				printf("speed              order %u osr %3u stride %u: %.2f cycles per sample\n",
+					order, osrs[o], stride, (double) best / N_IN);
+			}
+}
+
+int main(void)
+{
+	int failed = exact();
+
+	failed |= noise();
+	speed();
+	printf("%s\n", failed ? "FAIL" : "PASS");
+	return failed;
+}
@@ -0,0 +1,168 @@
+#include <stdlib.h>
+#include "mmio.h"
+#include "stm32f1xx.h"
+
+//core peripherals of the simulated chip and plain memory for blocks that have no model yet
+//model files map their own block from a constructor that runs before this one starts the simulator ,
+//the weak pointers below give way to periph.c when it is linked in (RCC , GPIO , TIM , USART , ADC and DMA1 models)
+
+uint32_t SystemCoreClock = 8000000;		//HSI , what the chip runs on out of reset
+
+static RCC_TypeDef rcc_regs;
+static GPIO_TypeDef gpioa_regs, gpiob_regs, gpioc_regs;
+static AFIO_TypeDef afio_regs;
+static TIM_TypeDef tim1_regs, tim2_regs, tim3_regs, tim4_regs;
+static USART_TypeDef usart1_regs, usart2_regs, usart3_regs;
+static ADC_TypeDef adc1_regs, adc2_regs;
+static DMA_TypeDef dma1_regs;
+static DMA_Channel_TypeDef dma1_ch_regs[7];
+static I2C_TypeDef i2c1_regs, i2c2_regs;
+static SPI_TypeDef spi1_regs, spi2_regs;
+static CoreDebug_Type coredebug_regs;
+static FLASH_TypeDef flash_regs;
+
+#define MODELLED __attribute__((weak))
+
+MODELLED RCC_TypeDef *RCC = &rcc_regs;
+MODELLED GPIO_TypeDef *GPIOA = &gpioa_regs, *GPIOB = &gpiob_regs, *GPIOC = &gpioc_regs;
+AFIO_TypeDef *AFIO = &afio_regs;
+MODELLED TIM_TypeDef *TIM1 = &tim1_regs, *TIM2 = &tim2_regs, *TIM3 = &tim3_regs, *TIM4 = &tim4_regs;
+MODELLED USART_TypeDef *USART1 = &usart1_regs, *USART2 = &usart2_regs, *USART3 = &usart3_regs;
+MODELLED ADC_TypeDef *ADC1 = &adc1_regs, *ADC2 = &adc2_regs;
+MODELLED DMA_TypeDef *DMA1 = &dma1_regs;
+MODELLED DMA_Channel_TypeDef *DMA1_Channel1 = &dma1_ch_regs[0], *DMA1_Channel2 = &dma1_ch_regs[1], *DMA1_Channel3 = &dma1_ch_regs[2];
+MODELLED DMA_Channel_TypeDef *DMA1_Channel4 = &dma1_ch_regs[3], *DMA1_Channel5 = &dma1_ch_regs[4], *DMA1_Channel6 = &dma1_ch_regs[5];
+MODELLED DMA_Channel_TypeDef *DMA1_Channel7 = &dma1_ch_regs[6];
+MODELLED I2C_TypeDef *I2C1 = &i2c1_regs, *I2C2 = &i2c2_regs;
+SPI_TypeDef *SPI1 = &spi1_regs, *SPI2 = &spi2_regs;
+CoreDebug_Type *CoreDebug = &coredebug_regs;
+FLASH_TypeDef *FLASH = &flash_regs;
+SysTick_Type *SysTick;
+DWT_Type *DWT;
+
+//------------------------------------------------------------------ DWT , CYCCNT follows virtual time
+
+static DWT_Type *dwt;
+static uint32_t cyccnt_offset;		//CYCCNT = sim_cycles() - offset while counting
+
+static void dwt_read(void *ctx, uint32_t offset, int after)
+{
+	(void) ctx;
+	if (!after && offset == 4 && (dwt->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+		dwt->CYCCNT = sim_cycles() - cyccnt_offset;
+}
+
+static void dwt_write(void *ctx, uint32_t offset, uint32_t old, uint32_t val)
+{
+	(void) ctx;
+	(void) old;
+	if (offset == 0 || offset == 4)
+		cyccnt_offset = sim_cycles() - dwt->CYCCNT;	//started , stopped or written , count on from here
+	(void) val;
+}
+
+//------------------------------------------------------------------ SysTick
+
+static SysTick_Type *systick;
+static uint64_t systick_reload_ns;	//virtual time the counter last reloaded from LOAD
+
+static uint64_t systick_period_ns(void)
+{
+	uint64_t cycles = (uint64_t) ((systick->LOAD & SysTick_LOAD_RELOAD_Msk) + 1);
+
+	if (!(systick->CTRL & SysTick_CTRL_CLKSOURCE_Msk))
+		cycles *= 8;				//HCLK/8
+	return cycles * 1000000000ULL / SystemCoreClock;
+}
+
+static uint64_t systick_step(void *ctx, uint64_t now)
+{
+	uint64_t period;
+
+	(void) ctx;
+	if (!(systick->CTRL & SysTick_CTRL_ENABLE_Msk))
+		return ~0ULL;
+	period = systick_period_ns();
+	if (now >= systick_reload_ns + period)
+	{
+		systick_reload_ns += (now - systick_reload_ns) / period * period;	//late ticks collapse into one , like a pending bit
+		systick->CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+		if (systick->CTRL & SysTick_CTRL_TICKINT_Msk)
+			nvic_pend(SysTick_IRQn);
+	}
+	return systick_reload_ns + period;
+}
+
+static void systick_read(void *ctx, uint32_t offset, int after)
+{
+	(void) ctx;
+	if (offset == 8 && !after && (systick->CTRL & SysTick_CTRL_ENABLE_Msk))
+	{
+		uint64_t period = systick_period_ns();
+		uint64_t into = (sim_now_ns() - systick_reload_ns) % period;
+
+		systick->VAL = (uint32_t) ((period - into) * (systick->LOAD & SysTick_LOAD_RELOAD_Msk) / period);	//counts down
+	}
+	if (offset == 0 && after)
+		systick->CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;	//cleared by reading
+}
+
+static void systick_write(void *ctx, uint32_t offset, uint32_t old, uint32_t val)
+{
+	(void) ctx;
+	if (offset == 0)
+	{
+		systick->CTRL = (val & 0x7) | (old & SysTick_CTRL_COUNTFLAG_Msk);
+		if ((val & SysTick_CTRL_ENABLE_Msk) && !(old & SysTick_CTRL_ENABLE_Msk))
+			systick_reload_ns = sim_now_ns();
+	}
+	else if (offset == 8)
+	{
+		systick->VAL = 0;			//any write clears the counter and COUNTFLAG
+		systick->CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+		systick_reload_ns = sim_now_ns();
+	}
+	else if (offset == 12)
+		*(volatile uint32_t *) &systick->CALIB = old;	//read only
+	sim_kick();
+}
+
+uint32_t SysTick_Config(uint32_t ticks)
+{
+	if (ticks - 1 > SysTick_LOAD_RELOAD_Msk)
+		return 1;
+	SysTick->LOAD = ticks - 1;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+	return 0;
+}
+
+//------------------------------------------------------------------ clock tree
+
+void SystemInit(void)
+{
+}
+
+MODELLED void SystemCoreClockUpdate(void)
+{
+	//RCC has no model without periph.c , the core stays on HSI
+}
+
+//------------------------------------------------------------------ start up
+
+__attribute__((constructor(300))) static void device_init(void)
+{
+	const char *scale = getenv("HOSTSIM_TIME_SCALE");
+	void *alias;
+
+	DWT = mmio_map(sizeof(DWT_Type), 1, dwt_write, dwt_read, 0, &alias);
+	dwt = alias;
+	SysTick = mmio_map(sizeof(SysTick_Type), 1, systick_write, systick_read, 0, &alias);
+	systick = alias;
+	sim_add_model(systick_step, 0);
+
+	if (scale)
+		sim_set_time_scale(atof(scale));
+	sim_start();
+	NVIC_EnableIRQ(SysTick_IRQn);		//exceptions are always enabled
+}
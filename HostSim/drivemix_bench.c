@@ -0,0 +1,136 @@
+//host checks for the drive mixer (MyDrivers/drivemix.c)
+//
+//  drivemix_bench                   exit status 0 when every check passes
+//
+//exact: the old Rover MotorCode() / Drive() (copied below , TIM4 and the LED pins swapped for plain variables) and
+//       drive_mix() both run over every x , y in -8000 .. 8000 for every gear 0 .. 10 , in the same order so the
+//       kept-output cases see the same history , duty and direction must match after every call
+//speed: host TSC cycles per update for both on a random stick walk , the M3 has no FPU so the float path costs
+//       far more there (soft float multiply and conversions) than it does here
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <x86intrin.h>
+#include "drivemix.h"
+
+#define RANGE 8000
+
+static volatile uint32_t CCR1, CCR2, LED;	//stand ins for TIM4->CCR1 , TIM4->CCR2 and A4 / A5
+
+//the old code , unchanged apart from the register names
+static void Drive(int DL, int DR, int a, int b, int p, int q, int X, int Y, float gear) {
+	if (DL == 1)
+		LED |= DRIVE_LEFT;
+	else
+		LED &= ~DRIVE_LEFT;
+
+	if (DR == 1)
+		LED |= DRIVE_RIGHT;
+	else
+		LED &= ~DRIVE_RIGHT;
+
+	CCR1 = (uint32_t) abs(abs(a * X) - abs(b * Y)) * (gear * 0.1); //Left PWM
+	CCR2 = (uint32_t) abs(abs(p * X) - abs(q * Y)) * (gear * 0.1); //Right PWM
+}
+
+static void MotorCode(int x, int y, float g) {
+	if (abs(x) < 20 && abs(y) < 20)   //No Motion
+		Drive(0, 0, 0, 0, 0, 0, 0, 0, 0);
+	else if (abs(x) < 10 && y < 0)   //Full Backward
+		Drive(0, 0, 0, 1, 0, 1, x, y, g);
+	else if (abs(x) < 10 && y > 0)   //Full Forward
+		Drive(1, 1, 0, 1, 0, 1, x, y, g);
+	else if (x < 0 && abs(y) <= 10)   //Spot Turn Left
+		Drive(0, 1, 1, 0, 1, 0, x, y, g);
+	else if (x > 0 && abs(y) <= 10)   //Spot Turn Right
+		Drive(1, 0, 1, 0, 1, 0, x, y, g);
+	else if (x > 0 && y > 0 && x > y)   //Octet 1
+		Drive(1, 0, 1, 0, 1, 1, x, y, g);
+	else if (x > 0 && y > 0 && x < y)   //Octet 2
+		Drive(1, 1, 0, 1, 1, 1, x, y, g);
+	else if (x < 0 && y > 0 && abs(x) < y)   //Octet 3
+		Drive(1, 1, 1, 1, 0, 1, x, y, g);
+	else if (x < 0 && y > 0 && abs(x) >= y)   //Octet 4
+		Drive(0, 1, 1, 1, 1, 0, x, y, g);
+	else if (x < 0 && y < 0 && abs(x) > abs(y))   //Octet 5
+		Drive(0, 1, 1, 0, 1, 1, x, y, g);
+	else if (x < 0 && y < 0 && abs(x) < abs(y))   //Octet 6
+		Drive(0, 0, 0, 1, 1, 1, x, y, g);
+	else if (x > 0 && y < 0 && abs(x) < abs(y))   //Octet 7
+		Drive(0, 0, 1, 1, 0, 1, x, y, g);
+	else if (x > 0 && y < 0 && abs(x) > abs(y))   //Octet 8
+		Drive(1, 0, 1, 1, 1, 0, x, y, g);
+}
+
+static int exact(void)
+{
+	uint64_t bad = 0;
+
+	for (uint32_t gear = 0; gear <= 10; gear++)
+	{
+		drivemix_t m = { 0, 0, 0 };
+
+		CCR1 = CCR2 = LED = 0;
+		for (int32_t x = -RANGE; x <= RANGE; x++)
+			for (int32_t y = -RANGE; y <= RANGE; y++)
+			{
+				MotorCode(x, y, gear);
+				drive_mix(&m, x, y, gear);
+				if (m.left != CCR1 || m.right != CCR2 || m.dir != LED)
+				{
+					if (bad++ < 10)
+						printf("  x %d y %d gear %u: old %u %u dir %u , mixer %u %u dir %u\n", x, y, gear,
+								CCR1, CCR2, LED, m.left, m.right, m.dir);
+				}
+			}
+	}
+	printf("exact: %llu mismatches over 11 gears x %d x %d points\n", (unsigned long long) bad, 2 * RANGE + 1, 2 * RANGE + 1);
+	return bad != 0;
+}
+
+#define WALK (1 << 20)
+
+static int16_t walk[WALK][2];
+
+static void speed(void)
+{
+	drivemix_t m = { 0, 0, 0 };
+	uint32_t sum = 0;
+	uint64_t t0, t1, t2;
+	int32_t x = 0, y = 0;
+	uint32_t rng = 99;
+
+	//a stick that wanders , so branch prediction does not get the old chain for free
+	for (int i = 0; i < WALK; i++)
+	{
+		rng = rng * 1664525 + 1013904223;
+		x += (int32_t) (rng >> 20) - 2048;
+		y += (int32_t) ((rng >> 8) & 0xFFF) - 2048;
+		x = x > RANGE ? RANGE : x < -RANGE ? -RANGE : x;
+		y = y > RANGE ? RANGE : y < -RANGE ? -RANGE : y;
+		walk[i][0] = x;
+		walk[i][1] = y;
+	}
+
+	t0 = __rdtsc();
+	for (int i = 0; i < WALK; i++)
+		MotorCode(walk[i][0], walk[i][1], 7);
+	t1 = __rdtsc();
+	for (int i = 0; i < WALK; i++)
+	{
+		drive_mix(&m, walk[i][0], walk[i][1], 7);
+		sum += m.left + m.right;
+	}
+	t2 = __rdtsc();
+	printf("speed: old %.1f cycles per update , mixer %.1f (checksum %u)\n",
+			(double) (t1 - t0) / WALK, (double) (t2 - t1) / WALK, sum);
+}
+
+int main(void)
+{
+	int failed = exact();
+
+	speed();
+	printf(failed ? "FAILED\n" : "all passed\n");
+	return failed;
+}
@@ -0,0 +1,353 @@
+//host checks and benchmark for the fixed point filters (MyDrivers/sigfilt.c)
+//
+//  filt_bench                       exit status 0 when every check passes
+//
+//golden: the block functions on a fixed step / spike input must give exactly the stored outputs (catches any change in rounding)
+//float:  the biquad cascades on random input stay within a few LSB of a float reference with the unquantized coefficients
+//exact:  moving average and median against a brute force window on random input
+//speed:  host TSC cycles per sample of each filter next to the float reference
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <x86intrin.h>
+#include "sigfilt.h"
+
+#define N_IN (1 << 18)
+#define N_GOLDEN 32
+
+static uint16_t in[N_IN];
+static uint16_t buf[N_IN];
+
+static uint32_t rng = 4321;
+
+static uint32_t rand32(void)
+{
+	rng = rng * 1664525 + 1013904223;
+	return rng;
+}
+
+//RBJ cookbook low pass , b and a normalized so a0 = 1
+static void lowpass(double fc, double fs, double q, double *c)
+{
+	double w = 2 * M_PI * fc / fs, alpha = sin(w) / (2 * q), a0 = 1 + alpha;
+
+	c[0] = (1 - cos(w)) / 2 / a0;
+	c[1] = (1 - cos(w)) / a0;
+	c[2] = c[0];
+	c[3] = -2 * cos(w) / a0;
+	c[4] = (1 - alpha) / a0;
+}
+
+static filt_coef_q31_t to_q31(const double *c)
+{
+	filt_coef_q31_t q = { lround(c[0] * (1 << 30)), lround(c[1] * (1 << 30)), lround(c[2] * (1 << 30)),
+		lround(-c[3] * (1 << 30)), lround(-c[4] * (1 << 30)) };
+
+	return q;
+}
+
+static filt_coef_q15_t to_q15(const double *c)
+{
+	filt_coef_q15_t q = { lround(c[0] * (1 << 14)), lround(c[1] * (1 << 14)), lround(c[2] * (1 << 14)),
+		lround(-c[3] * (1 << 14)), lround(-c[4] * (1 << 14)) };
+
+	return q;
+}
+
+typedef struct
+{
+	double c[FILT_MAX_STAGES][5];
+	float x1[FILT_MAX_STAGES], x2[FILT_MAX_STAGES], y1[FILT_MAX_STAGES], y2[FILT_MAX_STAGES];
+	uint8_t stages;
+} float_biquad_t;
+
+static float float_step(float_biquad_t *f, float x)
+{
+	for (uint8_t s = 0; s < f->stages; s++)
+	{
+		float y = f->c[s][0] * x + f->c[s][1] * f->x1[s] + f->c[s][2] * f->x2[s] - f->c[s][3] * f->y1[s] - f->c[s][4] * f->y2[s];
+
+		f->x2[s] = f->x1[s];
+		f->x1[s] = x;
+		f->y2[s] = f->y1[s];
+		f->y1[s] = y;
+		x = y;
+	}
+	return x;
+}
+
+//a 4th order Butterworth at 20 Hz of 1 kHz as two Q31 sections and a 2nd order one at 100 Hz in Q15 , the golden vectors
+//use these constants , design() checks they still match what the cookbook formulas give
+static float_biquad_t ref_slow, ref_fast;
+static const filt_coef_q31_t coef_slow[2] =
+{
+	{ 3794065, 7588130, 3794065, 1909450996, -850885433 },
+	{ 4039640, 8079280, 4039640, 2033042158, -975458894 },
+};
+static const filt_coef_q15_t coef_fast[1] = { { 1105, 2210, 1105, 18727, -6763 } };
+
+static int design(void)
+{
+	filt_coef_q31_t q31[2];
+	filt_coef_q15_t q15;
+
+	memset(&ref_slow, 0, sizeof(ref_slow));
+	memset(&ref_fast, 0, sizeof(ref_fast));
+	ref_slow.stages = 2;
+	lowpass(20, 1000, 0.5412, ref_slow.c[0]);	//Butterworth 4th order as two sections
+	lowpass(20, 1000, 1.3066, ref_slow.c[1]);
+	q31[0] = to_q31(ref_slow.c[0]);
+	q31[1] = to_q31(ref_slow.c[1]);
+	ref_fast.stages = 1;
+	lowpass(100, 1000, 0.7071, ref_fast.c[0]);
+	q15 = to_q15(ref_fast.c[0]);
+	if (memcmp(q31, coef_slow, sizeof(q31)) || memcmp(&q15, coef_fast, sizeof(q15)))
+	{
+		printf("design             FAIL  coefficients do not match the formulas\n");
+		return 1;
+	}
+	return 0;
+}
+
+static void golden_input(uint16_t *x)
+{
+	for (int i = 0; i < N_GOLDEN; i++)
+		x[i] = i < 4 ? 100 : 3000;
+	x[12] = 4095;			//spike
+	x[20] = 0;
+}
+
+static const uint16_t golden_q31[N_GOLDEN] =
+{
+	0, 0, 0, 0, 0, 1, 3, 6, 13, 25, 42, 67, 100, 143, 196, 259,
+	334, 419, 515, 622, 737, 861, 991, 1127, 1265, 1406, 1547, 1686, 1824, 1959, 2089, 2214
+};
+static const uint16_t golden_q15[N_GOLDEN] =
+{
+	7, 28, 56, 80, 291, 913, 1733, 2413, 2852, 3074, 3145, 3136, 3169, 3285, 3330, 3259,
+	3160, 3076, 3021, 2993, 2781, 2348, 2143, 2289, 2542, 2769, 2926, 3010, 3042, 3044, 3033, 3020
+};
+//average of 8 , the spike and the dropout each shift it by an eighth for 8 samples
+static const uint16_t golden_ma[N_GOLDEN] =
+{
+	100, 100, 100, 100, 680, 1067, 1343, 1550, 1913, 2275, 2638, 3000, 3137, 3137, 3137, 3137,
+	3137, 3137, 3137, 3137, 2625, 2625, 2625, 2625, 2625, 2625, 2625, 2625, 3000, 3000, 3000, 3000
+};
+//median of 5 , the single sample spike and dropout never get through
+static const uint16_t golden_median[N_GOLDEN] =
+{
+	100, 100, 100, 100, 100, 100, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000,
+	3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000, 3000
+};
+
+static int compare(const char *name, const uint16_t *got, const uint16_t *want)
+{
+	if (!memcmp(got, want, N_GOLDEN * sizeof(uint16_t)))
+		return 0;
+	printf("  golden %s differs:", name);
+	for (int i = 0; i < N_GOLDEN; i++)
+		printf(" %u", got[i]);
+	printf("\n");
+	return 1;
+}
+
+static int golden(void)
+{
+	uint16_t x[N_GOLDEN];
+	filt_biquad_q31_t q31;
+	filt_biquad_q15_t q15;
+	filt_ma_t ma;
+	filt_median_t med;
+	int failed = 0;
+
+	golden_input(x);
+	filt_biquad_q31_init(&q31, coef_slow, 2);
+	filt_biquad_q31_block(&q31, x, N_GOLDEN, 1);
+	failed |= compare("q31", x, golden_q31);
+
+	golden_input(x);
+	filt_biquad_q15_init(&q15, coef_fast, 1);
+	filt_biquad_q15_block(&q15, x, N_GOLDEN, 1);
+	failed |= compare("q15", x, golden_q15);
+
+	golden_input(x);
+	filt_ma_init(&ma, 8);
+	filt_ma_block(&ma, x, N_GOLDEN, 1);
+	failed |= compare("ma", x, golden_ma);
+
+	golden_input(x);
+	filt_median_init(&med, 5);
+	filt_median_block(&med, x, N_GOLDEN, 1);
+	failed |= compare("median", x, golden_median);
+
+	printf("golden             %s\n", failed ? "FAIL" : "ok");
+	return failed;
+}
+
+//worst difference from the float reference , in 12 bit LSB , stride 2 to go through the block layout
+static double vs_float(float_biquad_t *ref, void (*block)(void *, uint16_t *, uint32_t, uint8_t), void *f)
+{
+	double worst = 0;
+	uint16_t x = 2048;
+
+	memset(ref->x1, 0, sizeof(ref->x1));
+	memset(ref->x2, 0, sizeof(ref->x2));
+	memset(ref->y1, 0, sizeof(ref->y1));
+	memset(ref->y2, 0, sizeof(ref->y2));
+	for (uint32_t i = 0; i < N_IN; i++)
+	{
+		//random walk with occasional jumps , stays inside 12 bits
+		x = (rand32() >> 24) < 4 ? (int) (rand32() % 4096) : x + (int) (rand32() % 65) - 32;
+		x = x > 4095 ? 4095 : x;
+		in[i] = x;
+	}
+	for (uint32_t i = 0; i < N_IN / 2; i++)
+	{
+		buf[2 * i] = in[i];
+		buf[2 * i + 1] = 0xFFFF;
+	}
+	block(f, buf, N_IN / 2, 2);
+	for (uint32_t i = 0; i < N_IN / 2; i++)
+	{
+		double want = float_step(ref, in[i]), e;
+
+		want = want < 0 ? 0 : want > 4095 ? 4095 : want;
+		e = fabs(buf[2 * i] - want);
+		if (e > worst)
+			worst = e;
+		if (buf[2 * i + 1] != 0xFFFF)
+			return 1e9;		//wrote outside its stride
+	}
+	return worst;
+}
+
+static int against_float(void)
+{
+	filt_biquad_q31_t q31;
+	filt_biquad_q15_t q15;
+	double e31, e15;
+	int failed;
+
+	filt_biquad_q31_init(&q31, coef_slow, 2);
+	e31 = vs_float(&ref_slow, filt_biquad_q31_block, &q31);
+	filt_biquad_q15_init(&q15, coef_fast, 1);
+	e15 = vs_float(&ref_fast, filt_biquad_q15_block, &q15);
+	//the Q15 sections carry only 2 fraction bits below the ADC LSB , the Q31 ones 16
+	failed = e31 > 1.0 || e15 > 2.0;
+	printf("float              %s  q31 worst %.2f LSB , q15 worst %.2f LSB\n", failed ? "FAIL" : "ok", e31, e15);
+	return failed;
+}
+
+static int exact(void)
+{
+	static const uint8_t ma_lens[] = { 1, 4, 16, 64 };
+	static const uint8_t med_lens[] = { 3, 5, 9 };
+	uint32_t bad = 0;
+
+	for (uint32_t i = 0; i < N_IN; i++)
+		in[i] = (rand32() >> 24) < 8 ? 4095 : rand32() % 4096;
+	for (unsigned l = 0; l < sizeof(ma_lens); l++)
+	{
+		filt_ma_t ma;
+
+		filt_ma_init(&ma, ma_lens[l]);
+		for (uint32_t i = 0; i < N_IN; i++)
+		{
+			uint32_t len = i + 1 < ma_lens[l] ? i + 1 : ma_lens[l], sum = 0;
+
+			for (uint32_t k = 0; k < len; k++)
+				sum += in[i - k];
+			bad += filt_ma_step(&ma, in[i]) != (sum + len / 2) / len;
+		}
+	}
+	for (unsigned l = 0; l < sizeof(med_lens); l++)
+	{
+		filt_median_t med;
+
+		filt_median_init(&med, med_lens[l]);
+		for (uint32_t i = 0; i < N_IN; i++)
+		{
+			uint16_t w[FILT_MEDIAN_MAX];
+			uint32_t len = i + 1 < med_lens[l] ? i + 1 : med_lens[l];
+
+			//selection sort of a copy of the window
+			for (uint32_t k = 0; k < len; k++)
+				w[k] = in[i - k];
+			for (uint32_t a = 0; a < len; a++)
+				for (uint32_t b = a + 1; b < len; b++)
+					if (w[b] < w[a])
+					{
+						uint16_t t = w[a];
+
+						w[a] = w[b];
+						w[b] = t;
+					}
+			bad += filt_median_step(&med, in[i]) != w[(len - 1) / 2];
+		}
+	}
+	printf("exact              %s  moving average and median , %u mismatches\n", bad ? "FAIL" : "ok", bad);
+	return bad != 0;
+}
+
+static double cycles(void (*block)(void *, uint16_t *, uint32_t, uint8_t), void *f)
+{
+	uint64_t best = ~0ULL;
+
+	for (int rep = 0; rep < 5; rep++)
+	{
+		uint64_t t;
+
+		memcpy(buf, in, sizeof(buf));
+		t = __rdtsc();
+		//DMA sized blocks of 16 scans , 2 channels
+		for (uint32_t pos = 0; pos < N_IN; pos += 32)
+			block(f, buf + pos, 16, 2);
+		t = __rdtsc() - t;
+		if (t < best)
+			best = t;
+	}
+	return (double) best / (N_IN / 2);
+}
+
+static void float_block(void *f, uint16_t *samples, uint32_t n, uint8_t stride)
+{
+	for (; n; n--, samples += stride)
+	{
+		float y = float_step(f, *samples);
+
+		*samples = y < 0 ? 0 : y > 4095 ? 4095 : y + 0.5f;
+	}
+}
+
+static void speed(void)
+{
+	filt_biquad_q31_t q31;
+	filt_biquad_q15_t q15;
+	filt_ma_t ma;
+	filt_median_t med;
+
+	filt_biquad_q31_init(&q31, coef_slow, 2);
+	filt_biquad_q15_init(&q15, coef_fast, 1);
+	filt_ma_init(&ma, 16);
+	filt_median_init(&med, 5);
+	printf("speed              q31 biquad x2   %.2f cycles per sample\n", cycles(filt_biquad_q31_block, &q31));
+	printf("speed              float biquad x2 %.2f cycles per sample\n", cycles(float_block, &ref_slow));
+	printf("speed              q15 biquad x1   %.2f cycles per sample\n", cycles(filt_biquad_q15_block, &q15));
+	printf("speed              float biquad x1 %.2f cycles per sample\n", cycles(float_block, &ref_fast));
+	printf("speed              average of 16   %.2f cycles per sample\n", cycles(filt_ma_block, &ma));
+	printf("speed              median of 5     %.2f cycles per sample\n", cycles(filt_median_block, &med));
+}
+
+int main(void)
+{
+	int failed;
+
+	failed = design();
+	failed |= golden();
+	failed |= against_float();
+	failed |= exact();
+	speed();
+	printf("%s\n", failed ? "FAIL" : "PASS");
+	return failed;
+}
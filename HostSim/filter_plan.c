@@ -0,0 +1,207 @@
+//checks the filter banks MyDrivers/mycanfilter.c plans , through the bxCAN filter model of HostSim/cansim.c
+//
+//gcc -O2 -I HostSim -I MyDrivers HostSim/mmio.c HostSim/device.c HostSim/cansim.c HostSim/filter_plan.c MyDrivers/mycanfilter.c -lpthread -o filter_plan
+//
+//every plan is written to CAN1 with can_filter_apply() , then each of the 2048 standard ids and the extended ids
+//EXT_EDGE either side of every extended range edge plus EXT_RANDOM random ones go through the model's filter banks ,
+//an id must be accepted exactly when one of the ranges holds it and can_filter_match() must name the FIFO the model
+//picked , hand made banks that overlap check the priority rules (32 bit before 16 bit , list before mask)
+//lists that cannot fit into CAN_FILTER_BANKS without passing extra ids must be refused
+//exit status is 0 when every case passes
+
+#include <stdio.h>
+#include "stm32f1xx.h"
+#include "mmio.h"
+#include "cansim.h"
+#include "mycanfilter.h"
+
+#define EXT_EDGE 512
+#define EXT_RANDOM 20000
+#define MAX_RANGES 128
+
+typedef struct
+{
+	const char *name;
+	int n;
+	can_filter_range_t r[MAX_RANGES];
+} filter_case_t;
+
+static filter_case_t cases[] = {
+	{ "one id", 1, { { 0x123, 0x123, 0 } } },
+	{ "id list", 5, { { 0x100, 0x100, 0 }, { 0x101, 0x101, 0 }, { 0x200, 0x200, 0 }, { 0x7FF, 0x7FF, 0 }, { 0x000, 0x000, 0 } } },
+	{ "aligned range", 1, { { 0x100, 0x1FF, 0 } } },
+	{ "unaligned range", 1, { { 0x123, 0x456, 0 } } },
+	{ "ids and ranges", 5, { { 0x080, 0x080, 0 }, { 0x700, 0x70F, 0 }, { 0x6A0, 0x6B7, 0 }, { 0x7DF, 0x7DF, 0 }, { 0x7E8, 0x7EF, 0 } } },
+	{ "overlapping", 2, { { 0x300, 0x3FF, 0 }, { 0x350, 0x420, 0 } } },
+	{ "everything", 1, { { 0x000, 0x7FF, 0 } } },
+	{ "ISO-TP pairs", 2, { { 0x700, 0x700, 0 }, { 0x708, 0x708, 0 } } },
+	{ "extended too", 3, { { 0x18DAF100, 0x18DAF1FF, 1 }, { 0x7E0, 0x7E0, 0 }, { 0x1FFFFFFF, 0x1FFFFFFF, 1 } } },
+	{ "extended odd range", 2, { { 0x00012345, 0x00012400, 1 }, { 0x010, 0x01F, 0 } } },
+};
+
+static int in_ranges(const filter_case_t *c, uint32_t id, uint8_t ide)
+{
+	for (int i = 0; i < c->n; i++)
+		if (c->r[i].ide == ide && id >= c->r[i].first && id <= c->r[i].last)
+			return 1;
+	return 0;
+}
+
+static uint32_t rng = 12345;
+
+//FIFO the model puts a data frame in
+static int model_fifo(uint32_t id, uint8_t ide)
+{
+	cansim_frame_t f = { .id = id, .ide = ide, .dlc = 8 };
+
+	return cansim_filter_fifo(&f);
+}
+
+//returns the number of ids that went the wrong way
+static uint32_t check_id(const filter_case_t *c, const can_filter_bank_t *banks, int nbanks, uint32_t id, uint8_t ide,
+		uint32_t *accepted)
+{
+	int fifo = model_fifo(id, ide);
+	int match = can_filter_match(banks, nbanks, id, ide);
+	int want = in_ranges(c, id, ide);
+
+	*accepted += fifo >= 0;
+	if ((fifo >= 0) != want || match != fifo)
+	{
+		printf("  %s id 0x%X %s , FIFO %d , can_filter_match() %d\n", ide ? "extended" : "standard", id,
+				(fifo >= 0) == want ? "right" : want ? "rejected" : "passed", fifo, match);
+		return 1;
+	}
+	return 0;
+}
+
+static int run(const filter_case_t *c)
+{
+	can_filter_bank_t banks[CAN_FILTER_BANKS];
+	int nbanks = can_filter_plan(c->r, c->n, banks);
+	uint32_t wrong = 0, accepted = 0, ext_checked = 0, ext_accepted = 0;
+	int ok;
+
+	if (nbanks <= 0 || nbanks > CAN_FILTER_BANKS)
+	{
+		printf("%-20s plan failed (%d) FAIL\n", c->name, nbanks);
+		return 0;
+	}
+	can_filter_apply(banks, nbanks);
+	for (uint32_t id = 0; id < 0x800; id++)
+		wrong += check_id(c, banks, nbanks, id, 0, &accepted);
+
+	//extended ids: both edges of every range and a good way either side , then anywhere
+	for (int i = 0; i < c->n; i++)
+	{
+		uint32_t edge[2] = { c->r[i].first, c->r[i].last };
+
+		if (!c->r[i].ide)
+			continue;
+		for (int e = 0; e < 2; e++)
+			for (int32_t d = -EXT_EDGE; d <= EXT_EDGE; d++)
+			{
+				uint32_t id = edge[e] + d;
+
+				if (id > 0x1FFFFFFF)
+					continue;
+				wrong += check_id(c, banks, nbanks, id, 1, &ext_accepted);
+				ext_checked++;
+			}
+	}
+	for (int i = 0; i < EXT_RANDOM; i++, ext_checked++)
+	{
+		rng = rng * 1664525 + 1013904223;
+		wrong += check_id(c, banks, nbanks, rng >> 3, 1, &ext_accepted);
+	}
+
+	ok = !wrong;
+	printf("%-20s %2d banks , %4u of 2048 standard , %5u of %5u extended ids accepted , %u wrong %s\n", c->name,
+			nbanks, accepted, ext_accepted, ext_checked, wrong, ok ? "ok" : "FAIL");
+	return ok;
+}
+
+//banks that overlap with different FIFOs , can_filter_match() has to pick the one the hardware picks
+static int run_priority(void)
+{
+	//16 bit mask 0x100..0x1FF to FIFO 0 under a 32 bit list of 0x150 and 0x1A0 to FIFO 1
+	//16 bit mask 0x700..0x7FF to FIFO 1 under a 16 bit list of 0x7DF and 0x7E8 to FIFO 0
+	//32 bit mask 0x400..0x47F to FIFO 0 under a 32 bit list of 0x440 to FIFO 1
+	static const can_filter_bank_t banks[] = {
+		{ .list = 0, .scale32 = 0, .fifo = 0, .fr1 = ((0x700 << 5 | 0x18) << 16) | 0x100 << 5,
+				.fr2 = ((0x700 << 5 | 0x18) << 16) | 0x100 << 5 },
+		{ .list = 1, .scale32 = 1, .fifo = 1, .fr1 = 0x150 << 21, .fr2 = 0x1A0 << 21 },
+		{ .list = 0, .scale32 = 0, .fifo = 1, .fr1 = ((0x700 << 5 | 0x18) << 16) | 0x700 << 5,
+				.fr2 = ((0x700 << 5 | 0x18) << 16) | 0x700 << 5 },
+		{ .list = 1, .scale32 = 0, .fifo = 0, .fr1 = (0x7E8 << 5) << 16 | 0x7DF << 5,
+				.fr2 = (0x7E8 << 5) << 16 | 0x7E8 << 5 },
+		{ .list = 0, .scale32 = 1, .fifo = 0, .fr1 = 0x400 << 21, .fr2 = 0x780u << 21 | CAN_RI0R_IDE | CAN_RI0R_RTR },
+		{ .list = 1, .scale32 = 1, .fifo = 1, .fr1 = 0x440 << 21, .fr2 = 0x440 << 21 },
+	};
+	static const struct { uint32_t id; int fifo; } want[] = {
+		{ 0x100, 0 }, { 0x150, 1 }, { 0x1A0, 1 }, { 0x1FF, 0 }, { 0x700, 1 }, { 0x7DF, 0 }, { 0x7E8, 0 },
+		{ 0x7FF, 1 }, { 0x400, 0 }, { 0x440, 1 }, { 0x47F, 0 }, { 0x480, -1 },
+	};
+	int n = sizeof(banks) / sizeof(banks[0]);
+	uint32_t wrong = 0;
+
+	can_filter_apply(banks, n);
+	for (uint32_t id = 0; id < 0x800; id++)
+	{
+		int fifo = model_fifo(id, 0);
+		int match = can_filter_match(banks, n, id, 0);
+
+		if (match != fifo)
+		{
+			printf("  standard id 0x%X FIFO %d , can_filter_match() %d\n", id, fifo, match);
+			wrong++;
+		}
+	}
+	for (unsigned i = 0; i < sizeof(want) / sizeof(want[0]); i++)
+	{
+		if (model_fifo(want[i].id, 0) != want[i].fifo)
+		{
+			printf("  standard id 0x%X FIFO %d , want %d\n", want[i].id, model_fifo(want[i].id, 0), want[i].fifo);
+			wrong++;
+		}
+	}
+	printf("%-20s %2d banks , %u wrong %s\n", "overlapping banks", n, wrong, wrong ? "FAIL" : "ok");
+	return !wrong;
+}
+
+//more single ids than the list banks can hold , a plan would have to pass ids nobody asked for
+static int run_too_many(void)
+{
+	static filter_case_t c = { "too many ids", 0, { { 0 } } };
+	can_filter_bank_t banks[CAN_FILTER_BANKS];
+	int nbanks;
+
+	for (int i = 0; i < 4 * CAN_FILTER_BANKS + 1; i++, c.n++)
+		c.r[i].first = c.r[i].last = i * 35;
+	nbanks = can_filter_plan(c.r, c.n, banks);
+	printf("%-20s %d single ids -> %d %s\n", c.name, c.n, nbanks, nbanks == -1 ? "ok" : "FAIL");
+	return nbanks == -1;
+}
+
+//as many as fit , spread over the whole id space
+static int run_full_list(void)
+{
+	static filter_case_t c = { "full id list", 0, { { 0 } } };
+
+	for (int i = 0; i < 4 * CAN_FILTER_BANKS; i++, c.n++)
+		c.r[i].first = c.r[i].last = i * 37;
+	return run(&c);
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+		failed += !run(&cases[i]);
+	failed += !run_full_list();
+	failed += !run_too_many();
+	failed += !run_priority();
+	printf(failed ? "FAILED\n" : "all passed\n");
+	return failed;
+}
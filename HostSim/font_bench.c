@@ -0,0 +1,347 @@
+//SSD1306_Putc() ("SSD1306 OLED DRIVER/ssd1306.c") with the page layout fonts against the pixel at a time renderer
+//
+//  gcc -O2 -DFONTS_ROW_TABLES -I HostSim -I MyDrivers -I "SSD1306 OLED DRIVER" HostSim/oledsim.c HostSim/font_bench.c
+//      HostSim/font_compiled.c "SSD1306 OLED DRIVER/ssd1306.c" "SSD1306 OLED DRIVER/fonts.c" -o font_bench
+//  ./font_bench                     exit status 0 when every check passes
+//
+//no simulator here , i2c_tx_write() below hands each transaction straight to the oledsim.c panel (thousands of frames
+//would take minutes at the bus rate)
+//
+//golden: every glyph of the three fonts at every row offset in a page (and in black , and with the display inverted)
+//        goes to the panel from the row tables through the pixel renderer (the font with pages NULL) , the frames hash to
+//        known values , the byte renderer must then give the same panel RAM , change no byte drawn over the same text
+//        and mark every byte it changes (the panel is cleared first and only the marked columns are sent)
+//fontc:  the fonts in font_compiled.c (a subset run length coded , a width per glyph , a subset as it is) against the
+//        font they came from: every glyph they have looks the same at every row offset (the proportional one once its
+//        blank columns are cut off , with the width that leaves) , the others are refused and draw nothing
+//speed: characters a second on the host for both renderers and a run length coded font , as a relative figure
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "oledsim.h"
+#include "periph.h"
+#include "ssd1306.h"
+
+#define BENCH_CHARS 200000
+
+typedef struct
+{
+	FontDef_t *font;
+	const char *name;
+	uint32_t golden;		//FNV-1a of the pixel renderer's frames
+	double min_speedup;
+} font_case_t;
+
+static font_case_t fonts[] =
+{
+	{ &Font_7x10, "Font_7x10", 0xeb1b32f4, 3 },
+	{ &Font_11x18, "Font_11x18", 0x5f37716e, 5 },
+	{ &Font_16x26, "Font_16x26", 0xfdd735b6, 6 },
+};
+
+typedef struct
+{
+	FontDef_t *font;
+	const char *name;
+	FontDef_t *from;
+	const char *chars;		//what fontc was given , NULL for all
+	int proportional;
+} compiled_case_t;
+
+extern FontDef_t Font_11x18_Clock, Font_7x10_Prop, Font_16x26_Caps;
+
+static compiled_case_t compiled[] =
+{
+	{ &Font_11x18_Clock, "Font_11x18_Clock", &Font_11x18, " 0123456789:", 0 },
+	{ &Font_7x10_Prop, "Font_7x10_Prop", &Font_7x10, 0, 1 },
+	{ &Font_16x26_Caps, "Font_16x26_Caps", &Font_16x26, "ABCDEFGHIJKLMNOPQRSTUVWXYZ", 0 },
+};
+
+static int failed;
+
+//the bus , one device and every transaction done at once
+
+static periph_i2c_fn panel;
+static void *panel_ctx;
+
+void hw_lock(void)
+{
+}
+
+void hw_unlock(void)
+{
+}
+
+void periph_i2c_device(I2C_TypeDef *i2c, uint8_t addr7, periph_i2c_fn fn, void *ctx)
+{
+	(void) i2c;
+	(void) addr7;
+	panel = fn;
+	panel_ctx = ctx;
+}
+
+void i2c_tx_init(void)
+{
+}
+
+int i2c_tx_write(uint8_t addr, uint8_t prefix, const void *data, uint16_t len, i2c_done_fn done, void *ctx)
+{
+	panel(PERIPH_I2C_START, addr, 0, panel_ctx);
+	panel(PERIPH_I2C_BYTE, prefix, 0, panel_ctx);
+	for (uint16_t i = 0; i < len; i++)
+		panel(PERIPH_I2C_BYTE, ((const uint8_t *) data)[i], 0, panel_ctx);
+	panel(PERIPH_I2C_STOP, 0, 0, panel_ctx);
+	if (done)
+		done(0, ctx);
+	return 1;
+}
+
+void i2c_tx_flush(void)
+{
+}
+
+static void frame(uint8_t ram[8][128])
+{
+	SSD1306_UpdateScreen();
+	oledsim_ram(ram);
+}
+
+static uint32_t fnv(uint32_t h, const uint8_t *p, uint32_t n)
+{
+	while (n--)
+		h = (h ^ *p++) * 16777619;
+	return h;
+}
+
+//a screen of glyphs from first on , a row of cells every FontHeight from y , returns the glyph after the last
+static uint32_t scene(FontDef_t *f, uint16_t y, uint32_t first, SSD1306_COLOR_t color)
+{
+	uint32_t c = first;
+
+	for (; y + f->FontHeight < SSD1306_HEIGHT; y += f->FontHeight)
+	{
+		SSD1306_GotoXY(0, y);
+		while (c < first + 95 && SSD1306_Putc(32 + c % 95, f, color))
+			c++;
+	}
+	return c % 95;
+}
+
+//every glyph at row offset y in as many screens as it takes
+static int golden_pass(font_case_t *fc, uint16_t y, SSD1306_COLOR_t color, uint32_t *hash)
+{
+	static uint8_t want[8][128], got[8][128];
+	FontDef_t rows = *fc->font;
+	oledsim_stats_t st;
+	uint32_t c = 0, next;
+	int ok = 1;
+
+	rows.pages = 0;
+	do
+	{
+		SSD1306_Fill(SSD1306_COLOR_BLACK);
+		next = scene(&rows, y, c, color);
+		frame(want);
+		*hash = fnv(*hash, &want[0][0], sizeof(want));
+
+		//the same text over itself changes nothing
+		oledsim_clear_stats();
+		scene(fc->font, y, c, color);
+		frame(got);
+		oledsim_stats(&st);
+		ok &= st.data_bytes == 0;
+
+		//onto a blank panel , only what was marked gets there
+		SSD1306_Fill(SSD1306_COLOR_BLACK);
+		frame(got);
+		scene(fc->font, y, c, color);
+		frame(got);
+		ok &= !memcmp(want, got, sizeof(want));
+		c = next;
+	} while (c);
+	return ok;
+}
+
+static void golden(font_case_t *fc)
+{
+	uint32_t hash = 2166136261u;
+	int ok = 1;
+
+	for (uint16_t y = 0; y < 8; y++)
+		ok &= golden_pass(fc, y, SSD1306_COLOR_WHITE, &hash);
+	ok &= golden_pass(fc, 13, SSD1306_COLOR_BLACK, &hash);
+	SSD1306_ToggleInvert();
+	ok &= golden_pass(fc, 2, SSD1306_COLOR_WHITE, &hash);
+	SSD1306_ToggleInvert();
+
+	printf("%-11s golden %08x (want %08x) , byte renderer %s\n", fc->name, hash, fc->golden,
+		ok && hash == fc->golden ? "ok" : "FAIL");
+	failed |= !ok || hash != fc->golden;
+}
+
+//columns of the panel with ink , rows y .. y + h - 1 , leading and trailing blank ones cut off , returns how many
+static uint32_t inked(uint8_t ram[8][128], uint16_t y, uint8_t h, uint64_t *col)
+{
+	uint32_t n = 0, first = 128, last = 0;
+
+	for (uint32_t x = 0; x < 128; x++)
+	{
+		uint64_t c = 0;
+
+		for (uint32_t p = 0; p < 8; p++)
+			c |= (uint64_t) ram[p][x] << (8 * p);
+		c = (c >> y) & ((1ULL << h) - 1);
+		col[x] = c;
+		if (c)
+		{
+			first = first == 128 ? x : first;
+			last = x;
+		}
+	}
+	if (first == 128)
+		return 0;
+	for (uint32_t x = first; x <= last; x++)
+		col[n++] = col[x];
+	return n;
+}
+
+static void check_compiled(compiled_case_t *cc)
+{
+	static uint8_t want[8][128], got[8][128];
+	static uint64_t want_col[128], got_col[128];
+	uint32_t glyphs = 0, bad = 0;
+	oledsim_stats_t st;
+
+	for (uint32_t c = 32; c < 127; c++)
+	{
+		int in = !cc->chars || strchr(cc->chars, c);
+		uint8_t w = 0;
+
+		glyphs += in;
+		if (!!FONTS_GetGlyph(cc->font, c, &w) != in)
+		{
+			printf("  0x%02X %s\n", c, in ? "missing" : "not asked for");
+			bad++;
+			continue;
+		}
+		for (uint16_t y = 0; y < 8; y++)
+		{
+			SSD1306_Fill(SSD1306_COLOR_BLACK);
+			frame(want);
+			SSD1306_GotoXY(3, y);
+			SSD1306_Putc(c, cc->from, SSD1306_COLOR_WHITE);
+			frame(want);
+
+			SSD1306_Fill(SSD1306_COLOR_BLACK);
+			frame(got);
+			oledsim_clear_stats();
+			SSD1306_GotoXY(3, y);
+			if (SSD1306_Putc(c, cc->font, SSD1306_COLOR_WHITE) != (in ? (char) c : 0))
+				bad++;
+			frame(got);
+			oledsim_stats(&st);
+			if (!in)
+			{
+				bad += st.data_bytes != 0;
+				continue;
+			}
+			if (!cc->proportional)
+			{
+				bad += memcmp(want, got, sizeof(want)) != 0;
+				continue;
+			}
+
+			//the same ink , and a blank column after it (half a cell when there is none)
+			uint32_t n = inked(want, y, cc->from->FontHeight, want_col);
+
+			bad += n != inked(got, y, cc->font->FontHeight, got_col) || memcmp(want_col, got_col, n * sizeof(uint64_t))
+				|| w != (n ? n + 1 : (uint32_t) (cc->from->FontWidth + 1) / 2);
+		}
+	}
+
+	//the string width adds the glyph widths up , characters the font does not have take none
+	{
+		FONTS_SIZE_t size;
+		uint32_t sum = 0;
+		uint8_t w;
+
+		FONTS_GetStringSize("09:AZ j", &size, cc->font);
+		for (const char *p = "09:AZ j"; *p; p++)
+			sum += FONTS_GetGlyph(cc->font, *p, &w) ? w : 0;
+		bad += size.Length != sum || size.Height != cc->font->FontHeight;
+	}
+
+	printf("%-16s %2u glyphs%s , every row offset %s\n", cc->name, glyphs, cc->proportional ? " (own widths)" : "",
+		bad ? "FAIL" : "ok");
+	failed |= bad != 0;
+}
+
+static double now_s(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+//characters a second , text runs over the screen and the colour flips every screen so bytes keep changing
+static double speed(FontDef_t *f)
+{
+	uint32_t per_row = (SSD1306_WIDTH - 1) / f->FontWidth, rows = (SSD1306_HEIGHT - 1) / f->FontHeight;
+	double t = now_s();
+
+	for (uint32_t i = 0; i < BENCH_CHARS; i++)
+	{
+		uint32_t cell = i % (per_row * rows);
+
+		if (cell % per_row == 0)
+			SSD1306_GotoXY(0, cell / per_row * f->FontHeight);
+		SSD1306_Putc(32 + i % 95, f, (i / (per_row * rows)) & 1 ? SSD1306_COLOR_BLACK : SSD1306_COLOR_WHITE);
+	}
+	return BENCH_CHARS / (now_s() - t);
+}
+
+static void bench(font_case_t *fc)
+{
+	FontDef_t rows = *fc->font;
+	double pixel, byte;
+
+	rows.pages = 0;
+	pixel = speed(&rows);
+	byte = speed(fc->font);
+	printf("%-11s pixel %9.0f chars/s , byte %9.0f chars/s , %5.1fx (at least %.0fx) %s\n", fc->name, pixel, byte,
+		byte / pixel, fc->min_speedup, byte >= fc->min_speedup * pixel ? "ok" : "FAIL");
+	failed |= byte < fc->min_speedup * pixel;
+}
+
+//run length coded against the pixel renderer of the font it came from
+static void bench_coded(FontDef_t *coded, FontDef_t *from, const char *name, double min_speedup)
+{
+	FontDef_t rows = *from;
+	double pixel, byte;
+
+	rows.pages = 0;
+	pixel = speed(&rows);
+	byte = speed(coded);
+	printf("%-16s pixel %9.0f chars/s , coded %9.0f chars/s , %5.1fx (at least %.0fx) %s\n", name, pixel, byte,
+		byte / pixel, min_speedup, byte >= min_speedup * pixel ? "ok" : "FAIL");
+	failed |= byte < min_speedup * pixel;
+}
+
+int main(void)
+{
+	oledsim_attach(0, SSD1306_I2C_ADDR >> 1);
+	SSD1306_Init();
+
+	for (uint32_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++)
+		golden(&fonts[i]);
+	for (uint32_t i = 0; i < sizeof(compiled) / sizeof(compiled[0]); i++)
+		check_compiled(&compiled[i]);
+	for (uint32_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++)
+		bench(&fonts[i]);
+	bench_coded(&Font_7x10_Prop, &Font_7x10, "Font_7x10_Prop", 2);
+
+	printf(failed ? "FAILED\n" : "all passed\n");
+	return failed;
+}
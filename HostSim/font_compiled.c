@@ -0,0 +1,236 @@
+/* Compiled fonts HostSim/font_bench.c checks, made with
+     ./fontc -c " 0123456789:" -r Font_11x18 Font_11x18_Clock
+     ./fontc -p -r Font_7x10 Font_7x10_Prop
+     ./fontc -c ABCDEFGHIJKLMNOPQRSTUVWXYZ Font_16x26 Font_16x26_Caps */
+
+/* Font_11x18_Clock , 11 x 18 , from Font_11x18 by HostSim/fontc.c , a subset , run length coded , do not edit */
+#include "fonts.h"
+
+static const uint8_t Font_11x18_Clock_Bitmap[] = {
+0xE0, // sp
+0xC0,0x07,0xF0,0xFC,0x0E,0x86,0x86,0x0E,0xFC,0xF0,0xC2,0x07,0x0F,0x3F,0x70,0x61,0x61,0x70,0x3F,0x0F,0xCC, // 0
+0xC1,0x04,0x30,0x18,0x0C,0xFE,0xFE,0xC8,0x01,0x7F,0x7F,0xCE, // 1
+0xC0,0x07,0x38,0x3C,0x0E,0x06,0x06,0x8E,0xFC,0x78,0xC2,0x07,0x70,0x78,0x6C,0x66,0x63,0x61,0x60,0x60,0xCC, // 2
+0xC0,0x06,0x18,0x1C,0x06,0xC6,0xC6,0xFC,0x38,0xC3,0x07,0x18,0x38,0x70,0x60,0x60,0x71,0x3F,0x1E,0xCC, // 3
+0xC1,0x04,0x80,0xF0,0x3C,0xFE,0xFE,0xC4,0x07,0x0E,0x0F,0x0D,0x0C,0x7F,0x7F,0x0C,0x0C,0xCC, // 4
+0xC0,0x02,0xFE,0xFE,0x86,0x81,0xC6,0x00,0x86,0xC3,0x07,0x19,0x39,0x70,0x60,0x60,0x71,0x3F,0x1F,0xCC, // 5
+0xC0,0x07,0xF0,0xFC,0x8E,0xC6,0xC6,0xCE,0x9C,0x18,0xC2,0x07,0x0F,0x3F,0x71,0x60,0x60,0x71,0x3F,0x1F,0xCC, // 6
+0xC0,0x82,0x06,0x03,0xC6,0xF6,0x3E,0x0E,0xC4,0x02,0x70,0x7F,0x07,0xCF, // 7
+0xC0,0x01,0x38,0x7C,0x81,0x86,0x02,0x8E,0x7C,0x38,0xC2,0x01,0x1E,0x3F,0x82,0x61,0x01,0x3F,0x1E,0xCC, // 8
+0xC0,0x07,0xF8,0xFC,0x8E,0x06,0x06,0x8E,0xFC,0xF0,0xC2,0x07,0x18,0x39,0x73,0x63,0x63,0x71,0x3F,0x0F,0xCC, // 9
+0xC3,0x01,0x60,0x60,0xC8,0x01,0x60,0x60,0xCF, // :
+};
+
+static const uint16_t Font_11x18_Clock_Offset[] = {
+	0, 1, 22, 34, 55, 75, 93, 113, 134, 148, 168, 189, 198,
+};
+
+static const uint8_t Font_11x18_Clock_Index[] = {
+	1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+};
+
+static const FontGlyphs_t Font_11x18_Clock_Glyphs = {
+	32,
+	58,
+	1,
+	Font_11x18_Clock_Index,
+	Font_11x18_Clock_Offset,
+	NULL,
+	Font_11x18_Clock_Bitmap
+};
+
+FontDef_t Font_11x18_Clock = {
+	11,
+	18,
+	NULL,
+	NULL,
+	&Font_11x18_Clock_Glyphs
+};
+
+/* Font_7x10_Prop , 7 x 10 , from Font_7x10 by HostSim/fontc.c , a width per glyph , run length coded , do not edit */
+#include "fonts.h"
+
+static const uint8_t Font_7x10_Prop_Bitmap[] = {
+0xC7, // sp
+0x00,0xBF,0xC2, // !
+0x00,0x07,0xC0,0x00,0x07,0xC4, // "
+0x04,0xF4,0x2F,0x24,0xF4,0x2F,0xC6, // #
+0x04,0x66,0x89,0xFF,0x89,0x72,0xC2,0x00,0x01,0xC2, // $
+0x04,0x26,0x19,0x6E,0x94,0x62,0xC6, // %
+0x04,0x60,0x96,0x99,0x66,0x90,0xC6, // &
+0x00,0x07,0xC2, // '
+0x02,0xFC,0x02,0x01,0xC1,0x01,0x01,0x02,0xC0, // (
+0x02,0x01,0x02,0xFC,0xC0,0x01,0x02,0x01,0xC1, // )
+0x02,0x0A,0x07,0x0A,0xC4, // *
+0x04,0x10,0x10,0x7C,0x10,0x10,0xC6, // +
+0x00,0x80,0xC0,0x00,0x03,0xC0, // ,
+0x81,0x20,0xC4, // -
+0x00,0x80,0xC2, // .
+0x02,0xC0,0x3C,0x03,0xC4, // /
+0x04,0x7E,0x81,0x89,0x81,0x7E,0xC6, // 0
+0x02,0x04,0x02,0xFF,0xC4, // 1
+0x04,0x86,0xC1,0xA1,0x91,0x8E,0xC6, // 2
+0x04,0x42,0x81,0x89,0x89,0x76,0xC6, // 3
+0x04,0x30,0x2C,0x22,0xFF,0x20,0xC6, // 4
+0x00,0x4F,0x81,0x89,0x00,0x71,0xC6, // 5
+0x00,0x7E,0x81,0x89,0x00,0x72,0xC6, // 6
+0x04,0x01,0xE1,0x19,0x05,0x03,0xC6, // 7
+0x00,0x76,0x81,0x89,0x00,0x76,0xC6, // 8
+0x00,0x4E,0x81,0x91,0x00,0x7E,0xC6, // 9
+0x00,0x84,0xC2, // :
+0x00,0x88,0xC0,0x00,0x03,0xC0, // ;
+0x04,0x10,0x28,0x28,0x44,0x44,0xC6, // <
+0x83,0x28,0xC6, // =
+0x04,0x44,0x44,0x28,0x28,0x10,0xC6, // >
+0x04,0x02,0x01,0xB1,0x09,0x06,0xC6, // ?
+0x04,0x7E,0x81,0x99,0x95,0x1E,0xC6, // @
+0x04,0xE0,0x3E,0x21,0x3E,0xE0,0xC6, // A
+0x00,0xFF,0x81,0x89,0x00,0x76,0xC6, // B
+0x00,0x7E,0x81,0x81,0x00,0x42,0xC6, // C
+0x04,0xFF,0x81,0x81,0x42,0x3C,0xC6, // D
+0x00,0xFF,0x82,0x89,0xC6, // E
+0x00,0xFF,0x81,0x09,0x00,0x01,0xC6, // F
+0x04,0x7E,0x81,0x91,0x91,0x72,0xC6, // G
+0x00,0xFF,0x81,0x08,0x00,0xFF,0xC6, // H
+0x02,0x81,0xFF,0x81,0xC4, // I
+0x00,0x40,0x81,0x80,0x00,0x7F,0xC6, // J
+0x04,0xFF,0x08,0x14,0x62,0x81,0xC6, // K
+0x00,0xFF,0x82,0x80,0xC6, // L
+0x04,0xFF,0x06,0x08,0x06,0xFF,0xC6, // M
+0x04,0xFF,0x06,0x18,0x60,0xFF,0xC6, // N
+0x00,0x7E,0x81,0x81,0x00,0x7E,0xC6, // O
+0x00,0xFF,0x81,0x11,0x00,0x0E,0xC6, // P
+0x04,0x7E,0x81,0xC1,0x81,0x7E,0xC4,0x00,0x01,0xC0, // Q
+0x04,0xFF,0x11,0x11,0x71,0x8E,0xC6, // R
+0x04,0x46,0x89,0x89,0x91,0x62,0xC6, // S
+0x04,0x01,0x01,0xFF,0x01,0x01,0xC6, // T
+0x00,0x7F,0x81,0x80,0x00,0x7F,0xC6, // U
+0x04,0x07,0x38,0xC0,0x38,0x07,0xC6, // V
+0x04,0x3F,0xE0,0x1C,0xE0,0x3F,0xC6, // W
+0x04,0x81,0x66,0x18,0x66,0x81,0xC6, // X
+0x04,0x03,0x0C,0xF0,0x0C,0x03,0xC6, // Y
+0x04,0xC1,0xA1,0x99,0x85,0x83,0xC6, // Z
+0x01,0xFF,0x01,0xC0,0x01,0x03,0x02,0xC0, // [
+0x02,0x03,0x3C,0xC0,0xC4, /* \ */
+0x01,0x01,0xFF,0xC0,0x01,0x02,0x03,0xC0, // ]
+0x04,0x08,0x06,0x01,0x06,0x08,0xC6, // ^
+0xC7,0x85,0x02,0xC0, // _
+0x01,0x01,0x02,0xC3, // `
+0x04,0x68,0x94,0x94,0x54,0xF8,0xC6, // a
+0x04,0xFF,0x48,0x84,0x84,0x78,0xC6, // b
+0x00,0x78,0x81,0x84,0x00,0x48,0xC6, // c
+0x04,0x78,0x84,0x84,0x48,0xFF,0xC6, // d
+0x00,0x78,0x81,0x94,0x00,0x58,0xC6, // e
+0x04,0x04,0x04,0xFE,0x05,0x05,0xC6, // f
+0x04,0x78,0x84,0x84,0x48,0xFC,0xC0,0x82,0x02,0x00,0x01,0xC0, // g
+0x04,0xFF,0x08,0x04,0x04,0xF8,0xC6, // h
+0x02,0x04,0x04,0xFD,0xC4, // i
+0xC0,0x02,0x04,0x04,0xFD,0xC0,0x81,0x02,0x00,0x01,0xC0, // j
+0x04,0xFF,0x10,0x28,0x44,0x80,0xC6, // k
+0x02,0x01,0x01,0xFF,0xC4, // l
+0x04,0xFC,0x04,0xFC,0x04,0xF8,0xC6, // m
+0x04,0xFC,0x08,0x04,0x04,0xF8,0xC6, // n
+0x00,0x78,0x81,0x84,0x00,0x78,0xC6, // o
+0x04,0xFC,0x48,0x84,0x84,0x78,0xC0,0x00,0x03,0xC4, // p
+0x04,0x78,0x84,0x84,0x48,0xFC,0xC4,0x00,0x03,0xC0, // q
+0x04,0xFC,0x08,0x04,0x04,0x08,0xC6, // r
+0x04,0x48,0x94,0x94,0xA4,0x48,0xC6, // s
+0x03,0x04,0x7F,0x84,0x84,0xC5, // t
+0x04,0x7C,0x80,0x80,0x40,0xFC,0xC6, // u
+0x04,0x0C,0x70,0x80,0x70,0x0C,0xC6, // v
+0x04,0x3C,0xE0,0x1C,0xE0,0x3C,0xC6, // w
+0x04,0x84,0x48,0x30,0x48,0x84,0xC6, // x
+0x04,0x0C,0x30,0xC0,0x30,0x0C,0xC0,0x02,0x02,0x02,0x01,0xC2, // y
+0x04,0xC4,0xA4,0x94,0x8C,0x84,0xC6, // z
+0x02,0x30,0xCF,0x01,0xC1,0x01,0x03,0x02,0xC0, // {
+0x00,0xFF,0xC0,0x00,0x03,0xC0, // |
+0x02,0x01,0xCF,0x30,0xC0,0x01,0x02,0x03,0xC1, // }
+0x04,0x18,0x08,0x08,0x10,0x18,0xC6, // ~
+};
+
+static const uint16_t Font_7x10_Prop_Offset[] = {
+	0, 1, 4, 10, 17, 27, 34, 41, 44, 53, 62, 67, 74, 80, 83, 86,
+	91, 98, 103, 110, 117, 124, 131, 138, 145, 152, 159, 162, 168, 175, 178, 185,
+	192, 199, 206, 213, 220, 227, 232, 239, 246, 253, 258, 265, 272, 277, 284, 291,
+	298, 305, 315, 322, 329, 336, 343, 350, 357, 364, 371, 378, 386, 391, 399, 406,
+	410, 414, 421, 428, 435, 442, 449, 456, 468, 475, 480, 491, 498, 503, 510, 517,
+	524, 534, 544, 551, 558, 564, 571, 578, 585, 592, 604, 611, 620, 626, 635, 642,
+};
+
+static const uint8_t Font_7x10_Prop_Width[] = {
+	4, 2, 4, 6, 6, 6, 6, 2, 4, 4, 4, 6, 2, 4, 2, 4,
+	6, 4, 6, 6, 6, 6, 6, 6, 6, 6, 2, 2, 6, 6, 6, 6,
+	6, 6, 6, 6, 6, 6, 6, 6, 6, 4, 6, 6, 6, 6, 6, 6,
+	6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 3, 4, 3, 6, 8,
+	3, 6, 6, 6, 6, 6, 6, 6, 6, 4, 5, 6, 4, 6, 6, 6,
+	6, 6, 6, 6, 5, 6, 6, 6, 6, 6, 6, 4, 2, 4, 6,
+};
+
+static const FontGlyphs_t Font_7x10_Prop_Glyphs = {
+	32,
+	126,
+	1,
+	NULL,
+	Font_7x10_Prop_Offset,
+	Font_7x10_Prop_Width,
+	Font_7x10_Prop_Bitmap
+};
+
+FontDef_t Font_7x10_Prop = {
+	7,
+	10,
+	NULL,
+	NULL,
+	&Font_7x10_Prop_Glyphs
+};
+
+/* Font_16x26_Caps , 16 x 26 , from Font_16x26 by HostSim/fontc.c , a subset , do not edit */
+#include "fonts.h"
+
+static const uint8_t Font_16x26_Caps_Bitmap[] = {
+0x00,0x00,0x1C,0x00,0x00,0x00,0x1F,0x00,0x00,0xE0,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xFF,0x03,0x00,0xE0,0xFF,0x00,0x00,0xF8,0xDF,0x00,0x00,0xF8,0xC3,0x00,0x00,0xF8,0xC0,0x00,0x00,0xF8,0xC7,0x00,0x00,0xF8,0xFF,0x00,0x00,0xE0,0xFF,0x01,0x00,0x00,0xFF,0x07,0x00,0x00,0xFC,0x1F,0x00,0x00,0xE0,0x1F,0x00,0x00,0x80,0x1F,0x00, // A
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x3C,0x18,0x00,0x38,0x3E,0x18,0x00,0xF8,0xFF,0x1C,0x00,0xF8,0xF7,0x1F,0x00,0xF0,0xE7,0x0F,0x00,0xE0,0xE3,0x0F,0x00,0x00,0xC0,0x07,0x00, // B
+0x00,0x00,0x00,0x00,0x00,0xFF,0x00,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xFF,0x07,0x00,0xE0,0xFF,0x07,0x00,0xF0,0xC1,0x0F,0x00,0x70,0x00,0x0F,0x00,0x38,0x00,0x1E,0x00,0x38,0x00,0x1C,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x38,0x00,0x18,0x00,0x38,0x00,0x1C,0x00,0x38,0x00,0x1C,0x00, // C
+0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x38,0x00,0x1C,0x00,0x38,0x00,0x1C,0x00,0xF8,0x00,0x0F,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0xFF,0x07,0x00,0xE0,0xFF,0x07,0x00,0xC0,0xFF,0x01,0x00, // D
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x00,0x18,0x00, // E
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00, // F
+0x00,0x3C,0x00,0x00,0x80,0xFF,0x01,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xFF,0x07,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0x81,0x0F,0x00,0x78,0x00,0x1E,0x00,0x38,0x00,0x1C,0x00,0x38,0x00,0x1C,0x00,0x18,0x30,0x18,0x00,0x18,0x30,0x18,0x00,0x18,0x30,0x18,0x00,0x18,0xF0,0x1F,0x00,0x38,0xF0,0x1F,0x00,0x38,0xF0,0x1F,0x00,0x30,0xF0,0x0F,0x00, // G
+0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00, // H
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00, // I
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1C,0x00,0x18,0x00,0x1C,0x00,0x18,0x00,0x1C,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x1C,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x07,0x00,0xF8,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // J
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x00,0x3E,0x00,0x00,0x00,0x7F,0x00,0x00,0x80,0xFF,0x00,0x00,0xC0,0xF7,0x03,0x00,0xE0,0xE3,0x07,0x00,0xF8,0xC0,0x0F,0x00,0x78,0x00,0x1F,0x00,0x38,0x00,0x1E,0x00,0x18,0x00,0x1C,0x00,0x08,0x00,0x18,0x00, // K
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00, // L
+0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0x0F,0x00,0x00,0xF0,0x3F,0x00,0x00,0xC0,0xFF,0x01,0x00,0x00,0xFE,0x01,0x00,0x00,0xF0,0x01,0x00,0x00,0xFE,0x01,0x00,0xC0,0xFF,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF8,0x03,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00, // M
+0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0x07,0x00,0x00,0xE0,0x0F,0x00,0x00,0xC0,0x3F,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0xFC,0x01,0x00,0x00,0xF8,0x07,0x00,0x00,0xE0,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00, // N
+0x00,0x7E,0x00,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xFF,0x07,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0xFF,0x0F,0x00,0x78,0x00,0x1E,0x00,0x38,0x00,0x1C,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x38,0x00,0x1C,0x00,0x78,0x00,0x1E,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0xFF,0x0F,0x00,0xE0,0xFF,0x07,0x00,0xC0,0xFF,0x03,0x00, // O
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x30,0x00,0x00,0x18,0x30,0x00,0x00,0x18,0x30,0x00,0x00,0x18,0x38,0x00,0x00,0x38,0x3C,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF0,0x0F,0x00,0x00,0xF0,0x0F,0x00,0x00, // P
+0x00,0x7E,0x00,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xFF,0x07,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0xFF,0x0F,0x00,0x78,0x00,0x1E,0x00,0x38,0x00,0x1C,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x38,0x00,0x38,0x00,0x7C,0x00,0x78,0x00,0x7E,0x00,0xF0,0xFF,0xFF,0x00,0xF0,0xFF,0xEF,0x00,0xE0,0xFF,0xC7,0x01,0xC0,0xFF,0xC3,0x01, // Q
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x30,0x00,0x00,0x18,0x70,0x00,0x00,0x18,0xF8,0x00,0x00,0x38,0xF8,0x01,0x00,0x78,0xFE,0x03,0x00,0xF8,0xDF,0x0F,0x00,0xF0,0x8F,0x1F,0x00,0xF0,0x0F,0x1F,0x00,0xE0,0x03,0x1E,0x00,0x00,0x00,0x18,0x00, // R
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xE0,0x03,0x0E,0x00,0xF0,0x07,0x1C,0x00,0xF0,0x0F,0x1C,0x00,0xF8,0x0F,0x1C,0x00,0x38,0x1E,0x18,0x00,0x18,0x1C,0x18,0x00,0x18,0x1C,0x18,0x00,0x18,0x3C,0x18,0x00,0x18,0x38,0x1C,0x00,0x18,0x78,0x1E,0x00,0x38,0xF8,0x0F,0x00,0x38,0xF0,0x0F,0x00,0x30,0xF0,0x07,0x00,0x00,0xE0,0x03,0x00, // S
+0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00, // T
+0x00,0x00,0x00,0x00,0xF8,0xFF,0x00,0x00,0xF8,0xFF,0x07,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x1F,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x1F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x07,0x00,0xF8,0xFF,0x00,0x00, // U
+0x38,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0xF8,0x07,0x00,0x00,0xF8,0x3F,0x00,0x00,0xE0,0xFF,0x00,0x00,0x80,0xFF,0x07,0x00,0x00,0xFC,0x1F,0x00,0x00,0xF0,0x1F,0x00,0x00,0x80,0x1F,0x00,0x00,0xE0,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xFF,0x07,0x00,0xC0,0xFF,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF8,0x07,0x00,0x00,0xF8,0x00,0x00,0x00, // V
+0xF8,0x03,0x00,0x00,0xF8,0xFF,0x01,0x00,0xF8,0xFF,0x1F,0x00,0xF0,0xFF,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF0,0x1F,0x00,0x80,0xFF,0x1F,0x00,0x80,0xFF,0x03,0x00,0x80,0x3F,0x00,0x00,0x80,0xFF,0x03,0x00,0x80,0xFF,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xE0,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x00,0x00, // W
+0x08,0x00,0x10,0x00,0x18,0x00,0x1C,0x00,0x78,0x00,0x1E,0x00,0xF8,0x00,0x1F,0x00,0xF8,0xC1,0x0F,0x00,0xF0,0xE7,0x03,0x00,0xE0,0xFF,0x01,0x00,0x80,0xFF,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0xFF,0x01,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xE3,0x07,0x00,0xF0,0xC1,0x1F,0x00,0xF8,0x80,0x1F,0x00,0x78,0x00,0x1E,0x00,0x18,0x00,0x1C,0x00, // X
+0x08,0x00,0x00,0x00,0x38,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0xF8,0x01,0x00,0x00,0xF8,0x07,0x00,0x00,0xE0,0x0F,0x00,0x00,0x80,0xFF,0x1F,0x00,0x00,0xFF,0x1F,0x00,0x00,0xFC,0x1F,0x00,0x00,0xFE,0x1F,0x00,0x00,0xFF,0x1F,0x00,0xC0,0x0F,0x00,0x00,0xE0,0x07,0x00,0x00,0xF8,0x01,0x00,0x00,0xF8,0x00,0x00,0x00,0x38,0x00,0x00,0x00, // Y
+0x00,0x00,0x00,0x00,0x18,0x00,0x1C,0x00,0x18,0x00,0x1E,0x00,0x18,0x00,0x1F,0x00,0x18,0xC0,0x1F,0x00,0x18,0xE0,0x1F,0x00,0x18,0xF0,0x1B,0x00,0x18,0xF8,0x18,0x00,0x18,0x7E,0x18,0x00,0x18,0x3F,0x18,0x00,0x98,0x1F,0x18,0x00,0xD8,0x07,0x18,0x00,0xF8,0x03,0x18,0x00,0xF8,0x01,0x18,0x00,0xF8,0x00,0x18,0x00,0x78,0x00,0x18,0x00, // Z
+};
+
+static const FontGlyphs_t Font_16x26_Caps_Glyphs = {
+	65,
+	90,
+	0,
+	NULL,
+	NULL,
+	NULL,
+	Font_16x26_Caps_Bitmap
+};
+
+FontDef_t Font_16x26_Caps = {
+	16,
+	26,
+	NULL,
+	NULL,
+	&Font_16x26_Caps_Glyphs
+};
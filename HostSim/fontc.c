@@ -0,0 +1,402 @@
+//font compiler for "SSD1306 OLED DRIVER/fonts.h" , glyph tables in LCD page layout
+//
+//  gcc -O2 -DFONTS_ROW_TABLES -I "SSD1306 OLED DRIVER" HostSim/fontc.c "SSD1306 OLED DRIVER/fonts.c" -o fontc
+//  ./fontc                                   prints the page tables of the three fonts , they go into fonts.c as they are
+//  ./fontc [-c chars] [-p] [-r] source name  a FontDef_t called name on stdout , the flash it takes on stderr
+//
+//source  a BDF file , or Font_7x10 , Font_11x18 or Font_16x26 for the row tables in fonts.c
+//-c      only these characters (all of 32 .. 126 the source has otherwise)
+//-p      a width per glyph , DWIDTH from a BDF file , for the fonts in fonts.c the inked columns and one blank after
+//        them (half a cell for a glyph with no ink)
+//-r      run length coded glyphs , a page row at a time (FontGlyphs_t in fonts.h)
+//
+//the row tables (one uint16_t a row , leftmost pixel in bit 15) and BDF bitmaps both come out as columns left to right ,
+//a column as ceil(height / 8) bytes top down with the top row in bit 0 , as the SSD1306 RAM holds it , so SSD1306_Putc()
+//writes whole bytes instead of single pixels
+//
+//flash is counted as on the M3: the tables , 20 bytes of FontGlyphs_t , against the same characters as uint16_t rows
+//and in page layout for all of 32 .. 126 (FontDef_t itself is the same size either way)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fonts.h"
+
+#define MAX_HEIGHT 63			//a cell must fit the LCD , and a column fits a uint64_t shifted by up to 7
+#define MAX_WIDTH 127
+
+typedef struct
+{
+	int present;
+	uint8_t advance;		//BDF DWIDTH
+	uint64_t col[MAX_WIDTH];	//bit r is row r
+} glyph_t;
+
+static glyph_t glyphs[256];
+static int cell_w, cell_h;
+static int has_advance;			//widths come from the source
+
+static void fail(const char *what, const char *detail)
+{
+	fprintf(stderr, "fontc: %s%s%s\n", what, detail ? " " : "", detail ? detail : "");
+	exit(1);
+}
+
+//------------------------------------------------------------------ sources
+
+static int load_rows(const char *name)
+{
+	static const struct { const char *name; const FontDef_t *font; } fonts[] =
+	{
+		{ "Font_7x10", &Font_7x10 }, { "Font_11x18", &Font_11x18 }, { "Font_16x26", &Font_16x26 },
+	};
+
+	for (uint32_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++)
+	{
+		const FontDef_t *f = fonts[i].font;
+
+		if (strcmp(name, fonts[i].name))
+			continue;
+		if (!f->data)
+			fail("the row tables are left out of fonts.c , build with -DFONTS_ROW_TABLES", 0);
+		cell_w = f->FontWidth;
+		cell_h = f->FontHeight;
+		for (uint32_t c = 0; c < 95; c++)
+		{
+			glyph_t *g = &glyphs[32 + c];
+
+			g->present = 1;
+			for (int r = 0; r < cell_h; r++)
+				for (int x = 0; x < cell_w; x++)
+					if ((f->data[c * cell_h + r] << x) & 0x8000)
+						g->col[x] |= 1ULL << r;
+		}
+		return 1;
+	}
+	return 0;
+}
+
+//the glyph box sits on the baseline , FONT_ASCENT rows below the top of the cell , the cell is
+//FONT_ASCENT + FONT_DESCENT high (the font bounding box without them) and as wide as the widest DWIDTH
+static void load_bdf(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[256];
+	int ascent = -1, descent = -1, bw = 0, bh = 0, bx = 0, by = 0;
+	int code = -1, dw = 0, w = 0, h = 0, xo = 0, yo = 0, row = -1;
+
+	if (!f)
+		fail("cannot open", path);
+	while (fgets(line, sizeof(line), f))
+	{
+		if (row >= 0 && strncmp(line, "ENDCHAR", 7))
+		{
+			//one bitmap row , MSB first
+			uint32_t bits = strtoul(line, 0, 16);
+			int y = ascent - yo - h + row++;
+
+			if (code < 0 || y < 0 || y >= cell_h)
+				continue;
+			for (int x = 0; x < w; x++)
+			{
+				int cx = xo + x;
+
+				if (cx >= 0 && cx < MAX_WIDTH && (bits >> ((w + 7) / 8 * 8 - 1 - x) & 1))
+					glyphs[code].col[cx] |= 1ULL << y;
+			}
+			continue;
+		}
+		if (sscanf(line, "FONTBOUNDINGBOX %d %d %d %d", &bw, &bh, &bx, &by) == 4)
+			;
+		else if (sscanf(line, "FONT_ASCENT %d", &ascent) == 1 || sscanf(line, "FONT_DESCENT %d", &descent) == 1)
+			;
+		else if (!strncmp(line, "CHARS ", 6))
+		{
+			if (ascent < 0 || descent < 0)
+			{
+				ascent = bh + by;
+				descent = -by;
+			}
+			cell_h = ascent + descent;
+			if (cell_h < 1 || cell_h > MAX_HEIGHT)
+				fail("cell height not 1 .. 63 rows in", path);
+		}
+		else if (sscanf(line, "ENCODING %d", &code) == 1)
+			code = code > 255 ? -1 : code;
+		else if (sscanf(line, "DWIDTH %d", &dw) == 1)
+			;
+		else if (sscanf(line, "BBX %d %d %d %d", &w, &h, &xo, &yo) == 4)
+		{
+			if (w > 32)
+				fail("glyph box wider than 32 columns in", path);
+		}
+		else if (!strncmp(line, "BITMAP", 6))
+		{
+			row = 0;
+			if (code >= 0)
+			{
+				glyphs[code].present = 1;
+				glyphs[code].advance = dw < 1 ? 1 : dw > MAX_WIDTH ? MAX_WIDTH : dw;
+			}
+		}
+		else if (!strncmp(line, "ENDCHAR", 7))
+		{
+			row = -1;
+			code = -1;
+		}
+	}
+	fclose(f);
+	if (!cell_h)
+		fail("no CHARS line in", path);
+
+	for (int c = 32; c < 127; c++)
+		if (glyphs[c].present && glyphs[c].advance > cell_w)
+			cell_w = glyphs[c].advance;
+	cell_w = cell_w ? cell_w : bw;
+	if (cell_w < 1 || cell_w > MAX_WIDTH)
+		fail("cell width not 1 .. 127 columns in", path);
+	has_advance = 1;
+}
+
+//------------------------------------------------------------------ page tables for fonts.c
+
+static void pages(const FontDef_t *f, const char *name)
+{
+	uint32_t bytes = (f->FontHeight + 7) / 8;
+
+	if (!f->data)
+		fail("the row tables are left out of fonts.c , build with -DFONTS_ROW_TABLES", 0);
+	printf("const uint8_t %s [] = {\n", name);
+	for (uint32_t c = 0; c < 95; c++)
+	{
+		const uint16_t *rows = &f->data[c * f->FontHeight];
+
+		for (uint32_t x = 0; x < f->FontWidth; x++)
+		{
+			for (uint32_t k = 0; k < bytes; k++)
+			{
+				uint8_t b = 0;
+
+				for (uint32_t bit = 0; bit < 8 && 8 * k + bit < f->FontHeight; bit++)
+					b |= ((rows[8 * k + bit] << x) & 0x8000) ? 1 << bit : 0;
+				printf("0x%02X,", b);
+			}
+		}
+		if (!c)
+			printf(" // sp\n");
+		else if (c + 32 == '\\')
+			printf(" /* \\ */\n");		//a // comment ending in a backslash would take the next line with it
+		else
+			printf(" // %c\n", c + 32);
+	}
+	printf("};\n\n");
+}
+
+//------------------------------------------------------------------ compiler
+
+//0x00 .. 0x7F: that many plus one bytes follow as they are , 0x80 .. 0xBF: the next byte (c & 0x3F) + 2 times ,
+//0xC0 .. 0xFF: (c & 0x3F) + 1 zero bytes
+static uint32_t rle(const uint8_t *in, uint32_t n, uint8_t *out)
+{
+	uint32_t i = 0, o = 0, lit = 0, ctl = 0;
+
+	while (i < n)
+	{
+		uint32_t run = 1;
+
+		while (i + run < n && in[i + run] == in[i] && run < (in[i] ? 65 : 64))
+			run++;
+		if (!in[i] || run >= 3)
+		{
+			out[o++] = in[i] ? 0x80 | (run - 2) : 0xC0 | (run - 1);
+			if (in[i])
+				out[o++] = in[i];
+			i += run;
+			lit = 0;
+			continue;
+		}
+		if (!lit || lit == 128)
+		{
+			ctl = o++;
+			lit = 0;
+		}
+		out[o++] = in[i++];
+		out[ctl] = lit++;
+	}
+	return o;
+}
+
+static void comment(int c)
+{
+	if (c == '\\')
+		printf(" /* \\ */\n");
+	else if (c == ' ')
+		printf(" // sp\n");
+	else if (c > 32 && c < 127)
+		printf(" // %c\n", c);
+	else
+		printf(" // 0x%02X\n", c);
+}
+
+static void saved(const char *against, uint32_t was, uint32_t now)
+{
+	if (now <= was)
+		fprintf(stderr, "  saves %5u bytes (%4.1f%%) against all of 32 .. 126 in %s (%u bytes)\n", was - now,
+			100.0 * (was - now) / was, against, was);
+	else
+		fprintf(stderr, "  takes %5u bytes more than all of 32 .. 126 in %s (%u bytes)\n", now - was, against, was);
+}
+
+static void compile(const char *chars, int proportional, int coded, const char *name, const char *source)
+{
+	static uint8_t bitmap[65536], raw[MAX_WIDTH * 8];
+	static uint16_t offset[257];
+	static uint8_t width[256], code[256];
+	uint32_t bytes = (cell_h + 7) / 8, n = 0, size = 0;
+	uint32_t first, last, holes, flash, rows_flash, pages_flash;
+
+	//the characters , in code order
+	for (int c = 0; c < 256; c++)
+	{
+		int wanted = chars ? memchr(chars, c, strlen(chars)) != 0 && c : c >= 32 && c < 127;
+
+		if (!wanted)
+			continue;
+		if (!glyphs[c].present)
+		{
+			fprintf(stderr, "fontc: no glyph for 0x%02X in %s , left out\n", c, source);
+			continue;
+		}
+		code[n++] = c;
+	}
+	if (!n || n > 255)
+		fail("need 1 .. 255 glyphs", 0);
+	first = code[0];
+	last = code[n - 1];
+	holes = last - first + 1 != n;
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		glyph_t *g = &glyphs[code[i]];
+		int l = 0, w = cell_w, len;
+
+		if (proportional && has_advance)
+			w = g->advance;
+		else if (proportional)
+		{
+			//inked columns and one blank
+			int r = cell_w - 1;
+
+			while (l < cell_w && !g->col[l])
+				l++;
+			while (r >= l && !g->col[r])
+				r--;
+			w = l > r ? (cell_w + 1) / 2 : r - l + 2;
+			l = l > r ? 0 : l;
+		}
+		w = w > MAX_WIDTH - l ? MAX_WIDTH - l : w;
+		//coded glyphs a page row at a time , the blank rows above and below the ink are long zero runs then
+		for (int x = 0; x < w; x++)
+			for (uint32_t k = 0; k < bytes; k++)
+				raw[coded ? k * w + x : x * bytes + k] = g->col[l + x] >> (8 * k);
+		len = coded ? (int) rle(raw, w * bytes, &bitmap[size]) : (int) (w * bytes);
+		if (!coded)
+			memcpy(&bitmap[size], raw, len);
+		if (size + len > 65535)
+			fail("more than 64 KB of glyphs", 0);
+		offset[i] = size;
+		width[i] = w;
+		size += len;
+	}
+	offset[n] = size;
+
+	printf("/* %s , %u x %u , from %s by HostSim/fontc.c%s%s%s , do not edit */\n", name, cell_w, cell_h, source,
+		chars ? " , a subset" : "", proportional ? " , a width per glyph" : "", coded ? " , run length coded" : "");
+	printf("#include \"fonts.h\"\n\n");
+	printf("static const uint8_t %s_Bitmap[] = {\n", name);
+	for (uint32_t i = 0; i < n; i++)
+	{
+		for (uint32_t b = offset[i]; b < offset[i + 1]; b++)
+			printf("0x%02X,", bitmap[b]);
+		comment(code[i]);
+	}
+	printf("};\n\n");
+	flash = size + 20;
+
+	//fixed width glyphs as they are need no offsets
+	if (proportional || coded)
+	{
+		printf("static const uint16_t %s_Offset[] = {", name);
+		for (uint32_t i = 0; i <= n; i++)
+			printf("%s%u,", i % 16 ? " " : "\n\t", offset[i]);
+		printf("\n};\n\n");
+		flash += 2 * (n + 1);
+	}
+	if (proportional)
+	{
+		printf("static const uint8_t %s_Width[] = {", name);
+		for (uint32_t i = 0; i < n; i++)
+			printf("%s%u,", i % 16 ? " " : "\n\t", width[i]);
+		printf("\n};\n\n");
+		flash += n;
+	}
+	if (holes)
+	{
+		uint32_t k = 0;
+
+		printf("static const uint8_t %s_Index[] = {", name);
+		for (uint32_t c = first; c <= last; c++)
+		{
+			printf("%s%u,", (c - first) % 16 ? " " : "\n\t", code[k] == c ? k + 1 : 0);
+			k += code[k] == c;
+		}
+		printf("\n};\n\n");
+		flash += last - first + 1;
+	}
+
+	printf("static const FontGlyphs_t %s_Glyphs = {\n\t%u,\n\t%u,\n\t%u,\n\t%s%s,\n\t%s%s,\n\t%s%s,\n\t%s_Bitmap\n};\n\n",
+		name, first, last, coded, holes ? name : "NULL", holes ? "_Index" : "", proportional || coded ? name : "NULL",
+		proportional || coded ? "_Offset" : "", proportional ? name : "NULL", proportional ? "_Width" : "", name);
+	printf("FontDef_t %s = {\n\t%u,\n\t%u,\n\tNULL,\n\tNULL,\n\t&%s_Glyphs\n};\n", name, cell_w, cell_h, name);
+
+	rows_flash = 95 * cell_h * 2 * ((cell_w + 15) / 16);
+	pages_flash = 95 * cell_w * bytes;
+	fprintf(stderr, "%s: %u glyphs , %u bytes of glyphs , %u bytes in all\n", name, n, size, flash);
+	saved("rows", rows_flash, flash);
+	saved("page layout", pages_flash, flash);
+}
+
+int main(int argc, char **argv)
+{
+	const char *chars = 0;
+	int proportional = 0, coded = 0, opt;
+
+	if (argc == 1)
+	{
+		pages(&Font_7x10, "Font7x10Pages");
+		pages(&Font_11x18, "Font11x18Pages");
+		pages(&Font_16x26, "Font16x26Pages");
+		return 0;
+	}
+	while ((opt = getopt(argc, argv, "c:pr")) != -1)
+	{
+		if (opt == 'c')
+			chars = optarg;
+		else if (opt == 'p')
+			proportional = 1;
+		else if (opt == 'r')
+			coded = 1;
+		else
+			return 2;
+	}
+	if (argc - optind != 2)
+	{
+		fprintf(stderr, "fontc [-c chars] [-p] [-r] source name\n");
+		return 2;
+	}
+	if (!load_rows(argv[optind]))
+		load_bdf(argv[optind]);
+	compile(chars, proportional, coded, argv[optind + 1], argv[optind]);
+	return 0;
+}
@@ -0,0 +1,143 @@
+//ISO-TP goodput test , MyDrivers/myisotp.c over MyDrivers/mycan.c in silent loopback as in "CAN/ISOTP LOOPBACK"
+//
+//gcc -O2 -I HostSim -I MyDrivers HostSim/mmio.c HostSim/device.c HostSim/cansim.c HostSim/isotp_goodput.c MyDrivers/mycan.c MyDrivers/mycanfilter.c MyDrivers/myisotp.c -lpthread -o isotp_goodput
+//
+//link A segments a block , link B reassembles it in the same chip , for a few sizes , block sizes and STmin values
+//exit status is 0 when every block came back intact , no frame was counted as dropped and the goodput
+//(payload bit/s) reached the floor of its case
+
+#include <stdio.h>
+#include <string.h>
+#include "stm32f1xx.h"
+#include "mmio.h"
+#include "cansim.h"
+#include "mycan.h"
+#include "mycanfilter.h"
+#include "myisotp.h"
+
+#define ID_A 0x700
+#define ID_B 0x708
+#define ROUNDS 3
+
+typedef struct
+{
+	uint32_t bitrate;
+	uint16_t len;
+	uint8_t bs;			//BS link B asks for
+	uint8_t st_min;			//STmin link B asks for
+	uint32_t floor;			//payload bit/s at least
+} goodput_case_t;
+
+static const goodput_case_t cases[] = {
+	{ 250000, 1024, 8, 0, 85000 },
+	{ 250000, 4095, 0, 0, 95000 },
+	{ 250000, 4095, 2, 0, 65000 },
+	{ 250000, 100, 8, 0, 70000 },
+	{ 250000, 1024, 8, 0xF5, 70000 },		//500 us gaps
+	{ 250000, 1024, 0, 2, 22000 },			//2 ms gaps , at most 7 bytes per 2 ms
+	{ 1000000, 4095, 0, 0, 380000 },
+	{ 1000000, 4095, 8, 0, 290000 },
+};
+
+static uint8_t txblock[ISOTP_MAX_LEN];
+static uint8_t rxblock[ISOTP_MAX_LEN];
+static isotp_link_t link_a, link_b;
+
+//------------------------------------------------------------------ CAN1 set up , as in the CAN/ programs
+
+static void can_init(uint32_t btr)
+{
+	RCC->APB1ENR |= RCC_APB1ENR_CAN1EN;
+	CAN1->MCR &= ~CAN_MCR_SLEEP;
+	while (CAN1->MSR & CAN_MSR_SLAK);
+	CAN1->MCR |= CAN_MCR_INRQ;
+	while (!(CAN1->MSR & CAN_MSR_INAK));
+	CAN1->MCR |= CAN_MCR_NART;
+	CAN1->BTR = btr | CAN_BTR_LBKM | CAN_BTR_SILM;
+	CAN1->MCR &= ~CAN_MCR_INRQ;
+	while (CAN1->MSR & CAN_MSR_INAK);
+}
+
+static void filter_setup(void)
+{
+	static const can_filter_range_t accept[] = { { ID_A, ID_A, 0 }, { ID_B, ID_B, 0 } };
+	can_filter_bank_t banks[CAN_FILTER_BANKS];
+	int nbanks = can_filter_plan(accept, 2, banks);
+
+	if (nbanks > 0)
+		can_filter_apply(banks, nbanks);
+}
+
+//------------------------------------------------------------------ one transfer , the loop of the program
+
+static int transfer(uint16_t len, uint64_t *ns)
+{
+	can_frame_t frame;
+	uint64_t start = sim_now_ns();
+	int got = 0;
+
+	*ns = 0;
+	link_b.rx_result = ISOTP_OK;
+	if (isotp_send(&link_a, txblock, len) != ISOTP_OK)
+		return -1;
+	while (!got && link_b.rx_result != ISOTP_ERR_TIMEOUT && link_a.tx_result != ISOTP_ERR_TIMEOUT)
+	{
+		while (can_recv(&frame))
+		{
+			if (!isotp_on_frame(&link_b, &frame))
+				isotp_on_frame(&link_a, &frame);
+		}
+		isotp_poll(&link_a);
+		isotp_poll(&link_b);
+		got = isotp_recv(&link_b);
+	}
+	*ns = sim_now_ns() - start;
+	//the last flow control may still be queued , let link A see the end of its transfer
+	while (isotp_tx_busy(&link_a) && link_a.tx_result == ISOTP_BUSY && sim_now_ns() - start < 2 * *ns + 10000000)
+		isotp_poll(&link_a);
+	return got;
+}
+
+static int run(const goodput_case_t *c)
+{
+	uint64_t ns, total_ns = 0;
+	uint32_t goodput, bad = 0;
+	int ok;
+
+	//PCLK1 is 8 MHz: 16 tq with prescaler 2 for 250 kbit/s , 8 tq with prescaler 1 for 1 Mbit/s
+	can_init(c->bitrate == 1000000 ? 0x00140000 : 0x001C0001);
+	filter_setup();
+	can_rx_init();
+	can_tx_init();
+
+	isotp_init(&link_a, ID_A, ID_B, 0, 0, 0);
+	isotp_init(&link_b, ID_B, ID_A, 0, c->bs, c->st_min);
+	isotp_set_rx_buffer(&link_b, rxblock, sizeof(rxblock));
+
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		for (int i = 0; i < c->len; i++)
+			txblock[i] = i * 7 + 3 + r;
+		memset(rxblock, 0, sizeof(rxblock));
+		if (transfer(c->len, &ns) != c->len || memcmp(rxblock, txblock, c->len))
+			bad++;
+		total_ns += ns;
+	}
+	goodput = (uint64_t) c->len * 8 * ROUNDS * 1000000000ULL / total_ns;
+
+	ok = !bad && !can_tx_stats.dropped && !can_tx_stats.failed && goodput >= c->floor;
+	printf("%7u bit/s  %4u bytes  BS %u  STmin 0x%02X   %6u bit/s goodput (at least %6u) , %u bad , %u dropped %s\n",
+			c->bitrate, c->len, c->bs, c->st_min, goodput, c->floor, bad, can_tx_stats.dropped, ok ? "ok" : "FAIL");
+	return ok;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	sim_set_time_scale(0.25);
+	for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+		failed += !run(&cases[i]);
+	printf(failed ? "FAILED\n" : "all passed\n");
+	return failed;
+}
@@ -0,0 +1,139 @@
+//host checks for the joystick frame codec (MyDrivers/joycodec.c)
+//
+//gcc -O2 -I MyDrivers HostSim/joy_codec.c MyDrivers/joycodec.c -o joy_codec
+//
+//  joy_codec                        exit status 0 when every check passes
+//
+//round trip: 1 .. 4 channels (DLC 4 , 5 , 7 , 8) , every sequence number , every combination of the boundary values
+//            0 , 1 , 0x7FF , 0x800 , 0xFFE , 0xFFF on every channel , bits above 12 dropped
+//versions:   the same frames with each of the 4 version codes and a good CRC , only JOY_CODEC_VERSION decodes
+//damage:     every other DLC is JOY_ERR_LEN , every single bit error is refused
+//speed:      host TSC cycles per encode and per decode for each channel count
+
+#include <stdio.h>
+#include <string.h>
+#include <x86intrin.h>
+#include "joycodec.h"
+
+#define WALK 1000000
+
+static const uint16_t edges[] = { 0x000, 0x001, 0x7FF, 0x800, 0xFFE, 0xFFF };
+#define NEDGES (sizeof(edges) / sizeof(edges[0]))
+
+static int failed;
+static uint32_t frames_checked;
+
+static void check(int ok, const char *what, uint8_t nch, uint8_t seq)
+{
+	if (!ok && failed < 20)
+		printf("FAIL %s , %u channels , seq %u\n", what, nch, seq);
+	failed += !ok;
+}
+
+//everything one encoded frame has to survive
+static void one_frame(const uint16_t *ch, uint8_t nch, uint8_t seq)
+{
+	static const uint8_t want_dlc[JOY_MAX_CHANNELS + 1] = { 0, 4, 5, 7, 8 };
+	uint8_t buf[8], bad[8];
+	joy_sample_t s;
+	uint8_t dlc = joy_encode(ch, nch, seq, buf);
+	int ok;
+
+	frames_checked++;
+	check(dlc == want_dlc[nch] && dlc == joy_dlc(nch), "DLC", nch, seq);
+	memset(&s, 0xA5, sizeof(s));
+	ok = joy_decode(buf, dlc, &s) == 0 && s.nch == nch && s.seq == (seq & JOY_SEQ_MASK);
+	for (uint8_t i = 0; ok && i < nch; i++)
+		ok = s.ch[i] == (ch[i] & 0xFFF);
+	check(ok, "round trip", nch, seq);
+
+	for (uint8_t v = 0; v < 4; v++)
+	{
+		memcpy(bad, buf, dlc);
+		bad[0] = (bad[0] & 0x3F) | (v << 6);
+		bad[dlc - 1] = joy_crc8(bad, dlc - 1);
+		check(joy_decode(bad, dlc, &s) == (v == JOY_CODEC_VERSION ? 0 : JOY_ERR_VERSION), "version", nch, seq);
+	}
+
+	for (uint8_t d = 0; d <= 8; d++)
+		if (d != dlc)
+			check(joy_decode(buf, d, &s) == JOY_ERR_LEN, "wrong DLC accepted", nch, seq);
+
+	for (uint8_t bit = 0; bit < 8 * dlc; bit++)
+	{
+		memcpy(bad, buf, dlc);
+		bad[bit / 8] ^= 1 << (bit % 8);
+		check(joy_decode(bad, dlc, &s) != 0, "bit error accepted", nch, seq);
+	}
+}
+
+static void round_trips(void)
+{
+	uint16_t ch[JOY_MAX_CHANNELS];
+
+	for (uint8_t nch = 1; nch <= JOY_MAX_CHANNELS; nch++)
+	{
+		uint32_t combos = 1;
+
+		for (uint8_t i = 0; i < nch; i++)
+			combos *= NEDGES;
+		for (uint8_t seq = 0; seq <= JOY_SEQ_MASK; seq++)
+			for (uint32_t c = 0; c < combos; c++)
+			{
+				uint32_t k = c;
+
+				for (uint8_t i = 0; i < nch; i++, k /= NEDGES)
+					ch[i] = edges[k % NEDGES];
+				one_frame(ch, nch, seq);
+			}
+
+		//bits above 12 and a sequence above 4 bits are dropped , not carried into the next field
+		for (uint8_t i = 0; i < nch; i++)
+			ch[i] = 0xF000 | (0x5A5 + i);
+		one_frame(ch, nch, 0xF3);
+		for (uint8_t i = 0; i < nch; i++)
+			ch[i] = 0xFFFF;
+		one_frame(ch, nch, 0xFF);
+	}
+	check(joy_encode(ch, 0, 0, (uint8_t [8]) { 0 }) == 0, "0 channels encoded", 0, 0);
+	check(joy_encode(ch, JOY_MAX_CHANNELS + 1, 0, (uint8_t [8]) { 0 }) == 0, "5 channels encoded", 5, 0);
+	printf("round trip , versions , DLC and bit errors: %u frames %s\n", frames_checked, failed ? "FAIL" : "ok");
+}
+
+static void speed(void)
+{
+	static uint8_t frames[WALK][8];
+	static uint8_t dlcs[WALK];
+	uint16_t ch[JOY_MAX_CHANNELS] = { 0 };
+	joy_sample_t s;
+	uint32_t rng = 7, sum = 0;
+	uint64_t t0, t1, t2;
+
+	for (uint8_t nch = 1; nch <= JOY_MAX_CHANNELS; nch++)
+	{
+		t0 = __rdtsc();
+		for (uint32_t i = 0; i < WALK; i++)
+		{
+			rng = rng * 1664525 + 1013904223;
+			ch[i % nch] = rng >> 20;
+			dlcs[i] = joy_encode(ch, nch, i, frames[i]);
+		}
+		t1 = __rdtsc();
+		for (uint32_t i = 0; i < WALK; i++)
+		{
+			joy_decode(frames[i], dlcs[i], &s);
+			sum += s.ch[0];
+		}
+		t2 = __rdtsc();
+		printf("speed: %u channels , DLC %u , encode %.1f cycles , decode %.1f cycles per frame (checksum %u)\n",
+				nch, joy_dlc(nch), (double) (t1 - t0) / WALK, (double) (t2 - t1) / WALK, sum);
+	}
+}
+
+int main(void)
+{
+	round_trips();
+	speed();
+	printf(failed ? "FAILED\n" : "all passed\n");
+	return failed != 0;
+}
@@ -0,0 +1,596 @@
+#define _GNU_SOURCE
+#include <signal.h>
+#include <ucontext.h>
+#include <pthread.h>
+#include <poll.h>
+#include <time.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include "mmio.h"
+#include "stm32f1xx.h"
+
+#define SIG_IRQ SIGUSR1
+#define MAX_REGIONS 32
+#define MAX_MODELS 16
+#define NVIC_LINES (16 + 43)		//core exceptions + F103xB interrupts
+#define TF_FLAG 0x100			//x86 trap flag , single step
+
+typedef struct
+{
+	uint8_t *view;
+	uint8_t *alias;
+	size_t size;
+	int prot;			//protection while no access is in flight
+	mmio_write_fn on_write;
+	mmio_read_fn on_read;
+	void *ctx;
+} region_t;
+
+static region_t regions[MAX_REGIONS];
+static int nregions = 0;
+
+static struct
+{
+	sim_step_fn step;
+	void *ctx;
+} models[MAX_MODELS];
+static int nmodels = 0;
+
+static pthread_mutex_t hw_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static pthread_t main_thread, sim_thread;
+static volatile int running = 0;
+static int kick_fd = -1;
+
+static struct timespec t0;		//set on first use
+static double time_scale = 1.0;
+static uint64_t base_virtual = 0, base_wall = 0;	//virtual time is base_virtual + (wall - base_wall) * time_scale
+
+//access being single stepped
+static region_t *step_region;
+static uint32_t step_offset, step_old;
+static int step_write;
+static sigset_t step_mask;
+
+static uint8_t nvic_enabled[NVIC_LINES];
+static uint8_t nvic_level[NVIC_LINES];
+static uint8_t nvic_pending[NVIC_LINES];	//edge requests , cleared when the handler is entered
+static uint8_t nvic_prio[NVIC_LINES];
+static volatile int irq_signalled = 0;
+static volatile int irq_busy = 0;		//requests raised that the firmware has not worked through yet
+
+static __thread int lock_depth = 0;
+static __thread sigset_t lock_saved;
+
+//------------------------------------------------------------------ vector table
+
+static void default_handler(void)
+{
+}
+
+#define WEAK_HANDLER(name) void name(void) __attribute__((weak, alias("default_handler")));
+WEAK_HANDLER(SysTick_Handler)
+WEAK_HANDLER(WWDG_IRQHandler)
+WEAK_HANDLER(PVD_IRQHandler)
+WEAK_HANDLER(TAMPER_IRQHandler)
+WEAK_HANDLER(RTC_IRQHandler)
+WEAK_HANDLER(FLASH_IRQHandler)
+WEAK_HANDLER(RCC_IRQHandler)
+WEAK_HANDLER(EXTI0_IRQHandler)
+WEAK_HANDLER(EXTI1_IRQHandler)
+WEAK_HANDLER(EXTI2_IRQHandler)
+WEAK_HANDLER(EXTI3_IRQHandler)
+WEAK_HANDLER(EXTI4_IRQHandler)
+WEAK_HANDLER(DMA1_Channel1_IRQHandler)
+WEAK_HANDLER(DMA1_Channel2_IRQHandler)
+WEAK_HANDLER(DMA1_Channel3_IRQHandler)
+WEAK_HANDLER(DMA1_Channel4_IRQHandler)
+WEAK_HANDLER(DMA1_Channel5_IRQHandler)
+WEAK_HANDLER(DMA1_Channel6_IRQHandler)
+WEAK_HANDLER(DMA1_Channel7_IRQHandler)
+WEAK_HANDLER(ADC1_2_IRQHandler)
+WEAK_HANDLER(USB_HP_CAN1_TX_IRQHandler)
+WEAK_HANDLER(USB_LP_CAN1_RX0_IRQHandler)
+WEAK_HANDLER(CAN1_RX1_IRQHandler)
+WEAK_HANDLER(CAN1_SCE_IRQHandler)
+WEAK_HANDLER(EXTI9_5_IRQHandler)
+WEAK_HANDLER(TIM1_BRK_IRQHandler)
+WEAK_HANDLER(TIM1_UP_IRQHandler)
+WEAK_HANDLER(TIM1_TRG_COM_IRQHandler)
+WEAK_HANDLER(TIM1_CC_IRQHandler)
+WEAK_HANDLER(TIM2_IRQHandler)
+WEAK_HANDLER(TIM3_IRQHandler)
+WEAK_HANDLER(TIM4_IRQHandler)
+WEAK_HANDLER(I2C1_EV_IRQHandler)
+WEAK_HANDLER(I2C1_ER_IRQHandler)
+WEAK_HANDLER(I2C2_EV_IRQHandler)
+WEAK_HANDLER(I2C2_ER_IRQHandler)
+WEAK_HANDLER(SPI1_IRQHandler)
+WEAK_HANDLER(SPI2_IRQHandler)
+WEAK_HANDLER(USART1_IRQHandler)
+WEAK_HANDLER(USART2_IRQHandler)
+WEAK_HANDLER(USART3_IRQHandler)
+WEAK_HANDLER(EXTI15_10_IRQHandler)
+WEAK_HANDLER(RTC_Alarm_IRQHandler)
+WEAK_HANDLER(USBWakeUp_IRQHandler)
+
+//indexed by IRQn + 16
+static void (*const vectors[NVIC_LINES])(void) =
+{
+	[SysTick_IRQn + 16] = SysTick_Handler,
+	[WWDG_IRQn + 16] = WWDG_IRQHandler,
+	[PVD_IRQn + 16] = PVD_IRQHandler,
+	[TAMPER_IRQn + 16] = TAMPER_IRQHandler,
+	[RTC_IRQn + 16] = RTC_IRQHandler,
+	[FLASH_IRQn + 16] = FLASH_IRQHandler,
+	[RCC_IRQn + 16] = RCC_IRQHandler,
+	[EXTI0_IRQn + 16] = EXTI0_IRQHandler,
+	[EXTI1_IRQn + 16] = EXTI1_IRQHandler,
+	[EXTI2_IRQn + 16] = EXTI2_IRQHandler,
+	[EXTI3_IRQn + 16] = EXTI3_IRQHandler,
+	[EXTI4_IRQn + 16] = EXTI4_IRQHandler,
+	[DMA1_Channel1_IRQn + 16] = DMA1_Channel1_IRQHandler,
+	[DMA1_Channel2_IRQn + 16] = DMA1_Channel2_IRQHandler,
+	[DMA1_Channel3_IRQn + 16] = DMA1_Channel3_IRQHandler,
+	[DMA1_Channel4_IRQn + 16] = DMA1_Channel4_IRQHandler,
+	[DMA1_Channel5_IRQn + 16] = DMA1_Channel5_IRQHandler,
+	[DMA1_Channel6_IRQn + 16] = DMA1_Channel6_IRQHandler,
+	[DMA1_Channel7_IRQn + 16] = DMA1_Channel7_IRQHandler,
+	[ADC1_2_IRQn + 16] = ADC1_2_IRQHandler,
+	[USB_HP_CAN1_TX_IRQn + 16] = USB_HP_CAN1_TX_IRQHandler,
+	[USB_LP_CAN1_RX0_IRQn + 16] = USB_LP_CAN1_RX0_IRQHandler,
+	[CAN1_RX1_IRQn + 16] = CAN1_RX1_IRQHandler,
+	[CAN1_SCE_IRQn + 16] = CAN1_SCE_IRQHandler,
+	[EXTI9_5_IRQn + 16] = EXTI9_5_IRQHandler,
+	[TIM1_BRK_IRQn + 16] = TIM1_BRK_IRQHandler,
+	[TIM1_UP_IRQn + 16] = TIM1_UP_IRQHandler,
+	[TIM1_TRG_COM_IRQn + 16] = TIM1_TRG_COM_IRQHandler,
+	[TIM1_CC_IRQn + 16] = TIM1_CC_IRQHandler,
+	[TIM2_IRQn + 16] = TIM2_IRQHandler,
+	[TIM3_IRQn + 16] = TIM3_IRQHandler,
+	[TIM4_IRQn + 16] = TIM4_IRQHandler,
+	[I2C1_EV_IRQn + 16] = I2C1_EV_IRQHandler,
+	[I2C1_ER_IRQn + 16] = I2C1_ER_IRQHandler,
+	[I2C2_EV_IRQn + 16] = I2C2_EV_IRQHandler,
+	[I2C2_ER_IRQn + 16] = I2C2_ER_IRQHandler,
+	[SPI1_IRQn + 16] = SPI1_IRQHandler,
+	[SPI2_IRQn + 16] = SPI2_IRQHandler,
+	[USART1_IRQn + 16] = USART1_IRQHandler,
+	[USART2_IRQn + 16] = USART2_IRQHandler,
+	[USART3_IRQn + 16] = USART3_IRQHandler,
+	[EXTI15_10_IRQn + 16] = EXTI15_10_IRQHandler,
+	[RTC_Alarm_IRQn + 16] = RTC_Alarm_IRQHandler,
+	[USBWakeUp_IRQn + 16] = USBWakeUp_IRQHandler,
+};
+
+
+//------------------------------------------------------------------ locking
+
+void hw_lock(void)
+{
+	if (lock_depth++ == 0)
+	{
+		sigset_t s;
+
+		sigemptyset(&s);
+		sigaddset(&s, SIG_IRQ);
+		pthread_sigmask(SIG_BLOCK, &s, &lock_saved);	//no interrupt may run on top of a half updated model
+	}
+	pthread_mutex_lock(&hw_mutex);
+}
+
+void hw_unlock(void)
+{
+	pthread_mutex_unlock(&hw_mutex);
+	if (--lock_depth == 0)
+		pthread_sigmask(SIG_SETMASK, &lock_saved, 0);
+}
+
+void sim_kick(void)
+{
+	uint64_t one = 1;
+	ssize_t n = write(kick_fd, &one, sizeof(one));	//fails harmlessly before sim_start()
+
+	(void) n;
+}
+
+//------------------------------------------------------------------ time
+
+static uint64_t wall_ns(void)
+{
+	struct timespec t;
+
+	if (!t0.tv_sec && !t0.tv_nsec)
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t) (t.tv_sec - t0.tv_sec) * 1000000000ULL + t.tv_nsec - t0.tv_nsec;
+}
+
+void sim_set_time_scale(double scale)
+{
+	hw_lock();
+	base_virtual = sim_now_ns();		//time stays continuous across the change
+	base_wall = wall_ns();
+	time_scale = scale;
+	hw_unlock();
+	sim_kick();
+}
+
+uint64_t sim_now_ns(void)
+{
+	return base_virtual + (uint64_t) ((wall_ns() - base_wall) * time_scale);
+}
+
+uint32_t sim_cycles(void)
+{
+	return (uint32_t) ((unsigned __int128) sim_now_ns() * SystemCoreClock / 1000000000ULL);
+}
+
+//------------------------------------------------------------------ NVIC
+
+static void irq_raise(void)
+{
+	for (int i = 0; i < NVIC_LINES; i++)
+	{
+		if ((nvic_level[i] || nvic_pending[i]) && nvic_enabled[i])
+		{
+			irq_busy = 1;
+			if (!irq_signalled)
+			{
+				irq_signalled = 1;
+				pthread_kill(main_thread, SIG_IRQ);
+			}
+			return;
+		}
+	}
+}
+
+void nvic_set_level(int irqn, int level)
+{
+	nvic_level[irqn + 16] = level ? 1 : 0;
+	if (level)
+		irq_raise();
+}
+
+void nvic_pend(int irqn)
+{
+	nvic_pending[irqn + 16] = 1;
+	irq_raise();
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irqn)
+{
+	hw_lock();
+	nvic_pend(irqn);
+	hw_unlock();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irqn)
+{
+	hw_lock();
+	nvic_enabled[irqn + 16] = 1;
+	irq_raise();
+	hw_unlock();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irqn)
+{
+	hw_lock();
+	nvic_enabled[irqn + 16] = 0;
+	hw_unlock();
+}
+
+void NVIC_SetPriority(IRQn_Type irqn, uint32_t priority)
+{
+	hw_lock();
+	nvic_prio[irqn + 16] = priority;
+	hw_unlock();
+}
+
+//runs in the firmware thread like an exception entry , lowest priority value first then lowest number
+static void irq_signal(int sig)
+{
+	(void) sig;
+	while (1)
+	{
+		int pick = -1;
+
+		pthread_mutex_lock(&hw_mutex);
+		irq_signalled = 0;
+		for (int i = 0; i < NVIC_LINES; i++)
+			if ((nvic_level[i] || nvic_pending[i]) && nvic_enabled[i] && (pick < 0 || nvic_prio[i] < nvic_prio[pick]))
+				pick = i;
+		if (pick < 0)
+			irq_busy = 0;
+		pthread_mutex_unlock(&hw_mutex);
+		if (pick < 0)
+			break;
+		nvic_pending[pick] = 0;
+		if (vectors[pick])
+			vectors[pick]();
+	}
+}
+
+void sim_irq_disable(void)
+{
+	sigset_t s;
+
+	sigemptyset(&s);
+	sigaddset(&s, SIG_IRQ);
+	pthread_sigmask(SIG_BLOCK, &s, 0);
+}
+
+void sim_irq_enable(void)
+{
+	sigset_t s;
+
+	sigemptyset(&s);
+	sigaddset(&s, SIG_IRQ);
+	pthread_sigmask(SIG_UNBLOCK, &s, 0);
+}
+
+//sleep until the next interrupt , a short nap is close enough and keeps the simulator thread fed
+void sim_wfi(void)
+{
+	struct timespec t = { 0, 20000 };
+
+	nanosleep(&t, 0);
+}
+
+uint32_t sim_irq_masked(void)
+{
+	sigset_t s;
+
+	pthread_sigmask(SIG_BLOCK, 0, &s);
+	return sigismember(&s, SIG_IRQ) ? 1 : 0;
+}
+
+//------------------------------------------------------------------ trapping
+
+void *mmio_map(size_t size, int trap_reads, mmio_write_fn on_write, mmio_read_fn on_read, void *ctx, void **alias)
+{
+	long page = sysconf(_SC_PAGESIZE);
+	region_t *r = &regions[nregions++];
+	int fd;
+
+	size = (size + page - 1) & ~(page - 1);
+	fd = memfd_create("mmio", 0);
+	if (fd < 0 || ftruncate(fd, size) < 0)
+	{
+		perror("mmio_map");
+		exit(1);
+	}
+	r->prot = trap_reads ? PROT_NONE : PROT_READ;
+	r->view = mmap(0, size, r->prot, MAP_SHARED, fd, 0);
+	r->alias = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	r->size = size;
+	r->on_write = on_write;
+	r->on_read = on_read;
+	r->ctx = ctx;
+	close(fd);
+	*alias = r->alias;
+	return r->view;
+}
+
+static void segv_handler(int sig, siginfo_t *info, void *uc_)
+{
+	ucontext_t *uc = uc_;
+	uint8_t *addr = info->si_addr;
+	region_t *r = 0;
+
+	for (int i = 0; i < nregions; i++)
+		if (addr >= regions[i].view && addr < regions[i].view + regions[i].size)
+			r = &regions[i];
+	if (!r)
+	{
+		signal(sig, SIG_DFL);		//a real crash , let it happen
+		return;
+	}
+
+	pthread_mutex_lock(&hw_mutex);		//released in trap_handler once the access is done
+	step_region = r;
+	step_offset = (addr - r->view) & ~3u;
+	step_write = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+	if (!step_write && r->on_read)
+		r->on_read(r->ctx, step_offset, 0);
+	step_old = *(uint32_t *) (r->alias + step_offset);
+
+	mprotect(r->view, r->size, PROT_READ | PROT_WRITE);
+	uc->uc_mcontext.gregs[REG_EFL] |= TF_FLAG;
+	step_mask = uc->uc_sigmask;
+	sigaddset(&uc->uc_sigmask, SIG_IRQ);	//no interrupt between here and the end of the stepped instruction
+}
+
+static void trap_handler(int sig, siginfo_t *info, void *uc_)
+{
+	ucontext_t *uc = uc_;
+	region_t *r = step_region;
+
+	(void) sig;
+	(void) info;
+	if (!r)
+		return;
+	uc->uc_mcontext.gregs[REG_EFL] &= ~TF_FLAG;
+	uc->uc_sigmask = step_mask;
+	mprotect(r->view, r->size, r->prot);
+	step_region = 0;
+
+	if (step_write && r->on_write)
+		r->on_write(r->ctx, step_offset, step_old, *(uint32_t *) (r->alias + step_offset));
+	else if (!step_write && r->on_read)
+		r->on_read(r->ctx, step_offset, 1);
+	pthread_mutex_unlock(&hw_mutex);
+}
+
+//------------------------------------------------------------------ bus masters
+
+extern char __executable_start[], _end[];	//the program image , its static data included
+
+static region_t *bus_region(uint32_t addr, uint32_t *offset)
+{
+	for (int i = 0; i < nregions; i++)
+	{
+		uint32_t off = addr - (uint32_t) (uintptr_t) regions[i].view;
+
+		if (off < regions[i].size)
+		{
+			*offset = off;
+			return &regions[i];
+		}
+	}
+	return 0;
+}
+
+static uint8_t *bus_memory(uint32_t addr, int size)
+{
+	uint8_t *p = (uint8_t *) (((uintptr_t) __executable_start & ~(uintptr_t) 0xFFFFFFFF) | addr);
+
+	return p >= (uint8_t *) __executable_start && p + size <= (uint8_t *) _end ? p : 0;
+}
+
+int mmio_bus_read(uint32_t addr, int size, uint32_t *val)
+{
+	uint32_t off;
+	region_t *r = bus_region(addr, &off);
+	uint8_t *p;
+
+	*val = 0;
+	if (r)
+	{
+		if (r->on_read)
+			r->on_read(r->ctx, off & ~3u, 0);
+		p = r->alias + off;
+	}
+	else if (!(p = bus_memory(addr, size)))
+		return 0;
+	memcpy(val, p, size);
+	if (r && r->on_read)
+		r->on_read(r->ctx, off & ~3u, 1);
+	return 1;
+}
+
+int mmio_bus_write(uint32_t addr, int size, uint32_t val)
+{
+	uint32_t off, old;
+	region_t *r = bus_region(addr, &off);
+	uint8_t *p;
+
+	if (!r)
+	{
+		if (!(p = bus_memory(addr, size)))
+			return 0;
+		memcpy(p, &val, size);
+		return 1;
+	}
+	old = *(uint32_t *) (r->alias + (off & ~3u));
+	memcpy(r->alias + off, &val, size);
+	if (r->on_write)
+		r->on_write(r->ctx, off & ~3u, old, *(uint32_t *) (r->alias + (off & ~3u)));
+	return 1;
+}
+
+//------------------------------------------------------------------ simulator thread
+
+void sim_add_model(sim_step_fn step, void *ctx)
+{
+	hw_lock();
+	models[nmodels].step = step;
+	models[nmodels].ctx = ctx;
+	nmodels++;
+	hw_unlock();
+	sim_kick();
+}
+
+static void *sim_main(void *arg)
+{
+	(void) arg;
+	while (running)
+	{
+		uint64_t now, next;
+		struct pollfd p = { kick_fd, POLLIN, 0 };
+		struct timespec wait;
+		uint64_t wait_ns;
+
+		hw_lock();
+		now = sim_now_ns();
+		next = now + 1000000;		//wake up at least every simulated ms
+		for (int i = 0; i < nmodels; i++)
+		{
+			uint64_t n = models[i].step(models[i].ctx, now);
+
+			if (n < next)
+				next = n;
+		}
+		hw_unlock();
+
+		if (next <= now)
+		{
+			//a model is catching up on events that are already due , one at a time so that the firmware
+			//gets to run its interrupt handlers in between , as it would have on time (bounded wait ,
+			//firmware sitting with interrupts masked must not stop the bus)
+			for (int spin = 0; spin < 100 && irq_busy; spin++)
+			{
+				struct timespec t = { 0, 10000 };
+
+				nanosleep(&t, 0);
+			}
+			continue;
+		}
+		wait_ns = (uint64_t) ((next - now) / time_scale);
+		wait.tv_sec = wait_ns / 1000000000ULL;
+		wait.tv_nsec = wait_ns % 1000000000ULL;
+		if (ppoll(&p, 1, &wait, 0) > 0)
+		{
+			uint64_t v;
+			ssize_t n = read(kick_fd, &v, sizeof(v));
+
+			(void) n;
+		}
+	}
+	return 0;
+}
+
+void sim_start(void)
+{
+	struct sigaction sa;
+	sigset_t s;
+
+	if (running)
+		return;
+	kick_fd = eventfd(0, EFD_NONBLOCK);
+	main_thread = pthread_self();
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_flags = SA_SIGINFO;
+	sigemptyset(&sa.sa_mask);
+	sigaddset(&sa.sa_mask, SIG_IRQ);
+	sa.sa_sigaction = segv_handler;
+	sigaction(SIGSEGV, &sa, 0);
+	sa.sa_sigaction = trap_handler;
+	sigaction(SIGTRAP, &sa, 0);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = irq_signal;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIG_IRQ, &sa, 0);
+
+	//the simulator thread never runs firmware code , keep interrupts away from it
+	sigemptyset(&s);
+	sigaddset(&s, SIG_IRQ);
+	pthread_sigmask(SIG_BLOCK, &s, 0);
+	running = 1;
+	pthread_create(&sim_thread, 0, sim_main, 0);
+	pthread_sigmask(SIG_UNBLOCK, &s, 0);
+}
+
+void sim_stop(void)
+{
+	if (!running)
+		return;
+	running = 0;
+	sim_kick();
+	pthread_join(sim_thread, 0);
+}
@@ -0,0 +1,52 @@
+#ifndef MMIO_H
+#define MMIO_H
+
+//host side memory mapped peripheral emulation (x86-64 Linux)
+//
+//every peripheral block gets two mappings of the same memory: the "view" that firmware code uses through
+//the usual CAN1->TSR style pointers , and an "alias" that the peripheral models use
+//the view is write protected (and read protected for blocks whose reads have side effects) ,
+//a faulting access is single stepped with the page opened up and the model is told about it afterwards
+//so write 1 to clear bits , read to clear flags and read only registers all behave like the real chip
+//
+//interrupts are delivered to the firmware (main) thread as a signal , the handler calls the IRQHandler
+//functions the firmware defines , __disable_irq() blocks that signal
+//handlers never nest , NVIC priorities only decide which pending one runs next
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef void (*mmio_write_fn)(void *ctx, uint32_t offset, uint32_t old, uint32_t val);
+typedef void (*mmio_read_fn)(void *ctx, uint32_t offset, int after);
+
+//returns the firmware view , *alias receives the model side mapping , both are zero filled
+void *mmio_map(size_t size, int trap_reads, mmio_write_fn on_write, mmio_read_fn on_read, void *ctx, void **alias);
+
+//bus master access for the DMA model , addr is what firmware wrote to CPAR / CMAR: the low 32 bits of a host pointer
+//a peripheral view goes through its model as a firmware access would , anything else must lie in the program's
+//own static data (DMA buffers on the stack or the heap cannot be reached) , returns 0 on a bus error
+int mmio_bus_read(uint32_t addr, int size, uint32_t *val);
+int mmio_bus_write(uint32_t addr, int size, uint32_t val);
+
+//one lock for all the peripheral models , held by the fault handlers and by the simulator thread
+void hw_lock(void);
+void hw_unlock(void);
+
+//virtual time , scale < 1 runs the simulated chip slower than the wall clock
+void sim_set_time_scale(double scale);
+uint64_t sim_now_ns(void);
+uint32_t sim_cycles(void);		//core clock cycles since start (DWT->CYCCNT)
+
+//models run from the simulator thread , step() is called with hw_lock held and returns when it next needs to run
+//returning a time that is already due handles one event per call , the firmware's interrupts run in between
+typedef uint64_t (*sim_step_fn)(void *ctx, uint64_t now_ns);
+void sim_add_model(sim_step_fn step, void *ctx);
+void sim_kick(void);			//wake the simulator thread early (call with hw_lock held)
+void sim_start(void);			//installs the fault handlers and starts the simulator thread , device.c does this before main()
+void sim_stop(void);
+
+//NVIC , called by the models with hw_lock held
+void nvic_set_level(int irqn, int level);	//level sensitive request line of a peripheral
+void nvic_pend(int irqn);			//one shot request (SysTick) , cleared when the handler runs
+
+#endif
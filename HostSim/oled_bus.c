@@ -0,0 +1,279 @@
+//bus cost of SSD1306_UpdateScreen() ("SSD1306 OLED DRIVER/ssd1306.c") on I2C2 with oledsim.c as the panel
+//
+//  gcc -O2 -I HostSim -I MyDrivers -I "SSD1306 OLED DRIVER" HostSim/mmio.c HostSim/device.c HostSim/periph.c
+//      HostSim/oledsim.c HostSim/oled_bus.c "SSD1306 OLED DRIVER/ssd1306.c" "SSD1306 OLED DRIVER/fonts.c"
+//      MyDrivers/myi2c.c -lpthread -lm -o oled_bus
+//  ./oled_bus                       exit status 0 when every check passes
+//
+//every workload is counted in bytes on the bus (address and control bytes included) and timed in virtual time twice:
+//how long the bus is busy and how long the program is held up in SSD1306_UpdateScreen() (the transfers run from
+//interrupts , an update has to return in a fraction of the bus time of a full frame) , after each workload the panel RAM must come
+//out the same as after a full rewrite of the frame buffer
+//
+//a NACK of the window commands or of a page in the middle of an update must still get the frame to the panel by the
+//next update
+//
+//the workloads run at 400 kHz as the demo does (381 kHz from the 8 MHz HSI) , a full screen animation runs for a second
+//at 100 and 400 kHz and must make ANIM_MIN_FPS at 400 , i2c_timing() is checked against values worked out from RM0008
+
+#include <stdio.h>
+#include <string.h>
+#include "mmio.h"
+#include "oledsim.h"
+#include "ssd1306.h"
+
+#define FULL_BYTES (2 + 1024)			//one data write , the window is still set from SSD1306_Init()
+#define WINDOW_BYTES (2 + 6)			//a command write that sets both
+#define HELD_SHARE 0.1				//of the bus time of a full frame an update may hold the program up
+#define ANIM_MIN_FPS 30
+
+typedef struct
+{
+	uint32_t pclk1;
+	uint32_t hz;
+	int err;
+	i2c_timing_t want;		//checked when err is 0
+} timing_case_t;
+
+static const timing_case_t timing_cases[] =
+{
+	{ .pclk1 = 8000000, .hz = 100000, .want = { 8, 40, 9, 100000 } },			//the demo's old hand worked values
+	{ .pclk1 = 36000000, .hz = 100000, .want = { 36, 180, 37, 100000 } },
+	{ .pclk1 = 8000000, .hz = 400000, .want = { 8, 0x8000 | 7, 3, 380952 } },		//2:1 at 7 beats 16:9 at 1 (320 kHz)
+	{ .pclk1 = 36000000, .hz = 400000, .want = { 36, 0x8000 | 30, 11, 400000 } },
+	{ .pclk1 = 10000000, .hz = 400000, .want = { 10, 0xC000 | 1, 4, 400000 } },		//16:9 only hits it on a multiple of 10 MHz
+	{ .pclk1 = 24000000, .hz = 50000, .want = { 24, 240, 25, 50000 } },
+	{ .pclk1 = 4000000, .hz = 1000, .want = { 4, 2000, 5, 1000 } },
+	{ .pclk1 = 36000000, .hz = 1000, .err = I2C_ERR_CLOCK },				//CCR over 12 bits
+	{ .pclk1 = 1000000, .hz = 100000, .err = I2C_ERR_CLOCK },
+	{ .pclk1 = 40000000, .hz = 100000, .err = I2C_ERR_CLOCK },
+	{ .pclk1 = 3000000, .hz = 400000, .err = I2C_ERR_CLOCK },
+	{ .pclk1 = 36000000, .hz = 1000000, .err = I2C_ERR_CLOCK },
+	{ .pclk1 = 8000000, .hz = 0, .err = I2C_ERR_CLOCK },
+};
+
+static int failed;
+static uint64_t full_ns;			//bus time of a full frame
+
+static void check_timing(void)
+{
+	int bad = 0;
+
+	for (uint32_t i = 0; i < sizeof(timing_cases) / sizeof(timing_cases[0]); i++)
+	{
+		const timing_case_t *c = &timing_cases[i];
+		i2c_timing_t t;
+		int err = i2c_timing(c->pclk1, c->hz, &t);
+
+		if (err != c->err || (!err && memcmp(&t, &c->want, sizeof(t))))
+		{
+			printf("timing PCLK1 %u Hz , SCL %u Hz: err %d CR2 %u CCR 0x%04x TRISE %u SCL %u , want err %d CR2 %u CCR 0x%04x"
+				" TRISE %u SCL %u\n", c->pclk1, c->hz, err, t.cr2, t.ccr, t.trise, t.scl_hz, c->err, c->want.cr2,
+				c->want.ccr, c->want.trise, c->want.scl_hz);
+			bad++;
+		}
+	}
+	printf("%-26s %u cases %s\n", "i2c_timing", (unsigned) (sizeof(timing_cases) / sizeof(timing_cases[0])), bad ? "FAIL" : "ok");
+	failed |= bad != 0;
+}
+
+static void i2c_init(void)
+{
+	//as in "SSD1306 OLED DRIVER/main.c"
+	RCC->APB1ENR |= RCC_APB1ENR_I2C2EN;
+	i2c_tx_clock(400000);
+	I2C2->CR1 |= I2C_CR1_ACK;
+	I2C2->CR1 |= I2C_CR1_PE;
+}
+
+//an update returns long before its last byte is on the bus
+static void settle(void)
+{
+	i2c_tx_flush();
+}
+
+//the panel must show what a full rewrite would give it
+static int panel_matches(void)
+{
+	static uint8_t dirty[8][128], full[8][128];
+
+	settle();
+	oledsim_ram(dirty);
+	SSD1306_Invalidate();
+	SSD1306_UpdateScreen();
+	settle();
+	oledsim_ram(full);
+	return !memcmp(dirty, full, sizeof(dirty));
+}
+
+static void report(const char *name, uint32_t updates, const oledsim_stats_t *st, uint64_t held_ns, int ok)
+{
+	double bus = (double) st->busy_ns / updates, held = (double) held_ns / updates;
+
+	printf("%-26s %4u updates , %7.1f bytes , bus %7.3f ms (%5.1f%% of a full frame) , held up %6.3f ms %s\n", name,
+		updates, (double) st->bytes / updates, bus / 1e6, full_ns ? 100.0 * bus / full_ns : 100.0, held / 1e6,
+		ok ? "ok" : "FAIL");
+	failed |= !ok;
+}
+
+//runs draw() then an update , n times , each update once the last is out
+static void workload(const char *name, uint32_t n, void (*draw)(uint32_t i), uint32_t max_bytes)
+{
+	oledsim_stats_t st;
+	uint64_t t, held = 0;
+
+	settle();
+	oledsim_clear_stats();
+	for (uint32_t i = 0; i < n; i++)
+	{
+		draw(i);
+		t = sim_now_ns();
+		SSD1306_UpdateScreen();
+		held += sim_now_ns() - t;
+		settle();
+	}
+	oledsim_stats(&st);
+	report(name, n, &st, held, st.bytes <= max_bytes * n && held <= HELD_SHARE * full_ns * n && panel_matches());
+}
+
+static void draw_pixel(uint32_t i)
+{
+	SSD1306_DrawPixel(64, 32, i & 1 ? SSD1306_COLOR_BLACK : SSD1306_COLOR_WHITE);
+}
+
+static void draw_counter(uint32_t i)
+{
+	char s[8];
+
+	snprintf(s, sizeof(s), "%5u", (unsigned) i * 7);
+	SSD1306_GotoXY(0, 0);
+	SSD1306_Puts(s, &Font_7x10, SSD1306_COLOR_WHITE);
+}
+
+static void draw_clock(uint32_t i)
+{
+	char s[12];
+	uint32_t t = 12 * 3600 + 34 * 60 + 50 + i;
+
+	snprintf(s, sizeof(s), "%02u:%02u:%02u", (unsigned) (t / 3600 % 24), (unsigned) (t / 60 % 60), (unsigned) (t % 60));
+	SSD1306_GotoXY(20, 30);
+	SSD1306_Puts(s, &Font_11x18, SSD1306_COLOR_WHITE);
+}
+
+static void on_done(int err, void *ctx)
+{
+	*(int *) ctx = err;
+}
+
+//every byte of the screen changes every frame , the next frame is drawn as soon as the last one is out
+static void animation(uint32_t hz, double min_fps)
+{
+	uint64_t end;
+	uint32_t frames = 0;
+	i2c_timing_t t;
+
+	settle();
+	i2c_tx_clock(hz);
+	i2c_timing(8000000, hz, &t);
+	end = sim_now_ns() + 1000000000ULL;
+	while (sim_now_ns() < end)
+	{
+		while (SSD1306_UpdateBusy())
+			;
+		SSD1306_Fill(SSD1306_COLOR_BLACK);
+		SSD1306_DrawFilledCircle(frames * 3 % SSD1306_WIDTH, 32, 20, SSD1306_COLOR_WHITE);
+		SSD1306_ToggleInvert();
+		SSD1306_UpdateScreen();
+		frames++;
+	}
+	printf("%-19s %3u kHz %4u frames per second (at least %.0f) %s\n", "animation", t.scl_hz / 1000, frames, min_fps,
+		frames >= min_fps && panel_matches() ? "ok" : "FAIL");
+	failed |= frames < min_fps || !panel_matches();
+}
+
+static void draw_invert(uint32_t i)
+{
+	(void) i;
+	SSD1306_ToggleInvert();
+}
+
+static void draw_clear(uint32_t i)
+{
+	(void) i;
+	SSD1306_Fill(SSD1306_COLOR_BLACK);
+}
+
+int main(void)
+{
+	oledsim_stats_t st;
+	uint64_t t, held;
+	int ok;
+
+	check_timing();
+	i2c_init();
+	oledsim_attach(I2C2, SSD1306_I2C_ADDR >> 1);
+	SSD1306_Init();
+
+	settle();
+	oledsim_clear_stats();
+	SSD1306_Invalidate();
+	t = sim_now_ns();
+	SSD1306_UpdateScreen();
+	held = sim_now_ns() - t;
+	settle();
+	oledsim_stats(&st);
+	full_ns = st.busy_ns;
+	report("full frame", 1, &st, held, st.bytes == FULL_BYTES && held <= HELD_SHARE * full_ns);
+
+	oledsim_clear_stats();
+	SSD1306_UpdateScreen();
+	settle();
+	oledsim_stats(&st);
+	printf("%-26s %u bytes %s\n", "nothing changed", st.bytes, st.bytes ? "FAIL" : "ok");
+	failed |= st.bytes != 0;
+
+	workload("one pixel", 20, draw_pixel, WINDOW_BYTES + 2 + 1);
+	workload("counter , Font_7x10", 100, draw_counter, FULL_BYTES / 8);
+	workload("clock , Font_11x18", 60, draw_clock, FULL_BYTES / 4);
+	workload("invert", 2, draw_invert, WINDOW_BYTES + FULL_BYTES);
+
+	//nobody at 0x38 , the update queued behind it must still get through
+	{
+		static const uint8_t probe[] = { 0x00, 0xAF };
+		int err = 0;
+
+		i2c_tx_write(0x38 << 1, probe[0], &probe[1], 1, on_done, &err);
+		SSD1306_DrawPixel(3, 3, SSD1306_COLOR_WHITE);
+		SSD1306_UpdateScreen();
+		settle();
+		ok = err == I2C_ERR_NACK && panel_matches();
+		printf("%-26s err %d , %u errors %s\n", "NACK", err, i2c_tx_stats.errors, ok ? "ok" : "FAIL");
+		failed |= !ok;
+	}
+
+	//the panel refuses a window or a page that is not the last of its update , the next update sends the frame again
+	for (uint32_t n = 1; n <= 3; n++)
+	{
+		uint32_t errors = i2c_tx_stats.errors;
+
+		settle();
+		SSD1306_DrawPixel(3, 3, n & 1 ? SSD1306_COLOR_BLACK : SSD1306_COLOR_WHITE);		//page 0
+		SSD1306_DrawPixel(100, 60, n & 1 ? SSD1306_COLOR_WHITE : SSD1306_COLOR_BLACK);	//page 7
+		oledsim_nack(n);
+		SSD1306_UpdateScreen();
+		settle();
+		SSD1306_UpdateScreen();
+		settle();
+		ok = i2c_tx_stats.errors == errors + 1 && panel_matches();
+		printf("%-19s part %u %u errors %s\n", "NACK mid update", n, i2c_tx_stats.errors - errors, ok ? "ok" : "FAIL");
+		failed |= !ok;
+	}
+
+	workload("clear", 1, draw_clear, WINDOW_BYTES + FULL_BYTES);
+
+	animation(100000, 0);
+	animation(400000, ANIM_MIN_FPS);
+
+	printf(failed ? "FAILED\n" : "all passed\n");
+	return failed;
+}
@@ -0,0 +1,187 @@
+//SSD1306 panel model , see oledsim.h
+
+#include <string.h>
+#include "mmio.h"
+#include "periph.h"
+#include "oledsim.h"
+
+enum { MODE_HORIZONTAL, MODE_VERTICAL, MODE_PAGE };
+
+static struct
+{
+	uint8_t ram[8][128];
+	int mode;
+	uint8_t col, page;
+	uint8_t col_start, col_end, page_start, page_end;
+	int open;			//inside a transaction
+	uint64_t open_ns;
+	int expect_control;		//the next byte is a control byte
+	int data;			//D/C of the bytes that follow
+	int single;			//Co set , one byte then a control byte again
+	uint8_t cmd;			//command waiting for arguments
+	uint8_t args[6];
+	int nargs, need;
+	uint32_t nack;			//transactions to go until one is refused , 0 none
+	oledsim_stats_t stats;
+} oled = { .mode = MODE_PAGE, .col_end = 127, .page_end = 7 };
+
+static int arg_count(uint8_t cmd)
+{
+	switch (cmd)
+	{
+	case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+		return 1;
+	case 0x21: case 0x22: case 0xA3:
+		return 2;
+	case 0x29: case 0x2A:
+		return 5;
+	case 0x26: case 0x27:
+		return 6;
+	default:
+		return 0;
+	}
+}
+
+static void command(uint8_t cmd, const uint8_t *a)
+{
+	if (cmd == 0x20)
+		oled.mode = (a[0] & 3) == 3 ? MODE_PAGE : a[0] & 3;	//3 is invalid , taken as the reset mode
+	else if (cmd == 0x21)
+	{
+		oled.col = oled.col_start = a[0] & 0x7F;
+		oled.col_end = a[1] & 0x7F;
+	}
+	else if (cmd == 0x22)
+	{
+		oled.page = oled.page_start = a[0] & 7;
+		oled.page_end = a[1] & 7;
+	}
+	else if (cmd < 0x10 && oled.mode == MODE_PAGE)
+		oled.col = (oled.col & 0xF0) | cmd;
+	else if (cmd >= 0x10 && cmd < 0x18 && oled.mode == MODE_PAGE)
+		oled.col = (oled.col & 0x0F) | (cmd & 7) << 4;
+	else if (cmd >= 0xB0 && cmd < 0xB8 && oled.mode == MODE_PAGE)
+		oled.page = cmd & 7;
+}
+
+static void command_byte(uint8_t byte)
+{
+	oled.stats.command_bytes++;
+	if (oled.need)
+	{
+		oled.args[oled.nargs++] = byte;
+		if (oled.nargs == oled.need)
+		{
+			command(oled.cmd, oled.args);
+			oled.need = 0;
+		}
+		return;
+	}
+	oled.cmd = byte;
+	oled.nargs = 0;
+	oled.need = arg_count(byte);
+	if (!oled.need)
+		command(byte, 0);
+}
+
+//the pointers move as the addressing mode says , page mode stays on its page
+static void data_byte(uint8_t byte)
+{
+	oled.stats.data_bytes++;
+	oled.ram[oled.page][oled.col] = byte;
+	switch (oled.mode)
+	{
+	case MODE_PAGE:
+		oled.col = (oled.col + 1) & 0x7F;
+		break;
+	case MODE_HORIZONTAL:
+		if (oled.col++ < oled.col_end)
+			break;
+		oled.col = oled.col_start;
+		oled.page = oled.page < oled.page_end ? oled.page + 1 : oled.page_start;
+		break;
+	case MODE_VERTICAL:
+		if (oled.page++ < oled.page_end)
+			break;
+		oled.page = oled.page_start;
+		oled.col = oled.col < oled.col_end ? oled.col + 1 : oled.col_start;
+		break;
+	}
+}
+
+static void close_transaction(uint64_t t_ns)
+{
+	if (oled.open)
+		oled.stats.busy_ns += t_ns - oled.open_ns;
+	oled.open = 0;
+}
+
+static int on_bus(int event, uint8_t byte, uint64_t t_ns, void *ctx)
+{
+	(void) ctx;
+	if (event == PERIPH_I2C_STOP)
+	{
+		close_transaction(t_ns);
+		return 1;
+	}
+	oled.stats.bytes++;
+	if (event == PERIPH_I2C_START)
+	{
+		if (byte & 1)
+			return 0;			//write only over I2C
+		if (oled.nack && !--oled.nack)
+			return 0;
+		close_transaction(t_ns);
+		oled.open = 1;
+		oled.open_ns = t_ns;
+		oled.stats.transactions++;
+		oled.expect_control = 1;
+		return 1;
+	}
+	if (oled.expect_control)
+	{
+		oled.data = byte & 0x40;
+		oled.single = byte & 0x80;
+		oled.expect_control = 0;
+		return 1;
+	}
+	if (oled.data)
+		data_byte(byte);
+	else
+		command_byte(byte);
+	oled.expect_control = oled.single;
+	return 1;
+}
+
+void oledsim_attach(I2C_TypeDef *i2c, uint8_t addr7)
+{
+	periph_i2c_device(i2c, addr7, on_bus, 0);
+}
+
+void oledsim_ram(uint8_t ram[8][128])
+{
+	hw_lock();
+	memcpy(ram, oled.ram, sizeof(oled.ram));
+	hw_unlock();
+}
+
+void oledsim_stats(oledsim_stats_t *stats)
+{
+	hw_lock();
+	*stats = oled.stats;
+	hw_unlock();
+}
+
+void oledsim_clear_stats(void)
+{
+	hw_lock();
+	memset(&oled.stats, 0, sizeof(oled.stats));
+	hw_unlock();
+}
+
+void oledsim_nack(uint32_t n)
+{
+	hw_lock();
+	oled.nack = n;
+	hw_unlock();
+}
@@ -0,0 +1,28 @@
+#ifndef OLEDSIM_H
+#define OLEDSIM_H
+
+//SSD1306 128 x 64 panel on a periph.c I2C bus , link oledsim.c in next to periph.c
+//
+//control bytes (Co , D/C) , every command with its argument count , page , horizontal and vertical addressing with
+//the 0x21 / 0x22 windows and the page mode column and page commands all act on the 8 x 128 display RAM as on the chip ,
+//scrolling , contrast , remap and the like are counted and otherwise ignored
+
+#include <stdint.h>
+#include "stm32f1xx.h"
+
+typedef struct
+{
+	uint32_t transactions;		//start to stop , a repeated start counts again
+	uint32_t bytes;			//on the bus , address and control bytes included
+	uint32_t command_bytes;		//commands and their arguments
+	uint32_t data_bytes;		//display RAM writes
+	uint64_t busy_ns;		//end of the address byte to the stop , summed over the transactions
+} oledsim_stats_t;
+
+void oledsim_attach(I2C_TypeDef *i2c, uint8_t addr7);	//0x3C for the usual modules , call once
+void oledsim_ram(uint8_t ram[8][128]);			//copy of the display RAM , [page][column]
+void oledsim_stats(oledsim_stats_t *stats);
+void oledsim_clear_stats(void);
+void oledsim_nack(uint32_t n);				//refuse the address of the n th transaction from now , 1 the next
+
+#endif
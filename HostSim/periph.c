@@ -0,0 +1,1857 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "mmio.h"
+#include "periph.h"
+
+#define NONE (~0ULL)
+#define POLL_NS 1000000ULL		//input files and FIFOs are looked at every simulated ms
+#define HSI_HZ 8000000
+
+//the firmware views , device.c only has plain memory for these when this file is left out
+RCC_TypeDef *RCC;
+GPIO_TypeDef *GPIOA, *GPIOB, *GPIOC;
+TIM_TypeDef *TIM1, *TIM2, *TIM3, *TIM4;
+USART_TypeDef *USART1, *USART2, *USART3;
+ADC_TypeDef *ADC1, *ADC2;
+I2C_TypeDef *I2C1, *I2C2;
+DMA_TypeDef *DMA1;
+DMA_Channel_TypeDef *DMA1_Channel1, *DMA1_Channel2, *DMA1_Channel3, *DMA1_Channel4;
+DMA_Channel_TypeDef *DMA1_Channel5, *DMA1_Channel6, *DMA1_Channel7;
+
+static int in_step;
+static uint64_t step_ns;		//time of the event being handled , stamps everything it sets off
+
+static uint64_t now_ns(void)
+{
+	return in_step ? step_ns : sim_now_ns();
+}
+
+static FILE *open_out(const char *env)
+{
+	const char *path = getenv(env);
+	FILE *f;
+
+	if (!path)
+		return 0;
+	if (!strcmp(path, "-"))
+		return stdout;
+	f = fopen(path, "w");
+	if (!f)
+		perror(path);
+	else
+		setvbuf(f, 0, _IOLBF, 0);
+	return f;
+}
+
+//------------------------------------------------------------------ RCC , clock tree
+
+static RCC_TypeDef *rcc;
+static uint32_t hse_hz = 8000000;
+
+static uint32_t sysclk(uint32_t cfgr)
+{
+	uint32_t mul = ((cfgr >> 18) & 0xF) + 2;
+
+	if ((cfgr & RCC_CFGR_SWS) == RCC_CFGR_SWS_HSE)
+		return hse_hz;
+	if ((cfgr & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL)
+		return HSI_HZ;
+	if (mul > 16)
+		mul = 16;
+	if (!(cfgr & RCC_CFGR_PLLSRC))
+		return HSI_HZ / 2 * mul;
+	return (cfgr & RCC_CFGR_PLLXTPRE ? hse_hz / 2 : hse_hz) * mul;
+}
+
+static uint32_t hclk_of(uint32_t cfgr)
+{
+	static const uint8_t shift[8] = { 1, 2, 3, 4, 6, 7, 8, 9 };
+	uint32_t hpre = (cfgr >> 4) & 0xF;
+
+	return sysclk(cfgr) >> (hpre & 0x8 ? shift[hpre & 0x7] : 0);
+}
+
+static uint32_t pclk_of(uint32_t cfgr, int apb)
+{
+	uint32_t ppre = (cfgr >> (apb == 1 ? 8 : 11)) & 0x7;
+
+	return hclk_of(cfgr) >> ((ppre & 0x4) ? (ppre & 0x3) + 1 : 0);
+}
+
+static uint32_t pclk(int apb)
+{
+	return pclk_of(rcc->CFGR, apb);
+}
+
+//timers run at twice PCLK when the APB is divided
+static uint32_t timclk_of(uint32_t cfgr, int apb)
+{
+	uint32_t ppre = (cfgr >> (apb == 1 ? 8 : 11)) & 0x7;
+
+	return (ppre & 0x4) ? 2 * pclk_of(cfgr, apb) : pclk_of(cfgr, apb);
+}
+
+static void tim_clock_change(uint32_t old_cfgr);
+
+static void rcc_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+{
+	uint32_t ready;
+
+	(void) ctx;
+	if (off == 0x00)
+	{
+		//oscillators and the PLL lock at once
+		val &= ~(RCC_CR_HSIRDY | RCC_CR_HSERDY | RCC_CR_PLLRDY);
+		if (val & RCC_CR_HSION)
+			val |= RCC_CR_HSIRDY;
+		if (val & RCC_CR_HSEON)
+			val |= RCC_CR_HSERDY;
+		if (val & RCC_CR_PLLON)
+			val |= RCC_CR_PLLRDY;
+		rcc->CR = val;
+	}
+	else if (off == 0x04)
+	{
+		static const uint32_t rdy[3] = { RCC_CR_HSIRDY, RCC_CR_HSERDY, RCC_CR_PLLRDY };
+		uint32_t sw = val & RCC_CFGR_SW;
+
+		ready = sw < 3 && (rcc->CR & rdy[sw]);
+		val = (val & ~RCC_CFGR_SWS) | (ready ? sw << 2 : old & RCC_CFGR_SWS);
+		rcc->CFGR = val;
+		if (hclk_of(old) != hclk_of(val) || pclk_of(old, 1) != pclk_of(val, 1) || pclk_of(old, 2) != pclk_of(val, 2))
+			tim_clock_change(old);
+	}
+}
+
+void SystemCoreClockUpdate(void)
+{
+	hw_lock();
+	SystemCoreClock = hclk_of(rcc->CFGR);
+	hw_unlock();
+}
+
+//------------------------------------------------------------------ GPIO
+
+typedef struct
+{
+	GPIO_TypeDef *view, *r;
+	const char *name;
+	uint32_t ext_mask;		//pins driven from outside
+	uint32_t ext_level;
+	uint32_t logged;		//ODR the monitors last saw
+} gpio_t;
+
+static gpio_t gpios[3] = { { .name = "GPIOA" }, { .name = "GPIOB" }, { .name = "GPIOC" } };
+static periph_gpio_fn gpio_fn;
+static void *gpio_ctx;
+static FILE *gpio_log;
+
+static void gpio_settle(gpio_t *g)
+{
+	uint32_t odr = g->r->ODR & 0xFFFF;
+
+	g->r->IDR = (odr & ~g->ext_mask) | (g->ext_level & g->ext_mask);
+	if (odr == g->logged)
+		return;
+	g->logged = odr;
+	if (gpio_log)
+		fprintf(gpio_log, "%.3f %s 0x%04x\n", now_ns() / 1e6, g->name, odr);
+	if (gpio_fn)
+		gpio_fn(g->view, odr, now_ns(), gpio_ctx);
+}
+
+static void gpio_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+{
+	gpio_t *g = ctx;
+
+	if (off == 0x08)
+		g->r->IDR = old;				//read only
+	else if (off == 0x0C)
+		g->r->ODR = val & 0xFFFF;
+	else if (off == 0x10)
+	{
+		g->r->ODR = ((g->r->ODR & ~(val >> 16)) | val) & 0xFFFF;	//set wins over reset
+		g->r->BSRR = 0;
+	}
+	else if (off == 0x14)
+	{
+		g->r->ODR &= ~val;
+		g->r->BRR = 0;
+	}
+	gpio_settle(g);
+}
+
+//------------------------------------------------------------------ DMA1
+
+//one request bit per peripheral that may ask a channel for transfers while its flag is up (USART)
+#define LINE_TX 0x1
+#define LINE_RX 0x2
+#define LINE_I2C 0x4			//I2C2 TX shares channel 4 with USART1 TX
+
+typedef struct
+{
+	DMA_Channel_TypeDef *r;		//alias
+	uint32_t par, mar;		//addresses of the next transfer
+	uint32_t count, reload;
+	uint32_t pulses;		//event requests not served yet (timers , ADC)
+	uint32_t lines;			//level requests , LINE_x of each USART
+} dmach_t;
+
+static DMA_TypeDef *dma;
+static dmach_t dmach[7];
+static int dma_busy, dma_again;
+
+static void dma_irqs(void)
+{
+	for (int n = 0; n < 7; n++)
+	{
+		uint32_t flags = (dma->ISR >> (4 * n)) & 0xE;
+
+		nvic_set_level(DMA1_Channel1_IRQn + n, flags & dmach[n].r->CCR);	//TCIE , HTIE , TEIE line up with the flags
+	}
+}
+
+static void dma_flag(int n, uint32_t flags)
+{
+	dma->ISR |= (flags | DMA_ISR_GIF1) << (4 * n);
+}
+
+static void dma_transfer(int n)
+{
+	dmach_t *c = &dmach[n];
+	uint32_t ccr = c->r->CCR;
+	int psize = 1 << ((ccr >> 8) & 0x3), msize = 1 << ((ccr >> 10) & 0x3);
+	uint32_t v;
+	int ok;
+
+	psize = psize > 4 ? 4 : psize;
+	msize = msize > 4 ? 4 : msize;
+	if (ccr & DMA_CCR_DIR)
+		ok = mmio_bus_read(c->mar, msize, &v) && mmio_bus_write(c->par, psize, v);
+	else
+		ok = mmio_bus_read(c->par, psize, &v) && mmio_bus_write(c->mar, msize, v);
+	if (!ok)
+	{
+		dma_flag(n, DMA_ISR_TEIF1);		//bus error , the channel turns itself off
+		c->r->CCR &= ~DMA_CCR_EN;
+		return;
+	}
+	if (ccr & DMA_CCR_PINC)
+		c->par += psize;
+	if (ccr & DMA_CCR_MINC)
+		c->mar += msize;
+	c->count--;
+	if (c->reload > 1 && c->reload - c->count == c->reload / 2)
+		dma_flag(n, DMA_ISR_HTIF1);
+	if (!c->count)
+	{
+		dma_flag(n, c->reload == 1 ? DMA_ISR_TCIF1 | DMA_ISR_HTIF1 : DMA_ISR_TCIF1);
+		if (ccr & DMA_CCR_CIRC)
+		{
+			c->count = c->reload;
+			c->par = c->r->CPAR;
+			c->mar = c->r->CMAR;
+		}
+	}
+	c->r->CNDTR = c->count;
+}
+
+//serves every channel with a request up , peripherals that react to a transfer may call back in here
+static void dma_service(void)
+{
+	if (dma_busy)
+	{
+		dma_again = 1;
+		return;
+	}
+	dma_busy = 1;
+	do
+	{
+		dma_again = 0;
+		for (int n = 0; n < 7; n++)
+		{
+			dmach_t *c = &dmach[n];
+
+			for (int guard = 0; guard < 0x10000; guard++)
+			{
+				if (!(c->r->CCR & DMA_CCR_EN) || !c->count || (!c->pulses && !c->lines))
+					break;
+				if (c->pulses)
+					c->pulses--;
+				dma_transfer(n);
+			}
+		}
+	} while (dma_again);
+	dma_busy = 0;
+	dma_irqs();
+}
+
+//n: DMA1 channel 1 .. 7 , 0 for a request that has no channel
+static void dma_pulse(int n, uint32_t transfers)
+{
+	if (!n)
+		return;
+	if (dmach[n - 1].pulses < transfers)
+		dmach[n - 1].pulses = transfers;	//a request line is one bit , repeats before it is served merge
+	dma_service();
+}
+
+static void dma_line(int n, uint32_t line, int on)
+{
+	uint32_t before;
+
+	if (!n)
+		return;
+	before = dmach[n - 1].lines;
+	dmach[n - 1].lines = on ? before | line : before & ~line;
+	if (on && !(before & line))
+		dma_service();
+}
+
+static void dma_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+{
+	(void) ctx;
+	if (off == 0x00)
+		dma->ISR = old;					//read only
+	else if (off == 0x04)
+	{
+		for (int n = 0; n < 7; n++)
+			if (val & (DMA_IFCR_CGIF1 << (4 * n)))
+				val |= 0xF << (4 * n);		//CGIF clears all four
+		dma->ISR &= ~val;
+		dma->IFCR = 0;
+	}
+	else if (off >= 0x08 && off < 0x08 + 7 * 0x14)
+	{
+		int n = (off - 0x08) / 0x14;
+		dmach_t *c = &dmach[n];
+		uint32_t reg = (off - 0x08) % 0x14;
+
+		if (reg == 0x00)
+		{
+			c->r->CCR = val & 0x7FFF;
+			if ((val & DMA_CCR_EN) && !(old & DMA_CCR_EN))
+			{
+				c->par = c->r->CPAR;
+				c->mar = c->r->CMAR;
+				c->count = c->reload = c->r->CNDTR;
+				if (val & DMA_CCR_MEM2MEM)
+					c->pulses = c->count;	//memory to memory runs through at once
+			}
+		}
+		else if (reg == 0x04)
+			c->r->CNDTR = (c->r->CCR & DMA_CCR_EN) ? old : val & 0xFFFF;	//read only while enabled
+		else if (reg == 0x10)
+			*(volatile uint32_t *) ((uint8_t *) dma + off) = 0;
+	}
+	dma_service();
+}
+
+//------------------------------------------------------------------ TIM1 .. TIM4
+
+typedef struct
+{
+	TIM_TypeDef *view, *r;
+	const char *name;
+	int n;				//1 .. 4
+	int apb;
+	uint8_t dma_up, dma_cc[4];	//DMA1 channel of each request , 0 none
+	uint8_t itr[4];			//timer on ITR0 .. 3 , 0 none
+	int8_t adc_sel[4];		//ADC EXTSEL code of each compare event , -1 none
+	int running;
+	uint64_t start_ns;		//virtual time the counter was 0 in this period
+	uint32_t psc, arr, ccr[4];	//active values , the registers hold what is preloaded
+	uint32_t rep;
+	uint8_t cc_done;		//compare events already handled in this period
+	uint8_t burst;			//next DMAR access
+	periph_pwm_t pwm[4];		//last captured
+} tim_t;
+
+static tim_t tims[4] =
+{
+	{ .name = "TIM1", .n = 1, .apb = 2, .dma_up = 5, .dma_cc = { 2, 3, 6, 4 }, .itr = { 0, 2, 3, 4 }, .adc_sel = { 0, 1, 2, -1 } },
+	{ .name = "TIM2", .n = 2, .apb = 1, .dma_up = 2, .dma_cc = { 5, 7, 1, 7 }, .itr = { 1, 0, 3, 4 }, .adc_sel = { -1, 3, -1, -1 } },
+	{ .name = "TIM3", .n = 3, .apb = 1, .dma_up = 3, .dma_cc = { 6, 0, 2, 3 }, .itr = { 1, 2, 0, 4 }, .adc_sel = { -1, -1, -1, -1 } },
+	{ .name = "TIM4", .n = 4, .apb = 1, .dma_up = 7, .dma_cc = { 1, 4, 5, 0 }, .itr = { 1, 2, 3, 0 }, .adc_sel = { -1, -1, -1, 5 } },
+};
+
+static periph_pwm_fn pwm_fn;
+static void *pwm_ctx;
+static FILE *pwm_log;
+
+static int adc_wants(int sel);
+static void adc_trigger(int sel);
+
+#define TIM_REG(r, off) (*(volatile uint32_t *) ((uint8_t *) (r) + (off)))
+#define TIM_MMS(t) (((t)->r->CR2 >> 4) & 0x7)
+
+static uint64_t tim_ticks_ns(tim_t *t, uint64_t ticks)
+{
+	return (uint64_t) ((unsigned __int128) ticks * (t->psc + 1) * 1000000000ULL / timclk_of(rcc->CFGR, t->apb));
+}
+
+static uint32_t tim_count(tim_t *t, uint64_t now)
+{
+	uint64_t c;
+
+	if (!t->running)
+		return t->r->CNT;
+	if (now <= t->start_ns)
+		return 0;
+	c = (unsigned __int128) (now - t->start_ns) * timclk_of(rcc->CFGR, t->apb) / ((uint64_t) (t->psc + 1) * 1000000000ULL);
+	return c % (t->arr + 1);		//the update may be due but not handled yet , the counter wraps all the same
+}
+
+static uint32_t tim_ccmr(tim_t *t, int i)
+{
+	return ((i < 2 ? t->r->CCMR1 : t->r->CCMR2) >> (8 * (i & 1))) & 0xFF;
+}
+
+//compare events somebody acts on get their own event , the others only set their flag
+static int tim_watched(tim_t *t, int i)
+{
+	return (t->r->DIER & ((TIM_DIER_CC1IE | TIM_DIER_CC1DE) << i)) || (i == 0 && TIM_MMS(t) == 3)
+		|| (t->adc_sel[i] >= 0 && adc_wants(t->adc_sel[i]));
+}
+
+static void tim_irqs(tim_t *t)
+{
+	uint32_t f = t->r->SR & t->r->DIER & 0xFF;
+
+	if (t->n == 1)
+	{
+		nvic_set_level(TIM1_UP_IRQn, f & TIM_SR_UIF);
+		nvic_set_level(TIM1_CC_IRQn, f & (TIM_SR_CC1IF | TIM_SR_CC2IF | TIM_SR_CC3IF | TIM_SR_CC4IF));
+		nvic_set_level(TIM1_TRG_COM_IRQn, f & (TIM_SR_TIF | TIM_SR_COMIF));
+		nvic_set_level(TIM1_BRK_IRQn, f & TIM_SR_BIF);
+	}
+	else
+		nvic_set_level(TIM2_IRQn + t->n - 2, f != 0);
+}
+
+static void pwm_capture(tim_t *t)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		periph_pwm_t p = { t->name, i + 1, t->ccr[i], t->arr + 1, 0, now_ns() };
+		uint32_t mode = (tim_ccmr(t, i) >> 4) & 0x7;
+		int on = (t->r->CCER & (TIM_CCER_CC1E << (4 * i))) && (t->n != 1 || (t->r->BDTR & TIM_BDTR_MOE));
+
+		if (tim_ccmr(t, i) & TIM_CCMR1_CC1S)
+			continue;			//input
+		if (mode == 6 || mode == 7)
+			p.duty = p.ccr >= p.period ? 1.0f : (float) p.ccr / p.period;
+		else if (mode == 5)
+			p.duty = 1.0f;
+		else if (mode != 4)
+			continue;			//frozen or output compare , not a steady duty
+		if (mode == 7)
+			p.duty = 1.0f - p.duty;
+		if (on && (t->r->CCER & (TIM_CCER_CC1P << (4 * i))))
+			p.duty = 1.0f - p.duty;
+		if (!on)
+			p.duty = 0;
+		if (p.ccr == t->pwm[i].ccr && p.period == t->pwm[i].period && p.duty == t->pwm[i].duty)
+			continue;
+		t->pwm[i] = p;
+		if (pwm_log)
+			fprintf(pwm_log, "%.3f %s CH%d %u/%u %.2f%%\n", p.t_ns / 1e6, p.tim, p.ch, p.ccr, p.period, 100.0 * p.duty);
+		if (pwm_fn)
+			pwm_fn(&p, pwm_ctx);
+	}
+}
+
+static void tim_update(tim_t *t, uint64_t at, int overflow);
+
+//TRGO of master into the slave mode controllers of the others and the ADC
+static void tim_trgo(tim_t *master, uint64_t at)
+{
+	for (int s = 0; s < 4; s++)
+	{
+		tim_t *t = &tims[s];
+		uint32_t sms = t->r->SMCR & TIM_SMCR_SMS;
+		uint32_t ts = (t->r->SMCR >> 4) & 0x7;
+
+		if (t == master || ts > 3 || t->itr[ts] != master->n || (sms != 4 && sms != 6))
+			continue;
+		t->r->SR |= TIM_SR_TIF;
+		if (sms == 6 && !t->running)
+		{
+			t->r->CR1 |= TIM_CR1_CEN;
+			t->running = 1;
+			t->start_ns = at - tim_ticks_ns(t, t->r->CNT);
+			if (TIM_MMS(t) == 1)
+				tim_trgo(t, at);
+		}
+		else if (sms == 4)
+		{
+			t->r->CNT = 0;
+			tim_update(t, at, 0);
+		}
+		tim_irqs(t);
+	}
+	if (master->n == 3)
+		adc_trigger(4);
+}
+
+//a request , DBL + 1 of them when the channel is pointed at DMAR
+static void tim_dma(tim_t *t, int ch)
+{
+	uint32_t transfers = 1;
+
+	if (!ch)
+		return;
+	if (dmach[ch - 1].r->CPAR == (uint32_t) (uintptr_t) &t->view->DMAR)
+	{
+		transfers = ((t->r->DCR >> 8) & 0x1F) + 1;
+		t->burst = 0;
+	}
+	dma_pulse(ch, transfers);
+}
+
+static void tim_update(tim_t *t, uint64_t at, int overflow)
+{
+	TIM_TypeDef *r = t->r;
+
+	t->start_ns = at;
+	if (overflow)
+		for (int i = 0; i < 4; i++)
+			if (!(t->cc_done & (1 << i)) && t->ccr[i] <= t->arr && !(tim_ccmr(t, i) & TIM_CCMR1_CC1S))
+				r->SR |= TIM_SR_CC1IF << i;	//matched in the period that just ended , nobody was waiting for it
+	t->cc_done = 0;
+	if (overflow && t->rep)
+	{
+		t->rep--;
+		return;
+	}
+	t->rep = r->RCR & 0xFF;
+	if (r->CR1 & TIM_CR1_UDIS)
+		return;
+	t->psc = r->PSC & 0xFFFF;
+	t->arr = r->ARR & 0xFFFF;
+	for (int i = 0; i < 4; i++)
+		if (tim_ccmr(t, i) & TIM_CCMR1_OC1PE)
+			t->ccr[i] = TIM_REG(r, 0x34 + 4 * i) & 0xFFFF;
+	if (overflow && (r->CR1 & TIM_CR1_OPM))
+	{
+		r->CR1 &= ~TIM_CR1_CEN;
+		r->CNT = 0;
+		t->running = 0;
+	}
+	if (overflow || !(r->CR1 & TIM_CR1_URS))
+	{
+		r->SR |= TIM_SR_UIF;
+		if (r->DIER & TIM_DIER_UDE)
+			tim_dma(t, t->dma_up);
+	}
+	if (TIM_MMS(t) == 2 || (TIM_MMS(t) >= 4 && t->ccr[TIM_MMS(t) - 4]))
+		tim_trgo(t, at);		//update , or OCxREF going high at the start of a PWM period
+	pwm_capture(t);
+	tim_irqs(t);
+}
+
+static void tim_compare(tim_t *t, int i, uint64_t at)
+{
+	t->cc_done |= 1 << i;
+	t->r->SR |= TIM_SR_CC1IF << i;
+	if (t->r->DIER & (TIM_DIER_CC1DE << i))
+		tim_dma(t, t->dma_cc[i]);
+	if (i == 0 && TIM_MMS(t) == 3)
+		tim_trgo(t, at);
+	if (t->adc_sel[i] >= 0)
+		adc_trigger(t->adc_sel[i]);
+	tim_irqs(t);
+}
+
+static void tim_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+{
+	tim_t *t = ctx;
+	TIM_TypeDef *r = t->r;
+	uint64_t now = now_ns();
+
+	switch (off)
+	{
+	case 0x00:
+		r->CR1 = val & 0x3FF;
+		if ((val & TIM_CR1_CEN) && !t->running)
+		{
+			t->running = 1;
+			t->start_ns = now - tim_ticks_ns(t, r->CNT);
+			if (TIM_MMS(t) == 1)
+				tim_trgo(t, now);
+		}
+		else if (!(val & TIM_CR1_CEN) && t->running)
+		{
+			r->CNT = tim_count(t, now);
+			t->running = 0;
+		}
+		if (!(val & TIM_CR1_ARPE))
+			t->arr = r->ARR & 0xFFFF;
+		break;
+	case 0x10:
+		r->SR = old & val;				//write 0 to clear
+		break;
+	case 0x14:
+		r->EGR = 0;
+		if (val & TIM_EGR_UG)
+		{
+			r->CNT = 0;
+			tim_update(t, now, 0);
+			if (TIM_MMS(t) == 0)
+				tim_trgo(t, now);
+		}
+		for (int i = 0; i < 4; i++)
+			if (val & (TIM_EGR_CC1G << i))
+				tim_compare(t, i, now);
+		if (val & TIM_EGR_TG)
+			r->SR |= TIM_SR_TIF;
+		break;
+	case 0x24:
+		r->CNT = val & 0xFFFF;
+		if (t->running)
+			t->start_ns = now - tim_ticks_ns(t, r->CNT);
+		t->cc_done = 0;
+		for (int i = 0; i < 4; i++)
+			if (t->ccr[i] < r->CNT)
+				t->cc_done |= 1 << i;		//already behind the counter
+		break;
+	case 0x2C:
+		if (!(r->CR1 & TIM_CR1_ARPE))
+			t->arr = val & 0xFFFF;
+		pwm_capture(t);
+		break;
+	case 0x34: case 0x38: case 0x3C: case 0x40:
+	{
+		int i = (off - 0x34) / 4;
+
+		if (!(tim_ccmr(t, i) & TIM_CCMR1_OC1PE))
+		{
+			t->ccr[i] = val & 0xFFFF;
+			if (t->running)
+			{
+				//a match still ahead of the counter happens in this period
+				t->cc_done &= ~(1 << i);
+				if (t->ccr[i] < tim_count(t, now))
+					t->cc_done |= 1 << i;
+			}
+		}
+		pwm_capture(t);
+		break;
+	}
+	case 0x18: case 0x1C: case 0x20: case 0x44:
+		pwm_capture(t);
+		break;
+	case 0x48:
+		t->burst = 0;
+		break;
+	case 0x4C:
+	{
+		uint32_t target = ((r->DCR & TIM_DCR_DBA) + t->burst) * 4;
+		uint32_t before;
+
+		t->burst = t->burst >= ((r->DCR >> 8) & 0x1F) ? 0 : t->burst + 1;
+		if (target >= 0x4C)
+			break;
+		before = TIM_REG(r, target);
+		TIM_REG(r, target) = val;
+		tim_write(ctx, target, before, val);
+		break;
+	}
+	}
+	tim_irqs(t);
+}
+
+static void tim_read(void *ctx, uint32_t off, int after)
+{
+	tim_t *t = ctx;
+	TIM_TypeDef *r = t->r;
+
+	if (off == 0x24 && !after)
+		r->CNT = tim_count(t, sim_now_ns());
+	else if (off == 0x10 && !after && t->running)
+	{
+		uint32_t cnt = tim_count(t, sim_now_ns());
+
+		for (int i = 0; i < 4; i++)
+			if (!tim_watched(t, i) && t->ccr[i] <= cnt && !(tim_ccmr(t, i) & TIM_CCMR1_CC1S))
+				r->SR |= TIM_SR_CC1IF << i;
+	}
+	else if (off == 0x4C)
+	{
+		if (!after)
+			r->DMAR = TIM_REG(r, ((r->DCR & TIM_DCR_DBA) + t->burst) * 4);
+		else
+			t->burst = t->burst >= ((r->DCR >> 8) & 0x1F) ? 0 : t->burst + 1;
+	}
+}
+
+//the counters keep their count across a change of the clock tree and go on at the new rate
+static void tim_clock_change(uint32_t old_cfgr)
+{
+	uint64_t now = now_ns();
+	uint32_t cfgr = rcc->CFGR;
+	uint32_t cnt[4];
+
+	rcc->CFGR = old_cfgr;
+	for (int i = 0; i < 4; i++)
+		cnt[i] = tim_count(&tims[i], now);
+	rcc->CFGR = cfgr;
+	for (int i = 0; i < 4; i++)
+		if (tims[i].running)
+			tims[i].start_ns = now - tim_ticks_ns(&tims[i], cnt[i]);
+}
+
+//------------------------------------------------------------------ USART1 .. USART3
+
+typedef struct
+{
+	USART_TypeDef *view, *r;
+	const char *name;
+	int apb;
+	IRQn_Type irq;
+	uint8_t dma_tx, dma_rx;
+
+	//receive side , a queue of bytes that are still to come onto the line
+	uint8_t q[PERIPH_USART_QUEUE];
+	uint64_t q_ready[PERIPH_USART_QUEUE];
+	uint32_t q_head, q_count;
+	int fd;				//HOSTSIM_USARTn_RX , -1 none
+	int fifo;
+	uint64_t rx_end;		//stop bit of the byte on the line , NONE if the line is quiet
+	uint8_t rx_byte;
+	uint8_t rx_garbled;
+	uint64_t line_free;		//end of the last byte
+	uint64_t idle_at;		//one frame of quiet after a byte sets IDLE , NONE
+	uint32_t rx_dr;			//what DR reads , a write to DR goes out instead
+	uint32_t peer_baud;
+
+	//transmit side
+	int tx_busy;
+	uint64_t tx_end;
+	uint8_t tx_shift;
+	int tx_full;
+	uint8_t tx_hold;
+	FILE *out;
+
+	int sr_read;			//SR was read , a DR access completes the clear sequence
+	periph_usart_fn on_sent, on_received;
+	void *ctx;
+} usart_t;
+
+static usart_t usarts[3] =
+{
+	{ .name = "USART1", .apb = 2, .irq = USART1_IRQn, .dma_tx = 4, .dma_rx = 5 },
+	{ .name = "USART2", .apb = 1, .irq = USART2_IRQn, .dma_tx = 7, .dma_rx = 6 },
+	{ .name = "USART3", .apb = 1, .irq = USART3_IRQn, .dma_tx = 2, .dma_rx = 3 },
+};
+
+//start , 8 or 9 data bits , 1 , 0.5 , 2 or 1.5 stop bits
+static uint32_t usart_half_bits(usart_t *u)
+{
+	static const uint8_t stop[4] = { 2, 1, 4, 3 };
+
+	return 2 + ((u->r->CR1 & USART_CR1_M) ? 18 : 16) + stop[(u->r->CR2 >> 12) & 0x3];
+}
+
+static uint32_t usart_baud(usart_t *u)
+{
+	return u->r->BRR >= 16 ? pclk(u->apb) / u->r->BRR : 0;
+}
+
+static uint64_t usart_frame_ns(usart_t *u, uint32_t baud)
+{
+	return baud ? (uint64_t) usart_half_bits(u) * 1000000000ULL / (2 * baud) : NONE;
+}
+
+static int usart_rx_on(usart_t *u)
+{
+	return (u->r->CR1 & (USART_CR1_UE | USART_CR1_RE)) == (USART_CR1_UE | USART_CR1_RE) && usart_baud(u);
+}
+
+static int usart_tx_on(usart_t *u)
+{
+	return (u->r->CR1 & (USART_CR1_UE | USART_CR1_TE)) == (USART_CR1_UE | USART_CR1_TE) && usart_baud(u);
+}
+
+static void usart_irqs(usart_t *u)
+{
+	uint32_t sr = u->r->SR, cr1 = u->r->CR1, cr3 = u->r->CR3;
+	int level = ((cr1 & USART_CR1_TXEIE) && (sr & USART_SR_TXE)) || ((cr1 & USART_CR1_TCIE) && (sr & USART_SR_TC))
+		|| ((cr1 & USART_CR1_RXNEIE) && (sr & (USART_SR_RXNE | USART_SR_ORE)))
+		|| ((cr1 & USART_CR1_IDLEIE) && (sr & USART_SR_IDLE)) || ((cr1 & USART_CR1_PEIE) && (sr & USART_SR_PE))
+		|| ((cr3 & USART_CR3_EIE) && (cr3 & USART_CR3_DMAR) && (sr & (USART_SR_FE | USART_SR_NE | USART_SR_ORE)));
+
+	nvic_set_level(u->irq, level);
+}
+
+static void usart_dma(usart_t *u)
+{
+	dma_line(u->dma_tx, LINE_TX, (u->r->CR3 & USART_CR3_DMAT) && (u->r->SR & USART_SR_TXE) && usart_tx_on(u));
+	dma_line(u->dma_rx, LINE_RX, (u->r->CR3 & USART_CR3_DMAR) && (u->r->SR & USART_SR_RXNE));
+}
+
+//put the next queued byte on the line , not before from
+static void usart_rx_next(usart_t *u, uint64_t from)
+{
+	uint32_t dut = usart_baud(u);
+	uint32_t peer = u->peer_baud ? u->peer_baud : dut;
+	uint64_t start;
+	double off;
+
+	if (u->rx_end != NONE || !u->q_count || !usart_rx_on(u))
+		return;
+	start = u->q_ready[u->q_head];
+	if (start < from)
+		start = from;
+	if (start < u->line_free)
+		start = u->line_free;
+	off = ((double) peer - dut) / dut;
+	u->rx_byte = u->q[u->q_head];
+	u->rx_garbled = off > 0.03 || off < -0.03;
+	u->q_head = (u->q_head + 1) % PERIPH_USART_QUEUE;
+	u->q_count--;
+	u->rx_end = start + usart_frame_ns(u, peer);
+	if (u->idle_at != NONE && start < u->idle_at)
+		u->idle_at = NONE;
+}
+
+static void usart_rx_done(usart_t *u, uint64_t at)
+{
+	USART_TypeDef *r = u->r;
+	uint8_t byte = u->rx_byte;
+
+	u->rx_end = NONE;
+	u->line_free = at;
+	if (usart_rx_on(u))
+	{
+		if (r->SR & USART_SR_RXNE)
+			r->SR |= USART_SR_ORE;			//DR keeps the byte that was not read , this one is gone
+		else
+		{
+			u->rx_dr = u->rx_garbled ? (byte >> 1) | 0x80 : byte;
+			r->DR = u->rx_dr;
+			r->SR |= USART_SR_RXNE | (u->rx_garbled ? USART_SR_FE : 0);
+		}
+		u->idle_at = at + usart_frame_ns(u, usart_baud(u));
+		if (u->on_received)
+			u->on_received(u->view, byte, at, u->ctx);
+	}
+	usart_rx_next(u, at);
+	usart_dma(u);
+	usart_irqs(u);
+}
+
+static void usart_tx_done(usart_t *u, uint64_t at)
+{
+	uint8_t byte = u->tx_shift;
+
+	if (u->out)
+	{
+		fputc(byte, u->out);
+		if (!u->tx_full)
+			fflush(u->out);
+	}
+	if (u->on_sent)
+		u->on_sent(u->view, byte, at, u->ctx);
+	if (u->tx_full)
+	{
+		u->tx_shift = u->tx_hold;
+		u->tx_full = 0;
+		u->tx_end = at + usart_frame_ns(u, usart_baud(u));
+		u->r->SR |= USART_SR_TXE;
+	}
+	else
+	{
+		u->tx_busy = 0;
+		u->r->SR |= USART_SR_TC;
+	}
+	usart_dma(u);
+	usart_irqs(u);
+}
+
+static void usart_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+{
+	usart_t *u = ctx;
+	USART_TypeDef *r = u->r;
+	uint64_t now = now_ns();
+
+	switch (off)
+	{
+	case 0x00:
+		r->SR = old & (val | ~(USART_SR_RXNE | USART_SR_TC | USART_SR_LBD | USART_SR_CTS));	//write 0 to clear , the rest is read only
+		break;
+	case 0x04:
+		r->DR = u->rx_dr;
+		u->sr_read = 0;
+		if (!usart_tx_on(u))
+			break;
+		r->SR &= ~USART_SR_TC;
+		if (!u->tx_busy)
+		{
+			u->tx_busy = 1;
+			u->tx_shift = val;
+			u->tx_end = now + usart_frame_ns(u, usart_baud(u));
+		}
+		else
+		{
+			u->tx_hold = val;			//overwrites a byte still waiting , like the chip
+			u->tx_full = 1;
+			r->SR &= ~USART_SR_TXE;
+		}
+		break;
+	case 0x0C:
+		if ((val & ~old) & (USART_CR1_UE | USART_CR1_RE))
+			usart_rx_next(u, now);
+		break;
+	}
+	usart_dma(u);
+	usart_irqs(u);
+	sim_kick();
+}
+
+static void usart_read(void *ctx, uint32_t off, int after)
+{
+	usart_t *u = ctx;
+
+	if (!after)
+		return;
+	if (off == 0x00)
+		u->sr_read = 1;
+	else if (off == 0x04)
+	{
+		u->r->SR &= ~(USART_SR_RXNE | (u->sr_read ? USART_SR_IDLE | USART_SR_ORE | USART_SR_NE | USART_SR_FE | USART_SR_PE : 0));
+		u->sr_read = 0;
+		usart_dma(u);
+		usart_irqs(u);
+	}
+}
+
+//HOSTSIM_USARTn_RX , as much as fits in the queue
+static void usart_poll(usart_t *u, uint64_t now)
+{
+	uint8_t buf[256];
+	ssize_t n;
+
+	while (u->fd >= 0 && PERIPH_USART_QUEUE - u->q_count >= sizeof(buf))
+	{
+		n = read(u->fd, buf, sizeof(buf));
+		if (n <= 0)
+		{
+			if (n == 0 && !u->fifo)
+			{
+				close(u->fd);
+				u->fd = -1;
+			}
+			break;
+		}
+		for (ssize_t i = 0; i < n; i++)
+		{
+			uint32_t slot = (u->q_head + u->q_count++) % PERIPH_USART_QUEUE;
+
+			u->q[slot] = buf[i];
+			u->q_ready[slot] = u->fifo ? now : 0;	//a FIFO's bytes come when they are written , a file's back to back
+		}
+	}
+	usart_rx_next(u, now);
+}
+
+//------------------------------------------------------------------ I2C1 , I2C2 master transmitter
+
+enum { I2C_IDLE, I2C_START, I2C_SB, I2C_ADDRESS, I2C_DATA, I2C_STOP };
+
+#define I2C_DEVICES 4
+
+typedef struct
+{
+	I2C_TypeDef *view, *r;
+	IRQn_Type ev_irq, er_irq;
+	uint8_t dma_tx;
+	int phase;
+	uint64_t at;			//end of the start , address byte , data byte or stop on the bus , NONE
+	uint8_t shift;			//byte on the bus
+	uint8_t hold;			//DR written while a byte was on the bus
+	int hold_full;
+	int sr1_read;			//SR1 was read , an SR2 read clears ADDR
+	int dev;			//addressed device , -1 none
+	struct
+	{
+		uint8_t addr;		//7 bit
+		periph_i2c_fn fn;
+		void *ctx;
+	} devs[I2C_DEVICES];
+	int ndevs;
+} i2c_t;
+
+static i2c_t i2cs[2] =
+{
+	{ .ev_irq = I2C1_EV_IRQn, .er_irq = I2C1_ER_IRQn, .dma_tx = 6 },
+	{ .ev_irq = I2C2_EV_IRQn, .er_irq = I2C2_ER_IRQn, .dma_tx = 4 },
+};
+
+//one SCL period: CCR high + CCR low (standard) , CCR + 2 CCR or 9 CCR + 16 CCR (fast) , rise times not counted
+static uint64_t i2c_bit_ns(i2c_t *c)
+{
+	uint32_t ccr = c->r->CCR & I2C_CCR_CCR;
+	uint32_t mul = !(c->r->CCR & I2C_CCR_FS) ? 2 : (c->r->CCR & I2C_CCR_DUTY) ? 25 : 3;
+
+	return (uint64_t) mul * (ccr ? ccr : 1) * 1000000000ULL / pclk(1);
+}
+
+static void i2c_irqs(i2c_t *c)
+{
+	uint32_t sr1 = c->r->SR1, cr2 = c->r->CR2;
+	int ev = (cr2 & I2C_CR2_ITEVTEN) && ((sr1 & (I2C_SR1_SB | I2C_SR1_ADDR | I2C_SR1_BTF | I2C_SR1_STOPF | I2C_SR1_ADD10))
+		|| ((cr2 & I2C_CR2_ITBUFEN) && (sr1 & (I2C_SR1_TXE | I2C_SR1_RXNE))));
+
+	nvic_set_level(c->ev_irq, ev);
+	nvic_set_level(c->er_irq, (cr2 & I2C_CR2_ITERREN) && (sr1 & 0xFF00));
+}
+
+static void i2c_dma(i2c_t *c)
+{
+	dma_line(c->dma_tx, LINE_I2C, (c->r->CR2 & I2C_CR2_DMAEN) && (c->r->SR1 & I2C_SR1_TXE) && !(c->r->SR1 & I2C_SR1_ADDR)
+		&& c->phase == I2C_DATA && (c->r->SR2 & I2C_SR2_TRA));
+}
+
+static void i2c_shift(i2c_t *c, uint8_t byte, uint64_t now)
+{
+	c->shift = byte;
+	c->at = now + 9 * i2c_bit_ns(c);
+	c->r->SR1 = (c->r->SR1 & ~I2C_SR1_BTF) | I2C_SR1_TXE;
+}
+
+//the bus is free of the last byte (or of the address , flags then has no BTF) , the master goes on with whatever is asked of it
+static void i2c_next(i2c_t *c, uint64_t now, uint32_t flags)
+{
+	c->at = NONE;
+	if (c->r->CR1 & I2C_CR1_STOP)
+	{
+		c->phase = I2C_STOP;
+		c->hold_full = 0;		//a byte still in DR never goes out
+		c->at = now + i2c_bit_ns(c);
+	}
+	else if (c->r->CR1 & I2C_CR1_START)
+	{
+		c->phase = I2C_START;
+		c->hold_full = 0;
+		c->at = now + i2c_bit_ns(c);
+	}
+	else if (c->phase == I2C_DATA && c->hold_full && !(c->r->SR1 & (I2C_SR1_ADDR | I2C_SR1_AF)))
+	{
+		c->hold_full = 0;
+		i2c_shift(c, c->hold, now);
+	}
+	else if (c->phase == I2C_DATA && !(c->r->SR1 & (I2C_SR1_ADDR | I2C_SR1_AF)) && (c->r->SR2 & I2C_SR2_TRA))
+		c->r->SR1 |= flags;		//SCL held low until DR is written
+}
+
+static void i2c_event(i2c_t *c, uint64_t at)
+{
+	I2C_TypeDef *r = c->r;
+	int ack;
+
+	switch (c->phase)
+	{
+	case I2C_START:
+		r->CR1 &= ~I2C_CR1_START;
+		r->SR1 = (r->SR1 & ~(I2C_SR1_TXE | I2C_SR1_BTF)) | I2C_SR1_SB;
+		r->SR2 |= I2C_SR2_MSL | I2C_SR2_BUSY;
+		c->phase = I2C_SB;
+		c->at = NONE;
+		break;
+	case I2C_ADDRESS:
+		c->dev = -1;
+		for (int i = 0; i < c->ndevs; i++)
+			if (c->devs[i].addr == c->shift >> 1)
+				c->dev = i;
+		ack = c->dev >= 0 && c->devs[c->dev].fn(PERIPH_I2C_START, c->shift, at, c->devs[c->dev].ctx);
+		c->phase = I2C_DATA;
+		c->at = NONE;
+		if (!ack)
+		{
+			c->dev = -1;
+			r->SR1 |= I2C_SR1_AF;
+			i2c_next(c, at, I2C_SR1_TXE | I2C_SR1_BTF);
+			break;
+		}
+		r->SR1 |= I2C_SR1_ADDR;
+		r->SR2 = (r->SR2 & ~I2C_SR2_TRA) | ((c->shift & 1) ? 0 : I2C_SR2_TRA);
+		break;
+	case I2C_DATA:
+		ack = c->dev >= 0 && c->devs[c->dev].fn(PERIPH_I2C_BYTE, c->shift, at, c->devs[c->dev].ctx);
+		if (!ack)
+		{
+			r->SR1 |= I2C_SR1_AF;
+			c->hold_full = 0;
+		}
+		i2c_next(c, at, I2C_SR1_TXE | I2C_SR1_BTF);
+		break;
+	case I2C_STOP:
+		if (c->dev >= 0)
+			c->devs[c->dev].fn(PERIPH_I2C_STOP, 0, at, c->devs[c->dev].ctx);
+		c->dev = -1;
+		r->CR1 &= ~I2C_CR1_STOP;
+		r->SR1 &= ~(I2C_SR1_TXE | I2C_SR1_BTF);
+		r->SR2 &= ~(I2C_SR2_MSL | I2C_SR2_BUSY | I2C_SR2_TRA);
+		c->phase = I2C_IDLE;
+		c->at = NONE;
+		if (r->CR1 & I2C_CR1_START)
+		{
+			c->phase = I2C_START;
+			c->at = at + i2c_bit_ns(c);
+		}
+		break;
+	}
+	i2c_dma(c);
+	i2c_irqs(c);
+}
+
+static void i2c_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+{
+	i2c_t *c = ctx;
+	I2C_TypeDef *r = c->r;
+	uint64_t now = now_ns();
+
+	switch (off)
+	{
+	case 0x00:
+		if (val & I2C_CR1_SWRST)
+		{
+			memset((void *) r, 0, sizeof(*r));
+			r->CR1 = I2C_CR1_SWRST;
+			c->phase = I2C_IDLE;
+			c->at = NONE;
+			c->hold_full = 0;
+			c->dev = -1;
+			break;
+		}
+		if (!(val & I2C_CR1_PE))
+		{
+			r->CR1 &= ~(I2C_CR1_START | I2C_CR1_STOP);
+			r->SR1 = 0;
+			r->SR2 = 0;
+			c->phase = I2C_IDLE;
+			c->at = NONE;
+			c->hold_full = 0;
+			break;
+		}
+		if (c->phase == I2C_IDLE)
+			r->CR1 &= ~I2C_CR1_STOP;	//not master , there is nothing to stop (a read-modify-write after the stop)
+		if (c->phase == I2C_IDLE && (val & I2C_CR1_START))
+		{
+			c->phase = I2C_START;
+			c->at = now + i2c_bit_ns(c);
+		}
+		else if ((val & ~old & (I2C_CR1_START | I2C_CR1_STOP)) && c->at == NONE && c->phase != I2C_IDLE
+			&& !((r->SR1 & I2C_SR1_ADDR) && !(val & I2C_CR1_STOP)))
+			i2c_next(c, now, I2C_SR1_TXE | I2C_SR1_BTF);	//nothing on the bus , the condition goes out at once
+		break;
+	case 0x10:
+		r->DR = val & 0xFF;
+		if (c->phase == I2C_SB)
+		{
+			r->SR1 &= ~I2C_SR1_SB;
+			c->phase = I2C_ADDRESS;
+			c->shift = val;
+			c->at = now + 9 * i2c_bit_ns(c);
+		}
+		else if (c->phase == I2C_DATA && (r->SR2 & I2C_SR2_TRA))
+		{
+			r->SR1 &= ~I2C_SR1_BTF;
+			if (c->at == NONE && !(r->SR1 & (I2C_SR1_ADDR | I2C_SR1_AF)))
+				i2c_shift(c, val, now);
+			else
+			{
+				c->hold = val;		//a second write before TXE overwrites it , as on the chip
+				c->hold_full = 1;
+				r->SR1 &= ~I2C_SR1_TXE;
+			}
+		}
+		c->sr1_read = 0;
+		break;
+	case 0x14:
+		r->SR1 = old & (val | 0xFF);		//error flags are write 0 to clear , the rest read only
+		break;
+	case 0x18:
+		r->SR2 = old;
+		break;
+	}
+	i2c_dma(c);
+	i2c_irqs(c);
+	sim_kick();
+}
+
+static void i2c_read(void *ctx, uint32_t off, int after)
+{
+	i2c_t *c = ctx;
+
+	if (!after)
+		return;
+	if (off == 0x14)
+		c->sr1_read = 1;
+	else if (off == 0x18 && c->sr1_read && (c->r->SR1 & I2C_SR1_ADDR))
+	{
+		c->r->SR1 &= ~I2C_SR1_ADDR;		//SR1 then SR2 , the clock runs again
+		c->sr1_read = 0;
+		i2c_next(c, now_ns(), I2C_SR1_TXE);
+		i2c_dma(c);
+		i2c_irqs(c);
+		sim_kick();
+	}
+}
+
+//------------------------------------------------------------------ ADC1 , ADC2
+
+typedef struct
+{
+	ADC_TypeDef *view, *r;
+	int n;
+	int on;
+	uint64_t cal_at;		//CAL and RSTCAL clear here , NONE
+	int busy;
+	uint32_t seq;			//index of the conversion in flight
+	uint64_t conv_end;
+} adc_t;
+
+static adc_t adcs[2] = { { .n = 1 }, { .n = 2 } };
+
+enum { WAVE_DC, WAVE_SINE, WAVE_SQUARE, WAVE_RAMP, WAVE_NOISE, WAVE_STEP };
+
+typedef struct
+{
+	uint8_t ch;
+	uint8_t shape;
+	double a, b, c;
+} wave_t;
+
+#define MAX_WAVES 64
+
+static wave_t waves[MAX_WAVES];
+static int nwaves;
+static struct
+{
+	periph_adc_fn fn;
+	void *ctx;
+} adc_src[18];
+static uint64_t noise_state = 0x2545F4914F6CDD1DULL;
+
+static double gauss(void)
+{
+	double u1, u2;
+
+	noise_state ^= noise_state << 13;
+	noise_state ^= noise_state >> 7;
+	noise_state ^= noise_state << 17;
+	u1 = ((noise_state >> 11) + 1.0) / 9007199254740993.0;
+	noise_state ^= noise_state << 13;
+	noise_state ^= noise_state >> 7;
+	noise_state ^= noise_state << 17;
+	u2 = (noise_state >> 11) / 9007199254740992.0;
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static uint16_t adc_value(int ch, uint64_t t)
+{
+	double v = 0, s = t / 1e9, phase;
+	int set = 0;
+
+	if (adc_src[ch].fn)
+		return adc_src[ch].fn(ch, t, adc_src[ch].ctx) & 0xFFF;
+	for (int i = 0; i < nwaves; i++)
+	{
+		wave_t *w = &waves[i];
+
+		if (w->ch != ch)
+			continue;
+		set = 1;
+		phase = s * w->b - floor(s * w->b);
+		switch (w->shape)
+		{
+		case WAVE_DC:
+			v += w->a;
+			break;
+		case WAVE_SINE:
+			v += w->a * sin(2.0 * M_PI * (s * w->b + w->c / 360.0));
+			break;
+		case WAVE_SQUARE:
+			v += phase < (w->c ? w->c : 0.5) ? w->a : 0;
+			break;
+		case WAVE_RAMP:
+			v += w->a * phase;
+			break;
+		case WAVE_NOISE:
+			v += w->a * gauss();
+			break;
+		case WAVE_STEP:
+			v += s * 1000.0 >= w->b ? w->a : 0;
+			break;
+		}
+	}
+	if (!set && ch == 16)
+		v = 1775;				//1.43 V
+	else if (!set && ch == 17)
+		v = 1489;				//1.20 V
+	v = floor(v + 0.5);
+	return v < 0 ? 0 : v > 4095 ? 4095 : (uint16_t) v;
+}
+
+static void adc_script(const char *path)
+{
+	static const char *const shapes[] = { "dc", "sine", "square", "ramp", "noise", "step" };
+	FILE *f = fopen(path, "r");
+	char line[256], shape[16];
+	int ch, n, lineno = 0;
+	double a, b, c;
+
+	if (!f)
+	{
+		perror(path);
+		return;
+	}
+	while (fgets(line, sizeof(line), f))
+	{
+		lineno++;
+		if (line[strspn(line, " \t\r\n")] == '#' || !line[strspn(line, " \t\r\n")])
+			continue;
+		a = b = c = 0;
+		n = sscanf(line, "%d %15s %lf %lf %lf", &ch, shape, &a, &b, &c);
+		for (int s = 0; s < 6 && n >= 3; s++)
+			if (!strcmp(shape, shapes[s]) && ch >= 0 && ch < 18 && nwaves < MAX_WAVES)
+			{
+				waves[nwaves++] = (wave_t) { ch, s, a, b, c };
+				n = 0;
+			}
+		if (n)
+			fprintf(stderr, "%s:%d: not understood: %s", path, lineno, line);
+	}
+	fclose(f);
+}
+
+static uint32_t adc_len(adc_t *a)
+{
+	return (a->r->CR1 & ADC_CR1_SCAN) ? ((a->r->SQR1 >> 20) & 0xF) + 1 : 1;
+}
+
+static int adc_channel(adc_t *a, uint32_t k)
+{
+	uint32_t sqr = k < 6 ? a->r->SQR3 : k < 12 ? a->r->SQR2 : a->r->SQR1;
+
+	return (sqr >> (5 * (k % 6))) & 0x1F;
+}
+
+static uint64_t adc_conv_ns(adc_t *a, int ch)
+{
+	static const uint16_t half_cycles[8] = { 3, 15, 27, 57, 83, 111, 143, 479 };	//sample time , 1.5 .. 239.5
+	uint32_t adcclk = pclk(2) / (2 * (((rcc->CFGR >> 14) & 0x3) + 1));
+	uint32_t smp = ch < 10 ? a->r->SMPR2 >> (3 * ch) : a->r->SMPR1 >> (3 * (ch - 10));
+
+	return (uint64_t) (half_cycles[smp & 0x7] + 25) * 1000000000ULL / (2 * adcclk);	//+ 12.5 cycles conversion
+}
+
+static int adc_dual(void)
+{
+	return ((adcs[0].r->CR1 & ADC_CR1_DUALMOD) >> 16) == 6;		//regular simultaneous
+}
+
+static void adc_irqs(void)
+{
+	int level = 0;
+
+	for (int i = 0; i < 2; i++)
+		if ((adcs[i].r->SR & ADC_SR_EOC) && (adcs[i].r->CR1 & ADC_CR1_EOCIE))
+			level = 1;
+	nvic_set_level(ADC1_2_IRQn, level);
+}
+
+static void adc_start(adc_t *a, uint64_t at)
+{
+	if (!a->on || a->busy || (a->n == 2 && adc_dual()))
+		return;				//in dual mode ADC2 runs in step with ADC1
+	a->busy = 1;
+	a->seq = 0;
+	a->conv_end = at + adc_conv_ns(a, adc_channel(a, 0));
+	a->r->SR |= ADC_SR_STRT;
+	a->r->CR2 &= ~ADC_CR2_SWSTART;
+	if (a->n == 1 && adc_dual() && adcs[1].on)
+		adcs[1].r->SR |= ADC_SR_STRT;
+}
+
+static void adc_done(adc_t *a, uint64_t at)
+{
+	uint32_t v = adc_value(adc_channel(a, a->seq), at);
+	adc_t *b = &adcs[1];
+	int last;
+
+	if (a->r->CR2 & ADC_CR2_ALIGN)
+		v <<= 4;
+	if (a->n == 1 && adc_dual() && b->on)
+	{
+		uint32_t v2 = adc_value(adc_channel(b, a->seq % adc_len(b)), at);
+
+		if (b->r->CR2 & ADC_CR2_ALIGN)
+			v2 <<= 4;
+		b->r->DR = v2;
+		v |= v2 << 16;				//ADC2 in the upper half for the DMA
+	}
+	a->r->DR = v;
+	a->seq++;
+	last = a->seq >= adc_len(a);
+	if (last)
+	{
+		a->r->SR |= ADC_SR_EOC;
+		if (a->n == 1 && adc_dual() && b->on)
+			b->r->SR |= ADC_SR_EOC;
+	}
+	if (a->r->CR2 & ADC_CR2_DMA)
+		dma_pulse(a->n == 1 ? 1 : 0, 1);	//ADC2 has no DMA request
+	if (!last)
+		a->conv_end = at + adc_conv_ns(a, adc_channel(a, a->seq));
+	else if (a->r->CR2 & ADC_CR2_CONT)
+	{
+		a->seq = 0;
+		a->conv_end = at + adc_conv_ns(a, adc_channel(a, 0));
+	}
+	else
+		a->busy = 0;
+	adc_irqs();
+}
+
+static int adc_wants(int sel)
+{
+	for (int i = 0; i < 2; i++)
+		if (adcs[i].on && (adcs[i].r->CR2 & ADC_CR2_EXTTRIG) && ((adcs[i].r->CR2 >> 17) & 0x7) == (uint32_t) sel)
+			return 1;
+	return 0;
+}
+
+static void adc_trigger(int sel)
+{
+	for (int i = 0; i < 2; i++)
+		if (adcs[i].on && (adcs[i].r->CR2 & ADC_CR2_EXTTRIG) && ((adcs[i].r->CR2 >> 17) & 0x7) == (uint32_t) sel)
+			adc_start(&adcs[i], now_ns());
+}
+
+static void adc_write(void *ctx, uint32_t off, uint32_t old, uint32_t val)
+{
+	adc_t *a = ctx;
+	uint64_t now = now_ns();
+
+	if (off == 0x00)
+		a->r->SR = old & val;				//write 0 to clear
+	else if (off == 0x08)
+	{
+		uint32_t adcclk = pclk(2) / (2 * (((rcc->CFGR >> 14) & 0x3) + 1));
+
+		if (!(val & ADC_CR2_ADON))
+		{
+			a->on = 0;
+			a->busy = 0;
+		}
+		else if (!(old & ADC_CR2_ADON))
+			a->on = 1;				//power up
+		else if (!((old ^ val) & ~ADC_CR2_ADON))
+			adc_start(a, now);			//ADON again , nothing else changed
+		if ((val & ~old) & (ADC_CR2_CAL | ADC_CR2_RSTCAL))
+			a->cal_at = now + (uint64_t) ((val & ADC_CR2_CAL) ? 83 : 2) * 1000000000ULL / adcclk;
+		if ((val & ADC_CR2_SWSTART) && (val & ADC_CR2_EXTTRIG) && (val & ADC_CR2_EXTSEL) == ADC_CR2_EXTSEL)
+			adc_start(a, now);
+		a->r->CR2 &= ~ADC_CR2_JSWSTART;
+	}
+	else if (off == 0x4C)
+		a->r->DR = old;					//read only
+	adc_irqs();
+	sim_kick();
+}
+
+static void adc_read(void *ctx, uint32_t off, int after)
+{
+	adc_t *a = ctx;
+
+	if (after && off == 0x4C)
+	{
+		a->r->SR &= ~ADC_SR_EOC;
+		adc_irqs();
+	}
+}
+
+//------------------------------------------------------------------ model
+
+enum { EV_UPDATE, EV_COMPARE, EV_RX, EV_IDLE, EV_TX, EV_I2C, EV_CONVERSION, EV_CAL };
+
+typedef struct
+{
+	uint64_t at;
+	int kind;
+	int unit;
+	int ch;
+} event_t;
+
+static void consider(event_t *e, uint64_t at, int kind, int unit, int ch)
+{
+	if (at < e->at)
+		*e = (event_t) { at, kind, unit, ch };
+}
+
+static event_t next_event(void)
+{
+	event_t e = { NONE, 0, 0, 0 };
+
+	for (int i = 0; i < 4; i++)
+	{
+		tim_t *t = &tims[i];
+
+		if (!t->running)
+			continue;
+		consider(&e, t->start_ns + tim_ticks_ns(t, t->arr + 1), EV_UPDATE, i, 0);
+		for (int c = 0; c < 4; c++)
+			if (!(t->cc_done & (1 << c)) && t->ccr[c] <= t->arr && tim_watched(t, c))
+				consider(&e, t->start_ns + tim_ticks_ns(t, t->ccr[c]), EV_COMPARE, i, c);
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		usart_t *u = &usarts[i];
+
+		consider(&e, u->rx_end, EV_RX, i, 0);
+		consider(&e, u->idle_at, EV_IDLE, i, 0);
+		if (u->tx_busy)
+			consider(&e, u->tx_end, EV_TX, i, 0);
+	}
+	for (int i = 0; i < 2; i++)
+		consider(&e, i2cs[i].at, EV_I2C, i, 0);
+	for (int i = 0; i < 2; i++)
+	{
+		if (adcs[i].busy)
+			consider(&e, adcs[i].conv_end, EV_CONVERSION, i, 0);
+		consider(&e, adcs[i].cal_at, EV_CAL, i, 0);
+	}
+	return e;
+}
+
+static void handle(const event_t *e)
+{
+	usart_t *u = &usarts[e->unit];
+	adc_t *a = &adcs[e->unit];
+
+	in_step = 1;
+	step_ns = e->at;
+	switch (e->kind)
+	{
+	case EV_UPDATE:
+		tim_update(&tims[e->unit], e->at, 1);
+		break;
+	case EV_COMPARE:
+		tim_compare(&tims[e->unit], e->ch, e->at);
+		break;
+	case EV_RX:
+		usart_rx_done(u, e->at);
+		break;
+	case EV_IDLE:
+		u->idle_at = NONE;
+		if (usart_rx_on(u))
+			u->r->SR |= USART_SR_IDLE;
+		usart_irqs(u);
+		break;
+	case EV_TX:
+		usart_tx_done(u, e->at);
+		break;
+	case EV_I2C:
+		i2c_event(&i2cs[e->unit], e->at);
+		break;
+	case EV_CONVERSION:
+		adc_done(a, e->at);
+		break;
+	case EV_CAL:
+		a->cal_at = NONE;
+		a->r->CR2 &= ~(ADC_CR2_CAL | ADC_CR2_RSTCAL);
+		break;
+	}
+	in_step = 0;
+}
+
+static uint64_t periph_step(void *ctx, uint64_t now)
+{
+	event_t e;
+	uint64_t poll = NONE;
+
+	(void) ctx;
+	for (int i = 0; i < 3; i++)
+	{
+		usart_poll(&usarts[i], now);
+		if (usarts[i].fd >= 0)
+			poll = now + POLL_NS;
+	}
+	e = next_event();
+	if (e.at <= now)
+	{
+		handle(&e);			//one at a time , the firmware's interrupts run in between
+		e = next_event();
+	}
+	return e.at < poll ? e.at : poll;
+}
+
+//------------------------------------------------------------------ start up
+
+__attribute__((constructor(200))) static void periph_init(void)
+{
+	static const char *const rx_env[3] = { "HOSTSIM_USART1_RX", "HOSTSIM_USART2_RX", "HOSTSIM_USART3_RX" };
+	static const char *const tx_env[3] = { "HOSTSIM_USART1_TX", "HOSTSIM_USART2_TX", "HOSTSIM_USART3_TX" };
+	GPIO_TypeDef **gpio_views[3] = { &GPIOA, &GPIOB, &GPIOC };
+	TIM_TypeDef **tim_views[4] = { &TIM1, &TIM2, &TIM3, &TIM4 };
+	USART_TypeDef **usart_views[3] = { &USART1, &USART2, &USART3 };
+	ADC_TypeDef **adc_views[2] = { &ADC1, &ADC2 };
+	I2C_TypeDef **i2c_views[2] = { &I2C1, &I2C2 };
+	DMA_Channel_TypeDef **ch_views[7] = { &DMA1_Channel1, &DMA1_Channel2, &DMA1_Channel3, &DMA1_Channel4,
+					      &DMA1_Channel5, &DMA1_Channel6, &DMA1_Channel7 };
+	const char *env;
+	void *alias;
+
+	if ((env = getenv("HOSTSIM_HSE_HZ")))
+		hse_hz = atoi(env);
+	RCC = mmio_map(sizeof(RCC_TypeDef), 0, rcc_write, 0, 0, &alias);
+	rcc = alias;
+	rcc->CR = 0x00000083;				//HSI on and ready , trim in the middle
+	rcc->AHBENR = 0x00000014;
+	rcc->CSR = 0x0C000000;
+
+	for (int i = 0; i < 3; i++)
+	{
+		gpio_t *g = &gpios[i];
+
+		*gpio_views[i] = g->view = mmio_map(sizeof(GPIO_TypeDef), 0, gpio_write, 0, g, &alias);
+		g->r = alias;
+		g->r->CRL = g->r->CRH = 0x44444444;	//floating inputs
+	}
+
+	DMA1 = mmio_map(0x08 + 7 * 0x14, 0, dma_write, 0, 0, &alias);
+	dma = alias;
+	for (int n = 0; n < 7; n++)
+	{
+		*ch_views[n] = (DMA_Channel_TypeDef *) ((uint8_t *) DMA1 + 0x08 + 0x14 * n);
+		dmach[n].r = (DMA_Channel_TypeDef *) ((uint8_t *) dma + 0x08 + 0x14 * n);
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		tim_t *t = &tims[i];
+
+		*tim_views[i] = t->view = mmio_map(sizeof(TIM_TypeDef), 1, tim_write, tim_read, t, &alias);
+		t->r = alias;
+		t->r->ARR = t->arr = 0xFFFF;
+		for (int c = 0; c < 4; c++)
+			t->pwm[c].period = 0x10000;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		usart_t *u = &usarts[i];
+		struct stat st;
+
+		*usart_views[i] = u->view = mmio_map(sizeof(USART_TypeDef), 1, usart_write, usart_read, u, &alias);
+		u->r = alias;
+		u->r->SR = USART_SR_TXE | USART_SR_TC;
+		u->rx_end = u->idle_at = NONE;
+		u->fd = -1;
+		if ((env = getenv(rx_env[i])))
+		{
+			u->fd = open(env, O_RDONLY | O_NONBLOCK);
+			if (u->fd < 0)
+				perror(env);
+			else
+				u->fifo = !fstat(u->fd, &st) && S_ISFIFO(st.st_mode);
+		}
+		u->out = open_out(tx_env[i]);
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		*i2c_views[i] = i2cs[i].view = mmio_map(sizeof(I2C_TypeDef), 1, i2c_write, i2c_read, &i2cs[i], &alias);
+		i2cs[i].r = alias;
+		i2cs[i].at = NONE;
+		i2cs[i].dev = -1;
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		*adc_views[i] = adcs[i].view = mmio_map(sizeof(ADC_TypeDef), 1, adc_write, adc_read, &adcs[i], &alias);
+		adcs[i].r = alias;
+		adcs[i].cal_at = NONE;
+	}
+	if ((env = getenv("HOSTSIM_ADC_SCRIPT")))
+		adc_script(env);
+
+	pwm_log = open_out("HOSTSIM_PWM_LOG");
+	gpio_log = open_out("HOSTSIM_GPIO_LOG");
+	sim_add_model(periph_step, 0);
+}
+
+//------------------------------------------------------------------ test side
+
+static tim_t *find_tim(TIM_TypeDef *view)
+{
+	for (int i = 0; i < 4; i++)
+		if (tims[i].view == view)
+			return &tims[i];
+	return 0;
+}
+
+static gpio_t *find_gpio(GPIO_TypeDef *view)
+{
+	for (int i = 0; i < 3; i++)
+		if (gpios[i].view == view)
+			return &gpios[i];
+	return 0;
+}
+
+static usart_t *find_usart(USART_TypeDef *view)
+{
+	for (int i = 0; i < 3; i++)
+		if (usarts[i].view == view)
+			return &usarts[i];
+	return 0;
+}
+
+static i2c_t *find_i2c(I2C_TypeDef *view)
+{
+	for (int i = 0; i < 2; i++)
+		if (i2cs[i].view == view)
+			return &i2cs[i];
+	return 0;
+}
+
+void periph_pwm_monitor(periph_pwm_fn fn, void *ctx)
+{
+	hw_lock();
+	pwm_fn = fn;
+	pwm_ctx = ctx;
+	hw_unlock();
+}
+
+void periph_pwm_state(TIM_TypeDef *tim, int ch, periph_pwm_t *pwm)
+{
+	tim_t *t = find_tim(tim);
+
+	hw_lock();
+	*pwm = t->pwm[ch - 1];
+	pwm->tim = t->name;
+	pwm->ch = ch;
+	hw_unlock();
+}
+
+void periph_gpio_monitor(periph_gpio_fn fn, void *ctx)
+{
+	hw_lock();
+	gpio_fn = fn;
+	gpio_ctx = ctx;
+	hw_unlock();
+}
+
+void periph_gpio_drive(GPIO_TypeDef *port, int pin, int level)
+{
+	gpio_t *g = find_gpio(port);
+
+	hw_lock();
+	if (level < 0)
+		g->ext_mask &= ~(1u << pin);
+	else
+	{
+		g->ext_mask |= 1u << pin;
+		g->ext_level = (g->ext_level & ~(1u << pin)) | (level ? 1u << pin : 0);
+	}
+	gpio_settle(g);
+	hw_unlock();
+}
+
+uint32_t periph_gpio_odr(GPIO_TypeDef *port)
+{
+	gpio_t *g = find_gpio(port);
+	uint32_t odr;
+
+	hw_lock();
+	odr = g->r->ODR;
+	hw_unlock();
+	return odr;
+}
+
+int periph_usart_send_at(USART_TypeDef *usart, const void *data, uint32_t len, uint64_t t_ns)
+{
+	usart_t *u = find_usart(usart);
+	const uint8_t *p = data;
+	uint32_t n = 0;
+
+	hw_lock();
+	for (; n < len && u->q_count < PERIPH_USART_QUEUE; n++)
+	{
+		uint32_t slot = (u->q_head + u->q_count++) % PERIPH_USART_QUEUE;
+
+		u->q[slot] = p[n];
+		u->q_ready[slot] = t_ns;
+	}
+	usart_rx_next(u, now_ns());
+	hw_unlock();
+	sim_kick();
+	return n;
+}
+
+int periph_usart_send(USART_TypeDef *usart, const void *data, uint32_t len)
+{
+	return periph_usart_send_at(usart, data, len, 0);
+}
+
+uint32_t periph_usart_pending(USART_TypeDef *usart)
+{
+	usart_t *u = find_usart(usart);
+	uint32_t n;
+
+	hw_lock();
+	n = u->q_count + (u->rx_end != NONE);
+	hw_unlock();
+	return n;
+}
+
+void periph_usart_callbacks(USART_TypeDef *usart, periph_usart_fn on_sent, periph_usart_fn on_received, void *ctx)
+{
+	usart_t *u = find_usart(usart);
+
+	hw_lock();
+	u->on_sent = on_sent;
+	u->on_received = on_received;
+	u->ctx = ctx;
+	hw_unlock();
+}
+
+void periph_usart_peer_baud(USART_TypeDef *usart, uint32_t baud)
+{
+	usart_t *u = find_usart(usart);
+
+	hw_lock();
+	u->peer_baud = baud;
+	hw_unlock();
+}
+
+void periph_i2c_device(I2C_TypeDef *i2c, uint8_t addr7, periph_i2c_fn fn, void *ctx)
+{
+	i2c_t *c = find_i2c(i2c);
+
+	hw_lock();
+	if (c->ndevs < I2C_DEVICES)
+	{
+		c->devs[c->ndevs].addr = addr7;
+		c->devs[c->ndevs].fn = fn;
+		c->devs[c->ndevs].ctx = ctx;
+		c->ndevs++;
+	}
+	hw_unlock();
+}
+
+void periph_adc_source(int channel, periph_adc_fn fn, void *ctx)
+{
+	hw_lock();
+	adc_src[channel].fn = fn;
+	adc_src[channel].ctx = ctx;
+	hw_unlock();
+}
@@ -0,0 +1,87 @@
+#ifndef PERIPH_H
+#define PERIPH_H
+
+//register level models of the on chip peripherals the programs here use , link periph.c in next to mmio.c and device.c
+//
+//RCC        CR ready flags follow the enables , SWS follows SW once the source is ready , the models take every clock
+//           from these registers (HSE 8 MHz , HOSTSIM_HSE_HZ to change it) , SystemCoreClockUpdate() works it out too
+//GPIOA..C   BSRR and BRR act on ODR , IDR reads ODR back unless a pin is driven from outside (periph_gpio_drive)
+//TIM1..4    up counter on virtual time , PSC / ARR / CCR preload , update and compare events , URS , UDIS , OPM ,
+//           repetition counter , UG , interrupts , DMA requests and DMAR bursts , TRGO (reset , enable , update ,
+//           compare pulse , OCxREF) into the trigger and reset slave modes of the others and into the ADCs
+//USART1..3  baud rate and frame length from BRR , CR1 and CR2 , every byte takes its time on the line both ways ,
+//           TXE , TC , RXNE , IDLE , ORE , FE , SR then DR clears , interrupts , DMA on both sides
+//I2C1 , I2C2  master transmitter , start , 7 bit address , data and stop take their time at the SCL rate from CCR ,
+//           SB , ADDR (SR1 then SR2 clears) , TXE , BTF , AF on a NACK , repeated start , event and error interrupts , DMA
+//ADC1 , ADC2  ADON twice starts , CAL and RSTCAL take their time , single , continuous and scan , sample times and
+//           ADCCLK , external triggers , regular simultaneous dual mode , DMA , end of conversion interrupt
+//DMA1       seven channels with the F103 request map , sizes , increments , circular , half / full / error flags ,
+//           memory to memory , a transfer takes no time
+//
+//not modelled: centre aligned and down counting , input capture , gated slave mode , injected ADC channels ,
+//analog watchdog , USART synchronous , LIN , IrDA and smart card modes , I2C master receiver , slave mode , SMBus and
+//10 bit addresses , EXTI , clock enable bits (stored only)
+//
+//environment:
+//  HOSTSIM_USART1_RX=file    bytes USART1 receives , back to back at its baud rate once the receiver is on ,
+//                            a FIFO is read for as long as the program runs (USART2 and USART3 likewise)
+//  HOSTSIM_USART1_TX=file    where the bytes USART1 sends go , - for stdout
+//  HOSTSIM_ADC_SCRIPT=file   analog inputs , see below
+//  HOSTSIM_PWM_LOG=file      every change of a PWM output: ms , timer , channel , CCR / period , duty
+//  HOSTSIM_GPIO_LOG=file     every change of an output data register: ms , port , ODR
+//
+//ADC script , one component per line , components on one channel add up , counts 0 .. 4095 (0 .. 3.3 V) , # comments:
+//  <channel> dc <counts>
+//  <channel> sine <amplitude> <hz> [phase in degrees]
+//  <channel> square <amplitude> <hz> [duty 0 .. 1]     0 or amplitude
+//  <channel> ramp <amplitude> <hz>                     saw tooth from 0 to amplitude
+//  <channel> noise <rms>                               gaussian , the same sequence every run
+//  <channel> step <counts> <ms>                        adds counts from that time on
+//channels 16 (temperature sensor at 25 C) and 17 (Vrefint) read their typical values unless the script sets them
+
+#include <stdint.h>
+#include "stm32f1xx.h"
+
+#define PERIPH_USART_QUEUE 4096		//bytes waiting to go onto one RX line
+
+typedef struct
+{
+	const char *tim;		//"TIM4"
+	uint8_t ch;			//1 .. 4
+	uint16_t ccr;
+	uint32_t period;		//ARR + 1
+	float duty;			//share of the period the pin is high , mode , polarity and enable applied
+	uint64_t t_ns;			//virtual time the new duty took effect
+} periph_pwm_t;
+
+//callbacks run in the simulator thread with hw_lock held
+typedef void (*periph_pwm_fn)(const periph_pwm_t *pwm, void *ctx);
+typedef void (*periph_gpio_fn)(GPIO_TypeDef *port, uint32_t odr, uint64_t t_ns, void *ctx);
+typedef void (*periph_usart_fn)(USART_TypeDef *usart, uint8_t byte, uint64_t t_ns, void *ctx);	//t_ns: end of the stop bit
+typedef int (*periph_i2c_fn)(int event, uint8_t byte, uint64_t t_ns, void *ctx);		//returns the ACK , see below
+typedef uint16_t (*periph_adc_fn)(int channel, uint64_t t_ns, void *ctx);
+
+//the firmware's own pointers (TIM4 , GPIOA , USART1) name the blocks
+void periph_pwm_monitor(periph_pwm_fn fn, void *ctx);
+void periph_pwm_state(TIM_TypeDef *tim, int ch, periph_pwm_t *pwm);
+
+void periph_gpio_monitor(periph_gpio_fn fn, void *ctx);
+void periph_gpio_drive(GPIO_TypeDef *port, int pin, int level);	//level -1 lets go of the pin
+uint32_t periph_gpio_odr(GPIO_TypeDef *port);
+
+int periph_usart_send_at(USART_TypeDef *usart, const void *data, uint32_t len, uint64_t t_ns);	//bytes queued , first not before t_ns
+int periph_usart_send(USART_TypeDef *usart, const void *data, uint32_t len);
+uint32_t periph_usart_pending(USART_TypeDef *usart);		//queued or on the line
+void periph_usart_callbacks(USART_TypeDef *usart, periph_usart_fn on_sent, periph_usart_fn on_received, void *ctx);
+void periph_usart_peer_baud(USART_TypeDef *usart, uint32_t baud);	//0 follows BRR , more than 3% off gives framing errors
+
+//a device on the bus , fn sees PERIPH_I2C_START with the address byte once it is on the bus , every data byte after
+//that it acknowledged and PERIPH_I2C_STOP (a repeated start is a START without a STOP) , up to 4 devices per bus
+#define PERIPH_I2C_START 0
+#define PERIPH_I2C_BYTE 1
+#define PERIPH_I2C_STOP 2
+void periph_i2c_device(I2C_TypeDef *i2c, uint8_t addr7, periph_i2c_fn fn, void *ctx);
+
+void periph_adc_source(int channel, periph_adc_fn fn, void *ctx);	//takes over from the script , fn 0 gives it back
+
+#endif
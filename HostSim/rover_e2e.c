@@ -0,0 +1,173 @@
+//end to end check of the Rover program on the peripheral models , link it in with the program and run it
+//
+//  gcc -O2 -I HostSim -I MyDrivers -x c Rover -x none HostSim/mmio.c HostSim/device.c HostSim/periph.c
+//      HostSim/rover_e2e.c MyDrivers/myuart.c MyDrivers/roverproto.c MyDrivers/drivemix.c MyDrivers/myctl.c
+//      MyDrivers/mypwm.c -lpthread -lm -o rover_e2e
+//  ./rover_e2e                      exit status 0 when every check passes
+//
+//latency:    single drive frames on USART1 at 115200 from a stopped rover , at random points of the 1 ms control tick and
+//            the PWM period , time from the stop bit of the 0x00 to the first new duty on TIM4 CH1 (the left motor)
+//failsafe:   the same frames are never followed by another , TIM4 CH1 must drop to 0 from COMMAND_TIMEOUT_MS after
+//            the frame , within one tick and two PWM periods , and not before
+//throughput: drive , arm and gear frames back to back on the line for two seconds , every one must reach its handler
+//            (cmdlink.stats) with no decoder errors and no byte lost in the receive ring (uart_rx_stats)
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "mmio.h"
+#include "periph.h"
+#include "myuart.h"
+#include "myctl.h"
+#include "roverproto.h"
+
+#define MS 1000000ULL
+#define START_NS (100 * MS)		//the program is set up long before this
+#define CYCLES 12
+#define CYCLE_NS (400 * MS)		//timeout , ramp and a pause
+#define LATENCY_LIMIT_NS (4 * MS)	//1 ms tick + 2 ms PWM period + the DMA and the main loop
+#define TIMEOUT_NS (250 * MS)		//COMMAND_TIMEOUT_MS in Rover
+#define FAILSAFE_SLACK_NS (6 * MS)
+#define BLAST_NS (2000 * MS)
+
+extern rover_rx_t cmdlink;		//in Rover
+
+static int failed;
+static uint32_t rng = 7;
+static uint64_t frame_end;		//stop bit of the last 0x00 on the line
+static uint32_t frames_sent;
+static int waiting;			//a frame went out , its first duty change is still to come
+static int running;			//TIM4 CH1 is off 0
+static int blasting;			//the stick is all over the place , a 0 duty is not a stop
+static uint64_t lat_min = ~0ULL, lat_max, lat_sum;
+static uint32_t lat_n;
+static uint64_t fs_min = ~0ULL, fs_max;
+static uint32_t fs_n;
+
+static uint32_t next(void)
+{
+	rng = rng * 1664525 + 1013904223;
+	return rng >> 8;
+}
+
+static void on_received(USART_TypeDef *usart, uint8_t byte, uint64_t t_ns, void *ctx)
+{
+	(void) usart;
+	(void) ctx;
+	if (!byte)
+		frame_end = t_ns;
+}
+
+static void on_pwm(const periph_pwm_t *pwm, void *ctx)
+{
+	uint64_t d;
+
+	(void) ctx;
+	if (strcmp(pwm->tim, "TIM4") || pwm->ch != 1)
+		return;
+	if (waiting && pwm->duty > 0 && pwm->t_ns >= frame_end)
+	{
+		d = pwm->t_ns - frame_end;
+		waiting = 0;
+		lat_min = d < lat_min ? d : lat_min;
+		lat_max = d > lat_max ? d : lat_max;
+		lat_sum += d;
+		lat_n++;
+	}
+	if (running && pwm->duty == 0 && !blasting)
+	{
+		d = pwm->t_ns - frame_end;
+		fs_min = d < fs_min ? d : fs_min;
+		fs_max = d > fs_max ? d : fs_max;
+		fs_n++;
+	}
+	running = pwm->duty > 0;
+}
+
+static uint32_t random_frame(uint8_t *out)
+{
+	int16_t arm[6];
+
+	switch (next() % 3)
+	{
+	case 0:
+		return rover_encode_drive((int16_t) (next() % 16001) - 8000, (int16_t) (next() % 16001) - 8000, out);
+	case 1:
+		for (int i = 0; i < 6; i++)
+			arm[i] = (int16_t) (next() % 16001) - 8000;
+		return rover_encode_arm(arm, out);
+	default:
+		return rover_encode_gear(1, out);
+	}
+}
+
+static void report(void)
+{
+	uint32_t expected = frames_sent;
+	int link_ok = cmdlink.stats.frames == expected && !cmdlink.stats.cobs && !cmdlink.stats.len && !cmdlink.stats.crc
+		&& !cmdlink.stats.type && !uart_rx_stats.overruns;
+	int lat_ok = lat_n == CYCLES && lat_max <= LATENCY_LIMIT_NS;
+	int fs_ok = fs_n >= CYCLES && fs_min >= TIMEOUT_NS - MS && fs_max <= TIMEOUT_NS + FAILSAFE_SLACK_NS;
+
+	printf("latency: %u of %u frames , min %.3f ms , mean %.3f ms , max %.3f ms (limit %.1f) %s\n", lat_n, CYCLES,
+		lat_min / 1e6, lat_n ? lat_sum / 1e6 / lat_n : 0.0, lat_max / 1e6, LATENCY_LIMIT_NS / 1e6, lat_ok ? "ok" : "FAIL");
+	printf("failsafe: %u stops , %.3f .. %.3f ms after the last frame (allowed %.1f .. %.1f) %s\n", fs_n,
+		fs_min / 1e6, fs_max / 1e6, (TIMEOUT_NS - MS) / 1e6, (TIMEOUT_NS + FAILSAFE_SLACK_NS) / 1e6, fs_ok ? "ok" : "FAIL");
+	printf("throughput: %u frames sent , %u handled , errors cobs %u len %u crc %u type %u , ring overruns %u %s\n",
+		expected, cmdlink.stats.frames, cmdlink.stats.cobs, cmdlink.stats.len, cmdlink.stats.crc, cmdlink.stats.type,
+		uart_rx_stats.overruns, link_ok ? "ok" : "FAIL");
+	printf("control loop: %u ticks , %u late , longest hook %u cycles\n", ctl_stats.ticks, ctl_stats.late, ctl_stats.max_cycles);
+	failed = !lat_ok || !fs_ok || !link_ok;
+	printf(failed ? "FAILED\n" : "all passed\n");
+}
+
+static uint64_t e2e_step(void *ctx, uint64_t now)
+{
+	static uint32_t cycle;
+	static uint64_t at = START_NS;
+	static uint64_t blast_end;
+	uint8_t buf[ROVER_WIRE_MAX];
+	uint32_t n;
+
+	(void) ctx;
+	if (now < at)
+		return at;
+	if (cycle < CYCLES)
+	{
+		//one frame from a standstill , the jitter moves it around the tick and the PWM period
+		n = rover_encode_drive(0, cycle & 1 ? -4000 : 4000, buf);
+		periph_usart_send(USART1, buf, n);
+		frames_sent++;
+		waiting = 1;
+		cycle++;
+		at = now + CYCLE_NS + next() % (3 * MS);
+		return at;
+	}
+	if (!blast_end)
+		blast_end = now + BLAST_NS;
+	blasting = now < blast_end;
+	if (blasting)
+	{
+		while (periph_usart_pending(USART1) < PERIPH_USART_QUEUE - ROVER_WIRE_MAX)
+		{
+			n = random_frame(buf);
+			periph_usart_send(USART1, buf, n);
+			frames_sent++;
+		}
+		return now + MS;
+	}
+	if (periph_usart_pending(USART1))
+		return now + MS;
+	if (now < frame_end + TIMEOUT_NS + 50 * MS)
+		return frame_end + TIMEOUT_NS + 50 * MS;	//the last failsafe and the last frames through the main loop
+	report();
+	fflush(stdout);
+	_exit(failed);
+}
+
+__attribute__((constructor(250))) static void rover_e2e_init(void)
+{
+	periph_usart_callbacks(USART1, 0, on_received, 0);
+	periph_pwm_monitor(on_pwm, 0);
+	sim_add_model(e2e_step, 0);
+}
@@ -0,0 +1,262 @@
+//host side of the rover command link (MyDrivers/roverproto.c)
+//
+//  rover_proto                          runs the checks , exit status 0 when every one passes
+//  rover_proto drive X Y                writes one frame to stdout (> /dev/ttyUSB0 after stty 115200 raw)
+//  rover_proto arm SW L1 L2 RO PI GR
+//  rover_proto gear G
+//
+//checks: CRC check value , COBS round trips (zeros everywhere , 254 byte runs) , every message type through the
+//byte stream decoder in random pieces , single bit errors and cut frames rejected , resync after garbage ,
+//link bytes against the old ASCII packets
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "roverproto.h"
+
+static int failed;
+
+static void check(int ok, const char *what)
+{
+	if (!ok)
+	{
+		printf("FAIL %s\n", what);
+		failed = 1;
+	}
+}
+
+static uint32_t rng = 2024;
+
+static uint32_t next(void)
+{
+	rng = rng * 1664525 + 1013904223;
+	return rng >> 8;
+}
+
+static int16_t got[ROVER_MSG_COUNT][ROVER_MAX_FIELDS];
+static uint32_t calls[ROVER_MSG_COUNT];
+
+static void on_drive(const int16_t *f, void *ctx)
+{
+	(void) ctx;
+	memcpy(got[ROVER_MSG_DRIVE], f, 2 * sizeof(*f));
+	calls[ROVER_MSG_DRIVE]++;
+}
+
+static void on_arm(const int16_t *f, void *ctx)
+{
+	(void) ctx;
+	memcpy(got[ROVER_MSG_ARM], f, 6 * sizeof(*f));
+	calls[ROVER_MSG_ARM]++;
+}
+
+static void on_gear(const int16_t *f, void *ctx)
+{
+	(void) ctx;
+	got[ROVER_MSG_GEAR][0] = f[0];
+	calls[ROVER_MSG_GEAR]++;
+}
+
+static const rover_cmd_t table[ROVER_MSG_COUNT] =
+{
+	[ROVER_MSG_DRIVE] = { 2, on_drive },
+	[ROVER_MSG_ARM] = { 6, on_arm },
+	[ROVER_MSG_GEAR] = { 1, on_gear },
+};
+
+static void crc(void)
+{
+	check(rover_crc16((const uint8_t *) "123456789", 9) == 0x29B1, "crc16 check value");
+}
+
+static void cobs(void)
+{
+	static uint8_t in[1000], enc[1010], dec[1010];
+	int bad = 0;
+
+	for (int t = 0; t < 20000; t++)
+	{
+		uint32_t len = next() % (t < 10000 ? 20 : 1000);
+		uint32_t zeros = next() % 4;		//0: none , 1: few , 2: many , 3: all
+		uint32_t n;
+		int m;
+
+		for (uint32_t i = 0; i < len; i++)
+		{
+			in[i] = 1 + next() % 255;
+			if (zeros == 3 || (zeros == 1 && next() % 50 == 0) || (zeros == 2 && next() % 3 == 0))
+				in[i] = 0;
+		}
+		n = rover_cobs_encode(in, len, enc);
+		if (n > len + 1 + len / 254 || memchr(enc, 0, n))
+			bad++;
+		m = rover_cobs_decode(enc, n, dec);
+		if (m != (int) len || memcmp(in, dec, len))
+			bad++;
+	}
+	check(!bad, "cobs round trip");
+
+	//run lengths right around the 254 byte block
+	for (uint32_t len = 250; len <= 512; len++)
+	{
+		uint32_t n;
+
+		memset(in, 0x55, len);
+		n = rover_cobs_encode(in, len, enc);
+		if (n != len + 1 + (len - 1) / 254 || rover_cobs_decode(enc, n, dec) != (int) len || memcmp(in, dec, len))
+			bad++;
+	}
+	check(!bad, "cobs 254 byte runs");
+
+	enc[0] = 5;
+	enc[1] = 1;
+	check(rover_cobs_decode(enc, 2, dec) == ROVER_ERR_COBS, "cobs code past the end");
+	enc[0] = 3;
+	enc[1] = 0;
+	enc[2] = 1;
+	check(rover_cobs_decode(enc, 3, dec) == ROVER_ERR_COBS, "cobs zero inside");
+}
+
+static uint32_t random_frame(uint8_t *wire, uint8_t *type, int16_t *fields)
+{
+	*type = 1 + next() % 3;
+	for (int i = 0; i < ROVER_MAX_FIELDS; i++)
+		fields[i] = next() % 3 == 0 ? (int16_t) (next() & 0xFF00) : (int16_t) next();	//zero low bytes now and then
+	if (*type == ROVER_MSG_DRIVE)
+		return rover_encode_drive(fields[0], fields[1], wire);
+	if (*type == ROVER_MSG_ARM)
+		return rover_encode_arm(fields, wire);
+	return rover_encode_gear(fields[0], wire);
+}
+
+static void stream(void)
+{
+	static uint8_t wire[2000000];
+	static uint8_t types[100000];
+	static int16_t fields[100000][ROVER_MAX_FIELDS];
+	static const uint8_t nf[ROVER_MSG_COUNT] = { 0, 2, 6, 1 };
+	rover_rx_t rx;
+	uint32_t n = 0, pos = 0, bad = 0;
+	int frames = 100000;
+
+	for (int k = 0; k < frames; k++)
+		n += random_frame(wire + n, &types[k], fields[k]);
+
+	//feed in random pieces , check each message right after its delimiter went in
+	rover_rx_init(&rx, table, 0);
+	memset(calls, 0, sizeof(calls));
+	for (int k = 0; k < frames; k++)
+	{
+		uint8_t *end = memchr(wire + pos, 0, n - pos) + 1;
+
+		while (wire + pos < end)
+		{
+			uint32_t piece = 1 + next() % 5;
+
+			if (wire + pos + piece > end)
+				piece = end - (wire + pos);
+			rover_rx_feed(&rx, wire + pos, piece);
+			pos += piece;
+		}
+		if (memcmp(got[types[k]], fields[k], nf[types[k]] * sizeof(int16_t)))
+			bad++;
+	}
+	check(!bad && rx.stats.frames == (uint32_t) frames, "stream decode");
+	check(calls[1] + calls[2] + calls[3] == (uint32_t) frames, "one handler call per frame");
+}
+
+static void errors(void)
+{
+	uint8_t wire[ROVER_WIRE_MAX], msg[ROVER_WIRE_MAX];
+	int16_t fields[ROVER_MAX_FIELDS] = { 100, -200, 300, -400, 500, -600 };
+	uint32_t n = rover_encode_arm(fields, wire), missed = 0, before;
+	rover_rx_t rx;
+
+	//every single bit error inside the frame must be caught (a flip to 0 splits the frame , that is caught too)
+	rover_rx_init(&rx, table, 0);
+	for (uint32_t i = 0; i < n - 1; i++)
+		for (int b = 0; b < 8; b++)
+		{
+			before = rx.stats.frames;
+			memcpy(msg, wire, n);
+			msg[i] ^= 1 << b;
+			rover_rx_feed(&rx, msg, n);
+			if (rx.stats.frames != before)
+				missed++;
+		}
+	check(!missed, "single bit errors");
+
+	//cut frame , wrong length for the type , unknown type
+	rover_rx_init(&rx, table, 0);
+	rover_rx_feed(&rx, wire, 4);
+	rover_rx_feed(&rx, (const uint8_t *) "", 1);
+	check(rx.stats.frames == 0 && rx.stats.cobs + rx.stats.len + rx.stats.crc == 1, "cut frame");
+	before = rx.stats.len;
+	n = rover_encode(ROVER_MSG_DRIVE, fields, 3, wire);
+	rover_rx_feed(&rx, wire, n);
+	check(rx.stats.len == before + 1, "length for the type");
+	n = rover_encode(7, fields, 1, wire);
+	rover_rx_feed(&rx, wire, n);
+	check(rx.stats.type == 1, "unknown type");
+
+	//garbage with no zero for longer than any frame , then a good frame
+	rover_rx_init(&rx, table, 0);
+	for (int i = 0; i < 300; i++)
+	{
+		msg[0] = 1 + next() % 255;
+		rover_rx_feed(&rx, msg, 1);
+	}
+	n = rover_encode_gear(4, wire);
+	rover_rx_feed(&rx, wire, n);
+	rover_rx_feed(&rx, wire, n);
+	check(rx.stats.len == 1 && rx.stats.frames == 1 && got[ROVER_MSG_GEAR][0] == 4, "resync after garbage");
+}
+
+static void sizes(void)
+{
+	uint8_t wire[ROVER_WIRE_MAX];
+	int16_t arm[6] = { 0 };
+	uint32_t drive = rover_encode_drive(0, 0, wire);
+	uint32_t armn = rover_encode_arm(arm, wire);
+
+	//ASCII: m <gear> s <5 digits> f <5 digits> <mast cam> , a then six of <letter> <5 digits>
+	printf("drive %u bytes (ASCII 15) , arm %u bytes (ASCII 37) , a drive + arm update %u vs 52\n",
+			drive, armn, drive + armn);
+	check(drive == 9 && armn == 17, "frame sizes");
+}
+
+static int send(int argc, char **argv)
+{
+	uint8_t wire[ROVER_WIRE_MAX];
+	int16_t f[ROVER_MAX_FIELDS];
+	uint32_t n = 0;
+
+	for (int i = 2; i < argc && i - 2 < ROVER_MAX_FIELDS; i++)
+		f[i - 2] = atoi(argv[i]);
+	if (!strcmp(argv[1], "drive") && argc == 4)
+		n = rover_encode_drive(f[0], f[1], wire);
+	else if (!strcmp(argv[1], "arm") && argc == 8)
+		n = rover_encode_arm(f, wire);
+	else if (!strcmp(argv[1], "gear") && argc == 3)
+		n = rover_encode_gear(f[0], wire);
+	if (!n)
+	{
+		fprintf(stderr, "usage: rover_proto [drive X Y | arm SW L1 L2 RO PI GR | gear G]\n");
+		return 2;
+	}
+	fwrite(wire, 1, n, stdout);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1)
+		return send(argc, argv);
+	crc();
+	cobs();
+	stream();
+	errors();
+	sizes();
+	printf(failed ? "FAILED\n" : "all passed\n");
+	return failed;
+}
@@ -0,0 +1,7 @@
+#ifndef STM32F10X_H
+#define STM32F10X_H
+
+//older programs include the SPL name of the device header
+#include "stm32f1xx.h"
+
+#endif
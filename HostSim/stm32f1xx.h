@@ -0,0 +1,1323 @@
+#ifndef STM32F1XX_H
+#define STM32F1XX_H
+
+//host build stand in for the CMSIS device header (STM32F103xB register layout)
+//peripheral pointers are set up before main() by the HostSim models , see mmio.h
+
+#include <stdint.h>
+
+#define __I volatile const
+#define __O volatile
+#define __IO volatile
+#define __WEAK __attribute__((weak))
+#define __STATIC_INLINE static inline
+
+typedef enum
+{
+	NonMaskableInt_IRQn = -14,
+	HardFault_IRQn = -13,
+	MemoryManagement_IRQn = -12,
+	BusFault_IRQn = -11,
+	UsageFault_IRQn = -10,
+	SVCall_IRQn = -5,
+	DebugMonitor_IRQn = -4,
+	PendSV_IRQn = -2,
+	SysTick_IRQn = -1,
+	WWDG_IRQn = 0,
+	PVD_IRQn = 1,
+	TAMPER_IRQn = 2,
+	RTC_IRQn = 3,
+	FLASH_IRQn = 4,
+	RCC_IRQn = 5,
+	EXTI0_IRQn = 6,
+	EXTI1_IRQn = 7,
+	EXTI2_IRQn = 8,
+	EXTI3_IRQn = 9,
+	EXTI4_IRQn = 10,
+	DMA1_Channel1_IRQn = 11,
+	DMA1_Channel2_IRQn = 12,
+	DMA1_Channel3_IRQn = 13,
+	DMA1_Channel4_IRQn = 14,
+	DMA1_Channel5_IRQn = 15,
+	DMA1_Channel6_IRQn = 16,
+	DMA1_Channel7_IRQn = 17,
+	ADC1_2_IRQn = 18,
+	USB_HP_CAN1_TX_IRQn = 19,
+	USB_LP_CAN1_RX0_IRQn = 20,
+	CAN1_RX1_IRQn = 21,
+	CAN1_SCE_IRQn = 22,
+	EXTI9_5_IRQn = 23,
+	TIM1_BRK_IRQn = 24,
+	TIM1_UP_IRQn = 25,
+	TIM1_TRG_COM_IRQn = 26,
+	TIM1_CC_IRQn = 27,
+	TIM2_IRQn = 28,
+	TIM3_IRQn = 29,
+	TIM4_IRQn = 30,
+	I2C1_EV_IRQn = 31,
+	I2C1_ER_IRQn = 32,
+	I2C2_EV_IRQn = 33,
+	I2C2_ER_IRQn = 34,
+	SPI1_IRQn = 35,
+	SPI2_IRQn = 36,
+	USART1_IRQn = 37,
+	USART2_IRQn = 38,
+	USART3_IRQn = 39,
+	EXTI15_10_IRQn = 40,
+	RTC_Alarm_IRQn = 41,
+	USBWakeUp_IRQn = 42
+} IRQn_Type;
+
+//------------------------------------------------------------------ register blocks
+
+typedef struct
+{
+	__IO uint32_t TIR;
+	__IO uint32_t TDTR;
+	__IO uint32_t TDLR;
+	__IO uint32_t TDHR;
+} CAN_TxMailBox_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t RIR;
+	__IO uint32_t RDTR;
+	__IO uint32_t RDLR;
+	__IO uint32_t RDHR;
+} CAN_FIFOMailBox_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t FR1;
+	__IO uint32_t FR2;
+} CAN_FilterRegister_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t MCR;
+	__IO uint32_t MSR;
+	__IO uint32_t TSR;
+	__IO uint32_t RF0R;
+	__IO uint32_t RF1R;
+	__IO uint32_t IER;
+	__IO uint32_t ESR;
+	__IO uint32_t BTR;
+	uint32_t RESERVED0[88];
+	CAN_TxMailBox_TypeDef sTxMailBox[3];
+	CAN_FIFOMailBox_TypeDef sFIFOMailBox[2];
+	uint32_t RESERVED1[12];
+	__IO uint32_t FMR;
+	__IO uint32_t FM1R;
+	uint32_t RESERVED2;
+	__IO uint32_t FS1R;
+	uint32_t RESERVED3;
+	__IO uint32_t FFA1R;
+	uint32_t RESERVED4;
+	__IO uint32_t FA1R;
+	uint32_t RESERVED5[8];
+	CAN_FilterRegister_TypeDef sFilterRegister[14];
+} CAN_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CR;
+	__IO uint32_t CFGR;
+	__IO uint32_t CIR;
+	__IO uint32_t APB2RSTR;
+	__IO uint32_t APB1RSTR;
+	__IO uint32_t AHBENR;
+	__IO uint32_t APB2ENR;
+	__IO uint32_t APB1ENR;
+	__IO uint32_t BDCR;
+	__IO uint32_t CSR;
+} RCC_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CRL;
+	__IO uint32_t CRH;
+	__IO uint32_t IDR;
+	__IO uint32_t ODR;
+	__IO uint32_t BSRR;
+	__IO uint32_t BRR;
+	__IO uint32_t LCKR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t EVCR;
+	__IO uint32_t MAPR;
+	__IO uint32_t EXTICR[4];
+	uint32_t RESERVED0;
+	__IO uint32_t MAPR2;
+} AFIO_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t SMCR;
+	__IO uint32_t DIER;
+	__IO uint32_t SR;
+	__IO uint32_t EGR;
+	__IO uint32_t CCMR1;
+	__IO uint32_t CCMR2;
+	__IO uint32_t CCER;
+	__IO uint32_t CNT;
+	__IO uint32_t PSC;
+	__IO uint32_t ARR;
+	__IO uint32_t RCR;
+	__IO uint32_t CCR1;
+	__IO uint32_t CCR2;
+	__IO uint32_t CCR3;
+	__IO uint32_t CCR4;
+	__IO uint32_t BDTR;
+	__IO uint32_t DCR;
+	__IO uint32_t DMAR;
+	__IO uint32_t OR;
+} TIM_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t SR;
+	__IO uint32_t DR;
+	__IO uint32_t BRR;
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t CR3;
+	__IO uint32_t GTPR;
+} USART_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t SR;
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t SMPR1;
+	__IO uint32_t SMPR2;
+	__IO uint32_t JOFR1;
+	__IO uint32_t JOFR2;
+	__IO uint32_t JOFR3;
+	__IO uint32_t JOFR4;
+	__IO uint32_t HTR;
+	__IO uint32_t LTR;
+	__IO uint32_t SQR1;
+	__IO uint32_t SQR2;
+	__IO uint32_t SQR3;
+	__IO uint32_t JSQR;
+	__IO uint32_t JDR1;
+	__IO uint32_t JDR2;
+	__IO uint32_t JDR3;
+	__IO uint32_t JDR4;
+	__IO uint32_t DR;
+} ADC_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t ISR;
+	__IO uint32_t IFCR;
+} DMA_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CCR;
+	__IO uint32_t CNDTR;
+	__IO uint32_t CPAR;
+	__IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t OAR1;
+	__IO uint32_t OAR2;
+	__IO uint32_t DR;
+	__IO uint32_t SR1;
+	__IO uint32_t SR2;
+	__IO uint32_t CCR;
+	__IO uint32_t TRISE;
+} I2C_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t SR;
+	__IO uint32_t DR;
+	__IO uint32_t CRCPR;
+	__IO uint32_t RXCRCR;
+	__IO uint32_t TXCRCR;
+	__IO uint32_t I2SCFGR;
+} SPI_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t CTRL;
+	__IO uint32_t LOAD;
+	__IO uint32_t VAL;
+	__I uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct
+{
+	__IO uint32_t CTRL;
+	__IO uint32_t CYCCNT;
+	__IO uint32_t CPICNT;
+	__IO uint32_t EXCCNT;
+	__IO uint32_t SLEEPCNT;
+	__IO uint32_t LSUCNT;
+	__IO uint32_t FOLDCNT;
+	__I uint32_t PCSR;
+} DWT_Type;
+
+typedef struct
+{
+	__IO uint32_t ACR;
+	__IO uint32_t KEYR;
+	__IO uint32_t OPTKEYR;
+	__IO uint32_t SR;
+	__IO uint32_t CR;
+	__IO uint32_t AR;
+	uint32_t RESERVED;
+	__IO uint32_t OBR;
+	__IO uint32_t WRPR;
+} FLASH_TypeDef;
+
+typedef struct
+{
+	__IO uint32_t DHCSR;
+	__O uint32_t DCRSR;
+	__IO uint32_t DCRDR;
+	__IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+//------------------------------------------------------------------ instances
+
+extern CAN_TypeDef *CAN1;
+extern RCC_TypeDef *RCC;
+extern GPIO_TypeDef *GPIOA, *GPIOB, *GPIOC;
+extern AFIO_TypeDef *AFIO;
+extern TIM_TypeDef *TIM1, *TIM2, *TIM3, *TIM4;
+extern USART_TypeDef *USART1, *USART2, *USART3;
+extern ADC_TypeDef *ADC1, *ADC2;
+extern DMA_TypeDef *DMA1;
+extern DMA_Channel_TypeDef *DMA1_Channel1, *DMA1_Channel2, *DMA1_Channel3, *DMA1_Channel4;
+extern DMA_Channel_TypeDef *DMA1_Channel5, *DMA1_Channel6, *DMA1_Channel7;
+extern I2C_TypeDef *I2C1, *I2C2;
+extern SPI_TypeDef *SPI1, *SPI2;
+extern SysTick_Type *SysTick;
+extern DWT_Type *DWT;
+extern CoreDebug_Type *CoreDebug;
+extern FLASH_TypeDef *FLASH;
+
+//------------------------------------------------------------------ core
+
+extern uint32_t SystemCoreClock;
+void SystemInit(void);
+void SystemCoreClockUpdate(void);
+uint32_t SysTick_Config(uint32_t ticks);
+
+void NVIC_EnableIRQ(IRQn_Type irqn);
+void NVIC_DisableIRQ(IRQn_Type irqn);
+void NVIC_SetPriority(IRQn_Type irqn, uint32_t priority);
+void NVIC_SetPendingIRQ(IRQn_Type irqn);
+
+//PRIMASK is the interrupt signal mask of the firmware thread
+void sim_irq_disable(void);
+void sim_irq_enable(void);
+uint32_t sim_irq_masked(void);
+void sim_wfi(void);
+
+__STATIC_INLINE void __disable_irq(void)
+{
+	sim_irq_disable();
+}
+
+__STATIC_INLINE void __enable_irq(void)
+{
+	sim_irq_enable();
+}
+
+__STATIC_INLINE uint32_t __get_PRIMASK(void)
+{
+	return sim_irq_masked();
+}
+
+__STATIC_INLINE void __set_PRIMASK(uint32_t primask)
+{
+	if (primask & 1)
+		sim_irq_disable();
+	else
+		sim_irq_enable();
+}
+
+__STATIC_INLINE void __DMB(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_INLINE void __DSB(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_INLINE void __ISB(void)
+{
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_INLINE void __NOP(void)
+{
+}
+
+__STATIC_INLINE void __WFI(void)
+{
+	sim_wfi();
+}
+
+#define SysTick_CTRL_ENABLE_Msk 0x00000001U
+#define SysTick_CTRL_TICKINT_Msk 0x00000002U
+#define SysTick_CTRL_CLKSOURCE_Msk 0x00000004U
+#define SysTick_CTRL_COUNTFLAG_Msk 0x00010000U
+#define SysTick_LOAD_RELOAD_Msk 0x00FFFFFFU
+
+#define DWT_CTRL_CYCCNTENA_Msk 0x00000001U
+#define CoreDebug_DEMCR_TRCENA_Msk 0x01000000U
+
+//------------------------------------------------------------------ bxCAN
+
+#define CAN_MCR_INRQ 0x00000001U
+#define CAN_MCR_SLEEP 0x00000002U
+#define CAN_MCR_TXFP 0x00000004U
+#define CAN_MCR_RFLM 0x00000008U
+#define CAN_MCR_NART 0x00000010U
+#define CAN_MCR_AWUM 0x00000020U
+#define CAN_MCR_ABOM 0x00000040U
+#define CAN_MCR_TTCM 0x00000080U
+#define CAN_MCR_RESET 0x00008000U
+#define CAN_MCR_DBF 0x00010000U
+
+#define CAN_MSR_INAK 0x00000001U
+#define CAN_MSR_SLAK 0x00000002U
+#define CAN_MSR_ERRI 0x00000004U
+#define CAN_MSR_WKUI 0x00000008U
+#define CAN_MSR_SLAKI 0x00000010U
+#define CAN_MSR_TXM 0x00000100U
+#define CAN_MSR_RXM 0x00000200U
+#define CAN_MSR_SAMP 0x00000400U
+#define CAN_MSR_RX 0x00000800U
+
+#define CAN_TSR_RQCP0 0x00000001U
+#define CAN_TSR_TXOK0 0x00000002U
+#define CAN_TSR_ALST0 0x00000004U
+#define CAN_TSR_TERR0 0x00000008U
+#define CAN_TSR_ABRQ0 0x00000080U
+#define CAN_TSR_RQCP1 0x00000100U
+#define CAN_TSR_TXOK1 0x00000200U
+#define CAN_TSR_ALST1 0x00000400U
+#define CAN_TSR_TERR1 0x00000800U
+#define CAN_TSR_ABRQ1 0x00008000U
+#define CAN_TSR_RQCP2 0x00010000U
+#define CAN_TSR_TXOK2 0x00020000U
+#define CAN_TSR_ALST2 0x00040000U
+#define CAN_TSR_TERR2 0x00080000U
+#define CAN_TSR_ABRQ2 0x00800000U
+#define CAN_TSR_CODE 0x03000000U
+#define CAN_TSR_TME 0x1C000000U
+#define CAN_TSR_TME0 0x04000000U
+#define CAN_TSR_TME1 0x08000000U
+#define CAN_TSR_TME2 0x10000000U
+#define CAN_TSR_LOW 0xE0000000U
+#define CAN_TSR_LOW0 0x20000000U
+#define CAN_TSR_LOW1 0x40000000U
+#define CAN_TSR_LOW2 0x80000000U
+
+#define CAN_RF0R_FMP0 0x00000003U
+#define CAN_RF0R_FULL0 0x00000008U
+#define CAN_RF0R_FOVR0 0x00000010U
+#define CAN_RF0R_RFOM0 0x00000020U
+#define CAN_RF1R_FMP1 0x00000003U
+#define CAN_RF1R_FULL1 0x00000008U
+#define CAN_RF1R_FOVR1 0x00000010U
+#define CAN_RF1R_RFOM1 0x00000020U
+
+#define CAN_IER_TMEIE 0x00000001U
+#define CAN_IER_FMPIE0 0x00000002U
+#define CAN_IER_FFIE0 0x00000004U
+#define CAN_IER_FOVIE0 0x00000008U
+#define CAN_IER_FMPIE1 0x00000010U
+#define CAN_IER_FFIE1 0x00000020U
+#define CAN_IER_FOVIE1 0x00000040U
+#define CAN_IER_EWGIE 0x00000100U
+#define CAN_IER_EPVIE 0x00000200U
+#define CAN_IER_BOFIE 0x00000400U
+#define CAN_IER_LECIE 0x00000800U
+#define CAN_IER_ERRIE 0x00008000U
+#define CAN_IER_WKUIE 0x00010000U
+#define CAN_IER_SLKIE 0x00020000U
+
+#define CAN_ESR_EWGF 0x00000001U
+#define CAN_ESR_EPVF 0x00000002U
+#define CAN_ESR_BOFF 0x00000004U
+#define CAN_ESR_LEC 0x00000070U
+#define CAN_ESR_LEC_0 0x00000010U
+#define CAN_ESR_LEC_1 0x00000020U
+#define CAN_ESR_LEC_2 0x00000040U
+#define CAN_ESR_TEC 0x00FF0000U
+#define CAN_ESR_REC 0xFF000000U
+
+#define CAN_BTR_BRP 0x000003FFU
+#define CAN_BTR_TS1 0x000F0000U
+#define CAN_BTR_TS2 0x00700000U
+#define CAN_BTR_SJW 0x03000000U
+#define CAN_BTR_LBKM 0x40000000U
+#define CAN_BTR_SILM 0x80000000U
+
+#define CAN_TI0R_TXRQ 0x00000001U
+#define CAN_TI0R_RTR 0x00000002U
+#define CAN_TI0R_IDE 0x00000004U
+#define CAN_TI0R_EXID 0x001FFFF8U
+#define CAN_TI0R_STID 0xFFE00000U
+#define CAN_TDT0R_DLC 0x0000000FU
+#define CAN_TDT0R_TGT 0x00000100U
+#define CAN_TDT0R_TIME 0xFFFF0000U
+#define CAN_TI1R_TXRQ CAN_TI0R_TXRQ
+#define CAN_TI1R_RTR CAN_TI0R_RTR
+#define CAN_TI1R_IDE CAN_TI0R_IDE
+#define CAN_TI2R_TXRQ CAN_TI0R_TXRQ
+#define CAN_TI2R_RTR CAN_TI0R_RTR
+#define CAN_TI2R_IDE CAN_TI0R_IDE
+
+#define CAN_RI0R_RTR 0x00000002U
+#define CAN_RI0R_IDE 0x00000004U
+#define CAN_RI0R_EXID 0x001FFFF8U
+#define CAN_RI0R_STID 0xFFE00000U
+#define CAN_RDT0R_DLC 0x0000000FU
+#define CAN_RDT0R_FMI 0x0000FF00U
+#define CAN_RDT0R_TIME 0xFFFF0000U
+#define CAN_RI1R_RTR CAN_RI0R_RTR
+#define CAN_RI1R_IDE CAN_RI0R_IDE
+#define CAN_RDT1R_DLC CAN_RDT0R_DLC
+#define CAN_RDT1R_FMI CAN_RDT0R_FMI
+
+#define CAN_FMR_FINIT 0x00000001U
+
+#define CAN_FM1R_FBM0 0x00000001U
+#define CAN_FM1R_FBM1 0x00000002U
+#define CAN_FM1R_FBM2 0x00000004U
+#define CAN_FM1R_FBM3 0x00000008U
+#define CAN_FM1R_FBM4 0x00000010U
+#define CAN_FM1R_FBM5 0x00000020U
+#define CAN_FM1R_FBM6 0x00000040U
+#define CAN_FM1R_FBM7 0x00000080U
+#define CAN_FM1R_FBM8 0x00000100U
+#define CAN_FM1R_FBM9 0x00000200U
+#define CAN_FM1R_FBM10 0x00000400U
+#define CAN_FM1R_FBM11 0x00000800U
+#define CAN_FM1R_FBM12 0x00001000U
+#define CAN_FM1R_FBM13 0x00002000U
+
+#define CAN_FS1R_FSC0 0x00000001U
+#define CAN_FS1R_FSC1 0x00000002U
+#define CAN_FS1R_FSC2 0x00000004U
+#define CAN_FS1R_FSC3 0x00000008U
+#define CAN_FS1R_FSC4 0x00000010U
+#define CAN_FS1R_FSC5 0x00000020U
+#define CAN_FS1R_FSC6 0x00000040U
+#define CAN_FS1R_FSC7 0x00000080U
+#define CAN_FS1R_FSC8 0x00000100U
+#define CAN_FS1R_FSC9 0x00000200U
+#define CAN_FS1R_FSC10 0x00000400U
+#define CAN_FS1R_FSC11 0x00000800U
+#define CAN_FS1R_FSC12 0x00001000U
+#define CAN_FS1R_FSC13 0x00002000U
+
+#define CAN_FFA1R_FFA0 0x00000001U
+#define CAN_FFA1R_FFA1 0x00000002U
+#define CAN_FFA1R_FFA2 0x00000004U
+#define CAN_FFA1R_FFA3 0x00000008U
+#define CAN_FFA1R_FFA4 0x00000010U
+#define CAN_FFA1R_FFA5 0x00000020U
+#define CAN_FFA1R_FFA6 0x00000040U
+#define CAN_FFA1R_FFA7 0x00000080U
+#define CAN_FFA1R_FFA8 0x00000100U
+#define CAN_FFA1R_FFA9 0x00000200U
+#define CAN_FFA1R_FFA10 0x00000400U
+#define CAN_FFA1R_FFA11 0x00000800U
+#define CAN_FFA1R_FFA12 0x00001000U
+#define CAN_FFA1R_FFA13 0x00002000U
+
+#define CAN_FA1R_FACT0 0x00000001U
+#define CAN_FA1R_FACT1 0x00000002U
+#define CAN_FA1R_FACT2 0x00000004U
+#define CAN_FA1R_FACT3 0x00000008U
+#define CAN_FA1R_FACT4 0x00000010U
+#define CAN_FA1R_FACT5 0x00000020U
+#define CAN_FA1R_FACT6 0x00000040U
+#define CAN_FA1R_FACT7 0x00000080U
+#define CAN_FA1R_FACT8 0x00000100U
+#define CAN_FA1R_FACT9 0x00000200U
+#define CAN_FA1R_FACT10 0x00000400U
+#define CAN_FA1R_FACT11 0x00000800U
+#define CAN_FA1R_FACT12 0x00001000U
+#define CAN_FA1R_FACT13 0x00002000U
+
+//------------------------------------------------------------------ GPIO
+
+#define GPIO_CRL_MODE0 0x00000003U
+#define GPIO_CRL_MODE0_0 0x00000001U
+#define GPIO_CRL_MODE0_1 0x00000002U
+#define GPIO_CRL_CNF0 0x0000000CU
+#define GPIO_CRL_CNF0_0 0x00000004U
+#define GPIO_CRL_CNF0_1 0x00000008U
+#define GPIO_CRL_MODE1 0x00000030U
+#define GPIO_CRL_MODE1_0 0x00000010U
+#define GPIO_CRL_MODE1_1 0x00000020U
+#define GPIO_CRL_CNF1 0x000000C0U
+#define GPIO_CRL_CNF1_0 0x00000040U
+#define GPIO_CRL_CNF1_1 0x00000080U
+#define GPIO_CRL_MODE2 0x00000300U
+#define GPIO_CRL_MODE2_0 0x00000100U
+#define GPIO_CRL_MODE2_1 0x00000200U
+#define GPIO_CRL_CNF2 0x00000C00U
+#define GPIO_CRL_CNF2_0 0x00000400U
+#define GPIO_CRL_CNF2_1 0x00000800U
+#define GPIO_CRL_MODE3 0x00003000U
+#define GPIO_CRL_MODE3_0 0x00001000U
+#define GPIO_CRL_MODE3_1 0x00002000U
+#define GPIO_CRL_CNF3 0x0000C000U
+#define GPIO_CRL_CNF3_0 0x00004000U
+#define GPIO_CRL_CNF3_1 0x00008000U
+#define GPIO_CRL_MODE4 0x00030000U
+#define GPIO_CRL_MODE4_0 0x00010000U
+#define GPIO_CRL_MODE4_1 0x00020000U
+#define GPIO_CRL_CNF4 0x000C0000U
+#define GPIO_CRL_CNF4_0 0x00040000U
+#define GPIO_CRL_CNF4_1 0x00080000U
+#define GPIO_CRL_MODE5 0x00300000U
+#define GPIO_CRL_MODE5_0 0x00100000U
+#define GPIO_CRL_MODE5_1 0x00200000U
+#define GPIO_CRL_CNF5 0x00C00000U
+#define GPIO_CRL_CNF5_0 0x00400000U
+#define GPIO_CRL_CNF5_1 0x00800000U
+#define GPIO_CRL_MODE6 0x03000000U
+#define GPIO_CRL_MODE6_0 0x01000000U
+#define GPIO_CRL_MODE6_1 0x02000000U
+#define GPIO_CRL_CNF6 0x0C000000U
+#define GPIO_CRL_CNF6_0 0x04000000U
+#define GPIO_CRL_CNF6_1 0x08000000U
+#define GPIO_CRL_MODE7 0x30000000U
+#define GPIO_CRL_MODE7_0 0x10000000U
+#define GPIO_CRL_MODE7_1 0x20000000U
+#define GPIO_CRL_CNF7 0xC0000000U
+#define GPIO_CRL_CNF7_0 0x40000000U
+#define GPIO_CRL_CNF7_1 0x80000000U
+
+#define GPIO_CRH_MODE8 0x00000003U
+#define GPIO_CRH_MODE8_0 0x00000001U
+#define GPIO_CRH_MODE8_1 0x00000002U
+#define GPIO_CRH_CNF8 0x0000000CU
+#define GPIO_CRH_CNF8_0 0x00000004U
+#define GPIO_CRH_CNF8_1 0x00000008U
+#define GPIO_CRH_MODE9 0x00000030U
+#define GPIO_CRH_MODE9_0 0x00000010U
+#define GPIO_CRH_MODE9_1 0x00000020U
+#define GPIO_CRH_CNF9 0x000000C0U
+#define GPIO_CRH_CNF9_0 0x00000040U
+#define GPIO_CRH_CNF9_1 0x00000080U
+#define GPIO_CRH_MODE10 0x00000300U
+#define GPIO_CRH_MODE10_0 0x00000100U
+#define GPIO_CRH_MODE10_1 0x00000200U
+#define GPIO_CRH_CNF10 0x00000C00U
+#define GPIO_CRH_CNF10_0 0x00000400U
+#define GPIO_CRH_CNF10_1 0x00000800U
+#define GPIO_CRH_MODE11 0x00003000U
+#define GPIO_CRH_MODE11_0 0x00001000U
+#define GPIO_CRH_MODE11_1 0x00002000U
+#define GPIO_CRH_CNF11 0x0000C000U
+#define GPIO_CRH_CNF11_0 0x00004000U
+#define GPIO_CRH_CNF11_1 0x00008000U
+#define GPIO_CRH_MODE12 0x00030000U
+#define GPIO_CRH_MODE12_0 0x00010000U
+#define GPIO_CRH_MODE12_1 0x00020000U
+#define GPIO_CRH_CNF12 0x000C0000U
+#define GPIO_CRH_CNF12_0 0x00040000U
+#define GPIO_CRH_CNF12_1 0x00080000U
+#define GPIO_CRH_MODE13 0x00300000U
+#define GPIO_CRH_MODE13_0 0x00100000U
+#define GPIO_CRH_MODE13_1 0x00200000U
+#define GPIO_CRH_CNF13 0x00C00000U
+#define GPIO_CRH_CNF13_0 0x00400000U
+#define GPIO_CRH_CNF13_1 0x00800000U
+#define GPIO_CRH_MODE14 0x03000000U
+#define GPIO_CRH_MODE14_0 0x01000000U
+#define GPIO_CRH_MODE14_1 0x02000000U
+#define GPIO_CRH_CNF14 0x0C000000U
+#define GPIO_CRH_CNF14_0 0x04000000U
+#define GPIO_CRH_CNF14_1 0x08000000U
+#define GPIO_CRH_MODE15 0x30000000U
+#define GPIO_CRH_MODE15_0 0x10000000U
+#define GPIO_CRH_MODE15_1 0x20000000U
+#define GPIO_CRH_CNF15 0xC0000000U
+#define GPIO_CRH_CNF15_0 0x40000000U
+#define GPIO_CRH_CNF15_1 0x80000000U
+
+#define GPIO_BSRR_BS13 0x00002000U
+#define GPIO_BSRR_BR13 0x20000000U
+
+//------------------------------------------------------------------ AFIO
+
+#define AFIO_MAPR_USART1_REMAP 0x00000004U
+#define AFIO_MAPR_SWJ_CFG 0x07000000U
+#define AFIO_MAPR_SWJ_CFG_0 0x01000000U
+#define AFIO_MAPR_SWJ_CFG_1 0x02000000U
+#define AFIO_MAPR_SWJ_CFG_2 0x04000000U
+#define AFIO_MAPR_SWJ_CFG_JTAGDISABLE 0x02000000U
+#define AFIO_MAPR_SWJ_CFG_DISABLE 0x04000000U
+
+//------------------------------------------------------------------ FLASH
+
+#define FLASH_ACR_LATENCY 0x00000007U
+#define FLASH_ACR_LATENCY_0 0x00000001U
+#define FLASH_ACR_LATENCY_1 0x00000002U
+#define FLASH_ACR_HLFCYA 0x00000008U
+#define FLASH_ACR_PRFTBE 0x00000010U
+#define FLASH_ACR_PRFTBS 0x00000020U
+
+//------------------------------------------------------------------ RCC
+
+#define RCC_CR_HSION 0x00000001U
+#define RCC_CR_HSIRDY 0x00000002U
+#define RCC_CR_HSEON 0x00010000U
+#define RCC_CR_HSERDY 0x00020000U
+#define RCC_CR_HSEBYP 0x00040000U
+#define RCC_CR_CSSON 0x00080000U
+#define RCC_CR_PLLON 0x01000000U
+#define RCC_CR_PLLRDY 0x02000000U
+
+#define RCC_CFGR_SW 0x00000003U
+#define RCC_CFGR_SW_HSI 0x00000000U
+#define RCC_CFGR_SW_HSE 0x00000001U
+#define RCC_CFGR_SW_PLL 0x00000002U
+#define RCC_CFGR_SWS 0x0000000CU
+#define RCC_CFGR_SWS_HSI 0x00000000U
+#define RCC_CFGR_SWS_HSE 0x00000004U
+#define RCC_CFGR_SWS_PLL 0x00000008U
+#define RCC_CFGR_HPRE 0x000000F0U
+#define RCC_CFGR_HPRE_DIV1 0x00000000U
+#define RCC_CFGR_HPRE_DIV2 0x00000080U
+#define RCC_CFGR_HPRE_DIV4 0x00000090U
+#define RCC_CFGR_HPRE_DIV8 0x000000A0U
+#define RCC_CFGR_HPRE_DIV16 0x000000B0U
+#define RCC_CFGR_PPRE1 0x00000700U
+#define RCC_CFGR_PPRE1_DIV1 0x00000000U
+#define RCC_CFGR_PPRE1_DIV2 0x00000400U
+#define RCC_CFGR_PPRE1_DIV4 0x00000500U
+#define RCC_CFGR_PPRE1_DIV8 0x00000600U
+#define RCC_CFGR_PPRE1_DIV16 0x00000700U
+#define RCC_CFGR_PPRE2 0x00003800U
+#define RCC_CFGR_PPRE2_DIV1 0x00000000U
+#define RCC_CFGR_PPRE2_DIV2 0x00002000U
+#define RCC_CFGR_PPRE2_DIV4 0x00002800U
+#define RCC_CFGR_PPRE2_DIV8 0x00003000U
+#define RCC_CFGR_PPRE2_DIV16 0x00003800U
+#define RCC_CFGR_PLLSRC 0x00010000U
+#define RCC_CFGR_PLLXTPRE 0x00020000U
+#define RCC_CFGR_PLLMULL 0x003C0000U
+#define RCC_CFGR_PLLMULL2 0x00000000U
+#define RCC_CFGR_PLLMULL3 0x00040000U
+#define RCC_CFGR_PLLMULL4 0x00080000U
+#define RCC_CFGR_PLLMULL5 0x000C0000U
+#define RCC_CFGR_PLLMULL6 0x00100000U
+#define RCC_CFGR_PLLMULL7 0x00140000U
+#define RCC_CFGR_PLLMULL8 0x00180000U
+#define RCC_CFGR_PLLMULL9 0x001C0000U
+#define RCC_CFGR_PLLMULL10 0x00200000U
+#define RCC_CFGR_PLLMULL11 0x00240000U
+#define RCC_CFGR_PLLMULL12 0x00280000U
+#define RCC_CFGR_PLLMULL13 0x002C0000U
+#define RCC_CFGR_PLLMULL14 0x00300000U
+#define RCC_CFGR_PLLMULL15 0x00340000U
+#define RCC_CFGR_PLLMULL16 0x00380000U
+#define RCC_CFGR_USBPRE 0x00400000U
+#define RCC_CFGR_ADCPRE 0x0000C000U
+#define RCC_CFGR_ADCPRE_DIV2 0x00000000U
+#define RCC_CFGR_ADCPRE_DIV4 0x00004000U
+#define RCC_CFGR_ADCPRE_DIV6 0x00008000U
+#define RCC_CFGR_ADCPRE_DIV8 0x0000C000U
+
+#define RCC_AHBENR_DMA1EN 0x00000001U
+
+#define RCC_APB2ENR_AFIOEN 0x00000001U
+#define RCC_APB2ENR_IOPAEN 0x00000004U
+#define RCC_APB2ENR_IOPBEN 0x00000008U
+#define RCC_APB2ENR_IOPCEN 0x00000010U
+#define RCC_APB2ENR_ADC1EN 0x00000200U
+#define RCC_APB2ENR_ADC2EN 0x00000400U
+#define RCC_APB2ENR_TIM1EN 0x00000800U
+#define RCC_APB2ENR_SPI1EN 0x00001000U
+#define RCC_APB2ENR_USART1EN 0x00004000U
+
+#define RCC_APB1ENR_TIM2EN 0x00000001U
+#define RCC_APB1ENR_TIM3EN 0x00000002U
+#define RCC_APB1ENR_TIM4EN 0x00000004U
+#define RCC_APB1ENR_SPI2EN 0x00004000U
+#define RCC_APB1ENR_USART2EN 0x00020000U
+#define RCC_APB1ENR_USART3EN 0x00040000U
+#define RCC_APB1ENR_I2C1EN 0x00200000U
+#define RCC_APB1ENR_I2C2EN 0x00400000U
+#define RCC_APB1ENR_CAN1EN 0x02000000U
+
+//------------------------------------------------------------------ ADC
+
+#define ADC_SR_AWD 0x00000001U
+#define ADC_SR_EOC 0x00000002U
+#define ADC_SR_JEOC 0x00000004U
+#define ADC_SR_JSTRT 0x00000008U
+#define ADC_SR_STRT 0x00000010U
+
+#define ADC_CR1_AWDCH 0x0000001FU
+#define ADC_CR1_EOCIE 0x00000020U
+#define ADC_CR1_AWDIE 0x00000040U
+#define ADC_CR1_JEOCIE 0x00000080U
+#define ADC_CR1_SCAN 0x00000100U
+#define ADC_CR1_AWDSGL 0x00000200U
+#define ADC_CR1_JAUTO 0x00000400U
+#define ADC_CR1_DISCEN 0x00000800U
+#define ADC_CR1_JDISCEN 0x00001000U
+#define ADC_CR1_JAWDEN 0x00400000U
+#define ADC_CR1_AWDEN 0x00800000U
+#define ADC_CR1_DISCNUM 0x0000E000U
+#define ADC_CR1_DUALMOD 0x000F0000U
+#define ADC_CR1_DUALMOD_0 0x00010000U
+#define ADC_CR1_DUALMOD_1 0x00020000U
+#define ADC_CR1_DUALMOD_2 0x00040000U
+#define ADC_CR1_DUALMOD_3 0x00080000U
+
+#define ADC_CR2_ADON 0x00000001U
+#define ADC_CR2_CONT 0x00000002U
+#define ADC_CR2_CAL 0x00000004U
+#define ADC_CR2_RSTCAL 0x00000008U
+#define ADC_CR2_DMA 0x00000100U
+#define ADC_CR2_ALIGN 0x00000800U
+#define ADC_CR2_JEXTTRIG 0x00008000U
+#define ADC_CR2_EXTTRIG 0x00100000U
+#define ADC_CR2_JSWSTART 0x00200000U
+#define ADC_CR2_SWSTART 0x00400000U
+#define ADC_CR2_TSVREFE 0x00800000U
+#define ADC_CR2_JEXTSEL 0x00007000U
+#define ADC_CR2_EXTSEL 0x000E0000U
+#define ADC_CR2_EXTSEL_0 0x00020000U
+#define ADC_CR2_EXTSEL_1 0x00040000U
+#define ADC_CR2_EXTSEL_2 0x00080000U
+
+#define ADC_SMPR1_SMP10 0x00000007U
+#define ADC_SMPR1_SMP10_0 0x00000001U
+#define ADC_SMPR1_SMP10_1 0x00000002U
+#define ADC_SMPR1_SMP10_2 0x00000004U
+#define ADC_SMPR1_SMP11 0x00000038U
+#define ADC_SMPR1_SMP11_0 0x00000008U
+#define ADC_SMPR1_SMP11_1 0x00000010U
+#define ADC_SMPR1_SMP11_2 0x00000020U
+#define ADC_SMPR1_SMP12 0x000001C0U
+#define ADC_SMPR1_SMP12_0 0x00000040U
+#define ADC_SMPR1_SMP12_1 0x00000080U
+#define ADC_SMPR1_SMP12_2 0x00000100U
+#define ADC_SMPR1_SMP13 0x00000E00U
+#define ADC_SMPR1_SMP13_0 0x00000200U
+#define ADC_SMPR1_SMP13_1 0x00000400U
+#define ADC_SMPR1_SMP13_2 0x00000800U
+#define ADC_SMPR1_SMP14 0x00007000U
+#define ADC_SMPR1_SMP14_0 0x00001000U
+#define ADC_SMPR1_SMP14_1 0x00002000U
+#define ADC_SMPR1_SMP14_2 0x00004000U
+#define ADC_SMPR1_SMP15 0x00038000U
+#define ADC_SMPR1_SMP15_0 0x00008000U
+#define ADC_SMPR1_SMP15_1 0x00010000U
+#define ADC_SMPR1_SMP15_2 0x00020000U
+#define ADC_SMPR1_SMP16 0x001C0000U
+#define ADC_SMPR1_SMP16_0 0x00040000U
+#define ADC_SMPR1_SMP16_1 0x00080000U
+#define ADC_SMPR1_SMP16_2 0x00100000U
+#define ADC_SMPR1_SMP17 0x00E00000U
+#define ADC_SMPR1_SMP17_0 0x00200000U
+#define ADC_SMPR1_SMP17_1 0x00400000U
+#define ADC_SMPR1_SMP17_2 0x00800000U
+#define ADC_SMPR2_SMP0 0x00000007U
+#define ADC_SMPR2_SMP0_0 0x00000001U
+#define ADC_SMPR2_SMP0_1 0x00000002U
+#define ADC_SMPR2_SMP0_2 0x00000004U
+#define ADC_SMPR2_SMP1 0x00000038U
+#define ADC_SMPR2_SMP1_0 0x00000008U
+#define ADC_SMPR2_SMP1_1 0x00000010U
+#define ADC_SMPR2_SMP1_2 0x00000020U
+#define ADC_SMPR2_SMP2 0x000001C0U
+#define ADC_SMPR2_SMP2_0 0x00000040U
+#define ADC_SMPR2_SMP2_1 0x00000080U
+#define ADC_SMPR2_SMP2_2 0x00000100U
+#define ADC_SMPR2_SMP3 0x00000E00U
+#define ADC_SMPR2_SMP3_0 0x00000200U
+#define ADC_SMPR2_SMP3_1 0x00000400U
+#define ADC_SMPR2_SMP3_2 0x00000800U
+#define ADC_SMPR2_SMP4 0x00007000U
+#define ADC_SMPR2_SMP4_0 0x00001000U
+#define ADC_SMPR2_SMP4_1 0x00002000U
+#define ADC_SMPR2_SMP4_2 0x00004000U
+#define ADC_SMPR2_SMP5 0x00038000U
+#define ADC_SMPR2_SMP5_0 0x00008000U
+#define ADC_SMPR2_SMP5_1 0x00010000U
+#define ADC_SMPR2_SMP5_2 0x00020000U
+#define ADC_SMPR2_SMP6 0x001C0000U
+#define ADC_SMPR2_SMP6_0 0x00040000U
+#define ADC_SMPR2_SMP6_1 0x00080000U
+#define ADC_SMPR2_SMP6_2 0x00100000U
+#define ADC_SMPR2_SMP7 0x00E00000U
+#define ADC_SMPR2_SMP7_0 0x00200000U
+#define ADC_SMPR2_SMP7_1 0x00400000U
+#define ADC_SMPR2_SMP7_2 0x00800000U
+#define ADC_SMPR2_SMP8 0x07000000U
+#define ADC_SMPR2_SMP8_0 0x01000000U
+#define ADC_SMPR2_SMP8_1 0x02000000U
+#define ADC_SMPR2_SMP8_2 0x04000000U
+#define ADC_SMPR2_SMP9 0x38000000U
+#define ADC_SMPR2_SMP9_0 0x08000000U
+#define ADC_SMPR2_SMP9_1 0x10000000U
+#define ADC_SMPR2_SMP9_2 0x20000000U
+
+#define ADC_SQR1_SQ13 0x0000001FU
+#define ADC_SQR1_SQ13_0 0x00000001U
+#define ADC_SQR1_SQ13_1 0x00000002U
+#define ADC_SQR1_SQ13_2 0x00000004U
+#define ADC_SQR1_SQ13_3 0x00000008U
+#define ADC_SQR1_SQ13_4 0x00000010U
+#define ADC_SQR1_SQ14 0x000003E0U
+#define ADC_SQR1_SQ14_0 0x00000020U
+#define ADC_SQR1_SQ14_1 0x00000040U
+#define ADC_SQR1_SQ14_2 0x00000080U
+#define ADC_SQR1_SQ14_3 0x00000100U
+#define ADC_SQR1_SQ14_4 0x00000200U
+#define ADC_SQR1_SQ15 0x00007C00U
+#define ADC_SQR1_SQ15_0 0x00000400U
+#define ADC_SQR1_SQ15_1 0x00000800U
+#define ADC_SQR1_SQ15_2 0x00001000U
+#define ADC_SQR1_SQ15_3 0x00002000U
+#define ADC_SQR1_SQ15_4 0x00004000U
+#define ADC_SQR1_SQ16 0x000F8000U
+#define ADC_SQR1_SQ16_0 0x00008000U
+#define ADC_SQR1_SQ16_1 0x00010000U
+#define ADC_SQR1_SQ16_2 0x00020000U
+#define ADC_SQR1_SQ16_3 0x00040000U
+#define ADC_SQR1_SQ16_4 0x00080000U
+#define ADC_SQR2_SQ7 0x0000001FU
+#define ADC_SQR2_SQ7_0 0x00000001U
+#define ADC_SQR2_SQ7_1 0x00000002U
+#define ADC_SQR2_SQ7_2 0x00000004U
+#define ADC_SQR2_SQ7_3 0x00000008U
+#define ADC_SQR2_SQ7_4 0x00000010U
+#define ADC_SQR2_SQ8 0x000003E0U
+#define ADC_SQR2_SQ8_0 0x00000020U
+#define ADC_SQR2_SQ8_1 0x00000040U
+#define ADC_SQR2_SQ8_2 0x00000080U
+#define ADC_SQR2_SQ8_3 0x00000100U
+#define ADC_SQR2_SQ8_4 0x00000200U
+#define ADC_SQR2_SQ9 0x00007C00U
+#define ADC_SQR2_SQ9_0 0x00000400U
+#define ADC_SQR2_SQ9_1 0x00000800U
+#define ADC_SQR2_SQ9_2 0x00001000U
+#define ADC_SQR2_SQ9_3 0x00002000U
+#define ADC_SQR2_SQ9_4 0x00004000U
+#define ADC_SQR2_SQ10 0x000F8000U
+#define ADC_SQR2_SQ10_0 0x00008000U
+#define ADC_SQR2_SQ10_1 0x00010000U
+#define ADC_SQR2_SQ10_2 0x00020000U
+#define ADC_SQR2_SQ10_3 0x00040000U
+#define ADC_SQR2_SQ10_4 0x00080000U
+#define ADC_SQR2_SQ11 0x01F00000U
+#define ADC_SQR2_SQ11_0 0x00100000U
+#define ADC_SQR2_SQ11_1 0x00200000U
+#define ADC_SQR2_SQ11_2 0x00400000U
+#define ADC_SQR2_SQ11_3 0x00800000U
+#define ADC_SQR2_SQ11_4 0x01000000U
+#define ADC_SQR2_SQ12 0x3E000000U
+#define ADC_SQR2_SQ12_0 0x02000000U
+#define ADC_SQR2_SQ12_1 0x04000000U
+#define ADC_SQR2_SQ12_2 0x08000000U
+#define ADC_SQR2_SQ12_3 0x10000000U
+#define ADC_SQR2_SQ12_4 0x20000000U
+#define ADC_SQR3_SQ1 0x0000001FU
+#define ADC_SQR3_SQ1_0 0x00000001U
+#define ADC_SQR3_SQ1_1 0x00000002U
+#define ADC_SQR3_SQ1_2 0x00000004U
+#define ADC_SQR3_SQ1_3 0x00000008U
+#define ADC_SQR3_SQ1_4 0x00000010U
+#define ADC_SQR3_SQ2 0x000003E0U
+#define ADC_SQR3_SQ2_0 0x00000020U
+#define ADC_SQR3_SQ2_1 0x00000040U
+#define ADC_SQR3_SQ2_2 0x00000080U
+#define ADC_SQR3_SQ2_3 0x00000100U
+#define ADC_SQR3_SQ2_4 0x00000200U
+#define ADC_SQR3_SQ3 0x00007C00U
+#define ADC_SQR3_SQ3_0 0x00000400U
+#define ADC_SQR3_SQ3_1 0x00000800U
+#define ADC_SQR3_SQ3_2 0x00001000U
+#define ADC_SQR3_SQ3_3 0x00002000U
+#define ADC_SQR3_SQ3_4 0x00004000U
+#define ADC_SQR3_SQ4 0x000F8000U
+#define ADC_SQR3_SQ4_0 0x00008000U
+#define ADC_SQR3_SQ4_1 0x00010000U
+#define ADC_SQR3_SQ4_2 0x00020000U
+#define ADC_SQR3_SQ4_3 0x00040000U
+#define ADC_SQR3_SQ4_4 0x00080000U
+#define ADC_SQR3_SQ5 0x01F00000U
+#define ADC_SQR3_SQ5_0 0x00100000U
+#define ADC_SQR3_SQ5_1 0x00200000U
+#define ADC_SQR3_SQ5_2 0x00400000U
+#define ADC_SQR3_SQ5_3 0x00800000U
+#define ADC_SQR3_SQ5_4 0x01000000U
+#define ADC_SQR3_SQ6 0x3E000000U
+#define ADC_SQR3_SQ6_0 0x02000000U
+#define ADC_SQR3_SQ6_1 0x04000000U
+#define ADC_SQR3_SQ6_2 0x08000000U
+#define ADC_SQR3_SQ6_3 0x10000000U
+#define ADC_SQR3_SQ6_4 0x20000000U
+#define ADC_SQR1_L 0x00F00000U
+#define ADC_SQR1_L_0 0x00100000U
+#define ADC_SQR1_L_1 0x00200000U
+#define ADC_SQR1_L_2 0x00400000U
+#define ADC_SQR1_L_3 0x00800000U
+
+//------------------------------------------------------------------ DMA
+
+#define DMA_CCR_EN 0x00000001U
+#define DMA_CCR_TCIE 0x00000002U
+#define DMA_CCR_HTIE 0x00000004U
+#define DMA_CCR_TEIE 0x00000008U
+#define DMA_CCR_DIR 0x00000010U
+#define DMA_CCR_CIRC 0x00000020U
+#define DMA_CCR_PINC 0x00000040U
+#define DMA_CCR_MINC 0x00000080U
+#define DMA_CCR_MEM2MEM 0x00004000U
+#define DMA_CCR_PSIZE 0x00000300U
+#define DMA_CCR_PSIZE_0 0x00000100U
+#define DMA_CCR_PSIZE_1 0x00000200U
+#define DMA_CCR_MSIZE 0x00000C00U
+#define DMA_CCR_MSIZE_0 0x00000400U
+#define DMA_CCR_MSIZE_1 0x00000800U
+#define DMA_CCR_PL 0x00003000U
+#define DMA_CCR_PL_0 0x00001000U
+#define DMA_CCR_PL_1 0x00002000U
+
+#define DMA_ISR_GIF1 0x00000001U
+#define DMA_ISR_TCIF1 0x00000002U
+#define DMA_ISR_HTIF1 0x00000004U
+#define DMA_ISR_TEIF1 0x00000008U
+#define DMA_ISR_GIF2 0x00000010U
+#define DMA_ISR_TCIF2 0x00000020U
+#define DMA_ISR_HTIF2 0x00000040U
+#define DMA_ISR_TEIF2 0x00000080U
+#define DMA_ISR_GIF3 0x00000100U
+#define DMA_ISR_TCIF3 0x00000200U
+#define DMA_ISR_HTIF3 0x00000400U
+#define DMA_ISR_TEIF3 0x00000800U
+#define DMA_ISR_GIF4 0x00001000U
+#define DMA_ISR_TCIF4 0x00002000U
+#define DMA_ISR_HTIF4 0x00004000U
+#define DMA_ISR_TEIF4 0x00008000U
+#define DMA_ISR_GIF5 0x00010000U
+#define DMA_ISR_TCIF5 0x00020000U
+#define DMA_ISR_HTIF5 0x00040000U
+#define DMA_ISR_TEIF5 0x00080000U
+#define DMA_ISR_GIF6 0x00100000U
+#define DMA_ISR_TCIF6 0x00200000U
+#define DMA_ISR_HTIF6 0x00400000U
+#define DMA_ISR_TEIF6 0x00800000U
+#define DMA_ISR_GIF7 0x01000000U
+#define DMA_ISR_TCIF7 0x02000000U
+#define DMA_ISR_HTIF7 0x04000000U
+#define DMA_ISR_TEIF7 0x08000000U
+#define DMA_IFCR_CGIF1 0x00000001U
+#define DMA_IFCR_CTCIF1 0x00000002U
+#define DMA_IFCR_CHTIF1 0x00000004U
+#define DMA_IFCR_CTEIF1 0x00000008U
+#define DMA_IFCR_CGIF2 0x00000010U
+#define DMA_IFCR_CTCIF2 0x00000020U
+#define DMA_IFCR_CHTIF2 0x00000040U
+#define DMA_IFCR_CTEIF2 0x00000080U
+#define DMA_IFCR_CGIF3 0x00000100U
+#define DMA_IFCR_CTCIF3 0x00000200U
+#define DMA_IFCR_CHTIF3 0x00000400U
+#define DMA_IFCR_CTEIF3 0x00000800U
+#define DMA_IFCR_CGIF4 0x00001000U
+#define DMA_IFCR_CTCIF4 0x00002000U
+#define DMA_IFCR_CHTIF4 0x00004000U
+#define DMA_IFCR_CTEIF4 0x00008000U
+#define DMA_IFCR_CGIF5 0x00010000U
+#define DMA_IFCR_CTCIF5 0x00020000U
+#define DMA_IFCR_CHTIF5 0x00040000U
+#define DMA_IFCR_CTEIF5 0x00080000U
+#define DMA_IFCR_CGIF6 0x00100000U
+#define DMA_IFCR_CTCIF6 0x00200000U
+#define DMA_IFCR_CHTIF6 0x00400000U
+#define DMA_IFCR_CTEIF6 0x00800000U
+#define DMA_IFCR_CGIF7 0x01000000U
+#define DMA_IFCR_CTCIF7 0x02000000U
+#define DMA_IFCR_CHTIF7 0x04000000U
+#define DMA_IFCR_CTEIF7 0x08000000U
+
+//------------------------------------------------------------------ USART
+
+#define USART_SR_PE 0x00000001U
+#define USART_SR_FE 0x00000002U
+#define USART_SR_NE 0x00000004U
+#define USART_SR_ORE 0x00000008U
+#define USART_SR_IDLE 0x00000010U
+#define USART_SR_RXNE 0x00000020U
+#define USART_SR_TC 0x00000040U
+#define USART_SR_TXE 0x00000080U
+#define USART_SR_LBD 0x00000100U
+#define USART_SR_CTS 0x00000200U
+
+#define USART_DR_DR 0x000001FFU
+
+#define USART_BRR_DIV_Fraction 0x0000000FU
+#define USART_BRR_DIV_Mantissa 0x0000FFF0U
+
+#define USART_CR1_SBK 0x00000001U
+#define USART_CR1_RWU 0x00000002U
+#define USART_CR1_RE 0x00000004U
+#define USART_CR1_TE 0x00000008U
+#define USART_CR1_IDLEIE 0x00000010U
+#define USART_CR1_RXNEIE 0x00000020U
+#define USART_CR1_TCIE 0x00000040U
+#define USART_CR1_TXEIE 0x00000080U
+#define USART_CR1_PEIE 0x00000100U
+#define USART_CR1_PS 0x00000200U
+#define USART_CR1_PCE 0x00000400U
+#define USART_CR1_WAKE 0x00000800U
+#define USART_CR1_M 0x00001000U
+#define USART_CR1_UE 0x00002000U
+
+#define USART_CR2_STOP 0x00003000U
+#define USART_CR2_STOP_0 0x00001000U
+#define USART_CR2_STOP_1 0x00002000U
+#define USART_CR2_CLKEN 0x00000800U
+#define USART_CR2_LINEN 0x00004000U
+
+#define USART_CR3_EIE 0x00000001U
+#define USART_CR3_IREN 0x00000002U
+#define USART_CR3_IRLP 0x00000004U
+#define USART_CR3_HDSEL 0x00000008U
+#define USART_CR3_NACK 0x00000010U
+#define USART_CR3_SCEN 0x00000020U
+#define USART_CR3_DMAR 0x00000040U
+#define USART_CR3_DMAT 0x00000080U
+#define USART_CR3_RTSE 0x00000100U
+#define USART_CR3_CTSE 0x00000200U
+#define USART_CR3_CTSIE 0x00000400U
+
+//------------------------------------------------------------------ I2C
+
+#define I2C_CR1_PE 0x00000001U
+#define I2C_CR1_SMBUS 0x00000002U
+#define I2C_CR1_SMBTYPE 0x00000008U
+#define I2C_CR1_ENARP 0x00000010U
+#define I2C_CR1_ENPEC 0x00000020U
+#define I2C_CR1_ENGC 0x00000040U
+#define I2C_CR1_NOSTRETCH 0x00000080U
+#define I2C_CR1_START 0x00000100U
+#define I2C_CR1_STOP 0x00000200U
+#define I2C_CR1_ACK 0x00000400U
+#define I2C_CR1_POS 0x00000800U
+#define I2C_CR1_PEC 0x00001000U
+#define I2C_CR1_ALERT 0x00002000U
+#define I2C_CR1_SWRST 0x00008000U
+
+#define I2C_CR2_FREQ 0x0000003FU
+#define I2C_CR2_ITERREN 0x00000100U
+#define I2C_CR2_ITEVTEN 0x00000200U
+#define I2C_CR2_ITBUFEN 0x00000400U
+#define I2C_CR2_DMAEN 0x00000800U
+#define I2C_CR2_LAST 0x00001000U
+
+#define I2C_SR1_SB 0x00000001U
+#define I2C_SR1_ADDR 0x00000002U
+#define I2C_SR1_BTF 0x00000004U
+#define I2C_SR1_ADD10 0x00000008U
+#define I2C_SR1_STOPF 0x00000010U
+#define I2C_SR1_RXNE 0x00000040U
+#define I2C_SR1_TXE 0x00000080U
+#define I2C_SR1_BERR 0x00000100U
+#define I2C_SR1_ARLO 0x00000200U
+#define I2C_SR1_AF 0x00000400U
+#define I2C_SR1_OVR 0x00000800U
+#define I2C_SR1_PECERR 0x00001000U
+#define I2C_SR1_TIMEOUT 0x00004000U
+#define I2C_SR1_SMBALERT 0x00008000U
+
+#define I2C_SR2_MSL 0x00000001U
+#define I2C_SR2_BUSY 0x00000002U
+#define I2C_SR2_TRA 0x00000004U
+#define I2C_SR2_GENCALL 0x00000010U
+#define I2C_SR2_DUALF 0x00000080U
+
+#define I2C_CCR_CCR 0x00000FFFU
+#define I2C_CCR_DUTY 0x00004000U
+#define I2C_CCR_FS 0x00008000U
+
+#define I2C_TRISE_TRISE 0x0000003FU
+
+//------------------------------------------------------------------ SPI
+
+#define SPI_CR1_CPHA 0x00000001U
+#define SPI_CR1_CPOL 0x00000002U
+#define SPI_CR1_MSTR 0x00000004U
+#define SPI_CR1_BR 0x00000038U
+#define SPI_CR1_BR_0 0x00000008U
+#define SPI_CR1_BR_1 0x00000010U
+#define SPI_CR1_BR_2 0x00000020U
+#define SPI_CR1_SPE 0x00000040U
+#define SPI_CR1_LSBFIRST 0x00000080U
+#define SPI_CR1_SSI 0x00000100U
+#define SPI_CR1_SSM 0x00000200U
+#define SPI_CR1_RXONLY 0x00000400U
+#define SPI_CR1_DFF 0x00000800U
+
+#define SPI_CR2_RXDMAEN 0x00000001U
+#define SPI_CR2_TXDMAEN 0x00000002U
+#define SPI_CR2_SSOE 0x00000004U
+#define SPI_CR2_ERRIE 0x00000020U
+#define SPI_CR2_RXNEIE 0x00000040U
+#define SPI_CR2_TXEIE 0x00000080U
+
+#define SPI_SR_RXNE 0x00000001U
+#define SPI_SR_TXE 0x00000002U
+#define SPI_SR_MODF 0x00000020U
+#define SPI_SR_OVR 0x00000040U
+#define SPI_SR_BSY 0x00000080U
+
+//------------------------------------------------------------------ TIM
+
+#define TIM_CR1_CEN 0x00000001U
+#define TIM_CR1_UDIS 0x00000002U
+#define TIM_CR1_URS 0x00000004U
+#define TIM_CR1_OPM 0x00000008U
+#define TIM_CR1_DIR 0x00000010U
+#define TIM_CR1_ARPE 0x00000080U
+#define TIM_CR1_CMS 0x00000060U
+#define TIM_CR1_CKD 0x00000300U
+
+#define TIM_CR2_CCPC 0x00000001U
+#define TIM_CR2_CCUS 0x00000004U
+#define TIM_CR2_CCDS 0x00000008U
+#define TIM_CR2_TI1S 0x00000080U
+#define TIM_CR2_MMS 0x00000070U
+#define TIM_CR2_MMS_0 0x00000010U
+#define TIM_CR2_MMS_1 0x00000020U
+#define TIM_CR2_MMS_2 0x00000040U
+
+#define TIM_SMCR_SMS 0x00000007U
+#define TIM_SMCR_SMS_0 0x00000001U
+#define TIM_SMCR_SMS_1 0x00000002U
+#define TIM_SMCR_SMS_2 0x00000004U
+#define TIM_SMCR_TS 0x00000070U
+#define TIM_SMCR_TS_0 0x00000010U
+#define TIM_SMCR_TS_1 0x00000020U
+#define TIM_SMCR_TS_2 0x00000040U
+#define TIM_SMCR_MSM 0x00000080U
+#define TIM_SMCR_ETF 0x00000F00U
+#define TIM_SMCR_ETPS 0x00003000U
+#define TIM_SMCR_ECE 0x00004000U
+#define TIM_SMCR_ETP 0x00008000U
+
+#define TIM_DIER_UIE 0x00000001U
+#define TIM_DIER_CC1IE 0x00000002U
+#define TIM_DIER_CC2IE 0x00000004U
+#define TIM_DIER_CC3IE 0x00000008U
+#define TIM_DIER_CC4IE 0x00000010U
+#define TIM_DIER_COMIE 0x00000020U
+#define TIM_DIER_TIE 0x00000040U
+#define TIM_DIER_BIE 0x00000080U
+#define TIM_DIER_UDE 0x00000100U
+#define TIM_DIER_CC1DE 0x00000200U
+#define TIM_DIER_CC2DE 0x00000400U
+#define TIM_DIER_CC3DE 0x00000800U
+#define TIM_DIER_CC4DE 0x00001000U
+#define TIM_DIER_COMDE 0x00002000U
+#define TIM_DIER_TDE 0x00004000U
+
+#define TIM_SR_UIF 0x00000001U
+#define TIM_SR_CC1IF 0x00000002U
+#define TIM_SR_CC2IF 0x00000004U
+#define TIM_SR_CC3IF 0x00000008U
+#define TIM_SR_CC4IF 0x00000010U
+#define TIM_SR_COMIF 0x00000020U
+#define TIM_SR_TIF 0x00000040U
+#define TIM_SR_BIF 0x00000080U
+#define TIM_SR_CC1OF 0x00000200U
+#define TIM_SR_CC2OF 0x00000400U
+#define TIM_SR_CC3OF 0x00000800U
+#define TIM_SR_CC4OF 0x00001000U
+
+#define TIM_EGR_UG 0x00000001U
+#define TIM_EGR_CC1G 0x00000002U
+#define TIM_EGR_CC2G 0x00000004U
+#define TIM_EGR_CC3G 0x00000008U
+#define TIM_EGR_CC4G 0x00000010U
+#define TIM_EGR_COMG 0x00000020U
+#define TIM_EGR_TG 0x00000040U
+#define TIM_EGR_BG 0x00000080U
+
+#define TIM_CCMR1_CC1S 0x00000003U
+#define TIM_CCMR1_OC1FE 0x00000004U
+#define TIM_CCMR1_OC1PE 0x00000008U
+#define TIM_CCMR1_OC1M 0x00000070U
+#define TIM_CCMR1_OC1M_0 0x00000010U
+#define TIM_CCMR1_OC1M_1 0x00000020U
+#define TIM_CCMR1_OC1M_2 0x00000040U
+#define TIM_CCMR1_OC1CE 0x00000080U
+#define TIM_CCMR1_CC2S 0x00000300U
+#define TIM_CCMR1_OC2FE 0x00000400U
+#define TIM_CCMR1_OC2PE 0x00000800U
+#define TIM_CCMR1_OC2M 0x00007000U
+#define TIM_CCMR1_OC2M_0 0x00001000U
+#define TIM_CCMR1_OC2M_1 0x00002000U
+#define TIM_CCMR1_OC2M_2 0x00004000U
+#define TIM_CCMR1_OC2CE 0x00008000U
+#define TIM_CCMR2_CC3S 0x00000003U
+#define TIM_CCMR2_OC3FE 0x00000004U
+#define TIM_CCMR2_OC3PE 0x00000008U
+#define TIM_CCMR2_OC3M 0x00000070U
+#define TIM_CCMR2_OC3M_0 0x00000010U
+#define TIM_CCMR2_OC3M_1 0x00000020U
+#define TIM_CCMR2_OC3M_2 0x00000040U
+#define TIM_CCMR2_OC3CE 0x00000080U
+#define TIM_CCMR2_CC4S 0x00000300U
+#define TIM_CCMR2_OC4FE 0x00000400U
+#define TIM_CCMR2_OC4PE 0x00000800U
+#define TIM_CCMR2_OC4M 0x00007000U
+#define TIM_CCMR2_OC4M_0 0x00001000U
+#define TIM_CCMR2_OC4M_1 0x00002000U
+#define TIM_CCMR2_OC4M_2 0x00004000U
+#define TIM_CCMR2_OC4CE 0x00008000U
+
+#define TIM_CCER_CC1E 0x00000001U
+#define TIM_CCER_CC1P 0x00000002U
+#define TIM_CCER_CC1NE 0x00000004U
+#define TIM_CCER_CC1NP 0x00000008U
+#define TIM_CCER_CC2E 0x00000010U
+#define TIM_CCER_CC2P 0x00000020U
+#define TIM_CCER_CC2NE 0x00000040U
+#define TIM_CCER_CC2NP 0x00000080U
+#define TIM_CCER_CC3E 0x00000100U
+#define TIM_CCER_CC3P 0x00000200U
+#define TIM_CCER_CC3NE 0x00000400U
+#define TIM_CCER_CC3NP 0x00000800U
+#define TIM_CCER_CC4E 0x00001000U
+#define TIM_CCER_CC4P 0x00002000U
+
+#define TIM_BDTR_MOE 0x00008000U
+#define TIM_DCR_DBA 0x0000001FU
+#define TIM_DCR_DBL 0x00001F00U
+
+#endif
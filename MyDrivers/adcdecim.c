@@ -0,0 +1,90 @@
+#include "adcdecim.h"
+
+int decim_init(decim_t *d, uint16_t osr, uint8_t order, uint8_t out_bits)
+{
+	uint8_t log2_osr = 0;
+
+	if (osr < 4 || osr > 256 || (osr & (osr - 1)))
+		return DECIM_ERR_OSR;
+	if (order < 1 || order > 2)
+		return DECIM_ERR_ORDER;
+	if (out_bits < 12 || out_bits > 16)
+		return DECIM_ERR_BITS;
+	while ((1U << log2_osr) < osr)
+		log2_osr++;
+
+	d->acc = 0;
+	d->acc2 = 0;
+	d->z1 = 0;
+	d->z2 = 0;
+	d->left = osr;
+	d->osr = osr;
+	d->order = order;
+	d->warmup = order - 1;
+	d->shift = 12 + order * log2_osr - out_bits;	//gain of the sum is osr ^ order , 28 bits at most
+	d->out_bits = out_bits;
+	d->outputs = 0;
+	return 0;
+}
+
+static uint16_t scale(const decim_t *d, uint32_t sum)
+{
+	if (d->shift > 0)
+		return (sum + (1UL << (d->shift - 1))) >> d->shift;	//rounded , full scale still fits out_bits
+	return sum << -d->shift;
+}
+
+uint32_t decim_feed(decim_t *d, const uint16_t *samples, uint32_t n, uint8_t stride, uint16_t *out)
+{
+	uint32_t produced = 0;
+
+	//the inner loops run up to the next output with nothing but adds in them
+	while (n)
+	{
+		uint32_t take = n < d->left ? n : d->left;
+		uint32_t acc = d->acc;
+
+		n -= take;
+		d->left -= take;
+		if (d->order == 1)
+		{
+			while (take--)
+			{
+				acc += *samples;
+				samples += stride;
+			}
+			d->acc = acc;
+			if (d->left)
+				break;
+			out[produced++] = scale(d, acc);
+			d->acc = 0;
+		}
+		else
+		{
+			uint32_t acc2 = d->acc2;
+			uint32_t c1, c2;
+
+			while (take--)
+			{
+				acc += *samples;
+				acc2 += acc;
+				samples += stride;
+			}
+			d->acc = acc;
+			d->acc2 = acc2;
+			if (d->left)
+				break;
+			c1 = acc2 - d->z1;
+			d->z1 = acc2;
+			c2 = c1 - d->z2;
+			d->z2 = c1;
+			if (d->warmup)
+				d->warmup--;
+			else
+				out[produced++] = scale(d, c2);
+		}
+		d->left = d->osr;
+	}
+	d->outputs += produced;
+	return produced;
+}
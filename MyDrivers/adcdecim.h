@@ -0,0 +1,40 @@
+#ifndef ADCDECIM_H
+#define ADCDECIM_H
+
+#include <stdint.h>
+
+//oversampling and decimation of one ADC channel , fed straight from the blocks adc_block_hook() gets (no copy , the
+//channel is picked out with the scan stride) and cheap enough to run in the DMA interrupt: per input sample one add
+//(boxcar) or two adds (CIC order 2) , the shift and rounding only happen once per output
+//
+//every osr inputs give one output of out_bits , white noise on the input buys half a bit per doubling of osr ,
+//with 0.5 LSB rms on the input (11 bits a sample) that is 13 bits at osr 16 , 14 at osr 64 and 15 at osr 256 (HostSim/decim_bench)
+//order 1 is a plain boxcar average over osr samples , order 2 (sinc^2) rejects far more of the aliased noise
+//(and 50/60 Hz when osr / rate is a multiple of the mains period) at the cost of a 2 * osr sample response
+
+#define DECIM_ERR_OSR -1		//osr not a power of 2 from 4 to 256
+#define DECIM_ERR_ORDER -2		//order not 1 or 2
+#define DECIM_ERR_BITS -3		//out_bits not 12 to 16
+
+typedef struct
+{
+	uint32_t acc;			//integrator 1
+	uint32_t acc2;			//integrator 2 (order 2)
+	uint32_t z1;			//comb delays (order 2) , the integrators wrap and the combs undo it
+	uint32_t z2;
+	uint16_t left;			//inputs until the next output
+	uint16_t osr;
+	uint8_t order;
+	uint8_t warmup;			//outputs still to drop while the combs fill
+	int8_t shift;			//right shift from the accumulator width to out_bits , negative shifts left
+	uint8_t out_bits;
+	uint32_t outputs;		//outputs produced since decim_init()
+} decim_t;
+
+int decim_init(decim_t *d, uint16_t osr, uint8_t order, uint8_t out_bits);	//0 if ok , DECIM_ERR_x otherwise
+
+//feeds n samples taken every stride entries (stride = nch of the block , samples = block + channel index) ,
+//writes every finished output to out (room for n / osr + 1) and returns how many were written
+uint32_t decim_feed(decim_t *d, const uint16_t *samples, uint32_t n, uint8_t stride, uint16_t *out);
+
+#endif
@@ -0,0 +1,152 @@
+#include "canlogfmt.h"
+
+uint8_t canlog_put_varint(uint8_t *buf, uint32_t v)
+{
+	uint8_t n = 0;
+
+	while (v >= 0x80)
+	{
+		buf[n++] = v | 0x80;
+		v >>= 7;
+	}
+	buf[n++] = v;
+	return n;
+}
+
+uint8_t canlog_put_frame(uint8_t *buf, uint32_t delta_us, uint32_t id, uint8_t ide, uint8_t rtr, uint8_t dlc, const uint8_t *data)
+{
+	uint8_t n = 1;
+
+	if (dlc > 8)
+		dlc = 8;
+	buf[0] = dlc | (ide ? CANLOG_FLAG_IDE : 0) | (rtr ? CANLOG_FLAG_RTR : 0);
+	n += canlog_put_varint(buf + n, delta_us);
+	n += canlog_put_varint(buf + n, id);
+	for (uint8_t i = 0; !rtr && i < dlc; i++)
+		buf[n++] = data[i];
+	return n;
+}
+
+uint8_t canlog_put_sync(uint8_t *buf, uint32_t time_us)
+{
+	buf[0] = CANLOG_SYNC;
+	buf[1] = 'C';
+	buf[2] = 'L';
+	return 3 + canlog_put_varint(buf + 3, time_us);
+}
+
+uint8_t canlog_put_drop(uint8_t *buf, uint32_t count)
+{
+	buf[0] = CANLOG_DROP;
+	return 1 + canlog_put_varint(buf + 1, count);
+}
+
+void canlog_decoder_init(canlog_decoder_t *d)
+{
+	d->synced = 0;
+	d->time_us = 0;
+	d->skipped = 0;
+	d->errors = 0;
+}
+
+//0 if buf ran out , -1 if longer than 5 bytes
+static int get_varint(const uint8_t *buf, uint32_t len, uint32_t *v)
+{
+	*v = 0;
+	for (uint32_t i = 0; i < 5; i++)
+	{
+		if (i == len)
+			return 0;
+		*v |= (uint32_t) (buf[i] & 0x7F) << (7 * i);
+		if (!(buf[i] & 0x80))
+			return i + 1;
+	}
+	return -1;
+}
+
+static uint32_t lose_sync(canlog_decoder_t *d, canlog_record_t *rec)
+{
+	d->synced = 0;
+	d->errors++;
+	d->skipped++;
+	rec->type = CANLOG_REC_NONE;
+	return 1;
+}
+
+uint32_t canlog_decode(canlog_decoder_t *d, const uint8_t *buf, uint32_t len, canlog_record_t *rec)
+{
+	uint32_t n, v, id;
+	int k;
+
+	rec->type = CANLOG_REC_NONE;
+	if (!len)
+		return 0;
+
+	if (buf[0] == CANLOG_SYNC)
+	{
+		if (len < 3)
+			return 0;
+		if (buf[1] != 'C' || buf[2] != 'L')
+			return d->synced ? lose_sync(d, rec) : (d->skipped++, 1);
+		k = get_varint(buf + 3, len - 3, &v);
+		if (k <= 0)
+			return k ? lose_sync(d, rec) : 0;
+		//keep the 64 bit time , the 32 bit value only wraps forward
+		if (d->synced && v < (uint32_t) d->time_us)
+			d->time_us += 1ULL << 32;
+		d->time_us = (d->time_us & ~0xFFFFFFFFULL) | v;
+		d->synced = 1;
+		rec->type = CANLOG_REC_SYNC;
+		rec->time_us = d->time_us;
+		return 3 + k;
+	}
+	if (!d->synced)
+	{
+		d->skipped++;
+		return 1;
+	}
+
+	if (buf[0] == CANLOG_DROP)
+	{
+		k = get_varint(buf + 1, len - 1, &v);
+		if (k <= 0)
+			return k ? lose_sync(d, rec) : 0;
+		rec->type = CANLOG_REC_DROP;
+		rec->dropped = v;
+		rec->time_us = d->time_us;
+		return 1 + k;
+	}
+
+	if ((buf[0] & 0xC0) || (buf[0] & 0x0F) > 8)
+		return lose_sync(d, rec);
+	n = 1;
+	k = get_varint(buf + n, len - n, &v);
+	if (k <= 0)
+		return k ? lose_sync(d, rec) : 0;
+	n += k;
+	k = get_varint(buf + n, len - n, &id);
+	if (k <= 0)
+		return k ? lose_sync(d, rec) : 0;
+	n += k;
+	if (id > ((buf[0] & CANLOG_FLAG_IDE) ? 0x1FFFFFFFUL : 0x7FFUL))
+		return lose_sync(d, rec);
+
+	rec->ide = (buf[0] & CANLOG_FLAG_IDE) ? 1 : 0;
+	rec->rtr = (buf[0] & CANLOG_FLAG_RTR) ? 1 : 0;
+	rec->dlc = buf[0] & 0x0F;
+	rec->id = id;
+	for (uint8_t i = 0; i < 8; i++)
+		rec->data[i] = 0;
+	if (!rec->rtr)
+	{
+		if (len - n < rec->dlc)
+			return 0;
+		for (uint8_t i = 0; i < rec->dlc; i++)
+			rec->data[i] = buf[n + i];
+		n += rec->dlc;
+	}
+	d->time_us += v;
+	rec->type = CANLOG_REC_FRAME;
+	rec->time_us = d->time_us;
+	return n;
+}
@@ -0,0 +1,59 @@
+#ifndef CANLOGFMT_H
+#define CANLOGFMT_H
+
+#include <stdint.h>
+
+//binary CAN capture records (written by mycanlog , read back by the HostSim tools)
+//varint = 7 bits per byte , low group first , bit 7 set on every byte but the last
+//
+//frame : flags (0 0 RTR IDE DLC[3:0]) , varint microseconds since the previous record , varint id , DLC data bytes (none for RTR)
+//sync  : 0xFF 'C' 'L' , varint absolute time in microseconds (32 bit , wraps) , first record of a log and every CANLOG_SYNC_EVERY records
+//drop  : 0xFE , varint number of frames lost because the output could not keep up
+//
+//a standard 8 byte frame takes 13 bytes , a reader that lost bytes scans for the next sync
+
+#define CANLOG_SYNC 0xFF
+#define CANLOG_DROP 0xFE
+#define CANLOG_FLAG_IDE 0x10
+#define CANLOG_FLAG_RTR 0x20
+
+#ifndef CANLOG_SYNC_EVERY
+#define CANLOG_SYNC_EVERY 64
+#endif
+
+#define CANLOG_MAX_RECORD 19		//flags + 5 + 5 + 8 , a sync is 8
+
+#define CANLOG_REC_NONE 0		//more bytes needed
+#define CANLOG_REC_FRAME 1
+#define CANLOG_REC_SYNC 2
+#define CANLOG_REC_DROP 3
+
+typedef struct
+{
+	uint8_t type;			//CANLOG_REC_x
+	uint8_t ide;
+	uint8_t rtr;
+	uint8_t dlc;
+	uint32_t id;
+	uint8_t data[8];
+	uint32_t dropped;		//CANLOG_REC_DROP
+	uint64_t time_us;		//absolute , extended past the 32 bit wrap of the sync records
+} canlog_record_t;
+
+typedef struct
+{
+	uint8_t synced;
+	uint64_t time_us;
+	uint32_t skipped;		//bytes thrown away while looking for a sync
+	uint32_t errors;		//records that did not make sense , sync was lost after each
+} canlog_decoder_t;
+
+uint8_t canlog_put_varint(uint8_t *buf, uint32_t v);
+uint8_t canlog_put_frame(uint8_t *buf, uint32_t delta_us, uint32_t id, uint8_t ide, uint8_t rtr, uint8_t dlc, const uint8_t *data);	//returns the record length
+uint8_t canlog_put_sync(uint8_t *buf, uint32_t time_us);
+uint8_t canlog_put_drop(uint8_t *buf, uint32_t count);
+
+void canlog_decoder_init(canlog_decoder_t *d);
+uint32_t canlog_decode(canlog_decoder_t *d, const uint8_t *buf, uint32_t len, canlog_record_t *rec);	//bytes used , rec->type CANLOG_REC_NONE if len was not enough
+
+#endif
@@ -0,0 +1,80 @@
+#include "drivemix.h"
+
+//what to do , per case of the old MotorCode():
+//bit 0 DL , bit 1 DR , bit 2..5 a , b , p , q (left = |a|x| - b|y|| , right = |p|x| - q|y||) , bit 6 keep the last output
+#define ROW(dl, dr, a, b, p, q) ((dl) | (dr) << 1 | (a) << 2 | (b) << 3 | (p) << 4 | (q) << 5)
+#define KEEP 0x40
+
+#define STOP ROW(0, 0, 0, 0, 0, 0)
+#define BACKWARD ROW(0, 0, 0, 1, 0, 1)
+#define FORWARD ROW(1, 1, 0, 1, 0, 1)
+#define SPOT_LEFT ROW(0, 1, 1, 0, 1, 0)
+#define SPOT_RIGHT ROW(1, 0, 1, 0, 1, 0)
+#define OCTET1 ROW(1, 0, 1, 0, 1, 1)
+#define OCTET2 ROW(1, 1, 0, 1, 1, 1)
+#define OCTET3 ROW(1, 1, 1, 1, 0, 1)
+#define OCTET4 ROW(0, 1, 1, 1, 1, 0)
+#define OCTET5 ROW(0, 1, 1, 0, 1, 1)
+#define OCTET6 ROW(0, 0, 0, 1, 1, 1)
+#define OCTET7 ROW(0, 0, 1, 1, 0, 1)
+#define OCTET8 ROW(1, 0, 1, 1, 1, 0)
+
+//[zone][x < 0 , y < 0][|x| > |y| , |x| < |y| , |x| == |y| , unused]
+//zone 0: stick in the middle , 1: on the y axis (|x| < 10) , 2: on the x axis (|y| <= 10) , 3: anywhere else
+//in zone 1 y is never 0 and in zone 2 x is never 0 , in zone 3 neither is
+static const uint8_t mix_table[4][4][4] =
+{
+	{
+		{ STOP, STOP, STOP, STOP },
+		{ STOP, STOP, STOP, STOP },
+		{ STOP, STOP, STOP, STOP },
+		{ STOP, STOP, STOP, STOP },
+	},
+	{
+		{ FORWARD, FORWARD, FORWARD, FORWARD },
+		{ BACKWARD, BACKWARD, BACKWARD, BACKWARD },
+		{ FORWARD, FORWARD, FORWARD, FORWARD },
+		{ BACKWARD, BACKWARD, BACKWARD, BACKWARD },
+	},
+	{
+		{ SPOT_RIGHT, SPOT_RIGHT, SPOT_RIGHT, SPOT_RIGHT },
+		{ SPOT_RIGHT, SPOT_RIGHT, SPOT_RIGHT, SPOT_RIGHT },
+		{ SPOT_LEFT, SPOT_LEFT, SPOT_LEFT, SPOT_LEFT },
+		{ SPOT_LEFT, SPOT_LEFT, SPOT_LEFT, SPOT_LEFT },
+	},
+	{
+		{ OCTET1, OCTET2, KEEP, KEEP },		//x > 0 , y > 0
+		{ OCTET8, OCTET7, KEEP, KEEP },		//x > 0 , y < 0
+		{ OCTET4, OCTET3, OCTET4, KEEP },	//x < 0 , y > 0
+		{ OCTET5, OCTET6, KEEP, KEEP },		//x < 0 , y < 0
+	},
+};
+
+static inline uint32_t iabs(int32_t v)
+{
+	int32_t s = v >> 31;
+
+	return (v ^ s) - s;
+}
+
+void drive_mix(drivemix_t *out, int32_t x, int32_t y, uint32_t gear)
+{
+	uint32_t ax = iabs(x), ay = iabs(y);
+	uint32_t zone, rel, row, keep;
+	uint32_t left, right, dir;
+
+	//the old chain tried the middle , the y axis , the x axis and then the octets , the lowest set bit is the one it took
+	zone = __builtin_ctz(((ax < 20) & (ay < 20)) | (ax < 10) << 1 | (ay <= 10) << 2 | 1 << 3);	//RBIT + CLZ on the M3
+	rel = (ax < ay) | (ax == ay) << 1;
+	row = mix_table[zone][(uint32_t) x >> 31 << 1 | (uint32_t) y >> 31][rel];
+
+	left = iabs((int32_t) ((row >> 2 & 1) * ax - (row >> 3 & 1) * ay)) * gear / 10;
+	right = iabs((int32_t) ((row >> 4 & 1) * ax - (row >> 5 & 1) * ay)) * gear / 10;
+	dir = row & (DRIVE_LEFT | DRIVE_RIGHT);
+
+	//all ones when the old code would have left TIM4 alone
+	keep = -(row >> 6);
+	out->left = (out->left & keep) | (left & ~keep);
+	out->right = (out->right & keep) | (right & ~keep);
+	out->dir = (out->dir & keep) | (dir & ~keep);
+}
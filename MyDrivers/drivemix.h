@@ -0,0 +1,30 @@
+#ifndef DRIVEMIX_H
+#define DRIVEMIX_H
+
+#include <stdint.h>
+
+//differential drive mixer , stick x / y in , left / right duty and direction out , integers only
+//
+//gives exactly what the Rover's old MotorCode() / Drive() pair gave (float duty , 13 way if/else over the octets):
+//a count of trailing zeros picks the zone the old chain would have stopped in (middle , y axis , x axis , octets) ,
+//zone , signs and |x| against |y| index a 64 byte table whose row says which of |x| , |y| feed each side and which way it turns ,
+//duty = | a|x| - b|y| | * gear / 10 , so there is no float and no branch that depends on the stick
+//
+//the old chain had no case for a few stick positions right on an octant border (x == y in the first quadrant ,
+//|x| == |y| in the third and fourth) , there the last output is kept , like the old code did by not touching TIM4
+//
+//x , y: -8000 .. 8000 (centred , after the deadband) , gear: 0 .. 10 , duty tops out at 8000 (TIM4 ARR)
+
+#define DRIVE_LEFT 0x01			//dir bits , 1 -> forward (the LED on A4 / A5 is lit)
+#define DRIVE_RIGHT 0x02
+
+typedef struct
+{
+	uint16_t left;			//TIM4->CCR1
+	uint16_t right;			//TIM4->CCR2
+	uint8_t dir;			//DRIVE_x
+} drivemix_t;
+
+void drive_mix(drivemix_t *out, int32_t x, int32_t y, uint32_t gear);	//updates *out in place , keeps it on the border cases
+
+#endif
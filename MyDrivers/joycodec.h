@@ -0,0 +1,32 @@
+#ifndef JOYCODEC_H
+#define JOYCODEC_H
+
+#include <stdint.h>
+
+//frame layout (shared by every sender and receiver on the rover bus)
+//byte 0      : version[7:6] | channel count - 1 [5:4] | sequence[3:0]
+//byte 1..n   : 12 bit channels packed two per 3 bytes (a[7:0] , b[3:0]a[11:8] , b[11:4]) , an odd last channel takes 2 bytes
+//last byte   : CRC-8 (SAE J1850 , poly 0x1D) over everything before it
+//DLC = 2 + ceil(12 * channels / 8) -> 1 ch: 4 bytes , 2 ch: 5 bytes , 4 ch: 8 bytes
+
+#define JOY_CODEC_VERSION 1
+#define JOY_MAX_CHANNELS 4
+#define JOY_SEQ_MASK 0x0F
+
+#define JOY_ERR_LEN -1			//DLC does not match the channel count
+#define JOY_ERR_VERSION -2		//frame from a different codec version
+#define JOY_ERR_CRC -3
+
+typedef struct
+{
+	uint8_t nch;			//number of channels in the frame
+	uint8_t seq;			//rolling sequence counter (4 bit)
+	uint16_t ch[JOY_MAX_CHANNELS];	//12 bit samples
+} joy_sample_t;
+
+uint8_t joy_dlc(uint8_t nch);
+uint8_t joy_encode(const uint16_t *ch, uint8_t nch, uint8_t seq, uint8_t *buf);	//returns the DLC to send , 0 if nch is out of range
+int joy_decode(const uint8_t *buf, uint8_t dlc, joy_sample_t *out);			//0 if ok , JOY_ERR_x otherwise
+uint8_t joy_crc8(const uint8_t *buf, uint8_t len);
+
+#endif
@@ -0,0 +1,297 @@
+#include "stm32f1xx.h"
+#include "myadc.h"
+
+//sample time + 12.5 cycles conversion , in half ADC clocks , indexed by ADC_SMP_x
+static const uint16_t conv_half_cycles[8] = { 28, 40, 52, 82, 108, 136, 168, 504 };
+
+//both halves , 32 bit aligned for the dual mode DMA words , only cndtr transfers are used
+static volatile uint32_t buf[ADC_BLOCK_SCANS * ADC_MAX_CHANNELS];
+static uint16_t last_scan[ADC_MAX_CHANNELS];
+static uint8_t nchannels;		//entries per scan , 2 per pair in dual mode
+static uint32_t half_len;		//16 bit entries in one half
+static uint32_t half_xfers;		//DMA transfers in one half
+static struct
+{
+	adc_filter_fn fn;
+	void *filter;
+} filters[ADC_MAX_CHANNELS];
+
+volatile adc_stream_stats_t adc_stream_stats;
+
+__WEAK void adc_block_hook(const uint16_t *block, uint32_t nscans, uint8_t nch)
+{
+	(void) block;
+	(void) nscans;
+	(void) nch;
+}
+
+void DMA1_Channel1_IRQHandler(void)
+{
+	uint32_t isr = DMA1->ISR;
+	uint16_t *block;
+
+	if (!(isr & (DMA_ISR_HTIF1 | DMA_ISR_TCIF1)))
+		return;
+	DMA1->IFCR = DMA_IFCR_CHTIF1 | DMA_IFCR_CTCIF1 | DMA_IFCR_CGIF1;
+	if ((isr & DMA_ISR_HTIF1) && (isr & DMA_ISR_TCIF1))
+		adc_stream_stats.overruns++;		//a whole half went by unnoticed
+
+	//the finished half is the one the DMA is not writing
+	block = (uint16_t *) buf + (DMA1_Channel1->CNDTR > half_xfers ? half_len : 0);
+	for (uint8_t i = 0; i < nchannels; i++)
+		if (filters[i].fn)
+			filters[i].fn(filters[i].filter, block + i, half_len / nchannels, nchannels);
+	for (uint8_t i = 0; i < nchannels; i++)
+		last_scan[i] = block[half_len - nchannels + i];
+	adc_stream_stats.blocks++;
+	adc_block_hook(block, half_len / nchannels, nchannels);
+}
+
+void adc_snapshot(uint16_t *scan)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	for (uint8_t i = 0; i < nchannels; i++)
+		scan[i] = last_scan[i];
+	__set_PRIMASK(primask);
+}
+
+int adc_filter_attach(uint8_t entry, adc_filter_fn fn, void *filter)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	if (entry >= ADC_MAX_CHANNELS)
+		return ADC_ERR_CHANNELS;
+	__disable_irq();
+	filters[entry].fn = fn;
+	filters[entry].filter = filter;
+	__set_PRIMASK(primask);
+	return 0;
+}
+
+//regular sequence , 5 bits per entry: SQR3 holds 1-6 , SQR2 7-12 , SQR1 13-16 and the length
+//a channel listed twice gets the sample time of its last entry , SMPR has one field per channel
+static int sequence(const uint8_t *channels, const uint8_t *smp, uint8_t nch, uint32_t *sqr, uint32_t *smpr)
+{
+	sqr[0] = (uint32_t) (nch - 1) << 20;
+	sqr[1] = 0;
+	sqr[2] = 0;
+	smpr[0] = 0;
+	smpr[1] = 0;
+	for (uint8_t i = 0; i < nch; i++)
+	{
+		uint8_t ch = channels[i];
+		uint32_t t = smp[i] & 0x7;
+
+		if (ch > 17)
+			return ADC_ERR_CHANNELS;
+		if (i < 6)
+			sqr[2] |= (uint32_t) ch << (5 * i);
+		else if (i < 12)
+			sqr[1] |= (uint32_t) ch << (5 * (i - 6));
+		else
+			sqr[0] |= (uint32_t) ch << (5 * (i - 12));
+		if (ch < 10)
+			smpr[1] = (smpr[1] & ~(7UL << (3 * ch))) | t << (3 * ch);		//channels 0-9
+		else
+			smpr[0] = (smpr[0] & ~(7UL << (3 * (ch - 10)))) | t << (3 * (ch - 10));	//channels 10-17
+	}
+	return 0;
+}
+
+int adc_plan(const adc_config_t *cfg, uint32_t timer_clock, uint32_t pclk2, adc_plan_t *plan)
+{
+	uint32_t block = cfg->block ? cfg->block : ADC_BLOCK_SCANS;
+	uint32_t half_cycles = 0;
+	uint32_t sqr[3], smpr[2];
+	uint32_t ticks;
+
+	if (!cfg->nch || cfg->nch > (cfg->dual ? ADC_MAX_CHANNELS / 2 : ADC_MAX_CHANNELS))
+		return ADC_ERR_CHANNELS;
+	if (block > ADC_BLOCK_SCANS)
+		return ADC_ERR_BLOCK;
+
+	//smallest prescaler (2 , 4 , 6 , 8) that keeps the ADC clock at 14 MHz or below
+	plan->adcpre = 0;
+	while (plan->adcpre < 3 && pclk2 / (2 * (plan->adcpre + 1)) > 14000000)
+		plan->adcpre++;
+	plan->adc_clock = pclk2 / (2 * (plan->adcpre + 1));
+
+	if (sequence(cfg->channels, cfg->smp, cfg->nch, sqr, smpr))
+		return ADC_ERR_CHANNELS;
+	plan->sqr1 = sqr[0];
+	plan->sqr2 = sqr[1];
+	plan->sqr3 = sqr[2];
+	plan->smpr1 = smpr[0];
+	plan->smpr2 = smpr[1];
+	for (uint8_t i = 0; i < cfg->nch; i++)
+	{
+		uint8_t ch = cfg->channels[i];
+		uint32_t smp = ch < 10 ? plan->smpr2 >> (3 * ch) : plan->smpr1 >> (3 * (ch - 10));
+
+		half_cycles += conv_half_cycles[smp & 0x7];
+	}
+	plan->scan_ns = (uint64_t) half_cycles * 500000000 / plan->adc_clock;
+
+	plan->cr1 = cfg->nch > 1 ? ADC_CR1_SCAN : 0;
+	plan->cndtr = 2 * block * cfg->nch;	//one 32 bit word per pair in dual mode
+	plan->dma_ccr = DMA_CCR_CIRC | DMA_CCR_MINC | DMA_CCR_MSIZE_0 | DMA_CCR_PSIZE_0 | DMA_CCR_HTIE | DMA_CCR_TCIE;
+	plan->psc = 0;
+	plan->arr = 0;
+	plan->ccr = 0;
+	plan->adc2_cr1 = 0;
+	plan->adc2_cr2 = 0;
+	plan->adc2_sqr1 = 0;
+	plan->adc2_sqr2 = 0;
+	plan->adc2_sqr3 = 0;
+	plan->adc2_smpr1 = 0;
+	plan->adc2_smpr2 = 0;
+
+	if (cfg->trigger == ADC_TRIG_CONT)
+		plan->cr2 = ADC_CR2_DMA | ADC_CR2_CONT;
+	else if (cfg->trigger == ADC_TRIG_TIM3_TRGO)
+		plan->cr2 = ADC_CR2_DMA | ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL_2;			//EXTSEL 100
+	else if (cfg->trigger == ADC_TRIG_TIM2_CC2)
+		plan->cr2 = ADC_CR2_DMA | ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL_1 | ADC_CR2_EXTSEL_0;	//EXTSEL 011
+	else
+		return ADC_ERR_TRIGGER;
+
+	if (cfg->dual)
+	{
+		//ADC2 gets the same sequence length and sample times , a pair must not share a channel
+		for (uint8_t i = 0; i < cfg->nch; i++)
+			if (cfg->channels2[i] == cfg->channels[i])
+				return ADC_ERR_CHANNELS;
+		if (sequence(cfg->channels2, cfg->smp, cfg->nch, sqr, smpr))
+			return ADC_ERR_CHANNELS;
+		plan->adc2_sqr1 = sqr[0];
+		plan->adc2_sqr2 = sqr[1];
+		plan->adc2_sqr3 = sqr[2];
+		plan->adc2_smpr1 = smpr[0];
+		plan->adc2_smpr2 = smpr[1];
+		plan->adc2_cr1 = plan->cr1;
+		//ADC2 follows ADC1 , its own trigger must be SWSTART with EXTTRIG set , it has no DMA of its own
+		plan->adc2_cr2 = ADC_CR2_EXTTRIG | ADC_CR2_EXTSEL | (plan->cr2 & ADC_CR2_CONT);
+		plan->cr1 |= ADC_CR1_DUALMOD_2 | ADC_CR1_DUALMOD_1;	//0110 regular simultaneous
+		plan->dma_ccr = DMA_CCR_CIRC | DMA_CCR_MINC | DMA_CCR_MSIZE_1 | DMA_CCR_PSIZE_1 | DMA_CCR_HTIE | DMA_CCR_TCIE;
+	}
+
+	if (cfg->trigger == ADC_TRIG_CONT)
+	{
+		plan->rate_mhz = 1000000000000ULL / plan->scan_ns;
+		return 0;
+	}
+
+	//period in timer ticks , split into PSC and ARR keeping ARR as large as possible for the finest rate steps
+	if (!cfg->rate)
+		return ADC_ERR_RATE;
+	ticks = (timer_clock + cfg->rate / 2) / cfg->rate;
+	if ((ticks - 1) / 65536 > 65535)
+		return ADC_ERR_RATE;
+	plan->psc = (ticks - 1) / 65536;
+	plan->arr = (ticks + (plan->psc + 1) / 2) / (plan->psc + 1) - 1;
+	plan->ccr = (plan->arr + 1) / 2;
+	if (!plan->arr || (uint64_t) (plan->psc + 1) * (plan->arr + 1) * 1000000000 / timer_clock < plan->scan_ns)
+		return ADC_ERR_RATE;
+	plan->rate_mhz = (uint64_t) timer_clock * 1000 / ((uint32_t) (plan->psc + 1) * (plan->arr + 1));
+	return 0;
+}
+
+//power up , wait tSTAB (1us) , then calibrate
+static void adc_calibrate(ADC_TypeDef *adc)
+{
+	volatile uint32_t wait;
+
+	adc->CR2 = ADC_CR2_ADON;
+	for (wait = 0; wait < SystemCoreClock / 100000; wait++);
+	adc->CR2 |= ADC_CR2_RSTCAL;
+	while (adc->CR2 & ADC_CR2_RSTCAL);
+	adc->CR2 |= ADC_CR2_CAL;
+	while (adc->CR2 & ADC_CR2_CAL);
+}
+
+int adc_stream_init(const adc_config_t *cfg)
+{
+	uint32_t ppre1 = (RCC->CFGR >> 8) & 0x7;
+	uint32_t ppre2 = (RCC->CFGR >> 11) & 0x7;
+	uint32_t pclk1 = SystemCoreClock >> ((ppre1 & 0x4) ? (ppre1 & 0x3) + 1 : 0);
+	uint32_t pclk2 = SystemCoreClock >> ((ppre2 & 0x4) ? (ppre2 & 0x3) + 1 : 0);
+	adc_plan_t plan;
+	int err;
+
+	err = adc_plan(cfg, (ppre1 & 0x4) ? 2 * pclk1 : pclk1, pclk2, &plan);
+	if (err)
+		return err;
+	nchannels = cfg->dual ? 2 * cfg->nch : cfg->nch;
+	half_xfers = plan.cndtr / 2;
+	half_len = cfg->dual ? plan.cndtr : plan.cndtr / 2;
+
+	RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_ADCPRE) | (plan.adcpre << 14);
+	RCC->APB2ENR |= RCC_APB2ENR_ADC1EN | (cfg->dual ? RCC_APB2ENR_ADC2EN : 0);
+	RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+
+	adc_calibrate(ADC1);
+	ADC1->SQR1 = plan.sqr1;
+	ADC1->SQR2 = plan.sqr2;
+	ADC1->SQR3 = plan.sqr3;
+	ADC1->SMPR1 = plan.smpr1;
+	ADC1->SMPR2 = plan.smpr2;
+	if (cfg->dual)
+	{
+		adc_calibrate(ADC2);
+		ADC2->SQR1 = plan.adc2_sqr1;
+		ADC2->SQR2 = plan.adc2_sqr2;
+		ADC2->SQR3 = plan.adc2_sqr3;
+		ADC2->SMPR1 = plan.adc2_smpr1;
+		ADC2->SMPR2 = plan.adc2_smpr2;
+		ADC2->CR1 = plan.adc2_cr1;
+		ADC2->CR2 = ADC_CR2_ADON | plan.adc2_cr2;
+	}
+
+	/*****DMA SETTINGS*****/
+	DMA1_Channel1->CCR = 0;
+	DMA1_Channel1->CNDTR = plan.cndtr;
+	DMA1_Channel1->CMAR = (uint32_t) (uintptr_t) buf;
+	DMA1_Channel1->CPAR = (uint32_t) (uintptr_t) &(ADC1->DR);
+	DMA1->IFCR = DMA_IFCR_CGIF1;
+	DMA1_Channel1->CCR = plan.dma_ccr;
+	DMA1_Channel1->CCR |= DMA_CCR_EN;
+	NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+	/**********************/
+
+	adc_stream_stats.blocks = 0;
+	adc_stream_stats.overruns = 0;
+	ADC1->CR1 = plan.cr1;
+	ADC1->CR2 = ADC_CR2_ADON | plan.cr2;	//a write that changes other bits besides ADON does not start a conversion
+
+	if (cfg->trigger == ADC_TRIG_CONT)
+	{
+		ADC1->CR2 |= ADC_CR2_ADON;		//ADON again on a powered ADC starts the first scan (both ADCs in dual mode)
+		return 0;
+	}
+	//the trigger timer , every update (TIM3) or compare 2 match (TIM2) starts one scan
+	if (cfg->trigger == ADC_TRIG_TIM3_TRGO)
+	{
+		RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+		TIM3->CR1 = 0;
+		TIM3->PSC = plan.psc;
+		TIM3->ARR = plan.arr;
+		TIM3->CR2 = TIM_CR2_MMS_1;		//TRGO on update
+		TIM3->EGR = TIM_EGR_UG;
+		TIM3->CR1 = TIM_CR1_CEN;
+	}
+	else
+	{
+		RCC->APB1ENR |= RCC_APB1ENR_TIM2EN;
+		TIM2->CR1 = 0;
+		TIM2->PSC = plan.psc;
+		TIM2->ARR = plan.arr;
+		TIM2->CCR2 = plan.ccr;
+		TIM2->CCMR1 = (TIM2->CCMR1 & 0x00FF) | TIM_CCMR1_OC2M_2 | TIM_CCMR1_OC2M_1;	//PWM mode 1 , the compare event fires every period
+		TIM2->CCER |= TIM_CCER_CC2E;
+		TIM2->EGR = TIM_EGR_UG;
+		TIM2->CR1 = TIM_CR1_CEN;
+	}
+	return 0;
+}
@@ -0,0 +1,112 @@
+#ifndef MYADC_H
+#define MYADC_H
+
+#include <stdint.h>
+
+//ADC1 scan of up to ADC_MAX_CHANNELS channels , DMA1 channel 1 runs in circular mode over two halves of adc_config_t.block scans each
+//the half transfer and transfer complete interrupts hand the half that just filled to adc_block_hook() while the DMA fills the other ,
+//so a block is never written while it is being read as long as the hook returns within one block time
+//
+//scans are started by a timer at adc_config_t.rate (TIM3 TRGO , or TIM2 CC2 where mydelay owns TIM3) , or back to back in
+//continuous mode with ADC_TRIG_CONT , the rate then only depends on the sample times
+//
+//block layout is scan major: block[scan * nch + i] is the i-th channel of the channel list
+//
+//dual mode (adc_config_t.dual) runs ADC2 in regular simultaneous mode next to ADC1: ADC2 converts channels2[i] at the same
+//instant ADC1 converts channels[i] , both results come out of ADC1->DR as one 32 bit DMA word (ADC1 low , ADC2 high)
+//so a scan of n pairs reads as 2n entries: block[scan * 2n + 2i] from ADC1 and block[scan * 2n + 2i + 1] from ADC2 ,
+//nch in adc_block_hook() is 2n , the scan takes as long as n single conversions
+//
+//a filter attached to an entry (adc_filter_attach , the block functions of sigfilt.h fit) runs in place on the finished half
+//before adc_block_hook() and adc_snapshot() see it , so both get filtered samples without a copy
+
+#define ADC_MAX_CHANNELS 16		//length of the regular sequence
+
+#ifndef ADC_BLOCK_SCANS
+#define ADC_BLOCK_SCANS 16		//largest block , sets the size of the DMA buffer
+#endif
+
+//sample time codes for SMPRx , conversion takes sample time + 12.5 ADC clocks
+#define ADC_SMP_1_5 0
+#define ADC_SMP_7_5 1
+#define ADC_SMP_13_5 2
+#define ADC_SMP_28_5 3
+#define ADC_SMP_41_5 4
+#define ADC_SMP_55_5 5
+#define ADC_SMP_71_5 6
+#define ADC_SMP_239_5 7
+
+//timer that paces the scans
+#define ADC_TRIG_CONT 0			//no timer , continuous conversion
+#define ADC_TRIG_TIM3_TRGO 1		//TIM3 update event (mydelay also uses TIM3 , do not mix the two)
+#define ADC_TRIG_TIM2_CC2 2		//TIM2 compare 2 , PA1 is left alone
+
+#define ADC_ERR_CHANNELS -1		//no channels , too many , a channel above 17 , or a dual pair on the same channel
+#define ADC_ERR_RATE -2			//a scan takes longer than the trigger period , or the timer cannot go that slow
+#define ADC_ERR_TRIGGER -3
+#define ADC_ERR_BLOCK -4		//block larger than ADC_BLOCK_SCANS
+
+typedef struct
+{
+	uint32_t rate;			//scans per second , ignored for ADC_TRIG_CONT
+	uint8_t trigger;		//ADC_TRIG_x
+	uint8_t block;			//scans per adc_block_hook() call , 0 -> ADC_BLOCK_SCANS
+	uint8_t nch;
+	uint8_t channels[ADC_MAX_CHANNELS];
+	uint8_t smp[ADC_MAX_CHANNELS];	//ADC_SMP_x of each entry in channels (and channels2 , a pair must sample for the same time)
+	uint8_t dual;			//1 -> ADC2 converts channels2 alongside , nch is then at most ADC_MAX_CHANNELS / 2
+	uint8_t channels2[ADC_MAX_CHANNELS];
+} adc_config_t;
+
+//register values worked out from a config and the bus clocks
+typedef struct
+{
+	uint32_t adcpre;		//RCC_CFGR ADCPRE field (0-3 -> /2 /4 /6 /8)
+	uint32_t adc_clock;		//Hz
+	uint32_t cr1;
+	uint32_t cr2;			//without ADON
+	uint32_t sqr1;
+	uint32_t sqr2;
+	uint32_t sqr3;
+	uint32_t smpr1;
+	uint32_t smpr2;
+	uint32_t cndtr;			//both halves
+	uint16_t psc;			//trigger timer
+	uint16_t arr;
+	uint16_t ccr;			//compare value for ADC_TRIG_TIM2_CC2
+	uint32_t scan_ns;		//conversion time of one scan
+	uint32_t rate_mhz;		//scan rate that will actually be reached , millihertz
+	uint32_t dma_ccr;		//DMA1 channel 1 set up , without EN
+	uint32_t adc2_cr1;		//ADC2 registers , dual mode only
+	uint32_t adc2_cr2;
+	uint32_t adc2_sqr1;
+	uint32_t adc2_sqr2;
+	uint32_t adc2_sqr3;
+	uint32_t adc2_smpr1;
+	uint32_t adc2_smpr2;
+} adc_plan_t;
+
+typedef struct
+{
+	uint32_t blocks;		//blocks handed to adc_block_hook()
+	uint32_t overruns;		//both halves were full when the interrupt ran , the older one was overwritten
+} adc_stream_stats_t;
+
+extern volatile adc_stream_stats_t adc_stream_stats;
+
+//filters n samples in place , taken every stride entries
+typedef void (*adc_filter_fn)(void *filter, uint16_t *samples, uint32_t n, uint8_t stride);
+
+//timer_clock is what TIM2/TIM3 count (PCLK1 , doubled when the APB1 prescaler is not 1) , pclk2 feeds the ADC prescaler
+int adc_plan(const adc_config_t *cfg, uint32_t timer_clock, uint32_t pclk2, adc_plan_t *plan);	//0 if ok , ADC_ERR_x otherwise
+
+//plans for the current clocks , sets up ADC1 (and ADC2) calibrated , DMA1 channel 1 and the trigger timer and starts converting
+//pins must already be analog inputs , returns 0 or ADC_ERR_x
+int adc_stream_init(const adc_config_t *cfg);
+void adc_snapshot(uint16_t *scan);	//copies the newest complete scan (all channels from the same scan)
+int adc_filter_attach(uint8_t entry, adc_filter_fn fn, void *filter);	//entry of the scan (0 to 2n - 1 in dual mode) , fn 0 detaches
+
+//weak , empty by default , called from DMA1_Channel1_IRQHandler for every completed block
+void adc_block_hook(const uint16_t *block, uint32_t nscans, uint8_t nch);
+
+#endif
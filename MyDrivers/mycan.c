@@ -0,0 +1,243 @@
+#include "stm32f1xx.h"
+#include "mycan.h"
+
+//single producer (rx interrupts) , single consumer (can_recv) ring
+//head is only written by the interrupts and tail only by the application, both are free running
+static can_frame_t rx_ring[CAN_RX_RING_SIZE];
+static volatile uint32_t rx_head = 0;
+static volatile uint32_t rx_tail = 0;
+
+volatile can_rx_stats_t can_rx_stats;
+
+//frames waiting for a free mailbox, sorted by falling arbitration key so the most urgent frame is always at the end
+static can_frame_t tx_queue[CAN_TX_QUEUE_SIZE];
+static uint32_t tx_key[CAN_TX_QUEUE_SIZE];
+static volatile uint32_t tx_count = 0;
+static can_frame_t tx_mailbox[3];		//copy of what each hardware mailbox holds , for can_tx_hook()
+
+volatile can_tx_stats_t can_tx_stats;
+
+__WEAK uint32_t can_timestamp(void)
+{
+	return DWT->CYCCNT;
+}
+
+__WEAK void can_rx_hook(const can_frame_t *frame)
+{
+	(void) frame;
+}
+
+__WEAK void can_tx_hook(const can_frame_t *frame, uint8_t ok)
+{
+	(void) frame;
+	(void) ok;
+}
+
+static void can_rx_drain(uint8_t fifo)
+{
+	volatile uint32_t *rfr = fifo ? &CAN1->RF1R : &CAN1->RF0R;
+	CAN_FIFOMailBox_TypeDef *mb = &CAN1->sFIFOMailBox[fifo];
+
+	//FMP, FOVR and RFOM sit at the same bit positions in RF0R and RF1R
+	while (*rfr & CAN_RF0R_FMP0)
+	{
+		if (rx_head - rx_tail < CAN_RX_RING_SIZE)
+		{
+			can_frame_t *f = &rx_ring[rx_head & (CAN_RX_RING_SIZE - 1)];
+			uint32_t rir = mb->RIR;
+			uint32_t rdtr = mb->RDTR;
+			uint32_t lo = mb->RDLR;
+			uint32_t hi = mb->RDHR;
+
+			f->stamp = can_timestamp();
+			f->ide = (rir & CAN_RI0R_IDE) ? 1 : 0;
+			f->rtr = (rir & CAN_RI0R_RTR) ? 1 : 0;
+			f->id = f->ide ? (rir >> 3) : (rir >> 21);	//EXID[28:0] starts at bit 3 , STID[10:0] at bit 21
+			f->dlc = rdtr & CAN_RDT0R_DLC;
+			f->fmi = (rdtr & CAN_RDT0R_FMI) >> 8;
+			f->fifo = fifo;
+			f->data[0] = lo;
+			f->data[1] = lo >> 8;
+			f->data[2] = lo >> 16;
+			f->data[3] = lo >> 24;
+			f->data[4] = hi;
+			f->data[5] = hi >> 8;
+			f->data[6] = hi >> 16;
+			f->data[7] = hi >> 24;
+
+			can_rx_hook(f);
+			__DMB();				//frame must be complete before the consumer can see it
+			rx_head++;
+			can_rx_stats.frames++;
+		}
+		else
+			can_rx_stats.ring_overruns++;		//ring full, newest frame is dropped
+
+		*rfr = CAN_RF0R_RFOM0;				//release the hardware mailbox
+	}
+
+	if (*rfr & CAN_RF0R_FOVR0)
+	{
+		can_rx_stats.fifo_overruns[fifo]++;
+		*rfr = CAN_RF0R_FOVR0;				//write 1 to clear
+	}
+}
+
+void USB_LP_CAN1_RX0_IRQHandler(void)
+{
+	can_rx_drain(0);
+}
+
+void CAN1_RX1_IRQHandler(void)
+{
+	can_rx_drain(1);
+}
+
+void can_rx_init(void)
+{
+	//free running cycle counter used to timestamp frames
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	rx_head = 0;
+	rx_tail = 0;
+	can_rx_stats.frames = 0;
+	can_rx_stats.ring_overruns = 0;
+	can_rx_stats.fifo_overruns[0] = 0;
+	can_rx_stats.fifo_overruns[1] = 0;
+
+	//interrupt on message pending and on overrun for both FIFOs
+	CAN1->IER |= CAN_IER_FMPIE0 | CAN_IER_FOVIE0 | CAN_IER_FMPIE1 | CAN_IER_FOVIE1;
+	NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
+	NVIC_EnableIRQ(CAN1_RX1_IRQn);
+}
+
+int can_recv(can_frame_t *frame)
+{
+	uint32_t tail = rx_tail;
+
+	if (tail == rx_head)
+		return 0;
+
+	*frame = rx_ring[tail & (CAN_RX_RING_SIZE - 1)];
+	__DMB();					//finish reading the slot before handing it back to the interrupt
+	rx_tail = tail + 1;
+	return 1;
+}
+
+uint32_t can_rx_pending(void)
+{
+	return rx_head - rx_tail;
+}
+
+//lower key wins arbitration on the bus: base id first , then a standard frame beats an extended one , data beats remote
+static uint32_t can_arb_key(const can_frame_t *f)
+{
+	uint32_t key;
+
+	if (f->ide)
+		key = ((f->id >> 18) << 19) | (1 << 18) | (f->id & 0x3FFFF);
+	else
+		key = f->id << 19;
+	return (key << 1) | f->rtr;
+}
+
+//load the most urgent queued frames into every empty mailbox , interrupts must be masked by the caller
+static void can_tx_refill(void)
+{
+	while (tx_count && (CAN1->TSR & CAN_TSR_TME))
+	{
+		uint32_t mbx = (CAN1->TSR & CAN_TSR_CODE) >> 24;		//CODE holds the number of the next empty mailbox
+		CAN_TxMailBox_TypeDef *mb = &CAN1->sTxMailBox[mbx];
+		const can_frame_t *f = &tx_queue[--tx_count];
+
+		tx_mailbox[mbx] = *f;
+
+		mb->TIR = f->ide ? ((f->id << 3) | CAN_TI0R_IDE) : (f->id << 21);
+		if (f->rtr)
+			mb->TIR |= CAN_TI0R_RTR;
+		mb->TDTR = f->dlc;
+		mb->TDLR = f->data[0] | (f->data[1] << 8) | (f->data[2] << 16) | ((uint32_t) f->data[3] << 24);
+		mb->TDHR = f->data[4] | (f->data[5] << 8) | (f->data[6] << 16) | ((uint32_t) f->data[7] << 24);
+		mb->TIR |= CAN_TI0R_TXRQ;
+	}
+}
+
+void USB_HP_CAN1_TX_IRQHandler(void)
+{
+	uint32_t tsr = CAN1->TSR;
+	static const uint32_t rqcp[3] = { CAN_TSR_RQCP0, CAN_TSR_RQCP1, CAN_TSR_RQCP2 };
+	static const uint32_t txok[3] = { CAN_TSR_TXOK0, CAN_TSR_TXOK1, CAN_TSR_TXOK2 };
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (tsr & rqcp[i])
+		{
+			if (tsr & txok[i])
+				can_tx_stats.sent++;
+			else
+				can_tx_stats.failed++;
+			can_tx_hook(&tx_mailbox[i], (tsr & txok[i]) ? 1 : 0);
+			CAN1->TSR = rqcp[i];		//write 1 to clear RQCP (also clears TXOK/ALST/TERR)
+		}
+	}
+	can_tx_refill();
+}
+
+void can_tx_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	tx_count = 0;
+	can_tx_stats.queued = 0;
+	can_tx_stats.sent = 0;
+	can_tx_stats.failed = 0;
+	can_tx_stats.dropped = 0;
+
+	//the queue already hands out frames most urgent first , mailboxes must go out in the order they were loaded
+	//(with TXFP clear equal ids leave lowest mailbox first , which reorders consecutive frames of one id)
+	//the price is a bounded priority inversion: a frame is never pulled back out of a mailbox , so an urgent frame
+	//queued while all three are loaded waits for the three less urgent ones ahead of it , at most 3 frame times
+	//(up to ~1.6 ms for 8 byte standard frames with worst case stuffing at the 250 kbit/s every program runs ,
+	//~0.4 ms at 1 Mbit/s) plus whatever other nodes win in between
+	CAN1->MCR |= CAN_MCR_TXFP;
+	CAN1->IER |= CAN_IER_TMEIE;		//interrupt whenever a mailbox becomes empty
+	NVIC_EnableIRQ(USB_HP_CAN1_TX_IRQn);
+}
+
+int can_send(const can_frame_t *frame)
+{
+	uint32_t key = can_arb_key(frame);
+	uint32_t primask = __get_PRIMASK();
+	int i;
+
+	__disable_irq();			//can_send() may be called from any interrupt as well as from main
+	if (tx_count == CAN_TX_QUEUE_SIZE)
+	{
+		can_tx_stats.dropped++;
+		__set_PRIMASK(primask);
+		return 0;
+	}
+
+	//insertion sort , everything at least as urgent as the new frame moves up one slot (equal ids stay in order)
+	for (i = tx_count; i > 0 && tx_key[i - 1] <= key; i--)
+	{
+		tx_queue[i] = tx_queue[i - 1];
+		tx_key[i] = tx_key[i - 1];
+	}
+	tx_queue[i] = *frame;
+	tx_queue[i].stamp = can_timestamp();
+	tx_key[i] = key;
+	tx_count++;
+	can_tx_stats.queued++;
+
+	can_tx_refill();			//goes straight to a mailbox if one is free
+	__set_PRIMASK(primask);
+	return 1;
+}
+
+uint32_t can_tx_pending(void)
+{
+	return tx_count;
+}
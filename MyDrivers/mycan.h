@@ -0,0 +1,63 @@
+#ifndef MYCAN_H
+#define MYCAN_H
+
+#include <stdint.h>
+
+//number of frames the software rx ring can hold, must be a power of 2
+#ifndef CAN_RX_RING_SIZE
+#define CAN_RX_RING_SIZE 32
+#endif
+
+#if (CAN_RX_RING_SIZE & (CAN_RX_RING_SIZE - 1)) != 0
+#error "CAN_RX_RING_SIZE must be a power of 2"
+#endif
+
+//number of frames that can wait for a free tx mailbox
+#ifndef CAN_TX_QUEUE_SIZE
+#define CAN_TX_QUEUE_SIZE 16
+#endif
+
+typedef struct
+{
+	uint32_t id;			//11 bit (standard) or 29 bit (extended) identifier
+	uint32_t stamp;			//can_timestamp() when the frame left the rx FIFO (rx) or was queued (tx)
+	uint8_t ide;			//1 -> extended identifier
+	uint8_t rtr;			//1 -> remote frame
+	uint8_t dlc;			//number of data bytes (0-8)
+	uint8_t fifo;			//hardware FIFO the frame arrived in (0 or 1)
+	uint8_t fmi;			//index of the filter that accepted the frame
+	uint8_t data[8];
+} can_frame_t;
+
+typedef struct
+{
+	uint32_t frames;		//frames pushed into the rx ring
+	uint32_t ring_overruns;		//frames dropped because the rx ring was full
+	uint32_t fifo_overruns[2];	//frames lost in hardware (FOVR0 / FOVR1)
+} can_rx_stats_t;
+
+typedef struct
+{
+	uint32_t queued;		//frames accepted by can_send()
+	uint32_t sent;			//transmissions completed with TXOK
+	uint32_t failed;		//transmissions completed without TXOK (arbitration lost / error with NART set)
+	uint32_t dropped;		//frames refused because the tx queue was full
+} can_tx_stats_t;
+
+extern volatile can_rx_stats_t can_rx_stats;
+extern volatile can_tx_stats_t can_tx_stats;
+
+void can_rx_init(void);			//call after can_init() and filter setup
+int can_recv(can_frame_t *frame);	//returns 1 and fills frame if one was waiting, 0 otherwise
+uint32_t can_rx_pending(void);
+void can_tx_init(void);			//call after can_init()
+int can_send(const can_frame_t *frame);	//queues the frame (id, ide, rtr, dlc, data), returns 0 if it was dropped
+					//most urgent first , but up to 3 frames already in mailboxes still go ahead of it
+uint32_t can_tx_pending(void);		//frames still waiting for a mailbox
+uint32_t can_timestamp(void);		//weak, DWT cycle counter by default
+
+//weak hooks , empty by default , called from the rx / tx interrupts (see mycanstats)
+void can_rx_hook(const can_frame_t *frame);
+void can_tx_hook(const can_frame_t *frame, uint8_t ok);	//frame.stamp is still the time it was queued
+
+#endif
@@ -0,0 +1,280 @@
+#include "stm32f1xx.h"
+#include "mycanfilter.h"
+
+//one aligned block of ids , mask keeps the bits that have to match
+typedef struct
+{
+	uint32_t id;
+	uint32_t mask;
+	uint32_t size;
+	uint8_t ide;
+} filter_item_t;
+
+static filter_item_t items[CAN_FILTER_MAX_ITEMS];
+
+//32 bit filter layout: STID[10:0] EXID[17:0] IDE RTR 0
+static uint32_t enc32(uint32_t id, uint8_t ide)
+{
+	return ide ? ((id << 3) | 0x4) : (id << 21);
+}
+
+//IDE and RTR always compared , only data frames of the right format get through
+static uint32_t mask32(uint32_t mask, uint8_t ide)
+{
+	return (ide ? (mask << 3) : (mask << 21)) | 0x6;
+}
+
+//16 bit filter layout: STID[10:0] RTR IDE EXID[17:15]
+static uint32_t enc16(uint32_t id)
+{
+	return id << 5;
+}
+
+static uint32_t mask16(uint32_t mask)
+{
+	return (mask << 5) | 0x18;
+}
+
+static can_filter_bank_t *new_bank(can_filter_bank_t *banks, int *nbanks, uint8_t list, uint8_t scale32)
+{
+	can_filter_bank_t *b;
+
+	if (*nbanks == CAN_FILTER_BANKS)
+		return 0;
+	b = &banks[(*nbanks)++];
+	b->list = list;
+	b->scale32 = scale32;
+	b->fifo = 0;
+	b->accepted = 0;
+	b->fr1 = 0;
+	b->fr2 = 0;
+	return b;
+}
+
+//next unused item of one kind (single id or block , standard or extended) , -1 when there are none left
+static int take(int nitems, uint8_t *used, uint8_t ide, uint8_t single)
+{
+	for (int i = 0; i < nitems; i++)
+	{
+		if (!used[i] && items[i].ide == ide && (items[i].size == 1) == single)
+		{
+			used[i] = 1;
+			return i;
+		}
+	}
+	return -1;
+}
+
+//splits [first,last] into the fewest aligned power of 2 blocks , each one is a single id/mask pair
+static int split_range(const can_filter_range_t *r, int nitems)
+{
+	uint32_t top = r->ide ? (1UL << 29) : (1UL << 11);
+	uint32_t a = r->first;
+	uint32_t b = r->last;
+
+	if (a > b || b >= top)
+		return -1;
+
+	while (1)
+	{
+		uint32_t size = 1;
+
+		while (size < top && !(a & size) && b - a >= (size << 1) - 1)
+			size <<= 1;
+		if (nitems == CAN_FILTER_MAX_ITEMS)
+			return -1;
+		items[nitems].id = a;
+		items[nitems].mask = (top - 1) & ~(size - 1);
+		items[nitems].size = size;
+		items[nitems].ide = r->ide;
+		nitems++;
+		if (b - a < size)
+			break;
+		a += size;
+	}
+	return nitems;
+}
+
+int can_filter_plan(const can_filter_range_t *ranges, int n, can_filter_bank_t *banks)
+{
+	uint8_t used[CAN_FILTER_MAX_ITEMS] = { 0 };
+	uint32_t load[2] = { 0, 0 };
+	int nitems = 0;
+	int nbanks = 0;
+	int i, k, spare;
+	can_filter_bank_t *b;
+
+	for (i = 0; i < n; i++)
+	{
+		nitems = split_range(&ranges[i], nitems);
+		if (nitems < 0)
+			return -1;
+	}
+
+	//standard single ids , 4 per bank in 16 bit list mode while there are at least 4 left
+	while (1)
+	{
+		int left = 0;
+		uint16_t id[4];
+
+		for (i = 0; i < nitems; i++)
+			if (!used[i] && !items[i].ide && items[i].size == 1)
+				left++;
+		if (left < 4)
+			break;
+		if (!(b = new_bank(banks, &nbanks, 1, 0)))
+			return -1;
+		for (k = 0; k < 4; k++)
+			id[k] = enc16(items[take(nitems, used, 0, 1)].id);
+		b->fr1 = id[0] | ((uint32_t) id[1] << 16);
+		b->fr2 = id[2] | ((uint32_t) id[3] << 16);
+		b->accepted = 4;
+	}
+
+	//standard blocks , 2 per bank in 16 bit mask mode , a spare slot takes a leftover single id
+	while ((i = take(nitems, used, 0, 0)) >= 0)
+	{
+		if (!(b = new_bank(banks, &nbanks, 0, 0)))
+			return -1;
+		b->fr1 = enc16(items[i].id) | (mask16(items[i].mask) << 16);
+		b->accepted = items[i].size;
+		k = take(nitems, used, 0, 0);
+		if (k < 0)
+			k = take(nitems, used, 0, 1);
+		if (k < 0)
+			k = i;				//nothing left , repeat the first pair
+		else
+			b->accepted += items[k].size;
+		b->fr2 = enc16(items[k].id) | (mask16(items[k].mask) << 16);
+	}
+
+	//extended single ids , 2 per bank in 32 bit list mode , a spare slot takes a leftover standard id
+	while ((i = take(nitems, used, 1, 1)) >= 0)
+	{
+		if (!(b = new_bank(banks, &nbanks, 1, 1)))
+			return -1;
+		b->fr1 = enc32(items[i].id, 1);
+		b->accepted = 1;
+		spare = 1;
+		if ((k = take(nitems, used, 1, 1)) >= 0)
+			b->fr2 = enc32(items[k].id, 1);
+		else if ((k = take(nitems, used, 0, 1)) >= 0)
+			b->fr2 = enc32(items[k].id, 0);
+		else
+		{
+			b->fr2 = b->fr1;
+			spare = 0;
+		}
+		b->accepted += spare;
+	}
+
+	//extended blocks , one per bank in 32 bit mask mode
+	while ((i = take(nitems, used, 1, 0)) >= 0)
+	{
+		if (!(b = new_bank(banks, &nbanks, 0, 1)))
+			return -1;
+		b->fr1 = enc32(items[i].id, 1);
+		b->fr2 = mask32(items[i].mask, 1);
+		b->accepted = items[i].size;
+	}
+
+	//up to 3 standard single ids still left , one more 16 bit list bank padded with repeats
+	if ((i = take(nitems, used, 0, 1)) >= 0)
+	{
+		uint16_t id[4];
+
+		if (!(b = new_bank(banks, &nbanks, 1, 0)))
+			return -1;
+		id[0] = enc16(items[i].id);
+		b->accepted = 1;
+		for (k = 1; k < 4; k++)
+		{
+			int j = take(nitems, used, 0, 1);
+
+			if (j >= 0)
+			{
+				id[k] = enc16(items[j].id);
+				b->accepted++;
+			}
+			else
+				id[k] = id[0];
+		}
+		b->fr1 = id[0] | ((uint32_t) id[1] << 16);
+		b->fr2 = id[2] | ((uint32_t) id[3] << 16);
+	}
+
+	//balance the FIFOs , busiest bank first onto the FIFO with less traffic so far
+	for (i = 0; i < nbanks; i++)
+		banks[i].fifo = 0xFF;
+	for (i = 0; i < nbanks; i++)
+	{
+		int best = -1;
+
+		for (k = 0; k < nbanks; k++)
+			if (banks[k].fifo == 0xFF && (best < 0 || banks[k].accepted > banks[best].accepted))
+				best = k;
+		banks[best].fifo = load[1] < load[0];
+		load[banks[best].fifo] += banks[best].accepted;
+	}
+
+	return nbanks;
+}
+
+void can_filter_apply(const can_filter_bank_t *banks, int nbanks)
+{
+	CAN1->FMR |= CAN_FMR_FINIT;				//filter init mode
+	CAN1->FA1R &= ~((1UL << CAN_FILTER_BANKS) - 1);		//deactivate every bank
+	for (int i = 0; i < nbanks; i++)
+	{
+		uint32_t bit = 1UL << i;
+
+		if (banks[i].list)
+			CAN1->FM1R |= bit;
+		else
+			CAN1->FM1R &= ~bit;
+		if (banks[i].scale32)
+			CAN1->FS1R |= bit;
+		else
+			CAN1->FS1R &= ~bit;
+		if (banks[i].fifo)
+			CAN1->FFA1R |= bit;
+		else
+			CAN1->FFA1R &= ~bit;
+		CAN1->sFilterRegister[i].FR1 = banks[i].fr1;
+		CAN1->sFilterRegister[i].FR2 = banks[i].fr2;
+		CAN1->FA1R |= bit;
+	}
+	CAN1->FMR &= ~CAN_FMR_FINIT;
+}
+
+int can_filter_match(const can_filter_bank_t *banks, int nbanks, uint32_t id, uint8_t ide)
+{
+	uint32_t w32 = enc32(id, ide);
+	uint32_t w16 = ide ? (((id >> 18) << 5) | 0x8 | ((id >> 15) & 0x7)) : enc16(id);
+	int fifo = -1, best = 4;
+
+	//as the bxCAN picks among banks that all match: 32 bit before 16 bit , list before mask , then the lower bank
+	for (int i = 0; i < nbanks; i++)
+	{
+		const can_filter_bank_t *b = &banks[i];
+		int rank = (b->scale32 ? 0 : 2) + (b->list ? 0 : 1);
+		int hit;
+
+		if (b->scale32 && b->list)
+			hit = (w32 == b->fr1) || (w32 == b->fr2);
+		else if (b->scale32)
+			hit = ((w32 ^ b->fr1) & b->fr2) == 0;
+		else if (b->list)
+			hit = w16 == (b->fr1 & 0xFFFF) || w16 == (b->fr1 >> 16) || w16 == (b->fr2 & 0xFFFF)
+					|| w16 == (b->fr2 >> 16);
+		else
+			hit = ((w16 ^ b->fr1) & (b->fr1 >> 16) & 0xFFFF) == 0
+					|| ((w16 ^ b->fr2) & (b->fr2 >> 16) & 0xFFFF) == 0;
+		if (hit && rank < best)
+		{
+			best = rank;
+			fifo = b->fifo;
+		}
+	}
+	return fifo;
+}
@@ -0,0 +1,38 @@
+#ifndef MYCANFILTER_H
+#define MYCANFILTER_H
+
+#include <stdint.h>
+
+#define CAN_FILTER_BANKS 14		//filter banks on the F103 (single bxCAN)
+
+//upper limit on id/mask entries a plan may be built from (ranges are split into aligned power of 2 blocks)
+#ifndef CAN_FILTER_MAX_ITEMS
+#define CAN_FILTER_MAX_ITEMS 64
+#endif
+
+typedef struct
+{
+	uint32_t first;			//first accepted identifier
+	uint32_t last;			//last accepted identifier , same as first for a single id
+	uint8_t ide;			//1 -> extended (29 bit) identifiers
+} can_filter_range_t;
+
+typedef struct
+{
+	uint8_t list;			//1 -> identifier list mode (FM1R) , 0 -> id/mask mode
+	uint8_t scale32;		//1 -> one 32 bit filter (FS1R) , 0 -> two 16 bit filters
+	uint8_t fifo;			//FIFO the bank feeds (FFA1R)
+	uint32_t accepted;		//number of identifiers the bank lets through
+	uint32_t fr1;
+	uint32_t fr2;
+} can_filter_bank_t;
+
+//packs the accepted data frame ids into as few banks as possible and spreads them over both FIFOs
+//returns the number of banks used , -1 if the list does not fit into CAN_FILTER_BANKS without passing extra ids
+int can_filter_plan(const can_filter_range_t *ranges, int n, can_filter_bank_t *banks);
+void can_filter_apply(const can_filter_bank_t *banks, int nbanks);	//writes the banks and disables the rest
+//FIFO a data frame lands in , -1 if rejected , overlapping banks are resolved as the bxCAN does
+//(32 bit before 16 bit , list before mask , then the lower bank)
+int can_filter_match(const can_filter_bank_t *banks, int nbanks, uint32_t id, uint8_t ide);
+
+#endif
@@ -0,0 +1,106 @@
+#include "stm32f1xx.h"
+#include "mycanlog.h"
+
+static uint32_t cycles_per_us;
+static uint32_t last_stamp;			//can_timestamp() units of the last record
+static uint32_t leftover;			//cycles not yet counted as a whole microsecond
+static uint32_t time_us;			//absolute time of the last record
+static uint32_t since_sync;
+static uint32_t pending_drops;			//frames lost since the last drop record
+
+volatile canlog_stats_t canlog_stats;
+
+//advance the log clock to stamp and return the whole microseconds that passed
+static uint32_t advance(uint32_t stamp)
+{
+	int32_t d = (int32_t) (stamp - last_stamp);
+	uint32_t us;
+
+	if (d < 0)
+		d = 0;				//stamped before the last sync went out , log it at the sync time
+	else
+		last_stamp = stamp;
+	leftover += d;
+	us = leftover / cycles_per_us;
+	leftover -= us * cycles_per_us;
+	time_us += us;
+	return us;
+}
+
+int canlog_frame(const can_frame_t *frame)
+{
+	uint8_t rec[CANLOG_MAX_RECORD + 8 + 6];
+	uint8_t n = 0;
+	uint32_t primask = __get_PRIMASK();
+	uint32_t delta;
+
+	__disable_irq();
+	delta = advance(frame->stamp);
+	if (since_sync >= CANLOG_SYNC_EVERY)
+	{
+		n += canlog_put_sync(rec, time_us - delta);	//sync carries the time of the previous record , the delta still applies
+		since_sync = 0;
+	}
+	if (pending_drops)
+		n += canlog_put_drop(rec + n, pending_drops);
+	n += canlog_put_frame(rec + n, delta, frame->id, frame->ide, frame->rtr, frame->dlc, frame->data);
+
+	if (!uart_tx_write(rec, n))
+	{
+		pending_drops++;			//no room , the gap shows up as a drop record later
+		canlog_stats.dropped++;
+		since_sync = CANLOG_SYNC_EVERY;		//and the time after it is re-anchored
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	pending_drops = 0;
+	since_sync++;
+	canlog_stats.frames++;
+	__set_PRIMASK(primask);
+	return 1;
+}
+
+void canlog_lost(uint32_t count)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	pending_drops += count;
+	canlog_stats.dropped += count;
+	__set_PRIMASK(primask);
+}
+
+void canlog_poll(void)
+{
+	uint8_t rec[8];
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (can_timestamp() - last_stamp >= SystemCoreClock && uart_tx_free() >= sizeof(rec))
+	{
+		advance(can_timestamp());
+		uart_tx_write(rec, canlog_put_sync(rec, time_us));
+		since_sync = 0;
+	}
+	__set_PRIMASK(primask);
+}
+
+void canlog_init(uint32_t baud)
+{
+	uint8_t rec[8];
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	cycles_per_us = SystemCoreClock / 1000000;
+	uart_tx_init(baud);
+
+	leftover = 0;
+	time_us = 0;
+	pending_drops = 0;
+	canlog_stats.frames = 0;
+	canlog_stats.dropped = 0;
+
+	last_stamp = can_timestamp();
+	uart_tx_write(rec, canlog_put_sync(rec, 0));
+	since_sync = 0;
+}
@@ -0,0 +1,30 @@
+#ifndef MYCANLOG_H
+#define MYCANLOG_H
+
+#include <stdint.h>
+#include "mycan.h"
+#include "canlogfmt.h"
+#include "myuart.h"
+
+//streams canlogfmt records out of USART1 TX (A9) through myuart , the DMA empties the ring so logging costs one encode per frame
+//
+//budget: at 250 kbit/s a saturated bus carries at most ~31 KB/s of records (2 byte deltas , 13-16 byte records for
+//8 byte frames , 5-8 bytes for empty ones) , 500 kbaud (50 KB/s) keeps up with HSI at 8 MHz
+//at 1 Mbit/s it is ~125 KB/s , that needs 2 Mbaud and PCLK2 of 32 MHz or more
+//the ring (build with -DUART_TX_BUF_SIZE=2048) covers the gap while a sync record goes out and the main loop is busy elsewhere ,
+//its byte count and deepest fill are in uart_tx_stats
+
+typedef struct
+{
+	uint32_t frames;		//frame records written
+	uint32_t dropped;		//frames lost because the ring was full
+} canlog_stats_t;
+
+extern volatile canlog_stats_t canlog_stats;
+
+void canlog_init(uint32_t baud);		//uart_tx_init() , starts the log with a sync record
+int canlog_frame(const can_frame_t *frame);	//uses frame->stamp , returns 0 if it was dropped , safe from interrupts
+void canlog_lost(uint32_t count);		//frames lost before they reached the logger (rx overruns) , reported in the next drop record
+void canlog_poll(void);				//sync record after a second of silence so deltas stay short , call from the main loop
+
+#endif
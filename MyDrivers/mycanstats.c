@@ -0,0 +1,342 @@
+#include "stm32f1xx.h"
+#include "mycan.h"
+#include "mycanstats.h"
+#include <stdio.h>
+
+#if CAN_STATS_TX_RESERVE >= CAN_TX_QUEUE_SIZE
+#error "CAN_STATS_TX_RESERVE must leave room in the tx queue"
+#endif
+
+volatile can_stats_t can_stats;
+
+static uint32_t window_start = 0;	//can_timestamp() when the current bus load window opened
+static uint32_t window_bits = 0;	//bus_bits at that time
+
+//walks the frame bit by bit from SOF to the end of the CRC , tracking CRC-15 and the stuff bits the transmitter inserts
+typedef struct
+{
+	uint16_t crc;
+	uint8_t last;
+	uint8_t run;
+	uint32_t bits;
+} bitstream_t;
+
+static void put_bit(bitstream_t *s, uint8_t b, uint8_t crc)
+{
+	if (crc)
+	{
+		uint8_t next = b ^ ((s->crc >> 14) & 1);
+
+		s->crc = (s->crc << 1) & 0x7FFF;
+		if (next)
+			s->crc ^= 0x4599;
+	}
+	s->bits++;
+	if (b == s->last && ++s->run == 5)
+	{
+		s->bits++;			//stuff bit of opposite polarity , starts the next run
+		s->last = !b;
+		s->run = 1;
+	}
+	else if (b != s->last)
+	{
+		s->last = b;
+		s->run = 1;
+	}
+}
+
+static void put_field(bitstream_t *s, uint32_t v, uint8_t n)
+{
+	while (n--)
+		put_bit(s, (v >> n) & 1, 1);
+}
+
+uint32_t can_frame_bits(uint32_t id, uint8_t ide, uint8_t rtr, uint8_t dlc, const uint8_t *data)
+{
+	bitstream_t s = { 0, 2, 0, 0 };
+	uint8_t i;
+
+	put_field(&s, 0, 1);				//SOF
+	if (ide)
+	{
+		put_field(&s, id >> 18, 11);
+		put_field(&s, 3, 2);			//SRR , IDE
+		put_field(&s, id & 0x3FFFF, 18);
+		put_field(&s, rtr, 1);
+		put_field(&s, 0, 2);			//r1 , r0
+	}
+	else
+	{
+		put_field(&s, id, 11);
+		put_field(&s, rtr, 1);
+		put_field(&s, 0, 2);			//IDE , r0
+	}
+	put_field(&s, dlc, 4);
+	if (!rtr)
+		for (i = 0; i < dlc && i < 8; i++)
+			put_field(&s, data[i], 8);
+	for (i = 15; i > 0; i--)
+		put_bit(&s, (s.crc >> (i - 1)) & 1, 0);
+
+	return s.bits + 13;				//CRC delimiter , ACK slot + delimiter , EOF , intermission
+}
+
+static volatile can_id_count_t *id_slot(uint32_t id, uint8_t ide)
+{
+	for (int i = 0; i < CAN_STATS_IDS; i++)
+	{
+		volatile can_id_count_t *c = &can_stats.ids[i];
+
+		if (c->rx == 0 && c->tx == 0)		//first free slot , ids are never removed
+		{
+			c->id = id;
+			c->ide = ide;
+			return c;
+		}
+		if (c->id == id && c->ide == ide)
+			return c;
+	}
+	return 0;
+}
+
+void can_rx_hook(const can_frame_t *frame)
+{
+	volatile can_id_count_t *c = id_slot(frame->id, frame->ide);
+
+	if (c)
+		c->rx++;
+	else
+		can_stats.other_frames++;
+	can_stats.bus_bits += can_frame_bits(frame->id, frame->ide, frame->rtr, frame->dlc, frame->data);
+}
+
+void can_tx_hook(const can_frame_t *frame, uint8_t ok)
+{
+	volatile can_id_count_t *c;
+	uint32_t us = (can_timestamp() - frame->stamp) / (SystemCoreClock / 1000000);
+	uint8_t k = 0;
+
+	//a failed attempt counts nothing: lost arbitration overlaps the frame that won (counted when it is received) and
+	//an error is cut short by an error frame , neither is known here to better than the whole frame
+	if (!ok)
+		return;
+	can_stats.bus_bits += can_frame_bits(frame->id, frame->ide, frame->rtr, frame->dlc, frame->data);
+
+	c = id_slot(frame->id, frame->ide);
+	if (c)
+		c->tx++;
+	else
+		can_stats.other_frames++;
+
+	while (k < CAN_STATS_LAT_BUCKETS - 1 && us >= (64UL << k))
+		k++;
+	can_stats.latency[k]++;
+	if (us > can_stats.latency_max_us)
+		can_stats.latency_max_us = us;
+}
+
+void CAN1_SCE_IRQHandler(void)
+{
+	uint32_t esr = CAN1->ESR;
+	uint32_t rising = esr & ~can_stats.esr;
+	uint8_t lec = (esr & CAN_ESR_LEC) >> 4;
+
+	can_stats.esr = esr;
+	can_stats.tec = (esr & CAN_ESR_TEC) >> 16;
+	can_stats.rec = (esr & CAN_ESR_REC) >> 24;
+	if (can_stats.tec > can_stats.tec_peak)
+		can_stats.tec_peak = can_stats.tec;
+	if (can_stats.rec > can_stats.rec_peak)
+		can_stats.rec_peak = can_stats.rec;
+
+	if (rising & CAN_ESR_EWGF)
+		can_stats.warnings++;
+	if (rising & CAN_ESR_EPVF)
+		can_stats.passives++;
+	if (rising & CAN_ESR_BOFF)
+		can_stats.busoffs++;
+	if (lec && lec != 7)
+	{
+		can_stats.lec[lec]++;
+		CAN1->ESR &= ~CAN_ESR_LEC;		//only LEC is writable , clear it so the next error is counted again
+	}
+
+	CAN1->MSR = CAN_MSR_ERRI;			//write 1 to clear
+}
+
+void can_stats_init(uint32_t bitrate)
+{
+	uint8_t *p = (uint8_t *) &can_stats;
+
+	for (uint32_t i = 0; i < sizeof(can_stats); i++)
+		p[i] = 0;
+
+	if (bitrate == 0)
+	{
+		//bit rate = PCLK1 / (BRP * (1 + TS1 + TS2))
+		uint32_t ppre1 = (RCC->CFGR >> 8) & 0x7;
+		uint32_t pclk1 = SystemCoreClock >> ((ppre1 & 0x4) ? (ppre1 & 0x3) + 1 : 0);
+		uint32_t btr = CAN1->BTR;
+		uint32_t brp = (btr & 0x3FF) + 1;
+		uint32_t tq = 1 + ((btr >> 16) & 0xF) + 1 + ((btr >> 20) & 0x7) + 1;
+
+		bitrate = pclk1 / (brp * tq);
+	}
+	can_stats.bitrate = bitrate;
+	window_start = can_timestamp();
+	window_bits = 0;
+
+	CAN1->IER |= CAN_IER_EWGIE | CAN_IER_EPVIE | CAN_IER_BOFIE | CAN_IER_LECIE | CAN_IER_ERRIE;
+	NVIC_EnableIRQ(CAN1_SCE_IRQn);
+}
+
+void can_stats_update(void)
+{
+	uint32_t now = can_timestamp();
+	uint32_t bits = can_stats.bus_bits;
+	//bits the bus could have carried in the window , cycle counter wraps after 2^32 cycles so call often enough
+	uint64_t capacity = (uint64_t) (now - window_start) * can_stats.bitrate / SystemCoreClock;
+
+	if (capacity)
+	{
+		can_stats.load_permille = (uint64_t) (bits - window_bits) * 1000 / capacity;
+		if (can_stats.load_permille > can_stats.load_peak_permille)
+			can_stats.load_peak_permille = can_stats.load_permille;
+	}
+	window_start = now;
+	window_bits = bits;
+}
+
+int can_stats_format(char *buf, int size)
+{
+	int n = 0;
+	int i;
+
+#define APPEND(...) do { if (n < size) n += snprintf(buf + n, size - n, __VA_ARGS__); } while (0)
+	APPEND("bus load %u.%u%% (peak %u.%u%%) at %lu bit/s\n", can_stats.load_permille / 10,
+			can_stats.load_permille % 10, can_stats.load_peak_permille / 10, can_stats.load_peak_permille % 10,
+			(unsigned long) can_stats.bitrate);
+	APPEND("tec %u rec %u (peak %u/%u) warning %lu passive %lu busoff %lu\n", can_stats.tec, can_stats.rec,
+			can_stats.tec_peak, can_stats.rec_peak, (unsigned long) can_stats.warnings,
+			(unsigned long) can_stats.passives, (unsigned long) can_stats.busoffs);
+	APPEND("lec stuff %lu form %lu ack %lu recessive %lu dominant %lu crc %lu\n", (unsigned long) can_stats.lec[1],
+			(unsigned long) can_stats.lec[2], (unsigned long) can_stats.lec[3], (unsigned long) can_stats.lec[4],
+			(unsigned long) can_stats.lec[5], (unsigned long) can_stats.lec[6]);
+	APPEND("tx latency max %lu us :", (unsigned long) can_stats.latency_max_us);
+	for (i = 0; i < CAN_STATS_LAT_BUCKETS; i++)
+		APPEND(" <%lu:%lu", 64UL << i, (unsigned long) can_stats.latency[i]);
+	APPEND("\n");
+	for (i = 0; i < CAN_STATS_IDS && (can_stats.ids[i].rx || can_stats.ids[i].tx); i++)
+		APPEND("id 0x%lx%s rx %lu tx %lu\n", (unsigned long) can_stats.ids[i].id, can_stats.ids[i].ide ? "x" : "",
+				(unsigned long) can_stats.ids[i].rx, (unsigned long) can_stats.ids[i].tx);
+	APPEND("other %lu\n", (unsigned long) can_stats.other_frames);
+#undef APPEND
+
+	return n < size ? n : size - 1;
+}
+
+static uint16_t sat16(uint32_t v)
+{
+	return v > 0xFFFF ? 0xFFFF : v;
+}
+
+#define LAT_PAGES ((CAN_STATS_LAT_BUCKETS + 2) / 3)
+
+static int send_page = 0;		//next page of the set can_stats_send() is working through
+
+static int stats_pages(void)
+{
+	int i = 0;
+
+	while (i < CAN_STATS_IDS && (can_stats.ids[i].rx || can_stats.ids[i].tx))
+		i++;
+	return 2 + LAT_PAGES + i;
+}
+
+//page 0x00 : load , peak load , tec , rec , ESR flags
+//page 0x01 : max latency (us) , warning / passive / busoff counts (saturated to 255)
+//page 0x10+k : latency buckets 3k..3k+2 as 16 bit counts
+//page 0x20+i : id (bit 31 = extended) , rx + tx count
+//multi byte values are little endian
+static void stats_page(int p, can_frame_t *f)
+{
+	uint32_t v;
+	int i, k;
+
+	if (p == 0)
+	{
+		f->data[0] = 0x00;
+		f->data[1] = can_stats.load_permille;
+		f->data[2] = can_stats.load_permille >> 8;
+		f->data[3] = can_stats.load_peak_permille;
+		f->data[4] = can_stats.load_peak_permille >> 8;
+		f->data[5] = can_stats.tec;
+		f->data[6] = can_stats.rec;
+		f->data[7] = can_stats.esr & (CAN_ESR_EWGF | CAN_ESR_EPVF | CAN_ESR_BOFF);
+	}
+	else if (p == 1)
+	{
+		v = can_stats.latency_max_us;
+		f->data[0] = 0x01;
+		f->data[1] = v;
+		f->data[2] = v >> 8;
+		f->data[3] = v >> 16;
+		f->data[4] = v >> 24;
+		f->data[5] = can_stats.warnings > 255 ? 255 : can_stats.warnings;
+		f->data[6] = can_stats.passives > 255 ? 255 : can_stats.passives;
+		f->data[7] = can_stats.busoffs > 255 ? 255 : can_stats.busoffs;
+	}
+	else if (p < 2 + LAT_PAGES)
+	{
+		k = p - 2;
+		f->data[0] = 0x10 + k;
+		for (i = 0; i < 3; i++)
+		{
+			uint16_t c = (k * 3 + i < CAN_STATS_LAT_BUCKETS) ? sat16(can_stats.latency[k * 3 + i]) : 0;
+
+			f->data[1 + 2 * i] = c;
+			f->data[2 + 2 * i] = c >> 8;
+		}
+		f->data[7] = 0;
+	}
+	else
+	{
+		uint16_t c;
+
+		i = p - 2 - LAT_PAGES;
+		c = sat16(can_stats.ids[i].rx + can_stats.ids[i].tx);
+		v = can_stats.ids[i].id | ((uint32_t) can_stats.ids[i].ide << 31);
+		f->data[0] = 0x20 + i;
+		f->data[1] = v;
+		f->data[2] = v >> 8;
+		f->data[3] = v >> 16;
+		f->data[4] = v >> 24;
+		f->data[5] = c;
+		f->data[6] = c >> 8;
+		f->data[7] = 0;
+	}
+}
+
+//the whole set is more frames than the tx queue holds , so it goes out a few pages per call into the room the
+//application leaves , each page is filled when it is queued
+int can_stats_send(uint32_t diag_id)
+{
+	can_frame_t f = { 0 };
+	int pages = stats_pages();
+
+	f.id = diag_id;
+	f.ide = diag_id > 0x7FF;
+	f.dlc = 8;
+
+	while (send_page < pages && can_tx_pending() + CAN_STATS_TX_RESERVE < CAN_TX_QUEUE_SIZE)
+	{
+		stats_page(send_page, &f);
+		if (!can_send(&f))
+			break;
+		send_page++;
+	}
+	if (send_page < pages)
+		return 0;
+	send_page = 0;
+	return 1;
+}
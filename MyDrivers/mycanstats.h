@@ -0,0 +1,64 @@
+#ifndef MYCANSTATS_H
+#define MYCANSTATS_H
+
+#include <stdint.h>
+
+//identifiers that get their own rx/tx counters , the rest end up in other_frames
+#ifndef CAN_STATS_IDS
+#define CAN_STATS_IDS 16
+#endif
+
+//queueing latency histogram (can_send() -> TX complete) , bucket 0 is < 64us , bucket k is [32us << k , 64us << k)
+#ifndef CAN_STATS_LAT_BUCKETS
+#define CAN_STATS_LAT_BUCKETS 12
+#endif
+
+//tx queue slots can_stats_send() leaves free for the application's own frames
+#ifndef CAN_STATS_TX_RESERVE
+#define CAN_STATS_TX_RESERVE 4
+#endif
+
+//bus load counts the frames this node receives (can_rx_hook) and the ones it sent successfully (can_tx_hook) ,
+//frames its acceptance filters drop are never seen , nor are error frames and failed attempts
+//a node that reports the load of the whole bus needs a filter that accepts everything and a loop that keeps calling
+//can_recv() (the hook only runs for frames that fit in the rx ring) , otherwise the figure is its own share of the bus
+
+typedef struct
+{
+	uint32_t id;
+	uint8_t ide;
+	uint32_t rx;
+	uint32_t tx;
+} can_id_count_t;
+
+typedef struct
+{
+	can_id_count_t ids[CAN_STATS_IDS];
+	uint32_t other_frames;			//frames whose id did not fit in ids[]
+
+	uint32_t bitrate;			//bit/s , from BTR unless given to can_stats_init()
+	uint32_t bus_bits;			//stuffed bits of every frame seen (see above) since can_stats_init()
+	uint16_t load_permille;			//bus load over the last can_stats_update() window
+	uint16_t load_peak_permille;
+
+	uint32_t latency[CAN_STATS_LAT_BUCKETS];
+	uint32_t latency_max_us;
+
+	uint32_t esr;				//last CAN1->ESR snapshot
+	uint8_t tec, rec;			//transmit / receive error counters from that snapshot
+	uint8_t tec_peak, rec_peak;
+	uint32_t lec[8];			//last error code counts (stuff , form , ack , recessive , dominant , crc)
+	uint32_t warnings, passives, busoffs;	//entries into error warning / error passive / bus off
+} can_stats_t;
+
+extern volatile can_stats_t can_stats;
+
+void can_stats_init(uint32_t bitrate);	//0 -> work the bit rate out from BTR and the APB1 clock
+void can_stats_update(void);		//closes the bus load window , call every 100ms - 10s
+uint32_t can_frame_bits(uint32_t id, uint8_t ide, uint8_t rtr, uint8_t dlc, const uint8_t *data);	//on wire length incl. stuff bits and IFS
+int can_stats_format(char *buf, int size);	//human readable dump for a UART print() , returns chars written
+//same data as 8 byte frames on a diagnostic id , only as many pages as fit while CAN_STATS_TX_RESERVE slots stay free ,
+//returns 1 once the last page of the set is queued , 0 if the rest waits for the next call
+int can_stats_send(uint32_t diag_id);
+
+#endif
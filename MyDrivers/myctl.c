@@ -0,0 +1,57 @@
+#include "stm32f1xx.h"
+#include "myctl.h"
+
+volatile ctl_stats_t ctl_stats;
+
+__WEAK void ctl_tick_hook(void)
+{
+}
+
+void TIM1_UP_IRQHandler(void)
+{
+	uint32_t start = DWT->CYCCNT;
+	uint32_t cycles;
+
+	TIM1->SR = ~TIM_SR_UIF;
+	ctl_tick_hook();
+	ctl_stats.ticks++;
+	cycles = DWT->CYCCNT - start;
+	if (cycles > ctl_stats.max_cycles)
+		ctl_stats.max_cycles = cycles;
+	if (TIM1->SR & TIM_SR_UIF)
+		ctl_stats.late++;
+}
+
+int ctl_init(uint32_t hz)
+{
+	uint32_t ppre2 = (RCC->CFGR >> 11) & 0x7;
+	uint32_t pclk2 = SystemCoreClock >> ((ppre2 & 0x4) ? (ppre2 & 0x3) + 1 : 0);
+	uint32_t timer_clock = (ppre2 & 0x4) ? 2 * pclk2 : pclk2;
+	uint32_t div, psc;
+
+	if (!hz || timer_clock / hz < 2)
+		return CTL_ERR_RATE;
+	div = timer_clock / hz;
+	psc = (div - 1) / 65536;
+	if (psc > 0xFFFF)
+		return CTL_ERR_RATE;
+
+	//hook time is measured with the cycle counter
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	ctl_stats.ticks = 0;
+	ctl_stats.late = 0;
+	ctl_stats.max_cycles = 0;
+
+	RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
+	TIM1->CR1 = 0;
+	TIM1->PSC = psc;
+	TIM1->ARR = div / (psc + 1) - 1;
+	TIM1->EGR = TIM_EGR_UG;		//load PSC now , the update flag this sets is cleared below
+	TIM1->SR = 0;
+	TIM1->DIER = TIM_DIER_UIE;
+	NVIC_EnableIRQ(TIM1_UP_IRQn);
+	TIM1->CR1 = TIM_CR1_URS | TIM_CR1_CEN;
+	return 0;
+}
@@ -0,0 +1,40 @@
+#ifndef MYCTL_H
+#define MYCTL_H
+
+#include <stdint.h>
+
+//fixed rate control loop on the TIM1 update interrupt , ctl_tick_hook() runs every 1 / hz seconds
+//commands (from the main loop or other interrupts) only write targets , the hook reads them , ramps and writes the
+//outputs , so actuation happens on a fixed grid whatever the link does and a stalled main loop cannot hold it up
+//the delay from a new target to the output is at most one period plus the hook time (ctl_stats.max_cycles ,
+//DWT cycle counter) plus the longest interrupt of the same priority that is already running
+//
+//TIM1 is otherwise unused in the tree , its pins are left alone
+
+#define CTL_ERR_RATE -1			//the timer cannot divide down to that rate
+
+typedef struct
+{
+	uint32_t ticks;			//hook calls
+	uint32_t late;			//the next update came before the hook was done , a tick was lost
+	uint32_t max_cycles;		//longest hook so far
+} ctl_stats_t;
+
+extern volatile ctl_stats_t ctl_stats;
+
+int ctl_init(uint32_t hz);		//0 or CTL_ERR_RATE , the hook starts running at once
+
+//weak , empty by default
+void ctl_tick_hook(void);
+
+//now moved toward target by at most step
+static inline int32_t ctl_ramp(int32_t now, int32_t target, int32_t step)
+{
+	int32_t d = target - now;
+
+	d = d > step ? step : d;
+	d = d < -step ? -step : d;
+	return now + d;
+}
+
+#endif
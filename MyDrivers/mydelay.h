@@ -1,6 +1,8 @@
 #ifndef DELAY_H
 #define DELAY_H
 
-void delay_ms(int);
+#include <stdint.h>
+
+void delay_ms(uint16_t);
 
 #endif
@@ -0,0 +1,234 @@
+#include <string.h>
+#include "stm32f1xx.h"
+#include "myi2c.h"
+
+#define ERRORS (I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR)
+
+enum { S_IDLE, S_START, S_ADDR, S_DATA };
+
+typedef struct
+{
+	uint8_t addr;
+	uint8_t prefix;
+	uint16_t len;
+	const uint8_t *data;		//copy or the caller's buffer
+	uint8_t copy[I2C_TX_COPY];
+	i2c_done_fn done;
+	void *ctx;
+} i2c_job_t;
+
+//head is written by i2c_tx_write() under PRIMASK , tail only moves when the transaction at it is over
+static i2c_job_t queue[I2C_TX_QUEUE];
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+static volatile uint8_t state = S_IDLE;	//what the event interrupt waits for next
+
+volatile i2c_tx_stats_t i2c_tx_stats;
+
+//the queue was empty , start the transaction at tail
+static void job_start(void)
+{
+	while (I2C2->CR1 & I2C_CR1_STOP)
+		;				//no CR1 write while the last stop is pending (RM0008) , one bit time at most
+	state = S_START;
+	I2C2->CR1 |= I2C_CR1_START;
+}
+
+static void job_end(int err)
+{
+	i2c_job_t *j = &queue[tail & (I2C_TX_QUEUE - 1)];
+	i2c_done_fn done = j->done;
+	void *ctx = j->ctx;
+
+	I2C2->CR2 &= ~I2C_CR2_DMAEN;
+	DMA1_Channel4->CCR &= ~DMA_CCR_EN;
+	i2c_tx_stats.transactions++;
+	if (err)
+		i2c_tx_stats.errors++;
+	else
+		i2c_tx_stats.bytes += 1 + j->len;
+	tail++;
+	if (done)
+		done(err, ctx);			//state is not S_IDLE , whatever it queues waits for the check below
+}
+
+void I2C2_EV_IRQHandler(void)
+{
+	uint32_t sr1 = I2C2->SR1;
+	i2c_job_t *j = &queue[tail & (I2C_TX_QUEUE - 1)];
+
+	if (state == S_START && (sr1 & I2C_SR1_SB))
+	{
+		I2C2->DR = j->addr;
+		state = S_ADDR;
+	}
+	else if (state == S_ADDR && (sr1 & I2C_SR1_ADDR))
+	{
+		(void) I2C2->SR2;		//SR1 then SR2 clears ADDR
+		I2C2->DR = j->prefix;
+		if (j->len)
+		{
+			DMA1_Channel4->CMAR = (uint32_t) (uintptr_t) j->data;
+			DMA1_Channel4->CNDTR = j->len;
+			DMA1_Channel4->CCR |= DMA_CCR_EN;
+			I2C2->CR2 |= I2C_CR2_DMAEN;
+		}
+		state = S_DATA;
+	}
+	else if (state == S_DATA && (sr1 & I2C_SR1_BTF) && (!j->len || !DMA1_Channel4->CNDTR))
+	{
+		//last byte out and acknowledged , BTF stays up until the start or stop is on the bus
+		//a prefix only job never loads CNDTR , what is left there after a NACK must not hold it up
+		job_end(0);
+		if (head != tail)
+		{
+			state = S_START;
+			I2C2->CR1 |= I2C_CR1_START;
+		}
+		else
+		{
+			state = S_IDLE;
+			I2C2->CR1 |= I2C_CR1_STOP;
+		}
+	}
+}
+
+void I2C2_ER_IRQHandler(void)
+{
+	uint32_t sr1 = I2C2->SR1;
+
+	I2C2->SR1 = ~(sr1 & ERRORS);		//write 0 to clear , only the flags seen here
+	if (state == S_IDLE)
+		return;
+	if (!(sr1 & I2C_SR1_ARLO))
+		I2C2->CR1 |= I2C_CR1_STOP;	//still the master , let go of the bus
+	job_end(sr1 & I2C_SR1_AF ? I2C_ERR_NACK : I2C_ERR_BUS);
+	if (head != tail)
+		job_start();
+	else
+		state = S_IDLE;
+}
+
+int i2c_timing(uint32_t pclk1, uint32_t hz, i2c_timing_t *t)
+{
+	uint32_t mhz = pclk1 / 1000000;
+	uint32_t ccr, ccr25, hz3, hz25;
+
+	if (mhz < 2 || mhz > 36 || !hz || hz > 400000 || (hz > 100000 && mhz < 4))
+		return I2C_ERR_CLOCK;
+	t->cr2 = mhz;
+	if (hz <= 100000)
+	{
+		//SCL high and low CCR clocks each , 1000 ns rise time
+		ccr = (pclk1 + 2 * hz - 1) / (2 * hz);
+		ccr = ccr < 4 ? 4 : ccr;
+		if (ccr > I2C_CCR_CCR)
+			return I2C_ERR_CLOCK;
+		t->ccr = ccr;
+		t->trise = mhz + 1;
+		t->scl_hz = pclk1 / (2 * ccr);
+		return 0;
+	}
+
+	//fast mode , low:high 2:1 (3 CCR clocks a period) or 16:9 (25) , whichever gets closer without going over , 300 ns rise
+	ccr = (pclk1 + 3 * hz - 1) / (3 * hz);
+	ccr25 = (pclk1 + 25 * hz - 1) / (25 * hz);
+	ccr25 = ccr25 ? ccr25 : 1;
+	hz3 = pclk1 / (3 * ccr);
+	hz25 = pclk1 / (25 * ccr25);
+	if (hz25 > hz3)
+	{
+		t->ccr = I2C_CCR_FS | I2C_CCR_DUTY | ccr25;
+		t->scl_hz = hz25;
+	}
+	else
+	{
+		t->ccr = I2C_CCR_FS | ccr;
+		t->scl_hz = hz3;
+	}
+	t->trise = mhz * 300 / 1000 + 1;
+	return 0;
+}
+
+int i2c_tx_clock(uint32_t hz)
+{
+	uint32_t ppre1 = (RCC->CFGR >> 8) & 0x7;
+	uint32_t pclk1 = SystemCoreClock >> ((ppre1 & 0x4) ? (ppre1 & 0x3) + 1 : 0);
+	uint32_t pe = I2C2->CR1 & I2C_CR1_PE;
+	i2c_timing_t t;
+	int err;
+
+	err = i2c_timing(pclk1, hz, &t);
+	if (err)
+		return err;
+	RCC->APB1ENR |= RCC_APB1ENR_I2C2EN;
+	I2C2->CR1 &= ~I2C_CR1_PE;		//CCR and TRISE only take a write with the peripheral off
+	I2C2->CR2 = (I2C2->CR2 & ~I2C_CR2_FREQ) | t.cr2;
+	I2C2->CCR = t.ccr;
+	I2C2->TRISE = t.trise;
+	I2C2->CR1 |= pe;
+	return 0;
+}
+
+void i2c_tx_init(void)
+{
+	RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+
+	//memory -> I2C2->DR , byte wide , memory increment , BTF tells when it is over so no DMA interrupt
+	DMA1_Channel4->CCR = 0;
+	DMA1_Channel4->CPAR = (uint32_t) (uintptr_t) &I2C2->DR;
+	DMA1_Channel4->CCR = DMA_CCR_MINC | DMA_CCR_DIR;
+
+	head = 0;
+	tail = 0;
+	state = S_IDLE;
+	memset((void *) &i2c_tx_stats, 0, sizeof(i2c_tx_stats));
+
+	I2C2->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN;
+	NVIC_EnableIRQ(I2C2_EV_IRQn);
+	NVIC_EnableIRQ(I2C2_ER_IRQn);
+}
+
+int i2c_tx_write(uint8_t addr, uint8_t prefix, const void *data, uint16_t len, i2c_done_fn done, void *ctx)
+{
+	uint32_t primask = __get_PRIMASK();
+	i2c_job_t *j;
+
+	__disable_irq();
+	if (head - tail == I2C_TX_QUEUE)
+	{
+		i2c_tx_stats.refused++;
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	j = &queue[head & (I2C_TX_QUEUE - 1)];
+	j->addr = addr;
+	j->prefix = prefix;
+	j->len = len;
+	j->data = data;
+	if (len && len <= I2C_TX_COPY)
+	{
+		memcpy(j->copy, data, len);
+		j->data = j->copy;
+	}
+	j->done = done;
+	j->ctx = ctx;
+	head++;
+	if (head - tail > i2c_tx_stats.max_fill)
+		i2c_tx_stats.max_fill = head - tail;
+	if (state == S_IDLE)
+		job_start();
+	__set_PRIMASK(primask);
+	return 1;
+}
+
+uint32_t i2c_tx_pending(void)
+{
+	return head - tail;
+}
+
+void i2c_tx_flush(void)
+{
+	while (head != tail || (I2C2->CR1 & I2C_CR1_STOP))
+		;
+}
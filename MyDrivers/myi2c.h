@@ -0,0 +1,65 @@
+#ifndef MYI2C_H
+#define MYI2C_H
+
+#include <stdint.h>
+
+//I2C2 master transmitter run from interrupts , writers queue a transaction and return at once
+//
+//a transaction is start , address , one prefix byte (a register , an SSD1306 control byte) and len bytes that DMA1
+//channel 4 (I2C2_TX) moves into DR , the event interrupt does start , address and prefix and waits for BTF after the
+//last byte , transactions back to back are joined by a repeated start and the stop goes out when the queue runs dry
+//a NACK or a bus error ends the transaction with an error , the queue goes on with the next one
+//
+//up to I2C_TX_COPY bytes are copied into the queue , the caller may reuse them at once , longer data is read by the DMA
+//while it is on the bus and must stay put until done() is called (i2c_tx_flush() waits for that)
+//done() runs in the interrupt , it may queue more
+//
+//i2c_tx_clock() sets the timing registers (CR2 FREQ , CCR , TRISE) for a SCL rate from SystemCoreClock and PPRE1 ,
+//standard mode up to 100 kHz , fast mode above with the duty cycle that comes closest , PE is the program's ,
+//i2c_tx_init() after them
+//DMA1 channel 4 is also USART1 TX (myuart) , a program uses one of them
+
+#ifndef I2C_TX_QUEUE
+#define I2C_TX_QUEUE 32			//transactions , must be a power of 2 , an SSD1306 update takes up to 16
+#endif
+
+#if (I2C_TX_QUEUE & (I2C_TX_QUEUE - 1)) != 0
+#error "I2C_TX_QUEUE must be a power of 2"
+#endif
+
+#define I2C_TX_COPY 8
+
+#define I2C_ERR_NACK -1			//address or data byte not acknowledged
+#define I2C_ERR_BUS -2			//misplaced start / stop or arbitration lost
+#define I2C_ERR_CLOCK -3		//PCLK1 not 2 .. 36 MHz (4 .. 36 for fast mode) , rate 0 , above 400 kHz or too slow for CCR
+
+typedef void (*i2c_done_fn)(int err, void *ctx);	//err 0 or I2C_ERR_x
+
+typedef struct
+{
+	uint16_t cr2;			//FREQ
+	uint16_t ccr;			//with FS and DUTY
+	uint16_t trise;
+	uint32_t scl_hz;		//what it comes to , never above the rate asked for (rise times not counted)
+} i2c_timing_t;
+
+typedef struct
+{
+	uint32_t transactions;		//done , with or without an error
+	uint32_t bytes;			//prefix and data of the good ones
+	uint32_t errors;
+	uint32_t refused;		//writes that found the queue full
+	uint32_t max_fill;		//deepest the queue has been
+} i2c_tx_stats_t;
+
+extern volatile i2c_tx_stats_t i2c_tx_stats;
+
+int i2c_timing(uint32_t pclk1, uint32_t hz, i2c_timing_t *t);	//0 if ok , I2C_ERR_CLOCK otherwise
+int i2c_tx_clock(uint32_t hz);		//I2C2 , the bus must be idle , turns PE off while it writes CCR and TRISE
+void i2c_tx_init(void);
+//addr: the address byte as it goes on the bus (7 bit address << 1) , 1 if queued , 0 when the queue is full
+int i2c_tx_write(uint8_t addr, uint8_t prefix, const void *data, uint16_t len, i2c_done_fn done, void *ctx);
+uint32_t i2c_tx_pending(void);		//transactions queued or on the bus
+void i2c_tx_flush(void);		//waits until the queue is empty and the stop is out , not from interrupts
+
+#endif
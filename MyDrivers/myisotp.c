@@ -0,0 +1,312 @@
+#include "stm32f1xx.h"
+#include "myisotp.h"
+
+enum
+{
+	TX_IDLE, TX_SF, TX_FF, TX_WAIT_FC, TX_CF
+};
+
+enum
+{
+	RX_IDLE, RX_RECEIVING, RX_DONE
+};
+
+#define FC_NONE 0xFF
+#define FC_CTS 0
+#define FC_WAIT 1
+#define FC_OVFLW 2
+
+static uint32_t ms_to_ticks(uint32_t ms)
+{
+	return ms * (SystemCoreClock / 1000);
+}
+
+static uint32_t st_min_ticks(uint8_t st)
+{
+	if (st <= 0x7F)
+		return ms_to_ticks(st);
+	if (st >= 0xF1 && st <= 0xF9)
+		return (st - 0xF0) * (SystemCoreClock / 10000);	//100us steps
+	return ms_to_ticks(0x7F);				//reserved values mean the longest gap
+}
+
+static int expired(uint32_t deadline)
+{
+	return (int32_t) (can_timestamp() - deadline) >= 0;
+}
+
+//a full tx queue is backpressure , not a lost frame , so wait for room instead of letting can_send() count a drop
+static int send_frame(isotp_link_t *l, const uint8_t *data, uint8_t dlc)
+{
+	can_frame_t f = { 0 };
+
+	if (can_tx_pending() >= CAN_TX_QUEUE_SIZE)
+		return 0;
+	f.id = l->tx_id;
+	f.ide = l->ide;
+	f.dlc = dlc;
+	for (uint8_t i = 0; i < dlc; i++)
+		f.data[i] = data[i];
+	return can_send(&f);
+}
+
+static int send_fc(isotp_link_t *l, uint8_t status)
+{
+	uint8_t d[3] = { 0x30 | status, l->block_size, l->st_min };
+
+	if (send_frame(l, d, 3))
+	{
+		l->fc_pending = FC_NONE;
+		return 1;
+	}
+	l->fc_pending = status;		//tx queue full , retried from isotp_poll()
+	return 0;
+}
+
+void isotp_init(isotp_link_t *l, uint32_t tx_id, uint32_t rx_id, uint8_t ide, uint8_t block_size, uint8_t st_min)
+{
+	l->tx_id = tx_id;
+	l->rx_id = rx_id;
+	l->ide = ide;
+	l->block_size = block_size;
+	l->st_min = st_min;
+	l->tx_buf = 0;
+	l->tx_state = TX_IDLE;
+	l->tx_result = ISOTP_OK;
+	l->rx_buf = 0;
+	l->rx_size = 0;
+	l->rx_state = RX_IDLE;
+	l->rx_result = ISOTP_OK;
+	l->fc_pending = FC_NONE;
+}
+
+void isotp_set_rx_buffer(isotp_link_t *l, uint8_t *buf, uint16_t size)
+{
+	l->rx_buf = buf;
+	l->rx_size = size;
+	l->rx_state = RX_IDLE;
+}
+
+int isotp_send(isotp_link_t *l, const uint8_t *buf, uint16_t len)
+{
+	if (l->tx_state != TX_IDLE)
+		return ISOTP_BUSY;
+	if (len == 0 || len > ISOTP_MAX_LEN)
+		return ISOTP_ERR_LEN;
+
+	l->tx_buf = buf;
+	l->tx_len = len;
+	l->tx_pos = 0;
+	l->tx_result = ISOTP_BUSY;
+	l->tx_state = len <= 7 ? TX_SF : TX_FF;
+	isotp_poll(l);
+	return ISOTP_OK;
+}
+
+int isotp_tx_busy(isotp_link_t *l)
+{
+	return l->tx_state != TX_IDLE;
+}
+
+static void tx_poll(isotp_link_t *l)
+{
+	uint8_t d[8];
+	uint8_t i, n;
+
+	switch (l->tx_state)
+	{
+	case TX_SF:
+		d[0] = l->tx_len;
+		for (i = 0; i < l->tx_len; i++)
+			d[1 + i] = l->tx_buf[i];
+		if (send_frame(l, d, 1 + l->tx_len))
+		{
+			l->tx_state = TX_IDLE;
+			l->tx_result = ISOTP_OK;
+		}
+		break;
+
+	case TX_FF:
+		d[0] = 0x10 | (l->tx_len >> 8);
+		d[1] = l->tx_len;
+		for (i = 0; i < 6; i++)
+			d[2 + i] = l->tx_buf[i];
+		if (send_frame(l, d, 8))
+		{
+			l->tx_pos = 6;
+			l->tx_sn = 1;
+			l->tx_state = TX_WAIT_FC;
+			l->tx_deadline = can_timestamp() + ms_to_ticks(ISOTP_TIMEOUT_MS);
+		}
+		break;
+
+	case TX_WAIT_FC:
+		if (expired(l->tx_deadline))
+		{
+			l->tx_state = TX_IDLE;
+			l->tx_result = ISOTP_ERR_TIMEOUT;
+		}
+		break;
+
+	case TX_CF:
+		//with STmin 0 keep the tx queue topped up (send_frame() stops at a full queue) , otherwise one frame per gap
+		while (l->tx_state == TX_CF && (l->tx_st == 0 || can_timestamp() - l->tx_last >= l->tx_st))
+		{
+			n = l->tx_len - l->tx_pos < 7 ? l->tx_len - l->tx_pos : 7;
+			d[0] = 0x20 | l->tx_sn;
+			for (i = 0; i < n; i++)
+				d[1 + i] = l->tx_buf[l->tx_pos + i];
+			if (!send_frame(l, d, 1 + n))
+				break;
+			l->tx_last = can_timestamp();
+			l->tx_pos += n;
+			l->tx_sn = (l->tx_sn + 1) & 0x0F;
+			if (l->tx_pos == l->tx_len)
+			{
+				l->tx_state = TX_IDLE;
+				l->tx_result = ISOTP_OK;
+			}
+			else if (l->tx_bs && --l->tx_bs_left == 0)
+			{
+				l->tx_state = TX_WAIT_FC;
+				l->tx_deadline = can_timestamp() + ms_to_ticks(ISOTP_TIMEOUT_MS);
+			}
+		}
+		break;
+	}
+}
+
+void isotp_poll(isotp_link_t *l)
+{
+	tx_poll(l);
+
+	if (l->fc_pending != FC_NONE)
+		send_fc(l, l->fc_pending);
+	if (l->rx_state == RX_RECEIVING && expired(l->rx_deadline))
+	{
+		l->rx_state = RX_IDLE;
+		l->rx_result = ISOTP_ERR_TIMEOUT;
+	}
+}
+
+static void rx_flow_control(isotp_link_t *l, const can_frame_t *f)
+{
+	if (l->tx_state != TX_WAIT_FC || f->dlc < 3)
+		return;
+
+	switch (f->data[0] & 0x0F)
+	{
+	case FC_CTS:
+		l->tx_bs = f->data[1];
+		l->tx_bs_left = f->data[1];
+		l->tx_st = st_min_ticks(f->data[2]);
+		l->tx_last = can_timestamp() - l->tx_st;	//first consecutive frame may go right away
+		l->tx_state = TX_CF;
+		tx_poll(l);
+		break;
+	case FC_WAIT:
+		l->tx_deadline = can_timestamp() + ms_to_ticks(ISOTP_TIMEOUT_MS);
+		break;
+	default:
+		l->tx_state = TX_IDLE;
+		l->tx_result = ISOTP_ERR_OVERFLOW;
+		break;
+	}
+}
+
+int isotp_on_frame(isotp_link_t *l, const can_frame_t *f)
+{
+	uint8_t pci, i, n;
+	uint16_t len;
+
+	if (f->id != l->rx_id || f->ide != l->ide || f->rtr || f->dlc == 0)
+		return 0;
+
+	pci = f->data[0] >> 4;
+	if (pci == 3)
+	{
+		rx_flow_control(l, f);
+		return 1;
+	}
+	if (!l->rx_buf || l->rx_state == RX_DONE)	//no buffer , or the last message has not been collected yet
+		return 1;
+
+	switch (pci)
+	{
+	case 0:
+		len = f->data[0] & 0x0F;
+		if (len == 0 || len > f->dlc - 1)
+			break;
+		if (len > l->rx_size)
+		{
+			l->rx_result = ISOTP_ERR_OVERFLOW;
+			break;
+		}
+		for (i = 0; i < len; i++)
+			l->rx_buf[i] = f->data[1 + i];
+		l->rx_len = len;
+		l->rx_result = ISOTP_OK;
+		l->rx_state = RX_DONE;
+		break;
+
+	case 1:
+		len = ((f->data[0] & 0x0F) << 8) | f->data[1];
+		if (f->dlc < 8 || len < 8)
+			break;
+		if (len > l->rx_size)
+		{
+			l->rx_state = RX_IDLE;
+			l->rx_result = ISOTP_ERR_OVERFLOW;
+			send_fc(l, FC_OVFLW);
+			break;
+		}
+		for (i = 0; i < 6; i++)
+			l->rx_buf[i] = f->data[2 + i];
+		l->rx_len = len;
+		l->rx_pos = 6;
+		l->rx_sn = 1;
+		l->rx_bs_left = l->block_size;
+		l->rx_state = RX_RECEIVING;
+		l->rx_deadline = can_timestamp() + ms_to_ticks(ISOTP_TIMEOUT_MS);
+		send_fc(l, FC_CTS);
+		break;
+
+	case 2:
+		if (l->rx_state != RX_RECEIVING)
+			break;
+		if ((f->data[0] & 0x0F) != l->rx_sn)
+		{
+			l->rx_state = RX_IDLE;
+			l->rx_result = ISOTP_ERR_SEQ;
+			break;
+		}
+		n = l->rx_len - l->rx_pos < 7 ? l->rx_len - l->rx_pos : 7;
+		if (f->dlc < 1 + n)
+			break;
+		for (i = 0; i < n; i++)
+			l->rx_buf[l->rx_pos + i] = f->data[1 + i];
+		l->rx_pos += n;
+		l->rx_sn = (l->rx_sn + 1) & 0x0F;
+		l->rx_deadline = can_timestamp() + ms_to_ticks(ISOTP_TIMEOUT_MS);
+		if (l->rx_pos == l->rx_len)
+		{
+			l->rx_result = ISOTP_OK;
+			l->rx_state = RX_DONE;
+		}
+		else if (l->block_size && --l->rx_bs_left == 0)
+		{
+			l->rx_bs_left = l->block_size;
+			send_fc(l, FC_CTS);
+		}
+		break;
+	}
+	return 1;
+}
+
+int isotp_recv(isotp_link_t *l)
+{
+	if (l->rx_state != RX_DONE)
+		return 0;
+	l->rx_state = RX_IDLE;			//next message may start arriving with the next isotp_on_frame()
+	return l->rx_len;
+}
@@ -0,0 +1,55 @@
+#ifndef MYISOTP_H
+#define MYISOTP_H
+
+#include <stdint.h>
+#include "mycan.h"
+
+//ISO 15765-2 style segmentation on top of can_send() / can_recv()
+//single frame 0x0L , first frame 0x1L LL , consecutive frame 0x2N , flow control 0x3S BS STmin
+
+#define ISOTP_MAX_LEN 4095
+
+#ifndef ISOTP_TIMEOUT_MS
+#define ISOTP_TIMEOUT_MS 1000		//N_Bs (waiting for flow control) and N_Cr (waiting for the next consecutive frame)
+#endif
+
+#define ISOTP_OK 0
+#define ISOTP_BUSY -1			//a transfer is already running
+#define ISOTP_ERR_LEN -2
+#define ISOTP_ERR_TIMEOUT -3
+#define ISOTP_ERR_OVERFLOW -4		//receiver buffer too small (either side)
+#define ISOTP_ERR_SEQ -5		//consecutive frame out of order
+
+typedef struct
+{
+	uint32_t tx_id;			//id our frames go out on
+	uint32_t rx_id;			//id the peer sends on
+	uint8_t ide;
+	uint8_t block_size;		//BS we ask the sender for , 0 -> everything in one block
+	uint8_t st_min;			//STmin we ask the sender for (0-127 ms , 0xF1-0xF9 = 100-900 us)
+
+	//transmit side , tx_buf is read in place so it must stay valid until tx_result is set
+	const uint8_t *tx_buf;
+	uint16_t tx_len, tx_pos;
+	uint8_t tx_state, tx_sn, tx_bs, tx_bs_left;
+	uint32_t tx_st;			//peer STmin in can_timestamp() units
+	uint32_t tx_last, tx_deadline;
+	volatile int8_t tx_result;
+
+	//receive side , payload is written straight into rx_buf
+	uint8_t *rx_buf;
+	uint16_t rx_size, rx_len, rx_pos;
+	uint8_t rx_state, rx_sn, rx_bs_left, fc_pending;
+	uint32_t rx_deadline;
+	int8_t rx_result;
+} isotp_link_t;
+
+void isotp_init(isotp_link_t *l, uint32_t tx_id, uint32_t rx_id, uint8_t ide, uint8_t block_size, uint8_t st_min);
+void isotp_set_rx_buffer(isotp_link_t *l, uint8_t *buf, uint16_t size);
+int isotp_send(isotp_link_t *l, const uint8_t *buf, uint16_t len);	//starts a transfer , ISOTP_OK or an error
+int isotp_on_frame(isotp_link_t *l, const can_frame_t *f);		//feed every received frame , returns 1 if it belonged to this link
+void isotp_poll(isotp_link_t *l);					//sends pending frames and checks timeouts , call from the main loop
+int isotp_recv(isotp_link_t *l);	//length of a completed message in rx_buf (0 if none) , rx_buf stays untouched until the next isotp_on_frame()
+int isotp_tx_busy(isotp_link_t *l);
+
+#endif
@@ -0,0 +1,65 @@
+#include "stm32f1xx.h"
+#include "mylog.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+static uint32_t pending_drops;			//lines dropped since the last notice
+
+volatile log_stats_t log_stats;
+
+void log_init(uint32_t baud)
+{
+	uart_tx_init(baud);
+	pending_drops = 0;
+	log_stats.lines = 0;
+	log_stats.dropped = 0;
+	log_stats.truncated = 0;
+}
+
+int log_printf(const char *fmt, ...)
+{
+	char line[LOG_LINE_MAX];
+	char notice[32];
+	va_list args;
+	int len, n = 0, truncated = 0;
+	uint32_t primask;
+
+	va_start(args, fmt);
+	len = vsnprintf(line, sizeof(line), fmt, args);
+	va_end(args);
+	if (len < 0)
+		return 0;
+	if (len >= (int) sizeof(line))
+	{
+		len = sizeof(line) - 1;
+		truncated = 1;
+	}
+
+	//the notice and the line go in under one PRIMASK so another context cannot slip a line in between
+	//(the counters are bumped in there too , an ISR may log while this line is being formatted)
+	primask = __get_PRIMASK();
+	__disable_irq();
+	log_stats.truncated += truncated;
+	if (pending_drops)
+	{
+		n = snprintf(notice, sizeof(notice), "[%lu lines dropped]\n", (unsigned long) pending_drops);
+		if (uart_tx_free() < (uint32_t) (n + len))
+			n = -1;
+		else
+		{
+			uart_tx_write(notice, n);
+			pending_drops = 0;
+		}
+	}
+	if (n < 0 || !uart_tx_write(line, len))
+	{
+		pending_drops++;
+		log_stats.dropped++;
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	log_stats.lines++;
+	__set_PRIMASK(primask);
+	return len;
+}
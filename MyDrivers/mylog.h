@@ -0,0 +1,30 @@
+#ifndef MYLOG_H
+#define MYLOG_H
+
+#include <stdint.h>
+#include "myuart.h"
+
+//printf style text log over USART1 TX , lines are formatted into a stack buffer with vsnprintf and queued whole in the
+//myuart ring , the caller never waits for the UART (a 40 character line at 9600 baud would otherwise block for 40 ms)
+//
+//a line that does not fit in the ring is dropped and counted , the next line that gets through is preceded by
+//"[n lines dropped]" so gaps are visible on the terminal , lines longer than LOG_LINE_MAX - 1 are cut short
+//safe from interrupts and tasks , no mutex needed , but only with integer conversions there (newlib's %f allocates)
+
+#ifndef LOG_LINE_MAX
+#define LOG_LINE_MAX 96			//stack bytes per call , longest line + 1
+#endif
+
+typedef struct
+{
+	uint32_t lines;			//lines queued
+	uint32_t dropped;		//lines lost because the ring was full
+	uint32_t truncated;		//lines cut to LOG_LINE_MAX - 1
+} log_stats_t;
+
+extern volatile log_stats_t log_stats;
+
+void log_init(uint32_t baud);
+int log_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));	//characters queued , 0 if the line was dropped
+
+#endif
@@ -0,0 +1,92 @@
+#include "stm32f1xx.h"
+#include "mypwm.h"
+
+//what the DMA copies out on every update , circular , so an unchanged stage is simply written again
+static uint16_t stage_tim2[4];
+static uint16_t stage_tim4[4];
+static uint32_t stage_gpioa;
+static uint32_t stage_gpiob;
+
+#define DCR_CCR1_BURST4 ((3 << 8) | 13)	//DBL 4 transfers , DBA CCR1 (offset 0x34 / 4)
+
+static void dma_setup(DMA_Channel_TypeDef *ch, volatile uint32_t *reg, void *mem, uint32_t n, uint32_t size)
+{
+	ch->CCR = 0;
+	ch->CPAR = (uint32_t) (uintptr_t) reg;
+	ch->CMAR = (uint32_t) (uintptr_t) mem;
+	ch->CNDTR = n;
+	ch->CCR = size | DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_DIR | DMA_CCR_PL_1 | DMA_CCR_EN;
+}
+
+void pwm_init(void)
+{
+	TIM_TypeDef *tims[3] = { TIM2, TIM3, TIM4 };
+
+	RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+	for (int i = 0; i < 3; i++)
+	{
+		tims[i]->CR1 &= ~TIM_CR1_CEN;
+		tims[i]->CNT = 0;
+	}
+	stage_gpioa = 0;
+	stage_gpiob = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		stage_tim2[i] = (&TIM2->CCR1)[i];	//CCR1..4 are consecutive
+		stage_tim4[i] = (&TIM4->CCR1)[i];
+	}
+
+	//TIM2 and TIM4 duties come from the DMA right after the update , live at once
+	TIM2->CCMR1 &= ~(TIM_CCMR1_OC1PE | TIM_CCMR1_OC2PE);
+	TIM2->CCMR2 &= ~(TIM_CCMR2_OC3PE | TIM_CCMR2_OC4PE);
+	TIM4->CCMR1 &= ~(TIM_CCMR1_OC1PE | TIM_CCMR1_OC2PE);
+	TIM4->CCMR2 &= ~(TIM_CCMR2_OC3PE | TIM_CCMR2_OC4PE);
+	TIM2->DCR = DCR_CCR1_BURST4;
+	TIM4->DCR = DCR_CCR1_BURST4;
+	dma_setup(DMA1_Channel2, &TIM2->DMAR, stage_tim2, 4, DMA_CCR_MSIZE_0 | DMA_CCR_PSIZE_0);
+	dma_setup(DMA1_Channel7, &TIM4->DMAR, stage_tim4, 4, DMA_CCR_MSIZE_0 | DMA_CCR_PSIZE_0);
+	TIM2->DIER |= TIM_DIER_UDE;
+	TIM4->DIER |= TIM_DIER_UDE;
+
+	//TIM3 duties go through its preload registers , compare 1 at count 0 marks the start of the period for port B
+	TIM3->CCMR1 |= TIM_CCMR1_OC2PE;
+	TIM3->CCMR2 |= TIM_CCMR2_OC3PE | TIM_CCMR2_OC4PE;
+	TIM3->CCR1 = 0;
+	dma_setup(DMA1_Channel3, &GPIOA->BSRR, &stage_gpioa, 1, DMA_CCR_MSIZE_1 | DMA_CCR_PSIZE_1);
+	dma_setup(DMA1_Channel6, &GPIOB->BSRR, &stage_gpiob, 1, DMA_CCR_MSIZE_1 | DMA_CCR_PSIZE_1);
+	TIM3->DIER |= TIM_DIER_UDE | TIM_DIER_CC1DE;
+
+	//TIM3 and TIM4 wait for TIM2 (ITR1) , one write to TIM2->CR1 starts all three
+	TIM3->SMCR = TIM_SMCR_TS_0 | TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1;
+	TIM4->SMCR = TIM_SMCR_TS_0 | TIM_SMCR_SMS_2 | TIM_SMCR_SMS_1;
+	TIM2->CR2 = (TIM2->CR2 & ~TIM_CR2_MMS) | TIM_CR2_MMS_0;
+	TIM2->SMCR = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		tims[i]->CR1 |= TIM_CR1_URS;	//only the counter overflow requests DMA , not the UG below
+		tims[i]->EGR = TIM_EGR_UG;
+	}
+	TIM2->CR1 |= TIM_CR1_CEN;
+}
+
+void pwm_commit(const pwm_frame_t *frame)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t arr = TIM2->ARR;
+
+	__disable_irq();
+	//stay clear of the update and of the DMA copies right after it
+	while (TIM2->CNT < PWM_GUARD / 4 || TIM2->CNT + PWM_GUARD > arr)
+		;
+	for (int i = 0; i < 4; i++)
+	{
+		stage_tim2[i] = frame->tim2[i];
+		stage_tim4[i] = frame->tim4[i];
+	}
+	stage_gpioa = frame->gpioa_bsrr;
+	stage_gpiob = frame->gpiob_bsrr;
+	TIM3->CCR2 = frame->tim3[1];
+	TIM3->CCR3 = frame->tim3[2];
+	TIM3->CCR4 = frame->tim3[3];
+	__set_PRIMASK(primask);
+}
@@ -0,0 +1,40 @@
+#ifndef MYPWM_H
+#define MYPWM_H
+
+#include <stdint.h>
+
+//glitch free output stage for TIM2 , TIM3 and TIM4 PWM plus direction pins on ports A and B
+//
+//the three timers run off one start: TIM2 is the master (TRGO on enable) , TIM3 and TIM4 are slaves in trigger mode
+//on ITR1 , so with the same PSC and ARR every period starts on the same timer clock (the slaves lag by a fixed 1-2 clocks)
+//
+//pwm_commit() only copies a frame into the stage , nothing changes on the pins until the next update event , then:
+//  TIM2 CCR1..4 , TIM4 CCR1..4   DMA burst through TIMx_DMAR on the update request (DMA1 channels 2 and 7) ,
+//                                preload off so the new duty is live within the first microsecond of the period
+//  TIM3 CCR2..4                  written by pwm_commit() into the preload registers , the update moves them in
+//  GPIOA->BSRR , GPIOB->BSRR     one word each by DMA on TIM3 update and TIM3 compare 1 (DMA1 channels 3 and 6)
+//so duty and direction of every output change together , never a new direction with the old duty
+//
+//TIM3 CCR1 is held at 0 (its compare event at the start of the period triggers the port B write) , TIM3 channel 1
+//cannot be used as an output , DMA1 channels 1 , 4 and 5 are left for the ADC and USART1
+//
+//a commit waits while the counter is within PWM_GUARD ticks of an update so no frame is ever split across two periods ,
+//ARR must be well above 2 * PWM_GUARD and pwm_init() must have run (a stopped counter would hold pwm_commit() forever)
+
+#ifndef PWM_GUARD
+#define PWM_GUARD 64			//timer ticks , must cover the copy at the slowest core / timer clock ratio
+#endif
+
+typedef struct
+{
+	uint16_t tim2[4];		//CCR1..4
+	uint16_t tim3[4];		//CCR1..4 , [0] is ignored
+	uint16_t tim4[4];		//CCR1..4
+	uint32_t gpioa_bsrr;		//set bits low , reset bits high , 0 leaves port A alone
+	uint32_t gpiob_bsrr;
+} pwm_frame_t;
+
+void pwm_init(void);				//after the timers have their PSC , ARR and output modes , starts all three together
+void pwm_commit(const pwm_frame_t *frame);	//safe from interrupts , the last commit before an update wins
+
+#endif
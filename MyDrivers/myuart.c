@@ -0,0 +1,236 @@
+#include "stm32f1xx.h"
+#include "myuart.h"
+
+//byte ring , head is written by uart_tx_write() under PRIMASK and tail only moves when a DMA transfer completes
+static uint8_t ring[UART_TX_BUF_SIZE];
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+static volatile uint32_t dma_len = 0;		//bytes of the transfer in flight
+
+volatile uart_tx_stats_t uart_tx_stats;
+
+//receive ring , rx_head counts every byte the DMA wrote (as of the last look at CNDTR) , rx_tail every byte handed on
+static uint8_t rx_ring[UART_RX_BUF_SIZE];
+static volatile uint32_t rx_head = 0;
+static volatile uint32_t rx_tail = 0;
+static uint8_t rx_mode;
+static uint8_t rx_open;				//a piece went out with more set , the burst still needs its closing call
+
+volatile uart_rx_stats_t uart_rx_stats;
+
+__WEAK void uart_rx_frame_hook(const uart_rx_frame_t *frame)
+{
+	(void) frame;
+}
+
+//start the next transfer if the DMA is idle , the ring is sent in up to two pieces when it wraps
+static void dma_kick(void)
+{
+	uint32_t t = tail & (UART_TX_BUF_SIZE - 1);
+	uint32_t n = head - tail;
+
+	if (dma_len || !n)
+		return;
+	if (t + n > UART_TX_BUF_SIZE)
+		n = UART_TX_BUF_SIZE - t;
+	dma_len = n;
+	DMA1_Channel4->CCR &= ~DMA_CCR_EN;
+	DMA1_Channel4->CMAR = (uint32_t) (uintptr_t) &ring[t];
+	DMA1_Channel4->CNDTR = n;
+	DMA1_Channel4->CCR |= DMA_CCR_EN;
+}
+
+void DMA1_Channel4_IRQHandler(void)
+{
+	if (DMA1->ISR & DMA_ISR_TCIF4)
+	{
+		DMA1->IFCR = DMA_IFCR_CTCIF4;
+		uart_tx_stats.bytes += dma_len;
+		tail += dma_len;
+		dma_len = 0;
+		dma_kick();
+	}
+}
+
+int uart_tx_write(const void *data, uint32_t len)
+{
+	const uint8_t *p = data;
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (UART_TX_BUF_SIZE - (head - tail) < len)
+	{
+		uart_tx_stats.refused++;
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	for (uint32_t i = 0; i < len; i++)
+		ring[(head + i) & (UART_TX_BUF_SIZE - 1)] = p[i];
+	head += len;
+	if (head - tail > uart_tx_stats.max_fill)
+		uart_tx_stats.max_fill = head - tail;
+	dma_kick();
+	__set_PRIMASK(primask);
+	return 1;
+}
+
+uint32_t uart_tx_free(void)
+{
+	return UART_TX_BUF_SIZE - (head - tail);
+}
+
+uint32_t uart_tx_pending(void)
+{
+	return head - tail;
+}
+
+static void usart_setup(uint32_t baud)
+{
+	uint32_t ppre2 = (RCC->CFGR >> 11) & 0x7;
+	uint32_t pclk2 = SystemCoreClock >> ((ppre2 & 0x4) ? (ppre2 & 0x3) + 1 : 0);
+
+	RCC->APB2ENR |= RCC_APB2ENR_AFIOEN | RCC_APB2ENR_IOPAEN | RCC_APB2ENR_USART1EN;
+	RCC->AHBENR |= RCC_AHBENR_DMA1EN;
+	USART1->BRR = (pclk2 + baud / 2) / baud;	//mantissa and fraction in one go (16x oversampling)
+}
+
+void uart_tx_init(uint32_t baud)
+{
+	usart_setup(baud);
+
+	//A9 as alternate function push pull (USART1_TX)
+	GPIOA->CRH |= GPIO_CRH_MODE9 | GPIO_CRH_CNF9_1;
+	GPIOA->CRH &= ~GPIO_CRH_CNF9_0;
+
+	USART1->CR3 |= USART_CR3_DMAT;
+	USART1->CR1 |= USART_CR1_TE | USART_CR1_UE;
+
+	//memory -> USART1->DR , byte wide , memory increment , interrupt when a piece is done
+	DMA1_Channel4->CCR = 0;
+	DMA1_Channel4->CPAR = (uint32_t) (uintptr_t) &USART1->DR;
+	DMA1_Channel4->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TCIE;
+	NVIC_EnableIRQ(DMA1_Channel4_IRQn);
+
+	head = 0;
+	tail = 0;
+	dma_len = 0;
+	uart_tx_stats.bytes = 0;
+	uart_tx_stats.refused = 0;
+	uart_tx_stats.max_fill = 0;
+}
+
+//bring rx_head up to the DMA write position , must run at least twice per lap (the half and full transfer interrupts do)
+static void rx_update(void)
+{
+	uint32_t pos = UART_RX_BUF_SIZE - DMA1_Channel5->CNDTR;
+	uint32_t n = (pos - rx_head) & (UART_RX_BUF_SIZE - 1);
+
+	rx_head += n;
+	uart_rx_stats.bytes += n;
+	if (rx_head - rx_tail > UART_RX_BUF_SIZE)
+	{
+		uart_rx_stats.overruns += rx_head - rx_tail - UART_RX_BUF_SIZE;	//the reader fell a lap behind , the oldest bytes are gone
+		rx_tail = rx_head - UART_RX_BUF_SIZE;
+	}
+}
+
+//everything since the last delivery goes to the hook as up to two slices
+static void rx_deliver(uint8_t more)
+{
+	uart_rx_frame_t frame;
+	uint32_t t = rx_tail & (UART_RX_BUF_SIZE - 1);
+	uint32_t n = rx_head - rx_tail;
+
+	if (!n && (more || !rx_open))
+		return;
+	rx_open = more;
+	frame.data[0] = &rx_ring[t];
+	frame.len[0] = t + n > UART_RX_BUF_SIZE ? UART_RX_BUF_SIZE - t : n;
+	frame.data[1] = rx_ring;
+	frame.len[1] = n - frame.len[0];
+	frame.more = more;
+	rx_tail = rx_head;
+	uart_rx_frame_hook(&frame);
+}
+
+void DMA1_Channel5_IRQHandler(void)
+{
+	DMA1->IFCR = DMA_IFCR_CHTIF5 | DMA_IFCR_CTCIF5 | DMA_IFCR_CGIF5;
+	rx_update();
+	if (rx_mode == UART_RX_FRAMES)
+		rx_deliver(1);		//a long burst , hand over what is there before the DMA comes round to it
+}
+
+void USART1_IRQHandler(void)
+{
+	uint32_t sr = USART1->SR;
+
+	if (sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_FE | USART_SR_NE))
+	{
+		(void) USART1->DR;	//SR then DR clears IDLE and the error flags
+		if (sr & (USART_SR_ORE | USART_SR_FE | USART_SR_NE))
+			uart_rx_stats.overruns++;
+		if (sr & USART_SR_IDLE)
+		{
+			uart_rx_stats.bursts++;
+			rx_update();
+			if (rx_mode == UART_RX_FRAMES)
+				rx_deliver(0);
+		}
+	}
+}
+
+uint32_t uart_rx_peek(const uint8_t **data)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint32_t t, n;
+
+	__disable_irq();
+	rx_update();			//bytes of a burst that is still coming count too
+	t = rx_tail & (UART_RX_BUF_SIZE - 1);
+	n = rx_head - rx_tail;
+	__set_PRIMASK(primask);
+	*data = &rx_ring[t];
+	return t + n > UART_RX_BUF_SIZE ? UART_RX_BUF_SIZE - t : n;
+}
+
+void uart_rx_consume(uint32_t n)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	if (n > rx_head - rx_tail)
+		n = rx_head - rx_tail;
+	rx_tail += n;
+	__set_PRIMASK(primask);
+}
+
+void uart_rx_init(uint32_t baud, uint8_t mode)
+{
+	usart_setup(baud);
+
+	//A10 as input with pull up (USART1_RX) , an unconnected line reads idle instead of noise
+	GPIOA->CRH = (GPIOA->CRH & ~(GPIO_CRH_MODE10 | GPIO_CRH_CNF10)) | GPIO_CRH_CNF10_1;
+	GPIOA->BSRR = 1 << 10;
+
+	rx_head = 0;
+	rx_tail = 0;
+	rx_mode = mode;
+	rx_open = 0;
+	uart_rx_stats.bytes = 0;
+	uart_rx_stats.bursts = 0;
+	uart_rx_stats.overruns = 0;
+
+	//USART1->DR -> memory , byte wide , circular , interrupts at half and full
+	DMA1_Channel5->CCR = 0;
+	DMA1_Channel5->CPAR = (uint32_t) (uintptr_t) &USART1->DR;
+	DMA1_Channel5->CMAR = (uint32_t) (uintptr_t) rx_ring;
+	DMA1_Channel5->CNDTR = UART_RX_BUF_SIZE;
+	DMA1->IFCR = DMA_IFCR_CGIF5;
+	DMA1_Channel5->CCR = DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_EN;
+	NVIC_EnableIRQ(DMA1_Channel5_IRQn);
+
+	USART1->CR3 |= USART_CR3_DMAR | USART_CR3_EIE;
+	USART1->CR1 |= USART_CR1_RE | USART_CR1_IDLEIE | USART_CR1_UE;
+	NVIC_EnableIRQ(USART1_IRQn);
+}
@@ -0,0 +1,77 @@
+#ifndef MYUART_H
+#define MYUART_H
+
+#include <stdint.h>
+
+//USART1 TX (A9) fed by DMA1 channel 4 out of a byte ring , writers copy into the ring and return at once ,
+//the DMA sends the ring in up to two pieces per lap and the transfer complete interrupt starts the next piece
+//every write goes in whole or not at all , so records and lines from different contexts never interleave
+//
+//mylog (text) and mycanlog (binary records) are both built on this , a program uses one of them
+//
+//USART1 RX (A10) runs DMA1 channel 5 circular into a second ring , the CPU does nothing per byte: the half and full
+//transfer interrupts keep track of the write position and the IDLE interrupt (one idle character after the last byte)
+//marks the end of a burst , so a sender that writes a packet at a time gets one frame per packet
+//  UART_RX_FRAMES: every burst goes to uart_rx_frame_hook() from the interrupt as slices of the ring (two when it wraps) ,
+//                  a burst longer than half the ring comes in pieces with more set (the last piece , maybe empty , has it clear) ,
+//                  the slices are only valid until the hook returns
+//  UART_RX_STREAM: bytes wait in the ring for uart_rx_peek() / uart_rx_consume() from the main loop
+//the reader has half a ring of time to keep up , UART_RX_BUF_SIZE bytes at 2 Mbaud last 1.3 ms
+
+#ifndef UART_TX_BUF_SIZE
+#define UART_TX_BUF_SIZE 1024		//must be a power of 2 , the CAN logger wants 2048
+#endif
+
+#if (UART_TX_BUF_SIZE & (UART_TX_BUF_SIZE - 1)) != 0
+#error "UART_TX_BUF_SIZE must be a power of 2"
+#endif
+
+#ifndef UART_RX_BUF_SIZE
+#define UART_RX_BUF_SIZE 256		//must be a power of 2
+#endif
+
+#if (UART_RX_BUF_SIZE & (UART_RX_BUF_SIZE - 1)) != 0
+#error "UART_RX_BUF_SIZE must be a power of 2"
+#endif
+
+#define UART_RX_FRAMES 0
+#define UART_RX_STREAM 1
+
+typedef struct
+{
+	uint32_t bytes;			//bytes handed to the DMA
+	uint32_t refused;		//writes that did not fit
+	uint32_t max_fill;		//deepest the ring has been , bytes
+} uart_tx_stats_t;
+
+extern volatile uart_tx_stats_t uart_tx_stats;
+
+typedef struct
+{
+	uint32_t bytes;			//bytes the DMA brought in
+	uint32_t bursts;		//IDLE events
+	uint32_t overruns;		//bytes overwritten before they were read (UART_RX_STREAM) , or ORE/FE/NE flags
+} uart_rx_stats_t;
+
+extern volatile uart_rx_stats_t uart_rx_stats;
+
+typedef struct
+{
+	const uint8_t *data[2];		//second slice is the part after the ring wrapped , len[1] 0 otherwise
+	uint16_t len[2];
+	uint8_t more;			//1 -> the burst is still coming , the next call continues it
+} uart_rx_frame_t;
+
+void uart_tx_init(uint32_t baud);			//A9 , USART1 and DMA1 channel 4 , baud from the current PCLK2
+int uart_tx_write(const void *data, uint32_t len);	//1 if queued , 0 if the ring had no room , safe from interrupts
+uint32_t uart_tx_free(void);				//bytes that fit right now
+uint32_t uart_tx_pending(void);				//bytes not sent yet
+
+void uart_rx_init(uint32_t baud, uint8_t mode);		//A10 , USART1 and DMA1 channel 5 , mode UART_RX_x , same baud as TX
+uint32_t uart_rx_peek(const uint8_t **data);		//UART_RX_STREAM , unread bytes from *data on without a wrap (0 if none)
+void uart_rx_consume(uint32_t n);			//UART_RX_STREAM , drops n bytes that were peeked
+
+//weak , empty by default , called from the interrupts in UART_RX_FRAMES mode
+void uart_rx_frame_hook(const uart_rx_frame_t *frame);
+
+#endif
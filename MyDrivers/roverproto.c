@@ -0,0 +1,213 @@
+#include "roverproto.h"
+
+//CRC-16/CCITT-FALSE (poly 0x1021) , one table lookup per byte
+static const uint16_t crc16_table[256] =
+{
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+uint16_t rover_crc16(const uint8_t *buf, uint32_t len)
+{
+	uint16_t crc = 0xFFFF;
+
+	while (len--)
+		crc = (crc << 8) ^ crc16_table[(crc >> 8) ^ *buf++];
+	return crc;
+}
+
+//each code byte says how far away the next zero is , 0xFF marks a run of 254 with no zero after it
+uint32_t rover_cobs_encode(const uint8_t *in, uint32_t len, uint8_t *out)
+{
+	uint8_t *code = out;
+	uint8_t *p = out + 1;
+
+	for (uint32_t i = 0; i < len; i++)
+	{
+		if (in[i])
+			*p++ = in[i];
+		if (!in[i] || p - code == 0xFF)
+		{
+			*code = p - code;
+			code = p++;
+			if (in[i] && i + 1 == len)	//a full run at the very end needs no empty block after it
+				return code - out;
+		}
+	}
+	*code = p - code;
+	return p - out;
+}
+
+int rover_cobs_decode(const uint8_t *in, uint32_t len, uint8_t *out)
+{
+	uint8_t *p = out;
+	uint32_t i = 0;
+
+	while (i < len)
+	{
+		uint8_t code = in[i++];
+
+		if (!code || i + code - 1 > len)
+			return ROVER_ERR_COBS;
+		for (uint8_t k = 1; k < code; k++)
+		{
+			if (!in[i])
+				return ROVER_ERR_COBS;
+			*p++ = in[i++];
+		}
+		if (code != 0xFF && i < len)
+			*p++ = 0;
+	}
+	return p - out;
+}
+
+uint32_t rover_encode(uint8_t type, const int16_t *fields, uint8_t nfields, uint8_t *out)
+{
+	uint8_t msg[ROVER_MSG_MAX];
+	uint8_t *p = msg;
+	uint16_t crc;
+	uint32_t n;
+
+	if (nfields > ROVER_MAX_FIELDS)
+		return 0;
+	*p++ = type;
+	for (uint8_t i = 0; i < nfields; i++)
+	{
+		*p++ = fields[i];
+		*p++ = (uint16_t) fields[i] >> 8;
+	}
+	crc = rover_crc16(msg, p - msg);
+	*p++ = crc;
+	*p++ = crc >> 8;
+	n = rover_cobs_encode(msg, p - msg, out);
+	out[n] = 0;
+	return n + 1;
+}
+
+uint32_t rover_encode_drive(int16_t x, int16_t y, uint8_t *out)
+{
+	int16_t fields[2] = { x, y };
+
+	return rover_encode(ROVER_MSG_DRIVE, fields, 2, out);
+}
+
+uint32_t rover_encode_arm(const int16_t *arm, uint8_t *out)
+{
+	return rover_encode(ROVER_MSG_ARM, arm, 6, out);
+}
+
+uint32_t rover_encode_gear(int16_t gear, uint8_t *out)
+{
+	return rover_encode(ROVER_MSG_GEAR, &gear, 1, out);
+}
+
+int rover_dispatch(const rover_cmd_t *table, const uint8_t *msg, uint32_t len, void *ctx)
+{
+	int16_t fields[ROVER_MAX_FIELDS];
+	const rover_cmd_t *cmd;
+	uint8_t type;
+
+	if (len < 3 || len > ROVER_MSG_MAX)
+		return ROVER_ERR_LEN;
+	if (rover_crc16(msg, len - 2) != (msg[len - 2] | msg[len - 1] << 8))
+		return ROVER_ERR_CRC;
+	type = msg[0];
+	if (type >= ROVER_MSG_COUNT || !table[type].fn)
+		return ROVER_ERR_TYPE;
+	cmd = &table[type];
+	if (len != 3U + 2 * cmd->nfields)
+		return ROVER_ERR_LEN;
+	for (uint8_t i = 0; i < cmd->nfields; i++)
+		fields[i] = msg[1 + 2 * i] | msg[2 + 2 * i] << 8;
+	cmd->fn(fields, ctx);
+	return type;
+}
+
+void rover_rx_init(rover_rx_t *rx, const rover_cmd_t *table, void *ctx)
+{
+	rx->table = table;
+	rx->ctx = ctx;
+	rx->len = 0;
+	rx->overflow = 0;
+	rx->stats.frames = 0;
+	rx->stats.cobs = 0;
+	rx->stats.len = 0;
+	rx->stats.crc = 0;
+	rx->stats.type = 0;
+}
+
+//a zero closes the frame , two zeros in a row (idle filler , or the first byte after power up) are not counted as errors
+void rover_rx_feed(rover_rx_t *rx, const uint8_t *data, uint32_t n)
+{
+	uint8_t msg[ROVER_WIRE_MAX];
+	int len;
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		if (data[i])
+		{
+			if (rx->len < sizeof(rx->buf))
+				rx->buf[rx->len++] = data[i];
+			else
+				rx->overflow = 1;
+			continue;
+		}
+		if (rx->overflow)
+			rx->stats.len++;
+		else if (rx->len)
+		{
+			len = rover_cobs_decode(rx->buf, rx->len, msg);
+			if (len >= 0)
+				len = rover_dispatch(rx->table, msg, len, rx->ctx);
+			switch (len)
+			{
+			case ROVER_ERR_COBS:
+				rx->stats.cobs++;
+				break;
+			case ROVER_ERR_LEN:
+				rx->stats.len++;
+				break;
+			case ROVER_ERR_CRC:
+				rx->stats.crc++;
+				break;
+			case ROVER_ERR_TYPE:
+				rx->stats.type++;
+				break;
+			default:
+				rx->stats.frames++;
+			}
+		}
+		rx->len = 0;
+		rx->overflow = 0;
+	}
+}
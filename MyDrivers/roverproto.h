@@ -0,0 +1,73 @@
+#ifndef ROVERPROTO_H
+#define ROVERPROTO_H
+
+#include <stdint.h>
+
+//binary command link to the rover (base station -> Rover over USART1) , plain C so the base station builds the same file
+//
+//message     : type | fields as little endian int16 | CRC-16/CCITT-FALSE (poly 0x1021 , init 0xFFFF) over type and fields , low byte first
+//on the wire : the message COBS encoded (no zero bytes inside) , then one 0x00 , so a receiver that joins halfway or
+//              loses a byte is back in step at the next zero
+//
+//  ROVER_MSG_DRIVE  x , y                                    9 bytes (was 15 as ASCII)
+//  ROVER_MSG_ARM    swivel , link1 , link2 , roll , pitch , gripper   17 bytes (was 37)
+//  ROVER_MSG_GEAR   gear                                     7 bytes
+//
+//stick values are centred on 0 (-8000 .. 8000) , the on/off joints (swivel , roll , pitch , gripper) stop at 0
+//and turn one way or the other by the sign
+
+#define ROVER_MSG_DRIVE 1
+#define ROVER_MSG_ARM 2
+#define ROVER_MSG_GEAR 3
+#define ROVER_MSG_COUNT 4		//types are indexes into the dispatch table , 0 is never used
+
+#define ROVER_MAX_FIELDS 6
+#define ROVER_MSG_MAX (1 + 2 * ROVER_MAX_FIELDS + 2)	//decoded message , bytes
+#define ROVER_WIRE_MAX (ROVER_MSG_MAX + 2)		//COBS overhead byte and the delimiter
+
+#define ROVER_ERR_COBS -1		//zero inside the frame or a code byte pointing past its end
+#define ROVER_ERR_LEN -2		//too long , or the length does not match the fields of the type
+#define ROVER_ERR_CRC -3
+#define ROVER_ERR_TYPE -4		//no handler for the type
+
+typedef void (*rover_handler_fn)(const int16_t *fields, void *ctx);
+
+typedef struct
+{
+	uint8_t nfields;
+	rover_handler_fn fn;		//0 -> type not handled
+} rover_cmd_t;
+
+typedef struct
+{
+	uint32_t frames;		//messages handed to a handler
+	uint32_t cobs;			//errors by kind , ROVER_ERR_x
+	uint32_t len;
+	uint32_t crc;
+	uint32_t type;
+} rover_rx_stats_t;
+
+typedef struct
+{
+	const rover_cmd_t *table;	//ROVER_MSG_COUNT entries , indexed by type
+	void *ctx;
+	uint8_t buf[ROVER_WIRE_MAX];
+	uint8_t len;
+	uint8_t overflow;		//frame too long , skip to the next zero
+	rover_rx_stats_t stats;
+} rover_rx_t;
+
+uint16_t rover_crc16(const uint8_t *buf, uint32_t len);
+uint32_t rover_cobs_encode(const uint8_t *in, uint32_t len, uint8_t *out);	//bytes written , at most len + 1 + len / 254 , no delimiter
+int rover_cobs_decode(const uint8_t *in, uint32_t len, uint8_t *out);		//bytes written , ROVER_ERR_COBS if malformed
+
+uint32_t rover_encode(uint8_t type, const int16_t *fields, uint8_t nfields, uint8_t *out);	//wire bytes with the delimiter , 0 if nfields is too many
+uint32_t rover_encode_drive(int16_t x, int16_t y, uint8_t *out);
+uint32_t rover_encode_arm(const int16_t *arm, uint8_t *out);		//swivel , link1 , link2 , roll , pitch , gripper
+uint32_t rover_encode_gear(int16_t gear, uint8_t *out);
+
+int rover_dispatch(const rover_cmd_t *table, const uint8_t *msg, uint32_t len, void *ctx);	//decoded message -> handler , type or ROVER_ERR_x
+void rover_rx_init(rover_rx_t *rx, const rover_cmd_t *table, void *ctx);
+void rover_rx_feed(rover_rx_t *rx, const uint8_t *data, uint32_t n);	//wire bytes in any pieces , handlers run from in here
+
+#endif
@@ -0,0 +1,173 @@
+#include "sigfilt.h"
+
+static uint16_t clamp12(int32_t v)
+{
+	return v < 0 ? 0 : v > 4095 ? 4095 : v;
+}
+
+int filt_biquad_q31_init(filt_biquad_q31_t *f, const filt_coef_q31_t *coef, uint8_t stages)
+{
+	if (!stages || stages > FILT_MAX_STAGES)
+		return FILT_ERR_STAGES;
+	f->coef = coef;
+	f->stages = stages;
+	for (uint8_t s = 0; s < FILT_MAX_STAGES; s++)
+	{
+		f->x1[s] = 0;
+		f->x2[s] = 0;
+		f->y1[s] = 0;
+		f->y2[s] = 0;
+	}
+	return 0;
+}
+
+int32_t filt_biquad_q31_step(filt_biquad_q31_t *f, int32_t x)
+{
+	for (uint8_t s = 0; s < f->stages; s++)
+	{
+		const filt_coef_q31_t *c = &f->coef[s];
+		int64_t acc = (int64_t) 1 << 29;		//rounding
+		int32_t y;
+
+		acc += (int64_t) c->b0 * x;
+		acc += (int64_t) c->b1 * f->x1[s];
+		acc += (int64_t) c->b2 * f->x2[s];
+		acc += (int64_t) c->a1 * f->y1[s];
+		acc += (int64_t) c->a2 * f->y2[s];
+		acc >>= 30;
+		y = acc > INT32_MAX ? INT32_MAX : acc < INT32_MIN ? INT32_MIN : (int32_t) acc;
+		f->x2[s] = f->x1[s];
+		f->x1[s] = x;
+		f->y2[s] = f->y1[s];
+		f->y1[s] = y;
+		x = y;
+	}
+	return x;
+}
+
+void filt_biquad_q31_block(void *f, uint16_t *samples, uint32_t n, uint8_t stride)
+{
+	//12 bits << 16 leaves 3 bits of headroom for overshoot
+	for (; n; n--, samples += stride)
+		*samples = clamp12((filt_biquad_q31_step(f, (int32_t) *samples << 16) + 0x8000) >> 16);
+}
+
+int filt_biquad_q15_init(filt_biquad_q15_t *f, const filt_coef_q15_t *coef, uint8_t stages)
+{
+	if (!stages || stages > FILT_MAX_STAGES)
+		return FILT_ERR_STAGES;
+	f->coef = coef;
+	f->stages = stages;
+	for (uint8_t s = 0; s < FILT_MAX_STAGES; s++)
+	{
+		f->x1[s] = 0;
+		f->x2[s] = 0;
+		f->y1[s] = 0;
+		f->y2[s] = 0;
+	}
+	return 0;
+}
+
+int16_t filt_biquad_q15_step(filt_biquad_q15_t *f, int16_t x)
+{
+	for (uint8_t s = 0; s < f->stages; s++)
+	{
+		const filt_coef_q15_t *c = &f->coef[s];
+		int32_t acc = 1 << 13;
+		int16_t y;
+
+		acc += c->b0 * x;
+		acc += c->b1 * f->x1[s];
+		acc += c->b2 * f->x2[s];
+		acc += c->a1 * f->y1[s];
+		acc += c->a2 * f->y2[s];
+		acc >>= 14;
+		y = acc > INT16_MAX ? INT16_MAX : acc < INT16_MIN ? INT16_MIN : acc;
+		f->x2[s] = f->x1[s];
+		f->x1[s] = x;
+		f->y2[s] = f->y1[s];
+		f->y1[s] = y;
+		x = y;
+	}
+	return x;
+}
+
+void filt_biquad_q15_block(void *f, uint16_t *samples, uint32_t n, uint8_t stride)
+{
+	//12 bits << 2 , half of Q15 full scale , leaves one bit for overshoot
+	for (; n; n--, samples += stride)
+		*samples = clamp12((filt_biquad_q15_step(f, *samples << 2) + 2) >> 2);
+}
+
+int filt_ma_init(filt_ma_t *f, uint8_t len)
+{
+	if (!len || len > FILT_MA_MAX)
+		return FILT_ERR_LEN;
+	f->sum = 0;
+	f->len = len;
+	f->pos = 0;
+	f->count = 0;
+	return 0;
+}
+
+uint16_t filt_ma_step(filt_ma_t *f, uint16_t x)
+{
+	if (f->count < f->len)
+		f->count++;
+	else
+		f->sum -= f->hist[f->pos];	//the oldest sample leaves the window
+	f->sum += x;
+	f->hist[f->pos] = x;
+	if (++f->pos == f->len)
+		f->pos = 0;
+	return (f->sum + f->count / 2) / f->count;
+}
+
+void filt_ma_block(void *f, uint16_t *samples, uint32_t n, uint8_t stride)
+{
+	for (; n; n--, samples += stride)
+		*samples = filt_ma_step(f, *samples);
+}
+
+int filt_median_init(filt_median_t *f, uint8_t len)
+{
+	if (len < 3 || len > FILT_MEDIAN_MAX || !(len & 1))
+		return FILT_ERR_LEN;
+	f->len = len;
+	f->pos = 0;
+	f->count = 0;
+	return 0;
+}
+
+uint16_t filt_median_step(filt_median_t *f, uint16_t x)
+{
+	uint8_t i = 0;
+
+	if (f->count < f->len)
+		f->count++;
+	else
+	{
+		//take the oldest sample out of the sorted window
+		uint16_t old = f->hist[f->pos];
+
+		while (f->sorted[i] != old)
+			i++;
+		for (; i < f->len - 1; i++)
+			f->sorted[i] = f->sorted[i + 1];
+	}
+	f->hist[f->pos] = x;
+	if (++f->pos == f->len)
+		f->pos = 0;
+
+	//insertion from the top , count - 1 samples are in the window
+	for (i = f->count - 1; i && f->sorted[i - 1] > x; i--)
+		f->sorted[i] = f->sorted[i - 1];
+	f->sorted[i] = x;
+	return f->sorted[(f->count - 1) / 2];
+}
+
+void filt_median_block(void *f, uint16_t *samples, uint32_t n, uint8_t stride)
+{
+	for (; n; n--, samples += stride)
+		*samples = filt_median_step(f, *samples);
+}
@@ -0,0 +1,86 @@
+#ifndef SIGFILT_H
+#define SIGFILT_H
+
+#include <stdint.h>
+
+//fixed point filters for sensor channels , integer only (Cortex-M3 , no FPU) and plain C so they build on the host too
+//
+//biquad cascades , direct form 1 , a = 1 + a1 z^-1 + a2 z^-2 , coefficients stored with a1 and a2 already negated
+//  q31: coefficients Q2.30 , samples int32 , 64 bit accumulator (SMLAL) , for low cutoffs where Q15 runs out of bits
+//  q15: coefficients Q2.14 , samples int16 , 32 bit accumulator (MLA) , about twice as fast
+//moving average over up to FILT_MA_MAX samples with a running sum , one add and one subtract per sample
+//median of 3 to FILT_MEDIAN_MAX (odd) samples , keeps the window sorted , for spike rejection ahead of the other filters
+//
+//each filter has a step function for one sample and a block function that filters 12 bit ADC samples in place ,
+//n samples taken every stride entries (the layout of a myadc block) , the block functions take void * so they can be
+//handed to adc_filter_attach() as they are
+
+#define FILT_MAX_STAGES 4
+#define FILT_MA_MAX 64
+#define FILT_MEDIAN_MAX 9
+
+#define FILT_ERR_STAGES -1		//0 or more than FILT_MAX_STAGES biquads
+#define FILT_ERR_LEN -2			//moving average or median length out of range , or an even median
+
+typedef struct
+{
+	int32_t b0, b1, b2, a1, a2;	//Q2.30 , a1 and a2 negated
+} filt_coef_q31_t;
+
+typedef struct
+{
+	int16_t b0, b1, b2, a1, a2;	//Q2.14 , a1 and a2 negated
+} filt_coef_q15_t;
+
+typedef struct
+{
+	const filt_coef_q31_t *coef;
+	uint8_t stages;
+	int32_t x1[FILT_MAX_STAGES], x2[FILT_MAX_STAGES];
+	int32_t y1[FILT_MAX_STAGES], y2[FILT_MAX_STAGES];
+} filt_biquad_q31_t;
+
+typedef struct
+{
+	const filt_coef_q15_t *coef;
+	uint8_t stages;
+	int16_t x1[FILT_MAX_STAGES], x2[FILT_MAX_STAGES];
+	int16_t y1[FILT_MAX_STAGES], y2[FILT_MAX_STAGES];
+} filt_biquad_q15_t;
+
+typedef struct
+{
+	uint16_t hist[FILT_MA_MAX];
+	uint32_t sum;
+	uint8_t len;
+	uint8_t pos;
+	uint8_t count;			//samples seen , up to len
+} filt_ma_t;
+
+typedef struct
+{
+	uint16_t hist[FILT_MEDIAN_MAX];	//arrival order
+	uint16_t sorted[FILT_MEDIAN_MAX];
+	uint8_t len;
+	uint8_t pos;
+	uint8_t count;
+} filt_median_t;
+
+//coefficients are not copied , they must outlive the filter
+int filt_biquad_q31_init(filt_biquad_q31_t *f, const filt_coef_q31_t *coef, uint8_t stages);	//0 or FILT_ERR_x
+int32_t filt_biquad_q31_step(filt_biquad_q31_t *f, int32_t x);
+void filt_biquad_q31_block(void *f, uint16_t *samples, uint32_t n, uint8_t stride);	//runs the cascade on sample << 16
+
+int filt_biquad_q15_init(filt_biquad_q15_t *f, const filt_coef_q15_t *coef, uint8_t stages);
+int16_t filt_biquad_q15_step(filt_biquad_q15_t *f, int16_t x);
+void filt_biquad_q15_block(void *f, uint16_t *samples, uint32_t n, uint8_t stride);	//runs the cascade on sample << 2
+
+int filt_ma_init(filt_ma_t *f, uint8_t len);
+uint16_t filt_ma_step(filt_ma_t *f, uint16_t x);	//rounded mean of the last len samples (of all so far until len came in)
+void filt_ma_block(void *f, uint16_t *samples, uint32_t n, uint8_t stride);
+
+int filt_median_init(filt_median_t *f, uint8_t len);
+uint16_t filt_median_step(filt_median_t *f, uint16_t x);
+void filt_median_block(void *f, uint16_t *samples, uint32_t n, uint8_t stride);
+
+#endif
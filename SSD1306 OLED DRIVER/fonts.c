@@ -18,6 +18,14 @@
  */
 #include "fonts.h"
 
+/* The row tables are the source HostSim/fontc.c makes the page tables from, SSD1306_Putc() only needs the pages */
+#ifdef FONTS_ROW_TABLES
+#define FONTS_ROWS(rows) rows
+#else
+#define FONTS_ROWS(rows) NULL
+#endif
+
+#ifdef FONTS_ROW_TABLES
 const uint16_t Font7x10 [] = {
 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // sp
 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x1000, 0x0000, 0x1000, 0x0000, 0x0000,  // !
@@ -312,23 +320,327 @@ const uint16_t Font16x26 [] = {
 0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x3F07,0x7FC7,0x73E7,0xF1FF,0xF07E,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000,0x0000, // Ascii = [~]
 };
 
+#endif
+
+/* The same glyphs in LCD page layout for SSD1306_Putc(): columns left to right, ceil(height / 8) bytes a column, top
+   row in bit 0 of the first byte. Generated from the tables above by HostSim/fontc.c, do not edit */
+const uint8_t Font7x10Pages [] = {
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // sp
+0x00,0x00,0x00,0x00,0x00,0x00,0xBF,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // !
+0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00, // "
+0x00,0x00,0xF4,0x00,0x2F,0x00,0x24,0x00,0xF4,0x00,0x2F,0x00,0x00,0x00, // #
+0x00,0x00,0x66,0x00,0x89,0x00,0xFF,0x01,0x89,0x00,0x72,0x00,0x00,0x00, // $
+0x00,0x00,0x26,0x00,0x19,0x00,0x6E,0x00,0x94,0x00,0x62,0x00,0x00,0x00, // %
+0x00,0x00,0x60,0x00,0x96,0x00,0x99,0x00,0x66,0x00,0x90,0x00,0x00,0x00, // &
+0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // '
+0x00,0x00,0x00,0x00,0xFC,0x00,0x02,0x01,0x01,0x02,0x00,0x00,0x00,0x00, // (
+0x00,0x00,0x00,0x00,0x01,0x02,0x02,0x01,0xFC,0x00,0x00,0x00,0x00,0x00, // )
+0x00,0x00,0x00,0x00,0x0A,0x00,0x07,0x00,0x0A,0x00,0x00,0x00,0x00,0x00, // *
+0x00,0x00,0x10,0x00,0x10,0x00,0x7C,0x00,0x10,0x00,0x10,0x00,0x00,0x00, // +
+0x00,0x00,0x00,0x00,0x00,0x00,0x80,0x03,0x00,0x00,0x00,0x00,0x00,0x00, // ,
+0x00,0x00,0x00,0x00,0x20,0x00,0x20,0x00,0x20,0x00,0x00,0x00,0x00,0x00, // -
+0x00,0x00,0x00,0x00,0x00,0x00,0x80,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // .
+0x00,0x00,0x00,0x00,0xC0,0x00,0x3C,0x00,0x03,0x00,0x00,0x00,0x00,0x00, // /
+0x00,0x00,0x7E,0x00,0x81,0x00,0x89,0x00,0x81,0x00,0x7E,0x00,0x00,0x00, // 0
+0x00,0x00,0x04,0x00,0x02,0x00,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 1
+0x00,0x00,0x86,0x00,0xC1,0x00,0xA1,0x00,0x91,0x00,0x8E,0x00,0x00,0x00, // 2
+0x00,0x00,0x42,0x00,0x81,0x00,0x89,0x00,0x89,0x00,0x76,0x00,0x00,0x00, // 3
+0x00,0x00,0x30,0x00,0x2C,0x00,0x22,0x00,0xFF,0x00,0x20,0x00,0x00,0x00, // 4
+0x00,0x00,0x4F,0x00,0x89,0x00,0x89,0x00,0x89,0x00,0x71,0x00,0x00,0x00, // 5
+0x00,0x00,0x7E,0x00,0x89,0x00,0x89,0x00,0x89,0x00,0x72,0x00,0x00,0x00, // 6
+0x00,0x00,0x01,0x00,0xE1,0x00,0x19,0x00,0x05,0x00,0x03,0x00,0x00,0x00, // 7
+0x00,0x00,0x76,0x00,0x89,0x00,0x89,0x00,0x89,0x00,0x76,0x00,0x00,0x00, // 8
+0x00,0x00,0x4E,0x00,0x91,0x00,0x91,0x00,0x91,0x00,0x7E,0x00,0x00,0x00, // 9
+0x00,0x00,0x00,0x00,0x00,0x00,0x84,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // :
+0x00,0x00,0x00,0x00,0x00,0x00,0x88,0x03,0x00,0x00,0x00,0x00,0x00,0x00, // ;
+0x00,0x00,0x10,0x00,0x28,0x00,0x28,0x00,0x44,0x00,0x44,0x00,0x00,0x00, // <
+0x00,0x00,0x28,0x00,0x28,0x00,0x28,0x00,0x28,0x00,0x28,0x00,0x00,0x00, // =
+0x00,0x00,0x44,0x00,0x44,0x00,0x28,0x00,0x28,0x00,0x10,0x00,0x00,0x00, // >
+0x00,0x00,0x02,0x00,0x01,0x00,0xB1,0x00,0x09,0x00,0x06,0x00,0x00,0x00, // ?
+0x00,0x00,0x7E,0x00,0x81,0x00,0x99,0x00,0x95,0x00,0x1E,0x00,0x00,0x00, // @
+0x00,0x00,0xE0,0x00,0x3E,0x00,0x21,0x00,0x3E,0x00,0xE0,0x00,0x00,0x00, // A
+0x00,0x00,0xFF,0x00,0x89,0x00,0x89,0x00,0x89,0x00,0x76,0x00,0x00,0x00, // B
+0x00,0x00,0x7E,0x00,0x81,0x00,0x81,0x00,0x81,0x00,0x42,0x00,0x00,0x00, // C
+0x00,0x00,0xFF,0x00,0x81,0x00,0x81,0x00,0x42,0x00,0x3C,0x00,0x00,0x00, // D
+0x00,0x00,0xFF,0x00,0x89,0x00,0x89,0x00,0x89,0x00,0x89,0x00,0x00,0x00, // E
+0x00,0x00,0xFF,0x00,0x09,0x00,0x09,0x00,0x09,0x00,0x01,0x00,0x00,0x00, // F
+0x00,0x00,0x7E,0x00,0x81,0x00,0x91,0x00,0x91,0x00,0x72,0x00,0x00,0x00, // G
+0x00,0x00,0xFF,0x00,0x08,0x00,0x08,0x00,0x08,0x00,0xFF,0x00,0x00,0x00, // H
+0x00,0x00,0x00,0x00,0x81,0x00,0xFF,0x00,0x81,0x00,0x00,0x00,0x00,0x00, // I
+0x00,0x00,0x40,0x00,0x80,0x00,0x80,0x00,0x80,0x00,0x7F,0x00,0x00,0x00, // J
+0x00,0x00,0xFF,0x00,0x08,0x00,0x14,0x00,0x62,0x00,0x81,0x00,0x00,0x00, // K
+0x00,0x00,0xFF,0x00,0x80,0x00,0x80,0x00,0x80,0x00,0x80,0x00,0x00,0x00, // L
+0x00,0x00,0xFF,0x00,0x06,0x00,0x08,0x00,0x06,0x00,0xFF,0x00,0x00,0x00, // M
+0x00,0x00,0xFF,0x00,0x06,0x00,0x18,0x00,0x60,0x00,0xFF,0x00,0x00,0x00, // N
+0x00,0x00,0x7E,0x00,0x81,0x00,0x81,0x00,0x81,0x00,0x7E,0x00,0x00,0x00, // O
+0x00,0x00,0xFF,0x00,0x11,0x00,0x11,0x00,0x11,0x00,0x0E,0x00,0x00,0x00, // P
+0x00,0x00,0x7E,0x00,0x81,0x00,0xC1,0x00,0x81,0x00,0x7E,0x01,0x00,0x00, // Q
+0x00,0x00,0xFF,0x00,0x11,0x00,0x11,0x00,0x71,0x00,0x8E,0x00,0x00,0x00, // R
+0x00,0x00,0x46,0x00,0x89,0x00,0x89,0x00,0x91,0x00,0x62,0x00,0x00,0x00, // S
+0x00,0x00,0x01,0x00,0x01,0x00,0xFF,0x00,0x01,0x00,0x01,0x00,0x00,0x00, // T
+0x00,0x00,0x7F,0x00,0x80,0x00,0x80,0x00,0x80,0x00,0x7F,0x00,0x00,0x00, // U
+0x00,0x00,0x07,0x00,0x38,0x00,0xC0,0x00,0x38,0x00,0x07,0x00,0x00,0x00, // V
+0x00,0x00,0x3F,0x00,0xE0,0x00,0x1C,0x00,0xE0,0x00,0x3F,0x00,0x00,0x00, // W
+0x00,0x00,0x81,0x00,0x66,0x00,0x18,0x00,0x66,0x00,0x81,0x00,0x00,0x00, // X
+0x00,0x00,0x03,0x00,0x0C,0x00,0xF0,0x00,0x0C,0x00,0x03,0x00,0x00,0x00, // Y
+0x00,0x00,0xC1,0x00,0xA1,0x00,0x99,0x00,0x85,0x00,0x83,0x00,0x00,0x00, // Z
+0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x03,0x01,0x02,0x00,0x00,0x00,0x00, // [
+0x00,0x00,0x00,0x00,0x03,0x00,0x3C,0x00,0xC0,0x00,0x00,0x00,0x00,0x00, /* \ */
+0x00,0x00,0x00,0x00,0x01,0x02,0xFF,0x03,0x00,0x00,0x00,0x00,0x00,0x00, // ]
+0x00,0x00,0x08,0x00,0x06,0x00,0x01,0x00,0x06,0x00,0x08,0x00,0x00,0x00, // ^
+0x00,0x02,0x00,0x02,0x00,0x02,0x00,0x02,0x00,0x02,0x00,0x02,0x00,0x02, // _
+0x00,0x00,0x00,0x00,0x01,0x00,0x02,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // `
+0x00,0x00,0x68,0x00,0x94,0x00,0x94,0x00,0x54,0x00,0xF8,0x00,0x00,0x00, // a
+0x00,0x00,0xFF,0x00,0x48,0x00,0x84,0x00,0x84,0x00,0x78,0x00,0x00,0x00, // b
+0x00,0x00,0x78,0x00,0x84,0x00,0x84,0x00,0x84,0x00,0x48,0x00,0x00,0x00, // c
+0x00,0x00,0x78,0x00,0x84,0x00,0x84,0x00,0x48,0x00,0xFF,0x00,0x00,0x00, // d
+0x00,0x00,0x78,0x00,0x94,0x00,0x94,0x00,0x94,0x00,0x58,0x00,0x00,0x00, // e
+0x00,0x00,0x04,0x00,0x04,0x00,0xFE,0x00,0x05,0x00,0x05,0x00,0x00,0x00, // f
+0x00,0x00,0x78,0x02,0x84,0x02,0x84,0x02,0x48,0x02,0xFC,0x01,0x00,0x00, // g
+0x00,0x00,0xFF,0x00,0x08,0x00,0x04,0x00,0x04,0x00,0xF8,0x00,0x00,0x00, // h
+0x00,0x00,0x04,0x00,0x04,0x00,0xFD,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // i
+0x00,0x02,0x04,0x02,0x04,0x02,0xFD,0x01,0x00,0x00,0x00,0x00,0x00,0x00, // j
+0x00,0x00,0xFF,0x00,0x10,0x00,0x28,0x00,0x44,0x00,0x80,0x00,0x00,0x00, // k
+0x00,0x00,0x01,0x00,0x01,0x00,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // l
+0x00,0x00,0xFC,0x00,0x04,0x00,0xFC,0x00,0x04,0x00,0xF8,0x00,0x00,0x00, // m
+0x00,0x00,0xFC,0x00,0x08,0x00,0x04,0x00,0x04,0x00,0xF8,0x00,0x00,0x00, // n
+0x00,0x00,0x78,0x00,0x84,0x00,0x84,0x00,0x84,0x00,0x78,0x00,0x00,0x00, // o
+0x00,0x00,0xFC,0x03,0x48,0x00,0x84,0x00,0x84,0x00,0x78,0x00,0x00,0x00, // p
+0x00,0x00,0x78,0x00,0x84,0x00,0x84,0x00,0x48,0x00,0xFC,0x03,0x00,0x00, // q
+0x00,0x00,0xFC,0x00,0x08,0x00,0x04,0x00,0x04,0x00,0x08,0x00,0x00,0x00, // r
+0x00,0x00,0x48,0x00,0x94,0x00,0x94,0x00,0xA4,0x00,0x48,0x00,0x00,0x00, // s
+0x00,0x00,0x04,0x00,0x7F,0x00,0x84,0x00,0x84,0x00,0x00,0x00,0x00,0x00, // t
+0x00,0x00,0x7C,0x00,0x80,0x00,0x80,0x00,0x40,0x00,0xFC,0x00,0x00,0x00, // u
+0x00,0x00,0x0C,0x00,0x70,0x00,0x80,0x00,0x70,0x00,0x0C,0x00,0x00,0x00, // v
+0x00,0x00,0x3C,0x00,0xE0,0x00,0x1C,0x00,0xE0,0x00,0x3C,0x00,0x00,0x00, // w
+0x00,0x00,0x84,0x00,0x48,0x00,0x30,0x00,0x48,0x00,0x84,0x00,0x00,0x00, // x
+0x00,0x00,0x0C,0x02,0x30,0x02,0xC0,0x01,0x30,0x00,0x0C,0x00,0x00,0x00, // y
+0x00,0x00,0xC4,0x00,0xA4,0x00,0x94,0x00,0x8C,0x00,0x84,0x00,0x00,0x00, // z
+0x00,0x00,0x00,0x00,0x30,0x00,0xCF,0x03,0x01,0x02,0x00,0x00,0x00,0x00, // {
+0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x03,0x00,0x00,0x00,0x00,0x00,0x00, // |
+0x00,0x00,0x00,0x00,0x01,0x02,0xCF,0x03,0x30,0x00,0x00,0x00,0x00,0x00, // }
+0x00,0x00,0x18,0x00,0x08,0x00,0x08,0x00,0x10,0x00,0x18,0x00,0x00,0x00, // ~
+};
+
+const uint8_t Font11x18Pages [] = {
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // sp
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFE,0x6F,0x00,0xFE,0x6F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // !
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3E,0x00,0x00,0x3E,0x00,0x00,0x00,0x00,0x00,0x3E,0x00,0x00,0x3E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // "
+0x00,0x00,0x00,0x60,0x06,0x00,0x60,0x7F,0x00,0xFE,0x7F,0x00,0xFE,0x06,0x00,0x60,0x06,0x00,0x60,0x7F,0x00,0xFE,0x7F,0x00,0xFE,0x06,0x00,0x60,0x06,0x00,0x00,0x00,0x00, // #
+0x00,0x00,0x00,0x38,0x1C,0x00,0x7C,0x3C,0x00,0xEE,0x70,0x00,0xC6,0x60,0x00,0xFE,0xFF,0x01,0x86,0x61,0x00,0x1C,0x3F,0x00,0x18,0x1E,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // $
+0x3C,0x00,0x00,0x7E,0x18,0x00,0x42,0x0C,0x00,0x7E,0x06,0x00,0x3C,0x03,0x00,0x80,0x3D,0x00,0xC0,0x7E,0x00,0x60,0x42,0x00,0x30,0x7E,0x00,0x18,0x3C,0x00,0x00,0x00,0x00, // %
+0x00,0x00,0x00,0x00,0x1E,0x00,0x3C,0x3F,0x00,0x7E,0x61,0x00,0xC6,0x61,0x00,0xC6,0x63,0x00,0x7E,0x36,0x00,0x3C,0x1C,0x00,0x00,0x7F,0x00,0x00,0x23,0x00,0x00,0x00,0x00, // &
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3E,0x00,0x00,0x3E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // '
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0x0F,0x00,0xF8,0x7F,0x00,0x1C,0xE0,0x00,0x06,0x80,0x01,0x01,0x00,0x02,0x00,0x00,0x00,0x00,0x00,0x00, // (
+0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x02,0x06,0x80,0x01,0x1C,0xE0,0x00,0xF8,0x7F,0x00,0xC0,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // )
+0x00,0x00,0x00,0x00,0x00,0x00,0x2C,0x00,0x00,0x38,0x00,0x00,0x1E,0x00,0x00,0x1E,0x00,0x00,0x38,0x00,0x00,0x2C,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // *
+0x80,0x01,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0xF8,0x1F,0x00,0xF8,0x1F,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0x00,0x00,0x00, // +
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x60,0x02,0x00,0xE0,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // ,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // -
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // .
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x70,0x00,0x00,0x7F,0x00,0xF0,0x0F,0x00,0xFE,0x00,0x00,0x0E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // /
+0x00,0x00,0x00,0xF0,0x0F,0x00,0xFC,0x3F,0x00,0x0E,0x70,0x00,0x86,0x61,0x00,0x86,0x61,0x00,0x0E,0x70,0x00,0xFC,0x3F,0x00,0xF0,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 0
+0x00,0x00,0x00,0x00,0x00,0x00,0x30,0x00,0x00,0x18,0x00,0x00,0x0C,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 1
+0x00,0x00,0x00,0x38,0x70,0x00,0x3C,0x78,0x00,0x0E,0x6C,0x00,0x06,0x66,0x00,0x06,0x63,0x00,0x8E,0x61,0x00,0xFC,0x60,0x00,0x78,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 2
+0x00,0x00,0x00,0x18,0x18,0x00,0x1C,0x38,0x00,0x06,0x70,0x00,0xC6,0x60,0x00,0xC6,0x60,0x00,0xFC,0x71,0x00,0x38,0x3F,0x00,0x00,0x1E,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 3
+0x00,0x00,0x00,0x00,0x0E,0x00,0x80,0x0F,0x00,0xF0,0x0D,0x00,0x3C,0x0C,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x00,0x0C,0x00,0x00,0x0C,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 4
+0x00,0x00,0x00,0xFE,0x19,0x00,0xFE,0x39,0x00,0x86,0x70,0x00,0xC6,0x60,0x00,0xC6,0x60,0x00,0xC6,0x71,0x00,0x86,0x3F,0x00,0x00,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 5
+0x00,0x00,0x00,0xF0,0x0F,0x00,0xFC,0x3F,0x00,0x8E,0x71,0x00,0xC6,0x60,0x00,0xC6,0x60,0x00,0xCE,0x71,0x00,0x9C,0x3F,0x00,0x18,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 6
+0x00,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0x06,0x70,0x00,0x06,0x7F,0x00,0xC6,0x07,0x00,0xF6,0x00,0x00,0x3E,0x00,0x00,0x0E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 7
+0x00,0x00,0x00,0x38,0x1E,0x00,0x7C,0x3F,0x00,0x86,0x61,0x00,0x86,0x61,0x00,0x86,0x61,0x00,0x8E,0x61,0x00,0x7C,0x3F,0x00,0x38,0x1E,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 8
+0x00,0x00,0x00,0xF8,0x18,0x00,0xFC,0x39,0x00,0x8E,0x73,0x00,0x06,0x63,0x00,0x06,0x63,0x00,0x8E,0x71,0x00,0xFC,0x3F,0x00,0xF0,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // 9
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x60,0x60,0x00,0x60,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // :
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0x60,0x02,0xC0,0xE0,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // ;
+0x00,0x00,0x00,0x00,0x01,0x00,0x80,0x03,0x00,0x80,0x02,0x00,0xC0,0x06,0x00,0x40,0x04,0x00,0x60,0x0C,0x00,0x20,0x08,0x00,0x30,0x18,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // <
+0x00,0x00,0x00,0x60,0x06,0x00,0x60,0x06,0x00,0x60,0x06,0x00,0x60,0x06,0x00,0x60,0x06,0x00,0x60,0x06,0x00,0x60,0x06,0x00,0x60,0x06,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // =
+0x00,0x00,0x00,0x30,0x18,0x00,0x20,0x08,0x00,0x60,0x0C,0x00,0x40,0x04,0x00,0xC0,0x06,0x00,0x80,0x02,0x00,0x80,0x03,0x00,0x00,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // >
+0x00,0x00,0x00,0x18,0x00,0x00,0x1C,0x00,0x00,0x0E,0x00,0x00,0x06,0x6E,0x00,0x06,0x6F,0x00,0x86,0x03,0x00,0xCE,0x01,0x00,0xFC,0x00,0x00,0x78,0x00,0x00,0x00,0x00,0x00, // ?
+0x00,0x00,0x00,0xF0,0x0F,0x00,0xFC,0x3F,0x00,0x1E,0x70,0x00,0xC6,0x63,0x00,0xC6,0x67,0x00,0x66,0x36,0x00,0xFC,0x07,0x00,0xF8,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // @
+0x00,0x00,0x00,0x00,0x70,0x00,0x80,0x7F,0x00,0xF8,0x0F,0x00,0x7E,0x06,0x00,0x06,0x06,0x00,0x7E,0x06,0x00,0xF8,0x0F,0x00,0x80,0x7F,0x00,0x00,0x70,0x00,0x00,0x00,0x00, // A
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x86,0x61,0x00,0x86,0x61,0x00,0x86,0x61,0x00,0xFC,0x73,0x00,0x78,0x3E,0x00,0x00,0x1C,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // B
+0x00,0x00,0x00,0xF0,0x0F,0x00,0xFC,0x3F,0x00,0x0E,0x70,0x00,0x06,0x60,0x00,0x06,0x60,0x00,0x06,0x60,0x00,0x1C,0x38,0x00,0x18,0x18,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // C
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x06,0x60,0x00,0x06,0x60,0x00,0x06,0x60,0x00,0x1C,0x38,0x00,0xFC,0x1F,0x00,0xF0,0x07,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // D
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x86,0x61,0x00,0x86,0x61,0x00,0x86,0x61,0x00,0x86,0x61,0x00,0x86,0x61,0x00,0x06,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // E
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x86,0x01,0x00,0x86,0x01,0x00,0x86,0x01,0x00,0x86,0x01,0x00,0x86,0x01,0x00,0x06,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // F
+0x00,0x00,0x00,0xF0,0x0F,0x00,0xFC,0x3F,0x00,0x0E,0x70,0x00,0x06,0x60,0x00,0x06,0x60,0x00,0x06,0x63,0x00,0x1C,0x3F,0x00,0x18,0x3F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // G
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // H
+0x00,0x00,0x00,0x00,0x00,0x00,0x06,0x60,0x00,0x06,0x60,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x06,0x60,0x00,0x06,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // I
+0x00,0x00,0x00,0x00,0x1C,0x00,0x00,0x3C,0x00,0x00,0x70,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x70,0x00,0xFE,0x3F,0x00,0xFE,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // J
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x80,0x01,0x00,0xC0,0x01,0x00,0x70,0x07,0x00,0x38,0x0E,0x00,0x0C,0x38,0x00,0x06,0x70,0x00,0x02,0x40,0x00,0x00,0x00,0x00, // K
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // L
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x1E,0x00,0x00,0xF8,0x00,0x00,0x80,0x01,0x00,0xF8,0x00,0x00,0x0E,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x00,0x00,0x00, // M
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x3E,0x00,0x00,0xF8,0x01,0x00,0xC0,0x1F,0x00,0x00,0x7C,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // N
+0x00,0x00,0x00,0xF0,0x0F,0x00,0xFC,0x3F,0x00,0x0E,0x70,0x00,0x06,0x60,0x00,0x06,0x60,0x00,0x0E,0x70,0x00,0xFC,0x3F,0x00,0xF0,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // O
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x06,0x03,0x00,0x06,0x03,0x00,0x06,0x03,0x00,0x8E,0x03,0x00,0xFC,0x01,0x00,0xF8,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // P
+0x00,0x00,0x00,0xF0,0x0F,0x00,0xFC,0x3F,0x00,0x0E,0x70,0x00,0x06,0x60,0x00,0x06,0x6C,0x00,0x0E,0x78,0x00,0xFC,0x3F,0x00,0xF0,0x2F,0x00,0x00,0x40,0x00,0x00,0x00,0x00, // Q
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x86,0x01,0x00,0x86,0x01,0x00,0x86,0x03,0x00,0xCE,0x0F,0x00,0xFC,0x3C,0x00,0x78,0x70,0x00,0x00,0x40,0x00,0x00,0x00,0x00, // R
+0x00,0x00,0x00,0x00,0x0C,0x00,0x78,0x3C,0x00,0xFC,0x70,0x00,0xC6,0x60,0x00,0x86,0x61,0x00,0x86,0x63,0x00,0x1C,0x3F,0x00,0x18,0x1E,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // S
+0x06,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0x00,0x00,0x00, // T
+0x00,0x00,0x00,0xFE,0x1F,0x00,0xFE,0x3F,0x00,0x00,0x70,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x70,0x00,0xFE,0x3F,0x00,0xFE,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // U
+0x00,0x00,0x00,0x0E,0x00,0x00,0x7E,0x00,0x00,0xF0,0x07,0x00,0x80,0x3F,0x00,0x00,0x78,0x00,0x80,0x3F,0x00,0xF0,0x07,0x00,0x7E,0x00,0x00,0x0E,0x00,0x00,0x00,0x00,0x00, // V
+0x7E,0x00,0x00,0xFE,0x7F,0x00,0x00,0x70,0x00,0x00,0x1E,0x00,0xC0,0x03,0x00,0xC0,0x03,0x00,0x00,0x1E,0x00,0x00,0x70,0x00,0xFE,0x7F,0x00,0x7E,0x00,0x00,0x00,0x00,0x00, // W
+0x02,0x40,0x00,0x0E,0x70,0x00,0x3C,0x38,0x00,0x70,0x1E,0x00,0xE0,0x0F,0x00,0xC0,0x07,0x00,0x70,0x0E,0x00,0x38,0x3C,0x00,0x0E,0x70,0x00,0x02,0x40,0x00,0x00,0x00,0x00, // X
+0x02,0x00,0x00,0x0E,0x00,0x00,0x3C,0x00,0x00,0xF0,0x00,0x00,0xC0,0x7F,0x00,0xC0,0x7F,0x00,0xF0,0x00,0x00,0x3C,0x00,0x00,0x0E,0x00,0x00,0x02,0x00,0x00,0x00,0x00,0x00, // Y
+0x00,0x00,0x00,0x00,0x70,0x00,0x06,0x78,0x00,0x06,0x6E,0x00,0x86,0x67,0x00,0xC6,0x61,0x00,0x76,0x60,0x00,0x3E,0x60,0x00,0x0E,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // Z
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0x03,0xFF,0xFF,0x03,0x03,0x00,0x03,0x03,0x00,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // [
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0E,0x00,0x00,0xFE,0x00,0x00,0xF0,0x0F,0x00,0x00,0x7F,0x00,0x00,0x70,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, /* \ */
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x00,0x03,0x03,0x00,0x03,0xFF,0xFF,0x03,0xFF,0xFF,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // ]
+0x00,0x00,0x00,0x80,0x01,0x00,0xE0,0x01,0x00,0x78,0x00,0x00,0x0E,0x00,0x00,0x0E,0x00,0x00,0x78,0x00,0x00,0xE0,0x01,0x00,0x80,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // ^
+0x00,0x00,0x01,0x00,0x00,0x01,0x00,0x00,0x01,0x00,0x00,0x01,0x00,0x00,0x01,0x00,0x00,0x01,0x00,0x00,0x01,0x00,0x00,0x01,0x00,0x00,0x01,0x00,0x00,0x01,0x00,0x00,0x01, // _
+0x00,0x00,0x00,0x00,0x00,0x00,0x02,0x00,0x00,0x06,0x00,0x00,0x0E,0x00,0x00,0x08,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // `
+0x00,0x00,0x00,0x80,0x38,0x00,0xC0,0x7C,0x00,0x60,0x66,0x00,0x60,0x66,0x00,0x60,0x26,0x00,0x60,0x36,0x00,0xE0,0x3F,0x00,0xC0,0x7F,0x00,0x00,0x40,0x00,0x00,0x00,0x00, // a
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0xC0,0x30,0x00,0x60,0x60,0x00,0x60,0x60,0x00,0xE0,0x70,0x00,0xC0,0x3F,0x00,0x80,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // b
+0x00,0x00,0x00,0x80,0x1F,0x00,0xC0,0x3F,0x00,0xE0,0x70,0x00,0x60,0x60,0x00,0x60,0x60,0x00,0xE0,0x70,0x00,0xC0,0x39,0x00,0x80,0x19,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // c
+0x00,0x00,0x00,0x80,0x1F,0x00,0xC0,0x3F,0x00,0xE0,0x70,0x00,0x60,0x60,0x00,0x60,0x60,0x00,0xC0,0x30,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // d
+0x00,0x00,0x00,0x80,0x1F,0x00,0xC0,0x3F,0x00,0xE0,0x76,0x00,0x60,0x66,0x00,0x60,0x66,0x00,0xE0,0x66,0x00,0xC0,0x37,0x00,0x00,0x17,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // e
+0x00,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0xFC,0x7F,0x00,0xFE,0x7F,0x00,0x66,0x00,0x00,0x66,0x00,0x00,0x66,0x00,0x00,0x06,0x00,0x00,0x00,0x00,0x00, // f
+0x00,0x00,0x00,0xC0,0x8F,0x01,0xE0,0x9F,0x03,0x70,0x38,0x03,0x30,0x30,0x03,0x30,0x30,0x03,0x60,0x98,0x03,0xF0,0xFF,0x01,0xF0,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // g
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0xC0,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0xE0,0x7F,0x00,0xC0,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // h
+0x00,0x00,0x00,0x00,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0xE6,0x7F,0x00,0xE6,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // i
+0x00,0x00,0x00,0x00,0x80,0x01,0x30,0x00,0x03,0x30,0x00,0x03,0x30,0x00,0x03,0xF3,0xFF,0x03,0xF3,0xFF,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // j
+0x00,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x00,0x06,0x00,0x00,0x03,0x00,0x80,0x07,0x00,0xC0,0x1C,0x00,0x60,0x38,0x00,0x20,0x60,0x00,0x00,0x40,0x00,0x00,0x00,0x00, // k
+0x00,0x00,0x00,0x00,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0x06,0x00,0x00,0xFE,0x7F,0x00,0xFE,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // l
+0xE0,0x7F,0x00,0xE0,0x7F,0x00,0x40,0x00,0x00,0x60,0x00,0x00,0xE0,0x7F,0x00,0xE0,0x7F,0x00,0xC0,0x00,0x00,0x60,0x00,0x00,0xE0,0x7F,0x00,0xC0,0x7F,0x00,0x00,0x00,0x00, // m
+0x00,0x00,0x00,0xE0,0x7F,0x00,0xE0,0x7F,0x00,0xC0,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0xE0,0x7F,0x00,0xC0,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // n
+0x00,0x00,0x00,0x80,0x1F,0x00,0xC0,0x3F,0x00,0xE0,0x70,0x00,0x60,0x60,0x00,0x60,0x60,0x00,0xE0,0x70,0x00,0xC0,0x3F,0x00,0x80,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // o
+0x00,0x00,0x00,0xF0,0xFF,0x03,0xF0,0xFF,0x03,0x60,0x18,0x00,0x30,0x30,0x00,0x30,0x30,0x00,0x70,0x38,0x00,0xE0,0x1F,0x00,0xC0,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // p
+0x00,0x00,0x00,0xC0,0x0F,0x00,0xE0,0x1F,0x00,0x70,0x38,0x00,0x30,0x30,0x00,0x30,0x30,0x00,0x60,0x18,0x00,0xF0,0xFF,0x03,0xF0,0xFF,0x03,0x00,0x00,0x00,0x00,0x00,0x00, // q
+0x00,0x00,0x00,0x20,0x00,0x00,0xE0,0x7F,0x00,0xC0,0x7F,0x00,0xC0,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0xE0,0x00,0x00,0x40,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // r
+0x00,0x00,0x00,0x80,0x33,0x00,0xC0,0x37,0x00,0x60,0x66,0x00,0x60,0x66,0x00,0x60,0x66,0x00,0x60,0x66,0x00,0xC0,0x3E,0x00,0xC0,0x1C,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // s
+0x00,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0xF8,0x3F,0x00,0xFC,0x7F,0x00,0x60,0x60,0x00,0x60,0x60,0x00,0x60,0x60,0x00,0x00,0x60,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // t
+0x00,0x00,0x00,0xE0,0x3F,0x00,0xE0,0x7F,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x60,0x00,0x00,0x30,0x00,0xE0,0x7F,0x00,0xE0,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // u
+0x00,0x00,0x00,0x20,0x00,0x00,0xE0,0x01,0x00,0xC0,0x0F,0x00,0x00,0x3E,0x00,0x00,0x70,0x00,0x00,0x7E,0x00,0xC0,0x0F,0x00,0xE0,0x01,0x00,0x20,0x00,0x00,0x00,0x00,0x00, // v
+0xE0,0x00,0x00,0xE0,0x1F,0x00,0x00,0x78,0x00,0xE0,0x1F,0x00,0xE0,0x00,0x00,0xE0,0x1F,0x00,0x00,0x78,0x00,0xE0,0x1F,0x00,0xE0,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // w
+0x00,0x00,0x00,0x20,0x40,0x00,0xE0,0x70,0x00,0xC0,0x39,0x00,0x00,0x0F,0x00,0x00,0x0F,0x00,0xC0,0x39,0x00,0xE0,0x70,0x00,0x20,0x40,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // x
+0x00,0x00,0x00,0x30,0x00,0x03,0xF0,0x01,0x03,0xC0,0x8F,0x03,0x00,0xFE,0x01,0x00,0xF0,0x01,0x80,0x7F,0x00,0xF0,0x0F,0x00,0x70,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // y
+0x00,0x00,0x00,0x60,0x60,0x00,0x60,0x70,0x00,0x60,0x78,0x00,0x60,0x6C,0x00,0x60,0x66,0x00,0x60,0x63,0x00,0xE0,0x61,0x00,0xE0,0x60,0x00,0x60,0x60,0x00,0x00,0x00,0x00, // z
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x00,0x80,0x07,0x00,0xFE,0xFF,0x01,0xFF,0xFC,0x03,0x03,0x00,0x03,0x03,0x00,0x03,0x00,0x00,0x00,0x00,0x00,0x00, // {
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0x03,0xFF,0xFF,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // |
+0x00,0x00,0x00,0x00,0x00,0x00,0x03,0x00,0x03,0x03,0x00,0x03,0xFF,0xFC,0x03,0xFE,0xFF,0x01,0x80,0x07,0x00,0x00,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // }
+0x00,0x00,0x00,0x00,0x03,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0x80,0x01,0x00,0x00,0x03,0x00,0x00,0x03,0x00,0x00,0x03,0x00,0x80,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // ~
+};
+
+const uint8_t Font16x26Pages [] = {
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // sp
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x03,0x1C,0x00,0xFF,0x7F,0x1C,0x00,0xFF,0x7F,0x1C,0x00,0xFF,0x7F,0x1C,0x00,0xFF,0x00,0x1C,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // !
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // "
+0x00,0x60,0x00,0x00,0x80,0x60,0x00,0x00,0xC0,0x60,0x1C,0x00,0xC0,0xE0,0x1F,0x00,0xC0,0xFE,0x1F,0x00,0xE0,0xFF,0x0F,0x00,0xFE,0xFF,0x00,0x00,0xFF,0x6F,0x18,0x00,0xFF,0xE0,0x1F,0x00,0xC7,0xFC,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xFC,0xFF,0x01,0x00,0xFF,0x7F,0x00,0x00,0xFF,0x60,0x00,0x00,0xCF,0x60,0x00,0x00,0xC0,0x60,0x00,0x00, // #
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0C,0x00,0xFC,0x00,0x0C,0x00,0xFE,0x01,0x1C,0x00,0xFE,0x03,0x1C,0x00,0xFF,0x07,0x18,0x00,0x87,0xFF,0x7F,0x00,0xFF,0xFF,0x7F,0x00,0xFF,0xFF,0x7F,0x00,0xFF,0xFF,0x7F,0x00,0x03,0xFC,0x1F,0x00,0x07,0xF8,0x0F,0x00,0x07,0xF8,0x0F,0x00,0x06,0xF0,0x07,0x00,0x00,0x00,0x00,0x00, // $
+0xFE,0x01,0x18,0x00,0xFE,0x01,0x1C,0x00,0xFF,0x03,0x1F,0x00,0x03,0x83,0x0F,0x00,0x01,0xC2,0x07,0x00,0xCF,0xF3,0x01,0x00,0xFF,0xFB,0x00,0x00,0xFE,0x7F,0x00,0x00,0xFC,0xFF,0x07,0x00,0x80,0xFF,0x0F,0x00,0xE0,0xFB,0x1F,0x00,0xF0,0xF9,0x1F,0x00,0xFC,0x18,0x18,0x00,0x3E,0x18,0x18,0x00,0x1F,0xF8,0x1F,0x00,0x07,0xF8,0x1F,0x00, // %
+0x00,0xF8,0x03,0x00,0x00,0xFC,0x07,0x00,0x00,0xFC,0x0F,0x00,0x38,0xFE,0x1F,0x00,0xFE,0x0F,0x1E,0x00,0xFF,0x07,0x1C,0x00,0xFF,0x1F,0x18,0x00,0xFF,0x3F,0x18,0x00,0x83,0xFF,0x18,0x00,0xFF,0xFD,0x1D,0x00,0xFF,0xF1,0x1F,0x00,0xFE,0xE0,0x0F,0x00,0x7E,0x80,0x1F,0x00,0x00,0xF0,0x1F,0x00,0x00,0xFC,0x1F,0x00,0x00,0xFC,0x1D,0x00, // &
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3F,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // '
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x00,0x00,0xE0,0xFF,0x07,0x00,0xF0,0xFF,0x0F,0x00,0xFC,0xFF,0x3F,0x00,0xFC,0x81,0x3F,0x00,0x3E,0x00,0x7C,0x00,0x0F,0x00,0xF0,0x00,0x07,0x00,0xE0,0x00,0x03,0x00,0xC0,0x01,0x03,0x00,0xC0,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01, // (
+0x00,0x00,0x00,0x00,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x03,0x00,0xC0,0x01,0x03,0x00,0xC0,0x01,0x07,0x00,0xE0,0x00,0x0F,0x00,0xF0,0x00,0x3E,0x00,0x7C,0x00,0xFC,0x81,0x3F,0x00,0xFC,0xFF,0x3F,0x00,0xF0,0xFF,0x0F,0x00,0xE0,0xFF,0x07,0x00,0x00,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // )
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x38,0x00,0x00,0x00,0x38,0x04,0x00,0x00,0x38,0x06,0x00,0x00,0x30,0x0F,0x00,0x00,0xF3,0x0F,0x00,0x00,0xFF,0x07,0x00,0x00,0x1F,0x01,0x00,0x00,0xBF,0x03,0x00,0x00,0xF1,0x0F,0x00,0x00,0xB0,0x0F,0x00,0x00,0x38,0x0F,0x00,0x00,0x38,0x04,0x00,0x00,0x38,0x00,0x00,0x00,0x30,0x00,0x00,0x00, // *
+0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00, // +
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1E,0x02,0x00,0x00,0xFE,0x03,0x00,0x00,0xFE,0x03,0x00,0x00,0xFE,0x01,0x00,0x00,0xFE,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // ,
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x00,0x00,0x00, // -
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // .
+0x00,0x00,0x00,0x01,0x00,0x00,0xC0,0x01,0x00,0x00,0xF0,0x01,0x00,0x00,0xFC,0x01,0x00,0x00,0xFF,0x00,0x00,0xC0,0x3F,0x00,0x00,0xF0,0x0F,0x00,0x00,0xFC,0x03,0x00,0x00,0xFF,0x00,0x00,0xC0,0x3F,0x00,0x00,0xF0,0x0F,0x00,0x00,0xFC,0x03,0x00,0x00,0xFF,0x00,0x00,0x00,0x3F,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x03,0x00,0x00,0x00, // /
+0x00,0x00,0x00,0x00,0xE0,0xFF,0x00,0x00,0xF8,0xFF,0x03,0x00,0xFC,0xFF,0x07,0x00,0xFE,0xFF,0x0F,0x00,0x7F,0xC0,0x1F,0x00,0x0F,0x00,0x1E,0x00,0x07,0x00,0x1C,0x00,0x03,0x00,0x18,0x00,0x07,0x00,0x1C,0x00,0x0F,0x00,0x1E,0x00,0x7F,0xC0,0x1F,0x00,0xFE,0xFF,0x0F,0x00,0xFC,0xFF,0x07,0x00,0xF8,0xFF,0x03,0x00,0xE0,0xFF,0x00,0x00, // 0
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0C,0x00,0x18,0x00,0x0C,0x00,0x18,0x00,0x0C,0x00,0x18,0x00,0x0E,0x00,0x18,0x00,0x0E,0x00,0x18,0x00,0xFE,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00, // 1
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x06,0x00,0x1E,0x00,0x06,0x00,0x1F,0x00,0x07,0x80,0x1F,0x00,0x07,0xE0,0x1F,0x00,0x03,0xF0,0x1B,0x00,0x03,0xF8,0x18,0x00,0x03,0x7C,0x18,0x00,0x07,0x3E,0x18,0x00,0xFF,0x1F,0x18,0x00,0xFE,0x0F,0x18,0x00,0xFE,0x07,0x18,0x00,0xFC,0x03,0x18,0x00,0x70,0x00,0x18,0x00,0x00,0x00,0x00,0x00, // 2
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x06,0x00,0x1C,0x00,0x07,0x06,0x1C,0x00,0x07,0x06,0x1C,0x00,0x03,0x06,0x18,0x00,0x03,0x06,0x18,0x00,0x03,0x07,0x18,0x00,0x07,0x0F,0x1C,0x00,0xFF,0x1F,0x1E,0x00,0xFF,0xFF,0x0F,0x00,0xFE,0xFD,0x0F,0x00,0xFC,0xF8,0x07,0x00,0x38,0xF0,0x03,0x00,0x00,0x00,0x00,0x00, // 3
+0x00,0x60,0x00,0x00,0x00,0x78,0x00,0x00,0x00,0x7C,0x00,0x00,0x00,0x7F,0x00,0x00,0x80,0x7F,0x00,0x00,0xE0,0x67,0x00,0x00,0xF0,0x63,0x00,0x00,0xF8,0x60,0x00,0x00,0x7E,0x60,0x00,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00, // 4
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x03,0x1C,0x00,0xFF,0x03,0x1C,0x00,0xFF,0x03,0x1C,0x00,0xFF,0x03,0x18,0x00,0x07,0x03,0x18,0x00,0x07,0x07,0x18,0x00,0x07,0x0F,0x1C,0x00,0x07,0xBF,0x1F,0x00,0x07,0xFE,0x0F,0x00,0x07,0xFE,0x0F,0x00,0x07,0xFC,0x07,0x00,0x00,0xF0,0x01,0x00,0x00,0x00,0x00,0x00, // 5
+0x00,0x00,0x00,0x00,0x00,0x0C,0x00,0x00,0xE0,0xFF,0x01,0x00,0xF8,0xFF,0x07,0x00,0xFC,0xFF,0x0F,0x00,0xFE,0xFF,0x0F,0x00,0x3E,0x0E,0x1F,0x00,0x0F,0x07,0x1C,0x00,0x07,0x03,0x18,0x00,0x03,0x03,0x18,0x00,0x03,0x07,0x1C,0x00,0x03,0x0F,0x1E,0x00,0x07,0xFF,0x0F,0x00,0x07,0xFE,0x0F,0x00,0x06,0xFC,0x07,0x00,0x00,0xF8,0x03,0x00, // 6
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x07,0x00,0x00,0x00,0x07,0x00,0x18,0x00,0x07,0x00,0x1F,0x00,0x07,0x80,0x1F,0x00,0x07,0xE0,0x1F,0x00,0x07,0xF8,0x1F,0x00,0x07,0xFE,0x03,0x00,0x07,0x7F,0x00,0x00,0xC7,0x1F,0x00,0x00,0xF7,0x07,0x00,0x00,0xFF,0x01,0x00,0x00,0x7F,0x00,0x00,0x00,0x3F,0x00,0x00,0x00,0x0F,0x00,0x00,0x00, // 7
+0x00,0x00,0x00,0x00,0x00,0xC0,0x01,0x00,0x30,0xF0,0x07,0x00,0xFC,0xF8,0x0F,0x00,0xFE,0xFD,0x0F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0x1F,0x1C,0x00,0x87,0x07,0x1C,0x00,0x03,0x0F,0x18,0x00,0x03,0x0F,0x18,0x00,0x87,0x1F,0x1C,0x00,0xFF,0x7F,0x1E,0x00,0xFF,0xFD,0x0F,0x00,0xFE,0xF8,0x0F,0x00,0x7C,0xF0,0x07,0x00,0x00,0xE0,0x03,0x00, // 8
+0x00,0x00,0x00,0x00,0xE0,0x01,0x00,0x00,0xF8,0x07,0x0C,0x00,0xFC,0x0F,0x1C,0x00,0xFE,0x0F,0x1C,0x00,0xFF,0x1F,0x18,0x00,0x07,0x1C,0x18,0x00,0x03,0x18,0x18,0x00,0x03,0x18,0x1C,0x00,0x07,0x18,0x1C,0x00,0x0F,0x1C,0x1F,0x00,0xFF,0xEF,0x0F,0x00,0xFE,0xFF,0x07,0x00,0xFC,0xFF,0x03,0x00,0xF8,0xFF,0x01,0x00,0xE0,0x3F,0x00,0x00, // 9
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0x03,0x1E,0x00,0xC0,0x03,0x1E,0x00,0xC0,0x03,0x1E,0x00,0xC0,0x03,0x1E,0x00,0xC0,0x03,0x1E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // :
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0x03,0x1E,0x03,0xC0,0x03,0xFE,0x03,0xC0,0x03,0xFE,0x03,0xC0,0x03,0xFE,0x01,0xC0,0x03,0xFE,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // ;
+0x00,0x20,0x00,0x00,0x00,0x20,0x00,0x00,0x00,0x70,0x00,0x00,0x00,0x70,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0xFC,0x01,0x00,0x00,0xDC,0x01,0x00,0x00,0x8E,0x03,0x00,0x00,0x8E,0x03,0x00,0x00,0x07,0x07,0x00,0x00,0x07,0x07,0x00,0x80,0x03,0x0E,0x00,0x80,0x03,0x0E,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x01,0x1C,0x00, // <
+0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00,0x00,0x8C,0x01,0x00, // =
+0xC0,0x00,0x18,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x01,0x1C,0x00,0x80,0x03,0x0E,0x00,0x80,0x03,0x0E,0x00,0x00,0x07,0x07,0x00,0x00,0x07,0x07,0x00,0x00,0x8E,0x03,0x00,0x00,0x8E,0x03,0x00,0x00,0xDC,0x01,0x00,0x00,0xDC,0x01,0x00,0x00,0xF8,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0x70,0x00,0x00,0x00,0x70,0x00,0x00,0x00,0x20,0x00,0x00, // >
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,0x1F,0x00,0x00,0x00,0x1F,0x00,0x00,0x00,0x03,0x60,0x1C,0x00,0x03,0x78,0x1C,0x00,0x03,0x7C,0x1C,0x00,0x03,0x7E,0x1C,0x00,0x03,0x7F,0x1C,0x00,0x87,0x07,0x00,0x00,0xFF,0x03,0x00,0x00,0xFE,0x01,0x00,0x00,0xFE,0x00,0x00,0x00,0x7C,0x00,0x00,0x00,0x18,0x00,0x00,0x00, // ?
+0x00,0x3F,0x00,0x00,0xE0,0xFF,0x01,0x00,0xF8,0xFF,0x03,0x00,0xFC,0xFF,0x07,0x00,0x7E,0x80,0x0F,0x00,0x1E,0x00,0x0E,0x00,0x8F,0xFF,0x1C,0x00,0xC7,0xFF,0x1D,0x00,0xE3,0xFF,0x19,0x00,0xF3,0xC1,0x19,0x00,0x73,0xC0,0x19,0x00,0x37,0xF0,0x1D,0x00,0x7F,0xFE,0x1C,0x00,0xFE,0xFF,0x0D,0x00,0xFE,0xFF,0x01,0x00,0xF8,0xFF,0x01,0x00, // @
+0x00,0x00,0x1C,0x00,0x00,0x00,0x1F,0x00,0x00,0xE0,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xFF,0x03,0x00,0xE0,0xFF,0x00,0x00,0xF8,0xDF,0x00,0x00,0xF8,0xC3,0x00,0x00,0xF8,0xC0,0x00,0x00,0xF8,0xC7,0x00,0x00,0xF8,0xFF,0x00,0x00,0xE0,0xFF,0x01,0x00,0x00,0xFF,0x07,0x00,0x00,0xFC,0x1F,0x00,0x00,0xE0,0x1F,0x00,0x00,0x80,0x1F,0x00, // A
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x3C,0x18,0x00,0x38,0x3E,0x18,0x00,0xF8,0xFF,0x1C,0x00,0xF8,0xF7,0x1F,0x00,0xF0,0xE7,0x0F,0x00,0xE0,0xE3,0x0F,0x00,0x00,0xC0,0x07,0x00, // B
+0x00,0x00,0x00,0x00,0x00,0xFF,0x00,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xFF,0x07,0x00,0xE0,0xFF,0x07,0x00,0xF0,0xC1,0x0F,0x00,0x70,0x00,0x0F,0x00,0x38,0x00,0x1E,0x00,0x38,0x00,0x1C,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x38,0x00,0x18,0x00,0x38,0x00,0x1C,0x00,0x38,0x00,0x1C,0x00, // C
+0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x38,0x00,0x1C,0x00,0x38,0x00,0x1C,0x00,0xF8,0x00,0x0F,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0xFF,0x07,0x00,0xE0,0xFF,0x07,0x00,0xC0,0xFF,0x01,0x00, // D
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00,0x18,0x00,0x18,0x00, // E
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00,0x18,0x18,0x00,0x00, // F
+0x00,0x3C,0x00,0x00,0x80,0xFF,0x01,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xFF,0x07,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0x81,0x0F,0x00,0x78,0x00,0x1E,0x00,0x38,0x00,0x1C,0x00,0x38,0x00,0x1C,0x00,0x18,0x30,0x18,0x00,0x18,0x30,0x18,0x00,0x18,0x30,0x18,0x00,0x18,0xF0,0x1F,0x00,0x38,0xF0,0x1F,0x00,0x38,0xF0,0x1F,0x00,0x30,0xF0,0x0F,0x00, // G
+0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00, // H
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00, // I
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x1C,0x00,0x18,0x00,0x1C,0x00,0x18,0x00,0x1C,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x1C,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x07,0x00,0xF8,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // J
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x00,0x3E,0x00,0x00,0x00,0x7F,0x00,0x00,0x80,0xFF,0x00,0x00,0xC0,0xF7,0x03,0x00,0xE0,0xE3,0x07,0x00,0xF8,0xC0,0x0F,0x00,0x78,0x00,0x1F,0x00,0x38,0x00,0x1E,0x00,0x18,0x00,0x1C,0x00,0x08,0x00,0x18,0x00, // K
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00, // L
+0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0x0F,0x00,0x00,0xF0,0x3F,0x00,0x00,0xC0,0xFF,0x01,0x00,0x00,0xFE,0x01,0x00,0x00,0xF0,0x01,0x00,0x00,0xFE,0x01,0x00,0xC0,0xFF,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF8,0x03,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00, // M
+0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0x07,0x00,0x00,0xE0,0x0F,0x00,0x00,0xC0,0x3F,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0xFC,0x01,0x00,0x00,0xF8,0x07,0x00,0x00,0xE0,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00, // N
+0x00,0x7E,0x00,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xFF,0x07,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0xFF,0x0F,0x00,0x78,0x00,0x1E,0x00,0x38,0x00,0x1C,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x38,0x00,0x1C,0x00,0x78,0x00,0x1E,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0xFF,0x0F,0x00,0xE0,0xFF,0x07,0x00,0xC0,0xFF,0x03,0x00, // O
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x30,0x00,0x00,0x18,0x30,0x00,0x00,0x18,0x30,0x00,0x00,0x18,0x38,0x00,0x00,0x38,0x3C,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF0,0x0F,0x00,0x00,0xF0,0x0F,0x00,0x00, // P
+0x00,0x7E,0x00,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xFF,0x07,0x00,0xF0,0xFF,0x0F,0x00,0xF0,0xFF,0x0F,0x00,0x78,0x00,0x1E,0x00,0x38,0x00,0x1C,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x18,0x00,0x38,0x00,0x38,0x00,0x7C,0x00,0x78,0x00,0x7E,0x00,0xF0,0xFF,0xFF,0x00,0xF0,0xFF,0xEF,0x00,0xE0,0xFF,0xC7,0x01,0xC0,0xFF,0xC3,0x01, // Q
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x30,0x00,0x00,0x18,0x70,0x00,0x00,0x18,0xF8,0x00,0x00,0x38,0xF8,0x01,0x00,0x78,0xFE,0x03,0x00,0xF8,0xDF,0x0F,0x00,0xF0,0x8F,0x1F,0x00,0xF0,0x0F,0x1F,0x00,0xE0,0x03,0x1E,0x00,0x00,0x00,0x18,0x00, // R
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xE0,0x03,0x0E,0x00,0xF0,0x07,0x1C,0x00,0xF0,0x0F,0x1C,0x00,0xF8,0x0F,0x1C,0x00,0x38,0x1E,0x18,0x00,0x18,0x1C,0x18,0x00,0x18,0x1C,0x18,0x00,0x18,0x3C,0x18,0x00,0x18,0x38,0x1C,0x00,0x18,0x78,0x1E,0x00,0x38,0xF8,0x0F,0x00,0x38,0xF0,0x0F,0x00,0x30,0xF0,0x07,0x00,0x00,0xE0,0x03,0x00, // S
+0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00, // T
+0x00,0x00,0x00,0x00,0xF8,0xFF,0x00,0x00,0xF8,0xFF,0x07,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x1F,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x1F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x07,0x00,0xF8,0xFF,0x00,0x00, // U
+0x38,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0xF8,0x07,0x00,0x00,0xF8,0x3F,0x00,0x00,0xE0,0xFF,0x00,0x00,0x80,0xFF,0x07,0x00,0x00,0xFC,0x1F,0x00,0x00,0xF0,0x1F,0x00,0x00,0x80,0x1F,0x00,0x00,0xE0,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xFF,0x07,0x00,0xC0,0xFF,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF8,0x07,0x00,0x00,0xF8,0x00,0x00,0x00, // V
+0xF8,0x03,0x00,0x00,0xF8,0xFF,0x01,0x00,0xF8,0xFF,0x1F,0x00,0xF0,0xFF,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xF0,0x1F,0x00,0x80,0xFF,0x1F,0x00,0x80,0xFF,0x03,0x00,0x80,0x3F,0x00,0x00,0x80,0xFF,0x03,0x00,0x80,0xFF,0x1F,0x00,0x00,0xF8,0x1F,0x00,0x00,0xE0,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x00,0x00, // W
+0x08,0x00,0x10,0x00,0x18,0x00,0x1C,0x00,0x78,0x00,0x1E,0x00,0xF8,0x00,0x1F,0x00,0xF8,0xC1,0x0F,0x00,0xF0,0xE7,0x03,0x00,0xE0,0xFF,0x01,0x00,0x80,0xFF,0x00,0x00,0x00,0x7F,0x00,0x00,0x00,0xFF,0x01,0x00,0xC0,0xFF,0x03,0x00,0xE0,0xE3,0x07,0x00,0xF0,0xC1,0x1F,0x00,0xF8,0x80,0x1F,0x00,0x78,0x00,0x1E,0x00,0x18,0x00,0x1C,0x00, // X
+0x08,0x00,0x00,0x00,0x38,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0xF8,0x01,0x00,0x00,0xF8,0x07,0x00,0x00,0xE0,0x0F,0x00,0x00,0x80,0xFF,0x1F,0x00,0x00,0xFF,0x1F,0x00,0x00,0xFC,0x1F,0x00,0x00,0xFE,0x1F,0x00,0x00,0xFF,0x1F,0x00,0xC0,0x0F,0x00,0x00,0xE0,0x07,0x00,0x00,0xF8,0x01,0x00,0x00,0xF8,0x00,0x00,0x00,0x38,0x00,0x00,0x00, // Y
+0x00,0x00,0x00,0x00,0x18,0x00,0x1C,0x00,0x18,0x00,0x1E,0x00,0x18,0x00,0x1F,0x00,0x18,0xC0,0x1F,0x00,0x18,0xE0,0x1F,0x00,0x18,0xF0,0x1B,0x00,0x18,0xF8,0x18,0x00,0x18,0x7E,0x18,0x00,0x18,0x3F,0x18,0x00,0x98,0x1F,0x18,0x00,0xD8,0x07,0x18,0x00,0xF8,0x03,0x18,0x00,0xF8,0x01,0x18,0x00,0xF8,0x00,0x18,0x00,0x78,0x00,0x18,0x00, // Z
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x01,0xFF,0xFF,0xFF,0x01,0xFF,0xFF,0xFF,0x01,0xFF,0xFF,0xFF,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01, // [
+0x00,0x00,0x00,0x00,0x03,0x00,0x00,0x00,0x0F,0x00,0x00,0x00,0x3F,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0xFC,0x03,0x00,0x00,0xF0,0x0F,0x00,0x00,0xC0,0x3F,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0xFC,0x03,0x00,0x00,0xF0,0x0F,0x00,0x00,0xC0,0x3F,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0xFC,0x01,0x00,0x00,0xF0,0x01,0x00,0x00,0xC0,0x01, /* \ */
+0x00,0x00,0x00,0x00,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0xFF,0xFF,0xFF,0x01,0xFF,0xFF,0xFF,0x01,0xFF,0xFF,0xFF,0x01,0xFF,0xFF,0xFF,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // ]
+0x00,0x00,0x00,0x00,0x00,0x80,0x01,0x00,0x00,0xF0,0x01,0x00,0x00,0xFC,0x01,0x00,0x00,0xFF,0x01,0x00,0xE0,0x3F,0x00,0x00,0xF8,0x0F,0x00,0x00,0xFE,0x03,0x00,0x00,0x7F,0x00,0x00,0x00,0xFF,0x01,0x00,0x00,0xF8,0x0F,0x00,0x00,0xE0,0x3F,0x00,0x00,0x80,0xFF,0x00,0x00,0x00,0xFC,0x01,0x00,0x00,0xF0,0x01,0x00,0x00,0xC0,0x01,0x00, // ^
+0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00,0x00,0x00,0x60,0x00, // _
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // `
+0x00,0x00,0x00,0x00,0x00,0x80,0x07,0x00,0x80,0xC1,0x0F,0x00,0x80,0xE1,0x1F,0x00,0xC0,0xE1,0x1F,0x00,0xC0,0xF1,0x1E,0x00,0xC0,0x70,0x18,0x00,0xC0,0x30,0x18,0x00,0xC0,0x30,0x18,0x00,0xC0,0x31,0x1C,0x00,0xC0,0xFF,0x0F,0x00,0xC0,0xFF,0x0F,0x00,0xC0,0xFF,0x1F,0x00,0x80,0xFF,0x1F,0x00,0x00,0xFE,0x1F,0x00,0x00,0x00,0x18,0x00, // a
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x0F,0x00,0x80,0x03,0x1C,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x03,0x1F,0x00,0xC0,0xFF,0x0F,0x00,0x80,0xFF,0x0F,0x00,0x80,0xFF,0x07,0x00,0x00,0xFE,0x01,0x00, // b
+0x00,0x00,0x00,0x00,0x00,0x70,0x00,0x00,0x00,0xFE,0x03,0x00,0x00,0xFF,0x07,0x00,0x80,0xFF,0x0F,0x00,0x80,0xFF,0x0F,0x00,0xC0,0x07,0x1F,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x01,0x1C,0x00,0x80,0x01,0x0C,0x00, // c
+0x00,0x00,0x00,0x00,0x00,0xFC,0x01,0x00,0x00,0xFF,0x07,0x00,0x80,0xFF,0x0F,0x00,0x80,0xFF,0x1F,0x00,0xC0,0x9F,0x1F,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x1C,0x00,0xC0,0x01,0x0E,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00, // d
+0x00,0x00,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0xFE,0x03,0x00,0x00,0xFF,0x07,0x00,0x80,0xFF,0x0F,0x00,0x80,0xFF,0x0F,0x00,0xC0,0x33,0x1E,0x00,0xC0,0x31,0x1C,0x00,0xC0,0x30,0x18,0x00,0xC0,0x30,0x18,0x00,0xC0,0x31,0x18,0x00,0xC0,0x3F,0x18,0x00,0xC0,0x3F,0x18,0x00,0x80,0x3F,0x1C,0x00,0x00,0x3F,0x1C,0x00,0x00,0x3C,0x0C,0x00, // e
+0x00,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xF8,0xFF,0x1F,0x00,0xFE,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xC3,0x00,0x00,0x00,0xC1,0x00,0x00,0x00,0xC1,0x00,0x00,0x00,0xC1,0x00,0x00,0x00,0xC1,0x00,0x00,0x00,0xC3,0x00,0x00,0x00, // f
+0x00,0x00,0x00,0x00,0x00,0xFC,0x01,0x00,0x00,0xFF,0x07,0x03,0x80,0xFF,0x0F,0x03,0x80,0xFF,0x1F,0x03,0xC0,0x8F,0x1F,0x02,0xC0,0x01,0x1C,0x02,0xC0,0x00,0x18,0x02,0xC0,0x00,0x18,0x02,0xC0,0x01,0x1C,0x03,0xC0,0x01,0x0E,0x03,0x80,0xFF,0xFF,0x03,0xC0,0xFF,0xFF,0x03,0xC0,0xFF,0xFF,0x01,0xC0,0xFF,0xFF,0x00,0xC0,0xFF,0x1F,0x00, // g
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0x80,0x07,0x00,0x00,0xC0,0x03,0x00,0x00,0xC0,0x01,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x80,0xFF,0x1F,0x00,0x00,0xFE,0x1F,0x00, // h
+0x00,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC3,0xFF,0x1F,0x00,0xC3,0xFF,0x1F,0x00,0xC3,0xFF,0x1F,0x00,0xC3,0xFF,0x1F,0x00,0x03,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // i
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x03,0xC0,0x00,0x00,0x03,0xC0,0x00,0x00,0x03,0xC0,0x00,0x00,0x02,0xC0,0x00,0x00,0x02,0xC0,0x00,0x00,0x02,0xC0,0x00,0x00,0x03,0xC3,0xFF,0xFF,0x03,0xC3,0xFF,0xFF,0x03,0xC3,0xFF,0xFF,0x03,0xC3,0xFF,0xFF,0x01,0xC3,0xFF,0x7F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // j
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0x00,0x70,0x00,0x00,0x00,0xFC,0x00,0x00,0x00,0xFE,0x01,0x00,0x00,0xFF,0x03,0x00,0x80,0xCF,0x07,0x00,0xC0,0x87,0x1F,0x00,0xC0,0x03,0x1F,0x00,0xC0,0x01,0x1E,0x00,0xC0,0x00,0x1C,0x00,0x40,0x00,0x18,0x00, // k
+0x00,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0x01,0x00,0x00,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0xFF,0xFF,0x1F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // l
+0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x80,0x0F,0x00,0x00,0xC0,0x03,0x00,0x00,0xC0,0x07,0x00,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x80,0xFF,0x1F,0x00,0x80,0x0F,0x00,0x00,0xC0,0x03,0x00,0x00,0xC0,0x03,0x00,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x80,0xFF,0x1F,0x00, // m
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x80,0x07,0x00,0x00,0xC0,0x03,0x00,0x00,0xC0,0x01,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x80,0xFF,0x1F,0x00,0x00,0xFE,0x1F,0x00, // n
+0x00,0x00,0x00,0x00,0x00,0xFC,0x01,0x00,0x00,0xFF,0x07,0x00,0x80,0xFF,0x0F,0x00,0x80,0xFF,0x0F,0x00,0xC0,0x07,0x1F,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x07,0x1F,0x00,0x80,0xFF,0x0F,0x00,0x80,0xFF,0x0F,0x00,0x00,0xFF,0x07,0x00,0x00,0xFE,0x03,0x00, // o
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0xFF,0xFF,0x03,0xC0,0xFF,0xFF,0x03,0xC0,0xFF,0xFF,0x03,0xC0,0xFF,0xFF,0x03,0x80,0x03,0x1E,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x03,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x80,0xFF,0x0F,0x00,0x80,0xFF,0x07,0x00,0x00,0xFE,0x01,0x00, // p
+0x00,0x00,0x00,0x00,0x00,0xFC,0x03,0x00,0x00,0xFF,0x07,0x00,0x80,0xFF,0x0F,0x00,0x80,0xFF,0x1F,0x00,0xC0,0x07,0x1F,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x01,0x0E,0x00,0x80,0xFF,0xFF,0x03,0xC0,0xFF,0xFF,0x03,0xC0,0xFF,0xFF,0x03,0xC0,0xFF,0xFF,0x03,0x00,0x00,0x00,0x00, // q
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x80,0x07,0x00,0x00,0xC0,0x03,0x00,0x00,0xC0,0x01,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x07,0x00,0x00,0xC0,0x07,0x00,0x00,0xC0,0x07,0x00,0x00, // r
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0E,0x0C,0x00,0x80,0x1F,0x1C,0x00,0x80,0x1F,0x1C,0x00,0xC0,0x3F,0x1C,0x00,0xC0,0x3F,0x18,0x00,0xC0,0x38,0x18,0x00,0xC0,0x70,0x18,0x00,0xC0,0x70,0x18,0x00,0xC0,0xF0,0x1C,0x00,0xC0,0xE0,0x1F,0x00,0xC0,0xE1,0x0F,0x00,0xC0,0xE1,0x0F,0x00,0x80,0xC1,0x07,0x00,0x00,0x00,0x00,0x00, // s
+0x00,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xF8,0xFF,0x07,0x00,0xF8,0xFF,0x0F,0x00,0xF8,0xFF,0x1F,0x00,0xF8,0xFF,0x1F,0x00,0xC0,0x00,0x1C,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00,0xC0,0x00,0x18,0x00, // t
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xC0,0xFF,0x07,0x00,0xC0,0xFF,0x0F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x1C,0x00,0x00,0x00,0x1E,0x00,0x00,0x00,0x0F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x00,0x00,0x00,0x00, // u
+0x40,0x00,0x00,0x00,0xC0,0x01,0x00,0x00,0xC0,0x0F,0x00,0x00,0xC0,0x3F,0x00,0x00,0x80,0xFF,0x01,0x00,0x00,0xFE,0x07,0x00,0x00,0xF8,0x1F,0x00,0x00,0xC0,0x1F,0x00,0x00,0x00,0x1F,0x00,0x00,0xC0,0x1F,0x00,0x00,0xF0,0x1F,0x00,0x00,0xFE,0x07,0x00,0x80,0xFF,0x00,0x00,0xC0,0x3F,0x00,0x00,0xC0,0x0F,0x00,0x00,0xC0,0x01,0x00,0x00, // v
+0xC0,0x0F,0x00,0x00,0xC0,0xFF,0x01,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0x00,0xF0,0x1F,0x00,0x00,0xF0,0x1F,0x00,0x00,0xFF,0x1F,0x00,0x80,0xFF,0x01,0x00,0x80,0x1F,0x00,0x00,0x80,0xFF,0x01,0x00,0x80,0xFF,0x1F,0x00,0x00,0xFC,0x1F,0x00,0x00,0xC0,0x1F,0x00,0x00,0xFE,0x1F,0x00,0xC0,0xFF,0x1F,0x00,0xC0,0xFF,0x01,0x00, // w
+0x00,0x00,0x00,0x00,0x40,0x00,0x10,0x00,0xC0,0x01,0x1C,0x00,0xC0,0x03,0x1E,0x00,0xC0,0x07,0x1F,0x00,0xC0,0xDF,0x0F,0x00,0x80,0xFF,0x07,0x00,0x00,0xFE,0x01,0x00,0x00,0xFC,0x01,0x00,0x00,0xFC,0x03,0x00,0x00,0xFF,0x07,0x00,0x80,0xDF,0x1F,0x00,0xC0,0x87,0x1F,0x00,0xC0,0x03,0x1E,0x00,0xC0,0x00,0x1C,0x00,0x40,0x00,0x18,0x00, // x
+0x40,0x00,0x00,0x00,0xC0,0x01,0x00,0x02,0xC0,0x07,0x00,0x02,0xC0,0x3F,0x00,0x02,0xC0,0xFF,0x00,0x03,0x00,0xFF,0x83,0x03,0x00,0xF8,0xFF,0x03,0x00,0xE0,0xFF,0x03,0x00,0x80,0xFF,0x01,0x00,0xC0,0x7F,0x00,0x00,0xF8,0x0F,0x00,0x00,0xFE,0x03,0x00,0x80,0xFF,0x00,0x00,0xC0,0x3F,0x00,0x00,0xC0,0x07,0x00,0x00,0xC0,0x01,0x00,0x00, // y
+0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x00,0xC0,0x00,0x1C,0x00,0xC0,0x00,0x1F,0x00,0xC0,0x80,0x1F,0x00,0xC0,0xC0,0x1F,0x00,0xC0,0xE0,0x1B,0x00,0xC0,0xF0,0x19,0x00,0xC0,0xF8,0x18,0x00,0xC0,0x7C,0x18,0x00,0xC0,0x3E,0x18,0x00,0xC0,0x1F,0x18,0x00,0xC0,0x0F,0x18,0x00,0xC0,0x07,0x18,0x00,0xC0,0x03,0x18,0x00,0xC0,0x01,0x18,0x00, // z
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x3E,0x3C,0x7C,0x00,0xFF,0xFF,0xFF,0x00,0xFF,0xFF,0xFF,0x00,0xFF,0xE7,0xFF,0x01,0xC3,0x81,0xC3,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x00,0x00,0x00,0x00, // {
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0x01,0xFF,0xFF,0xFF,0x01,0xFF,0xFF,0xFF,0x01,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00, // |
+0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x01,0x00,0x80,0x01,0x83,0x81,0xC1,0x01,0xFF,0xE7,0xFF,0x01,0xFF,0xFF,0xFF,0x00,0xFF,0xFF,0xFF,0x00,0x3E,0x3C,0x7C,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x00,0x00,0x00, // }
+0x00,0xC0,0x00,0x00,0x00,0xF0,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x18,0x00,0x00,0x00,0x38,0x00,0x00,0x00,0x78,0x00,0x00,0x00,0x70,0x00,0x00,0x00,0xF0,0x00,0x00,0x00,0xE0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xC0,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0xF8,0x00,0x00,0x00,0x78,0x00,0x00, // ~
+};
+
 
 FontDef_t Font_7x10 = {
 	7,
 	10,
-	Font7x10
+	FONTS_ROWS(Font7x10),
+	Font7x10Pages,
+	NULL
 };
 
 FontDef_t Font_11x18 = {
 	11,
 	18,
-	Font11x18
+	FONTS_ROWS(Font11x18),
+	Font11x18Pages,
+	NULL
 };
 
 FontDef_t Font_16x26 = {
 	16,
 	26,
-	Font16x26
+	FONTS_ROWS(Font16x26),
+	Font16x26Pages,
+	NULL
 };
 
 char* FONTS_GetStringSize(char* str, FONTS_SIZE_t* SizeStruct, FontDef_t* Font) {
@@ -336,6 +648,50 @@ char* FONTS_GetStringSize(char* str, FONTS_SIZE_t* SizeStruct, FontDef_t* Font)
 	SizeStruct->Height = Font->FontHeight;
 	SizeStruct->Length = Font->FontWidth * strlen(str);
 	
+	/* Glyphs of their own width */
+	if (Font->glyphs) {
+		char* s;
+		uint8_t w;
+		
+		SizeStruct->Length = 0;
+		for (s = str; *s; s++) {
+			if (FONTS_GetGlyph(Font, *s, &w)) {
+				SizeStruct->Length += w;
+			}
+		}
+	}
+	
 	/* Return pointer */
 	return str;
 }
+
+const uint8_t* FONTS_GetGlyph(FontDef_t* Font, char ch, uint8_t* Width) {
+	const FontGlyphs_t* g = Font->glyphs;
+	uint8_t c = ch, n;
+	
+	/* All of 32 .. 126 at FontWidth */
+	if (!g) {
+		if (!Font->pages || c < 32 || c > 126) {
+			return NULL;
+		}
+		*Width = Font->FontWidth;
+		return &Font->pages[(c - 32) * Font->FontWidth * ((Font->FontHeight + 7) / 8)];
+	}
+	
+	/* Compiled font */
+	if (c < g->first || c > g->last) {
+		return NULL;
+	}
+	n = c - g->first;
+	if (g->index) {
+		if (!g->index[n]) {
+			return NULL;
+		}
+		n = g->index[n] - 1;
+	}
+	*Width = g->width ? g->width[n] : Font->FontWidth;
+	if (g->offset) {
+		return &g->bitmap[g->offset[n]];
+	}
+	return &g->bitmap[n * Font->FontWidth * ((Font->FontHeight + 7) / 8)];
+}
@@ -39,6 +39,7 @@ extern C {
  *  - 16 x 26 pixels
  */
 //#include "stm32f1xx_hal.h"
+#include "stdint.h"
 #include "stdio.h"
 #include "string.h"
 
@@ -48,13 +49,35 @@ extern C {
  * @{
  */
 
+/**
+ * @brief  Glyphs of a font made by HostSim/fontc.c, only some characters, a width per glyph, run length coded
+ * @note   Glyphs are in LCD page layout as @ref FontDef_t pages. Run length coded glyphs hold the same bytes a page
+ *         row at a time instead (the top byte of every column, then the next), which makes the zero runs long, as a
+ *         control byte and what it says: 0x00 .. 0x7F, that many plus one bytes follow as they are, 0x80 .. 0xBF, the
+ *         next byte (c & 0x3F) + 2 times, 0xC0 .. 0xFF, (c & 0x3F) + 1 zero bytes. Each glyph starts with a control byte
+ */
+typedef struct {
+	uint8_t first;          /*!< First character in the font */
+	uint8_t last;           /*!< Last character in the font */
+	uint8_t rle;            /*!< Glyphs are run length coded */
+	const uint8_t *index;   /*!< Glyph number plus one for each character from first to last, 0 for one left out.
+	                             NULL when none is left out */
+	const uint16_t *offset; /*!< Start of each glyph in bitmap. NULL when glyphs are FontWidth columns, not coded */
+	const uint8_t *width;   /*!< Columns of each glyph. NULL when all are FontWidth */
+	const uint8_t *bitmap;  /*!< Glyphs back to back */
+} FontGlyphs_t;
+
 /**
  * @brief  Font structure used on my LCD libraries
  */
 typedef struct {
 	uint8_t FontWidth;    /*!< Font width in pixels */
 	uint8_t FontHeight;   /*!< Font height in pixels */
-	const uint16_t *data; /*!< Pointer to data font data array */
+	const uint16_t *data; /*!< Pointer to data font data array, NULL when the rows are left out (fonts.c keeps them
+	                           with FONTS_ROW_TABLES defined) */
+	const uint8_t *pages; /*!< Same glyphs in LCD page layout, columns of ceil(FontHeight / 8) bytes with the top row in
+	                           bit 0, NULL when the font only has rows. Made from data by HostSim/fontc.c */
+	const FontGlyphs_t *glyphs; /*!< Glyphs of a compiled font, data and pages are NULL then, FontWidth is the widest */
 } FontDef_t;
 
 /** 
@@ -109,6 +132,15 @@ extern FontDef_t Font_16x26;
  */
 char* FONTS_GetStringSize(char* str, FONTS_SIZE_t* SizeStruct, FontDef_t* Font);
 
+/**
+ * @brief  Finds a glyph in LCD page layout
+ * @param  *Font: Pointer to @ref FontDef_t font with pages or glyphs
+ * @param  ch: Character to look for
+ * @param  *Width: Glyph width in columns is saved here
+ * @retval Pointer to the glyph (run length coded when Font->glyphs->rle is set), NULL when the font does not have it
+ */
+const uint8_t* FONTS_GetGlyph(FontDef_t* Font, char ch, uint8_t* Width);
+
 /**
  * @}
  */
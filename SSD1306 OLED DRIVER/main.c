@@ -8,6 +8,7 @@
 
 #include "fonts.h"
 #include "ssd1306.h"
+#include "myi2c.h"
 #include "mydelay.h"
 
 void i2c_init(void);
@@ -51,10 +52,7 @@ void i2c_init(void)
 {
 	RCC->APB1ENR |= RCC_APB1ENR_I2C2EN; //Enable clock for I2C2
 
-	//calculate according to datasheet (here Fpclk1 = 8 mhz and I2C freq = 100KHz)
-	I2C2->CR2 |= 8; 			// 8mhz Fpclk1
-	I2C2->CCR |= 40;			// ((I2CPERIOD/2)/Tpclk1)
-	I2C2->TRISE |= 9;			// (1000nS/Tpclk1) + 1
+	i2c_tx_clock(400000);		//fast mode , FREQ , CCR , duty and TRISE from SystemCoreClock (381 kHz on the 8 MHz HSI)
 	I2C2->CR1 |= I2C_CR1_ACK;	//Enable ACKs
 	I2C2->CR1 |= I2C_CR1_PE; 	//Enable the peripheral
 }
@@ -34,6 +34,18 @@
 /* SSD1306 data buffer */
 static uint8_t SSD1306_Buffer[SSD1306_WIDTH * SSD1306_HEIGHT / 8];
 
+/* Columns of each page changed since the last update, a clean page has first 0xFF and last 0 */
+static uint8_t SSD1306_DirtyFirst[SSD1306_HEIGHT / 8];
+static uint8_t SSD1306_DirtyLast[SSD1306_HEIGHT / 8];
+
+static void SSD1306_MarkDirty(uint8_t page, uint8_t first, uint8_t last)
+{
+	if (first < SSD1306_DirtyFirst[page])
+		SSD1306_DirtyFirst[page] = first;
+	if (last > SSD1306_DirtyLast[page])
+		SSD1306_DirtyLast[page] = last;
+}
+
 /* Private SSD1306 structure */
 typedef struct
 {
@@ -46,6 +58,18 @@ typedef struct
 /* Private variable */
 static SSD1306_t SSD1306;
 
+/* Column and page window of the LCD (first, last column, first, last page), 0 when not known, the RAM pointer is back
+   at its start after every update since each one fills its window exactly */
+static uint8_t SSD1306_Window[4];
+static uint8_t SSD1306_WindowSet;
+
+/* Updates queued and updates whose last byte is out */
+static volatile uint32_t SSD1306_UpdatesQueued;
+static volatile uint32_t SSD1306_UpdatesDone;
+
+/* Failed transactions of the update in flight, the bus runs them in order so they all end before its last one */
+static volatile uint8_t SSD1306_UpdateErrors;
+
 #define SSD1306_RIGHT_HORIZONTAL_SCROLL              0x26
 #define SSD1306_LEFT_HORIZONTAL_SCROLL               0x27
 #define SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL 0x29
@@ -114,6 +138,9 @@ void SSD1306_Scrolldiagleft(uint8_t start_row, uint8_t end_row)
 void SSD1306_Stopscroll(void)
 {
 	SSD1306_WRITECOMMAND(SSD1306_DEACTIVATE_SCROLL);
+
+	/* RAM has to be rewritten after the scroll is deactivated */
+	SSD1306_Invalidate();
 }
 
 void SSD1306_InvertDisplay(int i)
@@ -154,10 +181,14 @@ void SSD1306_DrawBitmap(int16_t x, int16_t y, const unsigned char *bitmap,
 
 uint8_t SSD1306_Init(void)
 {
+	/* Interrupt driven I2C2 */
+	i2c_tx_init();
+
 	/* Init LCD */
 	SSD1306_WRITECOMMAND(0xAE); //display off
 	SSD1306_WRITECOMMAND(0x20); //Set Memory Addressing Mode   
-	SSD1306_WRITECOMMAND(0x10); //00,Horizontal Addressing Mode;01,Vertical Addressing Mode;10,Page Addressing Mode (RESET);11,Invalid
+	SSD1306_WRITECOMMAND(0x00); //00,Horizontal Addressing Mode;01,Vertical Addressing Mode;10,Page Addressing Mode (RESET);11,Invalid
+	                            //updates go into a column / page window, see SSD1306_SetWindow()
 	SSD1306_WRITECOMMAND(0xB0); //Set Page Start Address for Page Addressing Mode,0-7
 	SSD1306_WRITECOMMAND(0xC8); //Set COM Output Scan Direction
 	SSD1306_WRITECOMMAND(0x00); //---set low column address
@@ -189,7 +220,9 @@ uint8_t SSD1306_Init(void)
 	/* Clear screen */
 	SSD1306_Fill(SSD1306_COLOR_BLACK);
 
-	/* Update screen */
+	/* Update screen, whatever the panel RAM holds after power up is overwritten */
+	SSD1306_WindowSet = 0;
+	SSD1306_Invalidate();
 	SSD1306_UpdateScreen();
 
 	/* Set default values */
@@ -203,19 +236,135 @@ uint8_t SSD1306_Init(void)
 	return 1;
 }
 
+__WEAK void SSD1306_UpdateCompleteCallback(void)
+{
+}
+
+/* Window commands and every page but the last, an error is kept for the end of the update */
+static void SSD1306_PartDone(int err, void *ctx)
+{
+	(void) ctx;
+	if (err)
+	{
+		SSD1306_UpdateErrors++;
+	}
+}
+
+static void SSD1306_UpdateDone(int err, void *ctx)
+{
+	(void) ctx;
+	if (err || SSD1306_UpdateErrors)
+	{
+		SSD1306_UpdateErrors = 0;
+		/* The panel may hold a partial window and partial data, send the window again and the whole frame with it */
+		SSD1306_WindowSet = 0;
+		SSD1306_Invalidate();
+	}
+	SSD1306_UpdatesDone++;
+	SSD1306_UpdateCompleteCallback();
+}
+
+/* Sends only the parts of the window that differ, nothing when it is already set */
+static void SSD1306_SetWindow(uint8_t col0, uint8_t col1, uint8_t page0, uint8_t page1)
+{
+	uint8_t cmd[6], n = 0;
+
+	if (!SSD1306_WindowSet || SSD1306_Window[0] != col0 || SSD1306_Window[1] != col1)
+	{
+		cmd[n++] = 0x21;
+		cmd[n++] = col0;
+		cmd[n++] = col1;
+	}
+	if (!SSD1306_WindowSet || SSD1306_Window[2] != page0 || SSD1306_Window[3] != page1)
+	{
+		cmd[n++] = 0x22;
+		cmd[n++] = page0;
+		cmd[n++] = page1;
+	}
+	SSD1306_Window[0] = col0;
+	SSD1306_Window[1] = col1;
+	SSD1306_Window[2] = page0;
+	SSD1306_Window[3] = page1;
+	SSD1306_WindowSet = 1;
+
+	if (n)
+	{
+		while (!i2c_tx_write(SSD1306_I2C_ADDR, 0x00, cmd, n, SSD1306_PartDone, 0))
+			;
+	}
+}
+
 void SSD1306_UpdateScreen(void)
 {
-	uint8_t m;
+	uint8_t m, first = 0xFF, last = 0, col0, col1;
+	uint32_t windows = 0;
+
+	/* Dirty pages, and the bytes a window per page would take (address, control, commands, columns) */
+	for (m = 0; m < SSD1306_HEIGHT / 8; m++)
+	{
+		if (SSD1306_DirtyFirst[m] <= SSD1306_DirtyLast[m])
+		{
+			first = first == 0xFF ? m : first;
+			last = m;
+			windows += 11 + SSD1306_DirtyLast[m] - SSD1306_DirtyFirst[m];
+		}
+	}
+	if (first == 0xFF)
+	{
+		/* Nothing changed */
+		return;
+	}
+	SSD1306_UpdatesQueued++;
+
+	if ((uint32_t) (10 + (last - first + 1) * SSD1306_WIDTH) <= windows)
+	{
+		/* Whole rows are one block in the buffer, a single transaction (the full frame when everything changed) */
+		SSD1306_SetWindow(0, SSD1306_WIDTH - 1, first, last);
+		for (m = first; m <= last; m++)
+		{
+			SSD1306_DirtyFirst[m] = 0xFF;
+			SSD1306_DirtyLast[m] = 0;
+		}
+		while (!i2c_tx_write(SSD1306_I2C_ADDR, 0x40, &SSD1306_Buffer[SSD1306_WIDTH * first],
+				(last - first + 1) * SSD1306_WIDTH, SSD1306_UpdateDone, 0))
+			;
+		return;
+	}
 
-	for (m = 0; m < 8; m++)
+	for (m = first; m <= last; m++)
 	{
-		SSD1306_WRITECOMMAND(0xB0 + m);
-		SSD1306_WRITECOMMAND(0x00);
-		SSD1306_WRITECOMMAND(0x10);
+		/* Skip pages nothing was drawn on */
+		if (SSD1306_DirtyFirst[m] > SSD1306_DirtyLast[m])
+		{
+			continue;
+		}
+
+		/* Changed columns only, sent by DMA straight from the buffer, the marks are cleared first so an error
+		   callback invalidating the buffer is not undone here */
+		col0 = SSD1306_DirtyFirst[m];
+		col1 = SSD1306_DirtyLast[m];
+		SSD1306_DirtyFirst[m] = 0xFF;
+		SSD1306_DirtyLast[m] = 0;
+		SSD1306_SetWindow(col0, col1, m, m);
+		while (!i2c_tx_write(SSD1306_I2C_ADDR, 0x40, &SSD1306_Buffer[SSD1306_WIDTH * m + col0], col1 - col0 + 1,
+				m == last ? SSD1306_UpdateDone : SSD1306_PartDone, 0))
+			;
+	}
+}
 
-		/* Write multi data */
-		ssd1306_I2C_WriteMulti(SSD1306_I2C_ADDR, 0x40, &SSD1306_Buffer[SSD1306_WIDTH * m],
-				SSD1306_WIDTH);
+uint8_t SSD1306_UpdateBusy(void)
+{
+	return SSD1306_UpdatesQueued != SSD1306_UpdatesDone;
+}
+
+void SSD1306_Invalidate(void)
+{
+	uint8_t m;
+
+	for (m = 0; m < SSD1306_HEIGHT / 8; m++)
+	{
+		SSD1306_DirtyFirst[m] = 0;
+		SSD1306_DirtyLast[m] = SSD1306_WIDTH - 1;
 	}
 }
 
@@ -231,13 +380,30 @@ void SSD1306_ToggleInvert(void)
 	{
 		SSD1306_Buffer[i] = ~SSD1306_Buffer[i];
 	}
+
+	/* Every byte changed */
+	SSD1306_Invalidate();
 }
 
 void SSD1306_Fill(SSD1306_COLOR_t color)
 {
+	uint8_t value = (color == SSD1306_COLOR_BLACK) ? 0x00 : 0xFF;
+	uint8_t m, x;
+
+	/* Mark the columns that change */
+	for (m = 0; m < SSD1306_HEIGHT / 8; m++)
+	{
+		for (x = 0; x < SSD1306_WIDTH; x++)
+		{
+			if (SSD1306_Buffer[SSD1306_WIDTH * m + x] != value)
+			{
+				SSD1306_MarkDirty(m, x, x);
+			}
+		}
+	}
+
 	/* Set memory */
-	memset(SSD1306_Buffer, (color == SSD1306_COLOR_BLACK) ? 0x00 : 0xFF,
-			sizeof(SSD1306_Buffer));
+	memset(SSD1306_Buffer, value, sizeof(SSD1306_Buffer));
 }
 
 void SSD1306_DrawPixel(uint16_t x, uint16_t y, SSD1306_COLOR_t color)
@@ -255,13 +421,22 @@ void SSD1306_DrawPixel(uint16_t x, uint16_t y, SSD1306_COLOR_t color)
 	}
 
 	/* Set color */
+	uint8_t *p = &SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH];
+	uint8_t old = *p;
+
 	if (color == SSD1306_COLOR_WHITE)
 	{
-		SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y % 8);
+		*p |= 1 << (y % 8);
 	}
 	else
 	{
-		SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
+		*p &= ~(1 << (y % 8));
+	}
+
+	/* Only a changed byte has to go to the LCD */
+	if (*p != old)
+	{
+		SSD1306_MarkDirty(y / 8, x, x);
 	}
 }
 
@@ -272,19 +447,129 @@ void SSD1306_GotoXY(uint16_t x, uint16_t y)
 	SSD1306.CurrentY = y;
 }
 
+/* Run length coded glyph bytes, see FontGlyphs_t */
+typedef struct
+{
+	const uint8_t *p;
+	uint8_t n;
+	uint8_t repeat;
+	uint8_t value;
+} SSD1306_Rle_t;
+
+static uint8_t SSD1306_RleByte(SSD1306_Rle_t *r)
+{
+	uint8_t c;
+
+	if (!r->n)
+	{
+		c = *r->p++;
+		r->repeat = c >= 0x80;
+		r->n = c < 0x80 ? c + 1 : c < 0xC0 ? (c & 0x3F) + 2 : (c & 0x3F) + 1;
+		r->value = c < 0x80 ? 0 : c < 0xC0 ? *r->p++ : 0;
+	}
+	r->n--;
+	return r->repeat ? r->value : *r->p++;
+}
+
+/* One buffer byte of a glyph cell, the rows in mask from value */
+static void SSD1306_MergeByte(uint8_t page, uint8_t x, uint8_t mask, uint8_t value)
+{
+	uint8_t *p = &SSD1306_Buffer[SSD1306_WIDTH * page + x];
+	uint8_t old = *p;
+
+	*p = (old & ~mask) | (value & mask);
+
+	/* Only a changed byte has to go to the LCD */
+	if (*p != old)
+	{
+		SSD1306_MarkDirty(page, x, x);
+	}
+}
+
+/* Glyph cell at the cursor from the page layout, each glyph byte shifted down to the cursor row and merged into the
+   buffer bytes below it, rows outside the cell are kept. The caller has checked that the cell fits */
+static void SSD1306_PutGlyph(const uint8_t *g, uint8_t width, uint8_t height, uint8_t rle, SSD1306_COLOR_t color)
+{
+	uint8_t bytes = (height + 7) / 8;
+	uint8_t shift = SSD1306.CurrentY % 8;
+	uint8_t page = SSD1306.CurrentY / 8;
+	uint8_t n = (shift + height + 7) / 8;
+	uint8_t flip = ((color == SSD1306_COLOR_WHITE) != SSD1306.Inverted) ? 0x00 : 0xFF;
+	uint64_t cell = ((1ULL << height) - 1) << shift;
+	uint8_t mask[SSD1306_HEIGHT / 8], above[SSD1306_WIDTH];
+	SSD1306_Rle_t r = { g, 0, 0, 0 };
+	uint16_t v, carry;
+	uint8_t x, i, j, b;
+
+	/* Cell rows of each page the glyph touches */
+	for (j = 0; j < n; j++)
+	{
+		mask[j] = cell >> (8 * j);
+	}
+
+	if (!rle)
+	{
+		/* A column at a time, the bits shifted out of one byte go into the next */
+		for (x = SSD1306.CurrentX; x < SSD1306.CurrentX + width; x++, g += bytes)
+		{
+			carry = 0;
+			for (j = 0; j < n; j++)
+			{
+				v = (j < bytes ? g[j] << shift : 0) | carry;
+				carry = v >> 8;
+				SSD1306_MergeByte(page + j, x, mask[j], v ^ flip);
+			}
+		}
+		return;
+	}
+
+	/* Coded glyphs come a page row at a time, the row above is kept for the bits that carry down */
+	for (j = 0; j < n; j++)
+	{
+		for (i = 0; i < width; i++)
+		{
+			b = j < bytes ? SSD1306_RleByte(&r) : 0;
+			v = (b << shift) | (j ? above[i] >> (8 - shift) : 0);
+			above[i] = b;
+			SSD1306_MergeByte(page + j, SSD1306.CurrentX + i, mask[j], v ^ flip);
+		}
+	}
+}
+
 char SSD1306_Putc(char ch, FontDef_t *Font, SSD1306_COLOR_t color)
 {
 	uint32_t i, b, j;
+	const uint8_t *g = 0;
+	uint8_t width = Font->FontWidth;
+
+	/* Glyph in page layout, with its own width in a compiled font */
+	if (Font->pages || Font->glyphs)
+	{
+		g = FONTS_GetGlyph(Font, ch, &width);
+		if (!g)
+		{
+			/* Not in the font */
+			return 0;
+		}
+	}
 
 	/* Check available space in LCD */
 	if (
-	SSD1306_WIDTH <= (SSD1306.CurrentX + Font->FontWidth) ||
+	SSD1306_WIDTH <= (SSD1306.CurrentX + width) ||
 	SSD1306_HEIGHT <= (SSD1306.CurrentY + Font->FontHeight))
 	{
 		/* Error */
 		return 0;
 	}
 
+	/* Whole bytes when the font has its page layout */
+	if (g)
+	{
+		SSD1306_PutGlyph(g, width, Font->FontHeight, Font->glyphs && Font->glyphs->rle, color);
+		SSD1306.CurrentX += width;
+		return ch;
+	}
+
 	/* Go through font */
 	for (i = 0; i < Font->FontHeight; i++)
 	{
@@ -670,39 +955,15 @@ void SSD1306_OFF(void)
 
 void ssd1306_I2C_Write(uint8_t address, uint8_t reg, uint8_t data)
 {
-	I2C2->CR1 |= I2C_CR1_PE;
-	I2C2->CR1 |= I2C_CR1_START;
-	while (!(I2C2->SR1 & I2C_SR1_SB))
-		;
-	I2C2->DR = address;
-	while (!(I2C2->SR1 & I2C_SR1_ADDR))
+	/* Copied into the queue, goes out after everything queued before it */
+	while (!i2c_tx_write(address, reg, &data, 1, 0, 0))
 		;
-	int temp = I2C2->SR2;
-	I2C2->DR = reg;
-	while (!(I2C2->SR1 & I2C_SR1_TXE))
-		;
-	I2C2->DR = data;
-	while (!(I2C2->SR1 & I2C_SR1_TXE))
-		;
-	I2C2->CR1 |= I2C_CR1_STOP;
 }
 void ssd1306_I2C_WriteMulti(uint8_t address, uint8_t reg, uint8_t *data, uint16_t count)
 {
-	I2C2->CR1 |= I2C_CR1_PE;
-	I2C2->CR1 |= I2C_CR1_START;
-	while (!(I2C2->SR1 & I2C_SR1_SB))
-		;
-	I2C2->DR = address;
-	while (!(I2C2->SR1 & I2C_SR1_ADDR))
-		;
-	int temp = I2C2->SR2;
-	I2C2->DR = reg;
-	while (!(I2C2->SR1 & I2C_SR1_TXE))
+	while (!i2c_tx_write(address, reg, data, count, 0, 0))
 		;
-	for (temp = 0; temp < count; temp++)
-	{
-		I2C2->DR = *(data + temp);
-		while (!(I2C2->SR1 & I2C_SR1_TXE))
-			;
-	}
+
+	/* Data may be on the stack, wait until the stop is out */
+	i2c_tx_flush();
 }
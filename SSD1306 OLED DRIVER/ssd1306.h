@@ -32,7 +32,7 @@ extern C {
 #endif
 
 /**
- * This SSD1306 LCD uses I2C2 for communication
+ * This SSD1306 LCD uses I2C2 for communication, driven by interrupts and DMA1 channel 4 (MyDrivers/myi2c.c)
  *
  * Library features functions for drawing lines, rectangles and circles.
  *
@@ -50,6 +50,7 @@ extern C {
 
 
 #include "stm32f1xx.h"
+#include "myi2c.h"
 #include "fonts.h"
 #include "stdlib.h"
 #include "string.h"
@@ -92,11 +93,40 @@ uint8_t SSD1306_Init(void);
 /** 
  * @brief  Updates buffer from internal RAM to LCD
  * @note   This function must be called each time you do some changes to LCD, to update buffer from RAM to LCD
+ * @note   Only pages with changes are sent, each from its first to its last changed column in its own window, or
+ *         all rows from the first to the last changed page in one transaction when that takes fewer bytes. A full
+ *         frame is one 1024 byte transaction, the window commands are left out when the window is already set
+ * @note   Returns once the transfers are queued, DMA reads the buffer while they are on the bus. Drawing in the
+ *         meantime is safe, a column drawn after it went out is sent again by the next update
  * @param  None
  * @retval None
  */
 void SSD1306_UpdateScreen(void);
 
+/**
+ * @brief  Tells if an update is still on the bus
+ * @param  None
+ * @retval 1 while the last byte of an update is not out, 0 otherwise
+ */
+uint8_t SSD1306_UpdateBusy(void);
+
+/**
+ * @brief  Called from the I2C2 interrupt when the last byte of an update is out
+ * @note   Weak, not called for an update that found nothing to send
+ * @param  None
+ * @retval None
+ */
+void SSD1306_UpdateCompleteCallback(void);
+
+/**
+ * @brief  Marks the whole screen for the next @ref SSD1306_UpdateScreen()
+ * @note   Only the columns changed since the last update are sent otherwise, call this when the LCD RAM
+ *         no longer matches the buffer (power up, after a scroll was stopped)
+ * @param  None
+ * @retval None
+ */
+void SSD1306_Invalidate(void);
+
 /**
  * @brief  Toggles pixels invertion inside internal RAM
  * @note   @ref SSD1306_UpdateScreen() must be called after that in order to see updated LCD screen
@@ -134,10 +164,13 @@ void SSD1306_GotoXY(uint16_t x, uint16_t y);
 /**
  * @brief  Puts character to internal RAM
  * @note   @ref SSD1306_UpdateScreen() must be called after that in order to see updated LCD screen
+ * @note   Fonts with a page layout (@ref FontDef_t pages or glyphs) are written a buffer byte at a time, a glyph column
+ *         per page, others a pixel at a time. Both give the same result. A compiled font moves the cursor by the width
+ *         of the glyph
  * @param  ch: Character to be written
  * @param  *Font: Pointer to @ref FontDef_t structure with used font
  * @param  color: Color used for drawing. This parameter can be a value of @ref SSD1306_COLOR_t enumeration
- * @retval Character written
+ * @retval Character written, 0 when it does not fit or the font does not have it
  */
 char SSD1306_Putc(char ch, FontDef_t *Font, SSD1306_COLOR_t color);
 
@@ -233,11 +266,12 @@ void SSD1306_DrawFilledCircle(int16_t x0, int16_t y0, int16_t r,
 #endif
 
 /**
- * @brief  Initializes SSD1306 LCD
- * @param  None
- * @retval Initialization status:
- *           - 0: LCD was not detected on I2C port
- *           - > 0: LCD initialized OK and ready to use
+ * @brief  Writes single byte to slave
+ * @note   Queued, returns at once
+ * @param  address: 7 bit slave address, left aligned, bits 7:1 are used, LSB bit is not used
+ * @param  reg: register to write to
+ * @param  data: data to be written
+ * @retval None
  */
 
 void ssd1306_I2C_Write(uint8_t address, uint8_t reg, uint8_t data);
@@ -249,6 +283,7 @@ void ssd1306_I2C_Write(uint8_t address, uint8_t reg, uint8_t data);
  * @param  reg: register to write to
  * @param  *data: pointer to data array to write it to slave
  * @param  count: how many bytes will be written
+ * @note   Returns once the stop is out, data may be reused
  * @retval None
  */
 void ssd1306_I2C_WriteMulti(uint8_t address, uint8_t reg, uint8_t *data,
@@ -276,6 +311,8 @@ void SSD1306_Scrolldiagright(uint8_t start_row, uint8_t end_row);
 
 void SSD1306_Scrolldiagleft(uint8_t start_row, uint8_t end_row);
 
+// stops the scroll and marks the whole screen, @ref SSD1306_UpdateScreen() rewrites the LCD RAM
+
 void SSD1306_Stopscroll(void);
 
 // inverts the display i = 1->inverted, i = 0->normal
@@ -31,6 +31,7 @@
 #include "tusb.h"
 #include "stm32f1xx.h"
 #include "usb_descriptors.h"
+#include "myadc.h"		//in MyDrivers
 
 //--------------------------------------------------------------------+
 // MACRO CONSTANT TYPEDEF PROTYPES
@@ -49,7 +50,9 @@ static uint32_t blink_interval_ms = BLINK_NOT_MOUNTED;
 
 void led_blinking_task(void);
 void hid_task(void);
-volatile uint16_t adcdata[2] = { 0, 0 };
+//A5 -> X , A6 -> Y , 1000 scans per second paced by TIM3
+static const adc_config_t adc_cfg = { .rate = 1000, .trigger = ADC_TRIG_TIM3_TRGO, .block = 10, .nch = 2, .channels = { 5, 6 },
+	.smp = { ADC_SMP_41_5, ADC_SMP_41_5 } };
 
 void adc_init(void) {
 	//enable clock for port A and B , and AFIO
@@ -65,38 +68,7 @@ void adc_init(void) {
 	GPIOA->CRL &= ~GPIO_CRL_CNF6_0;
 	GPIOA->CRL &= ~(GPIO_CRL_MODE6_0 | GPIO_CRL_MODE6_1);
 
-	RCC->CFGR |= RCC_CFGR_ADCPRE_DIV6;   			//adc prescaler /6 (<14mhz)
-	RCC->APB2ENR |= RCC_APB2ENR_ADC1EN; 				//clock enable for adc
-	//enable clock for DMA1
-	RCC->AHBENR |= RCC_AHBENR_DMA1EN;
-	// L[3:0] in ADC1_SQR1 TO SET THE NUMBER OF CONVERSIONS (here default 0000 - 1 conv)
-
-	ADC1->SQR1 |= ADC_SQR1_L_0;							//2 conversions
-	ADC1->SQR3 |= ADC_SQR3_SQ1_0 | ADC_SQR3_SQ1_2; 	//channel 5 in sequence 1
-	ADC1->SMPR2 |= ADC_SMPR2_SMP5_2; 		 		//set sampling rate (ch5)
-	ADC1->SQR3 |= ADC_SQR3_SQ2_1 | ADC_SQR3_SQ2_2; 	//channel 6 in sequence 2
-	ADC1->SMPR2 |= ADC_SMPR2_SMP6_2; 		 		//set sampling rate (ch6)
-
-	/*****DMA SETTINGS*****/
-	ADC1->CR2 |= ADC_CR2_DMA;							//enable DMA for ADC1
-	DMA1_Channel1->CNDTR = 2;
-	DMA1_Channel1->CMAR = (uint32_t) adcdata;
-	DMA1_Channel1->CPAR = (uint32_t) &(ADC1->DR);
-	DMA1_Channel1->CCR |= (DMA_CCR_CIRC | DMA_CCR_MINC | DMA_CCR_MSIZE_0
-			| DMA_CCR_PSIZE_0);
-	DMA1_Channel1->CCR |= DMA_CCR_EN;
-	/**********************/
-	ADC1->CR1 |= ADC_CR1_SCAN;
-	ADC1->CR2 |= ADC_CR2_ADON | ADC_CR2_CONT; //turn on adc and set it to continous conversion mode
-	int i;
-	for (i = 0; i < 1000; i++)
-		__NOP();
-	ADC1->CR2 |= ADC_CR2_ADON;
-	for (i = 0; i < 1000; i++)
-		__NOP();
-	ADC1->CR2 |= ADC_CR2_CAL;  		      		    //run calibration
-	for (i = 0; i < 5000; i++)
-		__NOP();
+	adc_stream_init(&adc_cfg);	//calibrates and starts the timer paced ping-pong DMA scan
 }
 /*------------- MAIN -------------*/
 int main(void) {
@@ -150,6 +122,8 @@ static void send_hid_report(uint8_t report_id, uint32_t btn) {
 	if (!tud_hid_ready())
 		return;
 	int8_t X, Y;
+	uint16_t adcdata[2];
+	adc_snapshot(adcdata);	//X and Y from the same scan
 	if (adcdata[0] > 2400)
 		X = -3;
 	else if (adcdata[0] < 1600)